@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Per-metric samples from repeated benchmark runs, their summary statistics,
+// a plain-text baseline file and a regression check between two sets.
+//
+// Each metric keeps one sample per run and knows whether lower or higher is
+// better. Summaries give mean, sample standard deviation, median and a 95%
+// Student-t confidence interval of the mean. Compare() runs Welch's t-test
+// (unequal variances) on two sample sets and calls a change a regression only
+// when it is significant at 95% two-sided, in the worse direction and at
+// least kMinRegressionPct of the baseline mean, so stable runs still trip on
+// 5% shifts without flagging sub-percent drift.
+//
+// Baseline file format, one metric per line, '#' lines are comments:
+//   metric <name> lower|higher <sample> <sample> ...
+class BenchStats {
+ public:
+  static const char* FileHeader() { return "# fpga_benchmark baseline v1"; }
+  static constexpr double kMinRegressionPct = 1.0;
+
+  enum Better { kLowerIsBetter = 0, kHigherIsBetter = 1 };
+
+  struct Metric {
+    std::string name;
+    Better better;
+    std::vector<double> samples;
+  };
+
+  struct Summary {
+    uint64_t n;
+    double mean;
+    double stddev;
+    double median;
+    double min;
+    double max;
+    double ci95_low;
+    double ci95_high;
+  };
+
+  struct Comparison {
+    double baseline_mean;
+    double mean;
+    // (mean - baseline_mean) / baseline_mean, in percent.
+    double change_pct;
+    double t;
+    double dof;
+    bool significant;
+    bool regression;
+  };
+
+  void Clear() { metrics_.clear(); }
+
+  // Appends one sample; the first sample of a name fixes its direction.
+  void Add(const std::string& name, Better better, double value) {
+    for (std::size_t i = 0; i < metrics_.size(); ++i) {
+      if (metrics_[i].name == name) {
+        metrics_[i].samples.push_back(value);
+        return;
+      }
+    }
+    Metric metric;
+    metric.name = name;
+    metric.better = better;
+    metric.samples.push_back(value);
+    metrics_.push_back(metric);
+  }
+
+  const std::vector<Metric>& Metrics() const { return metrics_; }
+
+  const Metric* Find(const std::string& name) const {
+    for (std::size_t i = 0; i < metrics_.size(); ++i) {
+      if (metrics_[i].name == name) {
+        return &metrics_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  static const char* BetterName(Better better) {
+    return better == kHigherIsBetter ? "higher" : "lower";
+  }
+
+  static Summary Summarize(const std::vector<double>& samples) {
+    Summary summary{};
+    summary.n = samples.size();
+    if (samples.empty()) {
+      return summary;
+    }
+    std::vector<double> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+      sum += sorted[i];
+    }
+    summary.mean = sum / static_cast<double>(sorted.size());
+    const std::size_t mid = sorted.size() / 2;
+    summary.median = sorted.size() % 2 == 1 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2.0;
+    summary.min = sorted.front();
+    summary.max = sorted.back();
+    summary.stddev = std::sqrt(Variance(sorted, summary.mean));
+    const double half = sorted.size() < 2
+                            ? 0.0
+                            : StudentT975(static_cast<double>(sorted.size() - 1)) *
+                                  summary.stddev / std::sqrt(static_cast<double>(sorted.size()));
+    summary.ci95_low = summary.mean - half;
+    summary.ci95_high = summary.mean + half;
+    return summary;
+  }
+
+  // Welch's t-test of `current` against `baseline`. Needs two samples on
+  // each side to call anything significant.
+  static Comparison Compare(const Metric& baseline, const Metric& current) {
+    Comparison result{};
+    const Summary base = Summarize(baseline.samples);
+    const Summary cur = Summarize(current.samples);
+    result.baseline_mean = base.mean;
+    result.mean = cur.mean;
+    result.change_pct =
+        base.mean != 0.0 ? (cur.mean - base.mean) / std::fabs(base.mean) * 100.0 : 0.0;
+    if (base.n < 2 || cur.n < 2) {
+      return result;
+    }
+    const double vb = base.stddev * base.stddev / static_cast<double>(base.n);
+    const double vc = cur.stddev * cur.stddev / static_cast<double>(cur.n);
+    const double diff = cur.mean - base.mean;
+    if (vb + vc == 0.0) {
+      // Both sets constant: any difference is certain.
+      result.t = diff == 0.0 ? 0.0 : (diff > 0 ? 1.0 : -1.0) * std::numeric_limits<double>::max();
+      result.dof = static_cast<double>(base.n + cur.n - 2);
+      result.significant = diff != 0.0;
+    } else {
+      result.t = diff / std::sqrt(vb + vc);
+      result.dof = (vb + vc) * (vb + vc) /
+                   (vb * vb / static_cast<double>(base.n - 1) +
+                    vc * vc / static_cast<double>(cur.n - 1));
+      result.significant = std::fabs(result.t) > StudentT975(result.dof);
+    }
+    const bool worse = baseline.better == kHigherIsBetter ? diff < 0.0 : diff > 0.0;
+    result.regression =
+        result.significant && worse && std::fabs(result.change_pct) >= kMinRegressionPct;
+    return result;
+  }
+
+  // Two-sided 95% critical value of Student's t with `dof` degrees of
+  // freedom, rounded down to the table (conservative for Welch's fractional
+  // dof).
+  static double StudentT975(double dof) {
+    static const double kTable[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                      2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                      2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                      2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    if (!(dof >= 1.0)) {
+      return kTable[0];
+    }
+    if (dof < 31.0) {
+      return kTable[static_cast<int>(dof) - 1];
+    }
+    if (dof < 40.0) {
+      return 2.042;
+    }
+    if (dof < 60.0) {
+      return 2.021;
+    }
+    if (dof < 120.0) {
+      return 2.000;
+    }
+    return dof < 1000.0 ? 1.980 : 1.960;
+  }
+
+  bool Save(const std::string& path, const std::string& comment) const {
+    std::ofstream out(path.c_str());
+    if (!out) {
+      return false;
+    }
+    out << FileHeader() << "\n";
+    if (!comment.empty()) {
+      out << "# " << comment << "\n";
+    }
+    out << std::setprecision(17);
+    for (std::size_t i = 0; i < metrics_.size(); ++i) {
+      const Metric& metric = metrics_[i];
+      out << "metric " << metric.name << " " << BetterName(metric.better);
+      for (std::size_t j = 0; j < metric.samples.size(); ++j) {
+        out << " " << metric.samples[j];
+      }
+      out << "\n";
+    }
+    return static_cast<bool>(out);
+  }
+
+  // Replaces the contents with `path`. On a malformed line returns false and
+  // sets `bad_line` to its 1-based number (0 if the file could not be read).
+  bool Load(const std::string& path, uint64_t* bad_line) {
+    *bad_line = 0;
+    std::ifstream in(path.c_str());
+    if (!in) {
+      return false;
+    }
+    std::vector<Metric> loaded;
+    std::string line;
+    uint64_t number = 0;
+    while (std::getline(in, line)) {
+      ++number;
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      std::istringstream fields(line);
+      std::string tag;
+      std::string better;
+      Metric metric;
+      fields >> tag >> metric.name >> better;
+      if (tag != "metric" || metric.name.empty() || (better != "lower" && better != "higher")) {
+        *bad_line = number;
+        return false;
+      }
+      metric.better = better == "higher" ? kHigherIsBetter : kLowerIsBetter;
+      double value = 0.0;
+      while (fields >> value) {
+        metric.samples.push_back(value);
+      }
+      if (!fields.eof() || metric.samples.empty()) {
+        *bad_line = number;
+        return false;
+      }
+      loaded.push_back(metric);
+    }
+    metrics_.swap(loaded);
+    return true;
+  }
+
+ private:
+  static double Variance(const std::vector<double>& samples, double mean) {
+    if (samples.size() < 2) {
+      return 0.0;
+    }
+    double sum = 0.0;
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+      sum += (samples[i] - mean) * (samples[i] - mean);
+    }
+    return sum / static_cast<double>(samples.size() - 1);
+  }
+
+  std::vector<Metric> metrics_;
+};
@@ -0,0 +1,261 @@
+#pragma once
+
+#include "feed_mapping.h"
+#include "fpga_shared_stream.h"
+#include "sw_order_book.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+// Checkpoint of the software-side book and the last feed SeqNo in a small
+// mapped file, so a restarted receiver can rebuild the FPGA book at once
+// instead of waiting for the market to repopulate it.
+//
+// File layout (native-endian):
+//   0     FileHeader (64 bytes): magic, version, book shape
+//   64    two slots, each a SlotHeader (64 bytes) and up to
+//         num_symbols * depth * 2 Levels (16 bytes each)
+//
+// Save() writes the slot not holding the latest checkpoint. Its generation
+// is odd while the slot is written and even once complete, and a checksum
+// covers the contents, so a crash mid-save leaves the previous checkpoint
+// to load. Only occupied levels are stored: 8 symbols of depth 8 are at
+// most 2 KiB. The file is not fsynced; it survives a process crash, and a
+// power loss only if the kernel wrote it back.
+class BookCheckpoint {
+ public:
+  static const uint32_t kMagic = 0x50434B42u;  // "BKCP"
+  static const uint32_t kVersion = 1;
+
+  struct Level {
+    uint32_t symbol;
+    uint32_t side;
+    uint32_t price;
+    uint32_t qty;
+  };
+
+  struct Snapshot {
+    uint64_t generation;
+    uint64_t last_seq;
+    uint64_t saved_realtime_ns;
+    // Per symbol, bids then asks, best first.
+    std::vector<Level> levels;
+  };
+
+  BookCheckpoint() : map_(nullptr), bytes_(0), slot_bytes_(0), saves_(0) {}
+  ~BookCheckpoint() { Close(); }
+
+  BookCheckpoint(const BookCheckpoint&) = delete;
+  BookCheckpoint& operator=(const BookCheckpoint&) = delete;
+
+  // Maps `path`, creating it if needed. A file written for another book
+  // shape (or not a checkpoint at all) is reinitialised empty and
+  // `*discarded` is set.
+  bool Open(const std::string& path, const SwOrderBook::Config& config, bool* discarded,
+            std::string* error) {
+    Close();
+    *discarded = false;
+    const std::size_t max_levels =
+        static_cast<std::size_t>(config.num_symbols) * config.depth * 2u;
+    const std::size_t slot_bytes = sizeof(SlotHeader) + max_levels * sizeof(Level);
+    const std::size_t bytes = sizeof(FileHeader) + 2u * slot_bytes;
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+      *error = "open " + path + ": " + std::strerror(errno);
+      return false;
+    }
+    struct stat st;
+    const bool existed = fstat(fd, &st) == 0 && st.st_size > 0;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+      *error = "ftruncate " + path + ": " + std::strerror(errno);
+      close(fd);
+      return false;
+    }
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+      *error = "mmap " + path + ": " + std::strerror(errno);
+      return false;
+    }
+    map_ = static_cast<char*>(map);
+    bytes_ = bytes;
+    slot_bytes_ = slot_bytes;
+
+    FileHeader* header = GetFileHeader();
+    if (header->magic != kMagic || header->version != kVersion ||
+        header->num_symbols != config.num_symbols || header->depth != config.depth ||
+        header->slot_bytes != slot_bytes) {
+      *discarded = existed;
+      std::memset(map_, 0, bytes_);
+      header->version = kVersion;
+      header->num_symbols = config.num_symbols;
+      header->depth = config.depth;
+      header->slot_bytes = static_cast<uint32_t>(slot_bytes);
+      header->magic = kMagic;
+    }
+    return true;
+  }
+
+  void Close() {
+    if (map_ != nullptr) {
+      munmap(map_, bytes_);
+      map_ = nullptr;
+    }
+  }
+
+  bool IsOpen() const { return map_ != nullptr; }
+  uint64_t Saves() const { return saves_; }
+
+  // Latest complete checkpoint; false if there is none.
+  bool Load(Snapshot* snapshot) const {
+    const SlotHeader* best = nullptr;
+    for (uint32_t s = 0; s < 2; ++s) {
+      const SlotHeader* slot = GetSlot(s);
+      const uint64_t generation = slot->generation.load(std::memory_order_acquire);
+      if (generation == 0 || (generation & 1u) != 0 || slot->levels > MaxLevels() ||
+          slot->checksum != Checksum(*slot, LevelsOf(slot))) {
+        continue;
+      }
+      if (best == nullptr || generation > best->generation.load(std::memory_order_relaxed)) {
+        best = slot;
+      }
+    }
+    if (best == nullptr) {
+      return false;
+    }
+    snapshot->generation = best->generation.load(std::memory_order_relaxed);
+    snapshot->last_seq = best->last_seq;
+    snapshot->saved_realtime_ns = best->saved_realtime_ns;
+    snapshot->levels.assign(LevelsOf(best), LevelsOf(best) + best->levels);
+    return true;
+  }
+
+  // Writes the occupied levels of `book` (of the shape given to Open()).
+  void Save(const SwOrderBook& book, uint64_t last_seq) {
+    // Never overwrite the latest complete checkpoint, even if the other slot
+    // holds a torn save with a higher generation.
+    const uint64_t g0 = GetSlot(0)->generation.load(std::memory_order_relaxed);
+    const uint64_t g1 = GetSlot(1)->generation.load(std::memory_order_relaxed);
+    const uint64_t complete0 = (g0 & 1u) == 0 ? g0 : 0;
+    const uint64_t complete1 = (g1 & 1u) == 0 ? g1 : 0;
+    SlotHeader* slot = GetSlot(complete1 > complete0 ? 0u : 1u);
+    const uint64_t next = (std::max(g0, g1) | 1u) + 1u;  // even, past both slots
+    slot->generation.store(next - 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Level* levels = LevelsOf(slot);
+    uint32_t count = 0;
+    const uint32_t depth = book.Depth();
+    for (uint32_t symbol = 0; symbol < book.NumSymbols(); ++symbol) {
+      count = CopySide(symbol, SwOrderBook::kSideBuy, book.BidPrices(symbol),
+                       book.BidQtys(symbol), depth, levels, count);
+      count = CopySide(symbol, SwOrderBook::kSideSell, book.AskPrices(symbol),
+                       book.AskQtys(symbol), depth, levels, count);
+    }
+    slot->levels = count;
+    slot->last_seq = last_seq;
+    slot->saved_realtime_ns = RealtimeNs();
+    slot->checksum = Checksum(*slot, levels);
+    slot->generation.store(next, std::memory_order_release);
+    ++saves_;
+  }
+
+  // Frames that rebuild the checkpointed book from any state: a reset per
+  // symbol, then its levels best first, numbered from 1.
+  static void ReplayFrames(const Snapshot& snapshot, uint32_t num_symbols,
+                           std::vector<FpgaSharedStream::Frame>* frames) {
+    frames->clear();
+    frames->reserve(num_symbols + snapshot.levels.size());
+    uint32_t seq = 0;
+    std::size_t next = 0;
+    for (uint32_t symbol = 0; symbol < num_symbols; ++symbol) {
+      frames->push_back(FeedMapping::ResetFrame(++seq, symbol));
+      for (; next < snapshot.levels.size() && snapshot.levels[next].symbol == symbol; ++next) {
+        const Level& level = snapshot.levels[next];
+        frames->push_back(
+            FeedMapping::LevelFrame(++seq, symbol, level.price, level.qty, level.side));
+      }
+    }
+  }
+
+ private:
+  struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_symbols;
+    uint32_t depth;
+    uint32_t slot_bytes;
+    char pad[44];
+  };
+
+  struct SlotHeader {
+    std::atomic<uint64_t> generation;
+    uint64_t last_seq;
+    uint64_t saved_realtime_ns;
+    uint64_t checksum;
+    uint32_t levels;
+    char pad[28];
+  };
+
+  static_assert(sizeof(Level) == 16, "checkpoint levels are 16 bytes");
+  static_assert(sizeof(FileHeader) == 64, "checkpoint header is 64 bytes");
+  static_assert(sizeof(SlotHeader) == 64, "checkpoint slot header is 64 bytes");
+
+  static uint64_t RealtimeNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(ts.tv_nsec);
+  }
+
+  // FNV-1a over the slot fields and levels.
+  static uint64_t Checksum(const SlotHeader& slot, const Level* levels) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const uint64_t fields[] = {slot.last_seq, slot.saved_realtime_ns, slot.levels};
+    hash = Fnv(hash, fields, sizeof(fields));
+    return Fnv(hash, levels, static_cast<std::size_t>(slot.levels) * sizeof(Level));
+  }
+
+  static uint64_t Fnv(uint64_t hash, const void* data, std::size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < bytes; ++i) {
+      hash = (hash ^ p[i]) * 0x100000001b3ull;
+    }
+    return hash;
+  }
+
+  static uint32_t CopySide(uint32_t symbol, uint32_t side, const uint32_t* px,
+                           const uint32_t* qty, uint32_t depth, Level* out, uint32_t count) {
+    for (uint32_t i = 0; i < depth && qty[i] != 0; ++i) {
+      out[count++] = Level{symbol, side, px[i], qty[i]};
+    }
+    return count;
+  }
+
+  FileHeader* GetFileHeader() const { return reinterpret_cast<FileHeader*>(map_); }
+  SlotHeader* GetSlot(uint32_t index) const {
+    return reinterpret_cast<SlotHeader*>(map_ + sizeof(FileHeader) + index * slot_bytes_);
+  }
+  static Level* LevelsOf(const SlotHeader* slot) {
+    return reinterpret_cast<Level*>(const_cast<SlotHeader*>(slot) + 1);
+  }
+  uint32_t MaxLevels() const {
+    return static_cast<uint32_t>((slot_bytes_ - sizeof(SlotHeader)) / sizeof(Level));
+  }
+
+  char* map_;
+  std::size_t bytes_;
+  std::size_t slot_bytes_;
+  uint64_t saves_;
+};
@@ -0,0 +1,300 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+#include "spsc_ring.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+// Append-only journal of bridge traffic: every TX event frame and RX
+// response with a CLOCK_MONOTONIC nanosecond timestamp.
+//
+// Append() is the only hot-path call. It timestamps the frame and pushes it
+// into an SpscRing, and never blocks or touches the file. A background
+// writer thread drains the ring into a file that Open() preallocated and
+// mapped, then publishes the record count in the file header, so a reader
+// can follow a live journal. If the ring is full (the writer fell behind)
+// or the file is full, records are dropped and counted rather than stalling
+// the caller. Close() drains the ring and trims the file to the records
+// written. A process that never closes leaves the preallocated tail, and
+// the header count still marks where the records end.
+//
+// File layout (native-endian, the same on the board and an x86 host):
+//   0    Header (64 bytes)
+//   64   Record[count], 48 bytes each
+//
+// Reader maps a journal read-only and iterates the records in place.
+class BridgeJournal {
+ public:
+  static const uint32_t kMagic = 0x4A544648u;  // "HFTJ"
+  static const uint32_t kVersion = 1;
+  static const uint64_t kDefaultRecords = 1u << 20;  // 48 MiB
+  static const std::size_t kRingRecords = 1u << 16;
+
+  enum Direction {
+    kTx = 1,  // event frame sent to the FPGA (or the software book)
+    kRx = 2,  // response received
+  };
+
+  struct Record {
+    uint64_t timestamp_ns;
+    uint32_t direction;
+    uint32_t reserved;
+    FpgaSharedStream::Frame frame;
+  };
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_bytes;
+    uint32_t reserved;
+    uint64_t capacity;
+    // Records written; release-stored by the writer after the records.
+    std::atomic<uint64_t> count;
+    uint64_t dropped;
+    // Clocks at Open(), to place the monotonic stamps in wall-clock time.
+    uint64_t start_realtime_ns;
+    uint64_t start_monotonic_ns;
+    char pad[8];
+  };
+
+  static_assert(sizeof(Record) == 48, "journal records are 48 bytes");
+  static_assert(sizeof(Header) == 64, "journal header is 64 bytes");
+
+  static uint64_t NowNs(clockid_t clock_id = CLOCK_MONOTONIC) {
+    timespec ts{};
+    clock_gettime(clock_id, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(ts.tv_nsec);
+  }
+
+  BridgeJournal()
+      : map_(nullptr),
+        bytes_(0),
+        fd_(-1),
+        running_(false),
+        ring_dropped_(0),
+        file_dropped_(0) {}
+  ~BridgeJournal() { Close(); }
+
+  BridgeJournal(const BridgeJournal&) = delete;
+  BridgeJournal& operator=(const BridgeJournal&) = delete;
+
+  // Creates (or replaces) `path` with room for `capacity` records and starts
+  // the writer thread.
+  bool Open(const std::string& path, uint64_t capacity, std::string* error) {
+    Close();
+    if (capacity == 0) {
+      *error = "journal capacity must be at least one record";
+      return false;
+    }
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      *error = "open " + path + ": " + std::strerror(errno);
+      return false;
+    }
+    const std::size_t bytes =
+        sizeof(Header) + static_cast<std::size_t>(capacity) * sizeof(Record);
+    // Reserve the blocks up front so the writer never hits ENOSPC mid-page.
+    const int rc = posix_fallocate(fd, 0, static_cast<off_t>(bytes));
+    if (rc != 0 && ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+      const int truncate_errno = errno;
+      *error = "preallocate " + path + ": " + std::strerror(rc);
+      *error += std::string("; ftruncate: ") + std::strerror(truncate_errno);
+      close(fd);
+      return false;
+    }
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+      *error = "mmap " + path + ": " + std::strerror(errno);
+      close(fd);
+      return false;
+    }
+    map_ = static_cast<char*>(map);
+    bytes_ = bytes;
+    fd_ = fd;
+    Header* header = HeaderOf(map_);
+    header->version = kVersion;
+    header->record_bytes = sizeof(Record);
+    header->reserved = 0;
+    header->capacity = capacity;
+    new (&header->count) std::atomic<uint64_t>(0);
+    header->dropped = 0;
+    header->start_realtime_ns = NowNs(CLOCK_REALTIME);
+    header->start_monotonic_ns = NowNs();
+    header->magic = kMagic;
+    if (!ring_) {
+      // 3 MiB; only receivers that journal pay for it.
+      ring_.reset(new SpscRing<Record>(kRingRecords));
+    }
+    ring_dropped_.store(0, std::memory_order_relaxed);
+    file_dropped_ = 0;
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread(&BridgeJournal::WriterLoop, this);
+    return true;
+  }
+
+  // Drains what is queued, stops the writer and trims the file.
+  void Close() {
+    if (map_ == nullptr) {
+      return;
+    }
+    running_.store(false, std::memory_order_release);
+    writer_.join();
+    Header* header = HeaderOf(map_);
+    header->dropped = Dropped();
+    const uint64_t count = header->count.load(std::memory_order_relaxed);
+    munmap(map_, bytes_);
+    // On failure the header count still bounds the records; the tail is unused.
+    (void)ftruncate(fd_, static_cast<off_t>(sizeof(Header) + count * sizeof(Record)));
+    close(fd_);
+    map_ = nullptr;
+    fd_ = -1;
+  }
+
+  bool IsOpen() const { return map_ != nullptr; }
+
+  // Hot path: one clock read and one ring push. Call only while open.
+  void Append(uint32_t direction, const FpgaSharedStream::Frame& frame) {
+    Record record;
+    record.timestamp_ns = NowNs();
+    record.direction = direction;
+    record.reserved = 0;
+    record.frame = frame;
+    if (!ring_->TryPush(record)) {
+      ring_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t Written() const {
+    return map_ == nullptr ? 0 : HeaderOf(map_)->count.load(std::memory_order_acquire);
+  }
+  // Dropped to a full ring or a full file. Exact after Close().
+  uint64_t Dropped() const {
+    return ring_dropped_.load(std::memory_order_relaxed) +
+           file_dropped_.load(std::memory_order_relaxed);
+  }
+
+  class Reader {
+   public:
+    Reader() : map_(nullptr), bytes_(0) {}
+    ~Reader() { Close(); }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    bool Open(const std::string& path, std::string* error) {
+      Close();
+      const int fd = open(path.c_str(), O_RDONLY);
+      if (fd < 0) {
+        *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+      }
+      struct stat st;
+      if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+        *error = path + " is not a bridge journal";
+        close(fd);
+        return false;
+      }
+      const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+      void* map = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (map == MAP_FAILED) {
+        *error = "mmap " + path + ": " + std::strerror(errno);
+        return false;
+      }
+      const Header* header = static_cast<const Header*>(map);
+      if (header->magic != kMagic || header->version != kVersion ||
+          header->record_bytes != sizeof(Record)) {
+        *error = path + " is not a version " + std::to_string(kVersion) + " bridge journal";
+        munmap(map, bytes);
+        return false;
+      }
+      map_ = static_cast<const char*>(map);
+      bytes_ = bytes;
+      return true;
+    }
+
+    void Close() {
+      if (map_ != nullptr) {
+        munmap(const_cast<char*>(map_), bytes_);
+        map_ = nullptr;
+      }
+    }
+
+    const Header& GetHeader() const { return *reinterpret_cast<const Header*>(map_); }
+
+    // Records written so far; grows while a live writer appends.
+    uint64_t Size() const {
+      const uint64_t count = GetHeader().count.load(std::memory_order_acquire);
+      const uint64_t fits = (bytes_ - sizeof(Header)) / sizeof(Record);
+      return count < fits ? count : fits;
+    }
+
+    const Record* begin() const {
+      return reinterpret_cast<const Record*>(map_ + sizeof(Header));
+    }
+    const Record* end() const { return begin() + Size(); }
+    const Record& operator[](uint64_t index) const { return begin()[index]; }
+
+   private:
+    const char* map_;
+    std::size_t bytes_;
+  };
+
+ private:
+  static Header* HeaderOf(char* map) { return reinterpret_cast<Header*>(map); }
+  static const Header* HeaderOf(const char* map) {
+    return reinterpret_cast<const Header*>(map);
+  }
+
+  void WriterLoop() {
+    Header* header = HeaderOf(map_);
+    Record* records = reinterpret_cast<Record*>(map_ + sizeof(Header));
+    const uint64_t capacity = header->capacity;
+    uint64_t count = 0;
+    const timespec idle = {0, 50000};
+    while (true) {
+      // Read the flag first: everything pushed before Close() is drained.
+      const bool running = running_.load(std::memory_order_acquire);
+      Record record;
+      uint64_t drained = 0;
+      while (ring_->TryPop(&record)) {
+        if (count < capacity) {
+          records[count++] = record;
+        } else {
+          file_dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        ++drained;
+      }
+      if (drained != 0) {
+        header->count.store(count, std::memory_order_release);
+      } else if (!running) {
+        return;
+      } else {
+        nanosleep(&idle, nullptr);
+      }
+    }
+  }
+
+  std::unique_ptr<SpscRing<Record>> ring_;
+  char* map_;
+  std::size_t bytes_;
+  int fd_;
+  std::atomic<bool> running_;
+  std::atomic<uint64_t> ring_dropped_;
+  std::atomic<uint64_t> file_dropped_;
+  std::thread writer_;
+};
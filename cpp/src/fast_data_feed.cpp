@@ -1,7 +1,11 @@
 
 #include "SimpleMD.h"
+#include "feed_framing.h"
+#include "mfast_arena_allocator.h"
 #include <mfast/coder/fast_encoder.h>
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <vector>
 #include <set>
@@ -10,6 +14,7 @@
 #include <thread>
 #include <mutex>
 #include <cmath>
+#include <cstdlib>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -20,6 +25,26 @@ static const int PORT = 9001;
 
 std::mutex clients_mutex;
 std::set<int> clients;
+// A client joined since the last message: it has no dictionary state, so
+// the next message must reset the dictionary.
+bool dictionary_reset_pending = false;
+
+// HFT_FAST_RESET_EVERY=N resets the FAST dictionary every N messages (1: on
+// every message, 0: only when a client joins).
+static uint32_t init_reset_every()
+{
+    const char* env = std::getenv("HFT_FAST_RESET_EVERY");
+    if (env == nullptr) {
+        return FeedFraming::kDefaultResetEvery;
+    }
+    char* end = nullptr;
+    const unsigned long value = std::strtoul(env, &end, 0);
+    if (end == env || *end != '\0' || value > 0xFFFFFFFFul) {
+        std::cerr << "Invalid HFT_FAST_RESET_EVERY value: " << env << "\n";
+        return FeedFraming::kDefaultResetEvery;
+    }
+    return static_cast<uint32_t>(value);
+}
 
 void accept_loop(int server_fd)
 {
@@ -31,6 +56,7 @@ void accept_loop(int server_fd)
         std::cout << "Client connected (fd=" << fd << ")\n";
         std::lock_guard<std::mutex> lock(clients_mutex);
         clients.insert(fd);
+        dictionary_reset_pending = true;
     }
 }
 
@@ -56,7 +82,11 @@ int main()
     std::thread(accept_loop, server_fd).detach();
 
     // --- mfast encoder ---
-    mfast::fast_encoder encoder;
+    // The encoder and one message object per template share an arena, and
+    // the messages are refilled in place each tick, so the loop does not
+    // allocate once the first messages have sized their strings and sequences.
+    MfastArenaAllocator alloc;
+    mfast::fast_encoder encoder(&alloc);
     const mfast::templates_description* descs[] = { SimpleMD::description() };
     encoder.include(descs);
 
@@ -77,47 +107,133 @@ int main()
     std::uniform_int_distribution<int> side_dist(0, (int)sides.size() - 1);
     std::uniform_int_distribution<int> qty_dist(100, 5000);
     std::uniform_int_distribution<int> level_ticks_dist(1, 80);
+    std::uniform_int_distribution<int> action_dist(0, 99);
+
+    // Levels the feed has published and not removed, per side and symbol
+    // (price in cents -> qty). Deletes and trades hit these, and a side never
+    // holds more levels than the 8-deep books downstream.
+    const std::size_t kMaxLevels = 8;
+    const uint32_t kBookResetEvery = 500;
+    std::map<std::string, std::map<int, int>> live[2];
+
+    // Stream mode: the dictionary persists between messages, so repeated
+    // symbols and sides and small price/seq steps cost a bit or a byte.
+    FeedFraming framing(init_reset_every());
+    std::cout << "FAST dictionary reset every " << framing.ResetEvery()
+              << " message(s) and on client join\n";
+    const uint32_t kReportEvery = 1000;
 
     uint32_t seq = 1;
     char encode_buf[1024];
+    SimpleMD::SimpleMD update_msg(&alloc);
+    SimpleMD::SimpleMD_mref update_ref = update_msg.ref();
+    SimpleMD::LevelDelete delete_msg(&alloc);
+    SimpleMD::LevelDelete_mref delete_ref = delete_msg.ref();
+    SimpleMD::BookReset reset_msg(&alloc);
+    SimpleMD::BookReset_mref reset_ref = reset_msg.ref();
+    SimpleMD::Trade trade_msg(&alloc);
+    SimpleMD::Trade_mref trade_ref = trade_msg.ref();
 
     while (true) {
         const std::string& sym  = symbols[sym_dist(rng)];
-        const std::string& side = sides[side_dist(rng)];
-        const double half_spread = static_cast<double>(level_ticks_dist(rng)) / 100.0;
-        double price = base_price.at(sym);
-        if (side == "buy") {
-            price -= half_spread;
+        const int side_index = side_dist(rng);
+        const std::string& side = sides[side_index];
+        std::map<int, int>& levels = live[side_index][sym];
+        const int action = action_dist(rng);
+        std::size_t encoded_len = 0;
+        bool client_joined = false;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            client_joined = dictionary_reset_pending;
+            dictionary_reset_pending = false;
+        }
+        const bool reset = framing.NextIsReset(client_joined);
+
+        if (seq % kBookResetEvery == 0) {
+            live[0][sym].clear();
+            live[1][sym].clear();
+            reset_ref.set_Symbol().as(sym.c_str());
+            reset_ref.set_SeqNo().as(seq);
+            encoded_len = encoder.encode(reset_ref, encode_buf, sizeof(encode_buf), reset);
+            std::cout << "seq=" << seq << " sym=" << sym << " reset";
+        } else if (!levels.empty() && (levels.size() >= kMaxLevels || action < 15)) {
+            // Pull the level farthest from the touch.
+            const int cents = side_index == 0 ? levels.begin()->first : levels.rbegin()->first;
+            levels.erase(cents);
+            const double price = cents / 100.0;
+            delete_ref.set_MDEntries().resize(1);
+            SimpleMD::LevelDelete_mref::MDEntries_element_mref entry(
+                delete_ref.set_MDEntries()[0]);
+            entry.set_Symbol().as(sym.c_str());
+            entry.set_Side().as(side.c_str());
+            entry.set_Price().as(price);
+            entry.set_SeqNo().as(seq);
+            encoded_len = encoder.encode(delete_ref, encode_buf, sizeof(encode_buf), reset);
+            std::cout << "seq=" << seq << " sym=" << sym << " side=" << side
+                      << " price=" << price << " delete";
+        } else if (!levels.empty() && action < 30) {
+            // Trade against the touch: the highest bid or the lowest ask.
+            std::map<int, int>::iterator best =
+                side_index == 0 ? std::prev(levels.end()) : levels.begin();
+            const int traded = std::min(best->second, qty_dist(rng) / 2);
+            const double price = best->first / 100.0;
+            best->second -= traded;
+            const int level_qty = best->second;
+            if (level_qty == 0) {
+                levels.erase(best);
+            }
+            trade_ref.set_MDEntries().resize(1);
+            SimpleMD::Trade_mref::MDEntries_element_mref entry(trade_ref.set_MDEntries()[0]);
+            entry.set_Symbol().as(sym.c_str());
+            entry.set_Side().as(side.c_str());
+            entry.set_Price().as(price);
+            entry.set_Qty().as(traded);
+            entry.set_LevelQty().as(level_qty);
+            entry.set_SeqNo().as(seq);
+            encoded_len = encoder.encode(trade_ref, encode_buf, sizeof(encode_buf), reset);
+            std::cout << "seq=" << seq << " sym=" << sym << " side=" << side
+                      << " price=" << price << " trade qty=" << traded
+                      << " level_qty=" << level_qty;
         } else {
-            price += half_spread;
+            const double half_spread = static_cast<double>(level_ticks_dist(rng)) / 100.0;
+            double price = base_price.at(sym);
+            if (side_index == 0) {
+                price -= half_spread;
+            } else {
+                price += half_spread;
+            }
+            price = std::round(price * 100.0) / 100.0;
+            int qty = qty_dist(rng);
+            levels[static_cast<int>(std::lround(price * 100.0))] = qty;
+
+            update_ref.set_MDEntries().resize(1);
+            SimpleMD::SimpleMD_mref::MDEntries_element_mref entry(update_ref.set_MDEntries()[0]);
+            entry.set_Symbol().as(sym.c_str());
+            entry.set_Side().as(side.c_str());
+            entry.set_Price().as(price);
+            entry.set_Qty().as(qty);
+            entry.set_SeqNo().as(seq);
+            encoded_len = encoder.encode(update_ref, encode_buf, sizeof(encode_buf), reset);
+            std::cout << "seq=" << seq << " sym=" << sym << " side=" << side
+                      << " price=" << price << " qty=" << qty;
+        }
+
+        const uint32_t frame_word = FeedFraming::Pack(static_cast<uint32_t>(encoded_len), reset);
+        framing.Record(frame_word);
+        std::cout << " (" << encoded_len << " bytes" << (reset ? ", reset" : "")
+                  << ", arena heap_allocations=" << alloc.stats().heap_allocations << ")\n";
+        if (framing.GetStats().messages % kReportEvery == 0) {
+            std::cout << "Stream: messages=" << framing.GetStats().messages
+                      << " bytes_per_msg=" << framing.BytesPerMessage()
+                      << " resets=" << framing.GetStats().resets << "\n";
         }
-        price = std::round(price * 100.0) / 100.0;
-        int qty = qty_dist(rng);
-
-        SimpleMD::SimpleMD message;
-        SimpleMD::SimpleMD_mref ref = message.ref();
-        ref.set_MDEntries().resize(1);
-        SimpleMD::SimpleMD_mref::MDEntries_element_mref entry(ref.set_MDEntries()[0]);
-
-        entry.set_Symbol().as(sym.c_str());
-        entry.set_Side().as(side.c_str());
-        entry.set_Price().as(price);
-        entry.set_Qty().as(qty);
-        entry.set_SeqNo().as(seq);
-
-        std::size_t encoded_len = encoder.encode(ref, encode_buf, sizeof(encode_buf), true);
-
-        std::cout << "seq=" << seq
-                  << " sym=" << sym << " side=" << side
-                  << " price=" << price << " qty=" << qty
-                  << " (" << encoded_len << " bytes)\n";
         ++seq;
 
         // broadcast to all connected clients
         {
             std::lock_guard<std::mutex> lock(clients_mutex);
             std::set<int> dead;
-            uint32_t frame_len = htonl((uint32_t)encoded_len);
+            uint32_t frame_len = htonl(frame_word);
             for (int fd : clients) {
                 ssize_t s1 = send(fd, &frame_len, sizeof(frame_len), MSG_NOSIGNAL | MSG_MORE);
                 ssize_t s2 = send(fd, encode_buf, encoded_len, MSG_NOSIGNAL);
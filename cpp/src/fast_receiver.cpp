@@ -1,15 +1,25 @@
 #include "SimpleMD.h"
+#include "book_checkpoint.h"
+#include "bridge_journal.h"
+#include "feed_framing.h"
+#include "feed_mapping.h"
 #include "fpga_shared_stream.h"
+#include "md_bus.h"
+#include "mfast_arena_allocator.h"
+#include "response_verifier.h"
+#include "rt_setup.h"
+#include "sw_order_book.h"
 #include <mfast/coder/fast_decoder.h>
 #include <iostream>
 #include <vector>
 #include <boost/exception/diagnostic_information.hpp>
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
-#include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <thread>
+#include <time.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
@@ -17,30 +27,6 @@
 static const char* SERVER_IP   = "127.0.0.1";
 static const int   SERVER_PORT = 9001;
 
-namespace {
-
-const uint32_t kEventUpsertLevel = 1;
-const uint32_t kEventDeleteLevel = 2;
-const uint32_t kEventResetBook   = 3;
-
-const uint32_t kSideBuy  = 1;
-const uint32_t kSideSell = 2;
-
-struct SymbolMapping {
-    const char* name;
-    uint32_t id;
-};
-
-const SymbolMapping kSymbolMappings[] = {
-    {"AAPL", 0},
-    {"MSFT", 1},
-    {"NVDA", 2},
-    {"GOOGL", 3},
-    {"TSLA", 4},
-};
-
-}  // namespace
-
 static bool parse_u64(const char* text, uint64_t* out)
 {
     if (text == nullptr || out == nullptr) {
@@ -56,61 +42,455 @@ static bool parse_u64(const char* text, uint64_t* out)
     return true;
 }
 
-static uint32_t parse_side_code(const char* side)
+static const char* action_to_string(uint32_t action)
 {
-    if (side != nullptr) {
-        if (side[0] == 'b' || side[0] == 'B') {
-            return kSideBuy;
+    switch (action) {
+        case 1:
+            return "BUY";
+        case 2:
+            return "SELL";
+        default:
+            return "NOOP";
+    }
+}
+
+static int32_t decode_imbalance(uint32_t raw_value)
+{
+    return static_cast<int32_t>(raw_value);
+}
+
+static void print_response(const char* tag, const FpgaSharedStream::Frame& rx)
+{
+    std::cout << tag << " seq=" << rx.word0
+              << " action=" << action_to_string(rx.word1)
+              << " best_bid_px_1e4=" << rx.word2
+              << " best_bid_qty=" << rx.word3
+              << " best_ask_px_1e4=" << rx.word4
+              << " best_ask_qty=" << rx.word5
+              << " spread_1e4=" << rx.word6
+              << " imbalance=" << decode_imbalance(rx.word7)
+              << "\n";
+}
+
+static bool map_symbol(const char* symbol, uint32_t* symbol_id)
+{
+    if (!FeedMapping::MapSymbol(symbol, symbol_id)) {
+        std::cerr << "Skipping unmapped symbol for book path: " << symbol << "\n";
+        return false;
+    }
+    return true;
+}
+
+static uint32_t price_1e4(const mfast::decimal_cref& price)
+{
+    return FeedMapping::PriceToFixed1e4(price.mantissa(), price.exponent());
+}
+
+// One handler per SimpleMD template: prints the entries and appends the
+// book events they map to (see FeedMapping).
+typedef void (*TemplateHandler)(const mfast::message_cref& msg,
+                                std::vector<FpgaSharedStream::Frame>* events);
+
+static void on_level_update(const mfast::message_cref& msg,
+                            std::vector<FpgaSharedStream::Frame>* events)
+{
+    SimpleMD::SimpleMD_cref typed(msg);
+    for (auto entry : typed.get_MDEntries()) {
+        std::cout
+            << "seq="    << entry.get_SeqNo().value()
+            << " sym="   << entry.get_Symbol().c_str()
+            << " side="  << entry.get_Side().c_str()
+            << " price=" << entry.get_Price().value()
+            << " qty="   << entry.get_Qty().value()
+            << "\n";
+        uint32_t symbol_id = 0;
+        if (map_symbol(entry.get_Symbol().c_str(), &symbol_id)) {
+            events->push_back(FeedMapping::LevelFrame(
+                entry.get_SeqNo().value(), symbol_id, price_1e4(entry.get_Price()),
+                entry.get_Qty().value(), FeedMapping::ParseSide(entry.get_Side().c_str())));
         }
-        if (side[0] == 's' || side[0] == 'S') {
-            return kSideSell;
+    }
+}
+
+static void on_level_delete(const mfast::message_cref& msg,
+                            std::vector<FpgaSharedStream::Frame>* events)
+{
+    SimpleMD::LevelDelete_cref typed(msg);
+    for (auto entry : typed.get_MDEntries()) {
+        std::cout
+            << "seq="    << entry.get_SeqNo().value()
+            << " sym="   << entry.get_Symbol().c_str()
+            << " side="  << entry.get_Side().c_str()
+            << " price=" << entry.get_Price().value()
+            << " delete\n";
+        uint32_t symbol_id = 0;
+        if (map_symbol(entry.get_Symbol().c_str(), &symbol_id)) {
+            events->push_back(FeedMapping::DeleteFrame(
+                entry.get_SeqNo().value(), symbol_id, price_1e4(entry.get_Price()),
+                FeedMapping::ParseSide(entry.get_Side().c_str())));
+        }
+    }
+}
+
+static void on_book_reset(const mfast::message_cref& msg,
+                          std::vector<FpgaSharedStream::Frame>* events)
+{
+    SimpleMD::BookReset_cref typed(msg);
+    std::cout << "seq=" << typed.get_SeqNo().value()
+              << " sym=" << typed.get_Symbol().c_str() << " reset\n";
+    uint32_t symbol_id = 0;
+    if (map_symbol(typed.get_Symbol().c_str(), &symbol_id)) {
+        events->push_back(FeedMapping::ResetFrame(typed.get_SeqNo().value(), symbol_id));
+    }
+}
+
+static void on_trade(const mfast::message_cref& msg, std::vector<FpgaSharedStream::Frame>* events)
+{
+    SimpleMD::Trade_cref typed(msg);
+    for (auto entry : typed.get_MDEntries()) {
+        std::cout
+            << "seq="    << entry.get_SeqNo().value()
+            << " sym="   << entry.get_Symbol().c_str()
+            << " side="  << entry.get_Side().c_str()
+            << " price=" << entry.get_Price().value()
+            << " trade qty=" << entry.get_Qty().value()
+            << " level_qty=" << entry.get_LevelQty().value()
+            << "\n";
+        uint32_t symbol_id = 0;
+        if (map_symbol(entry.get_Symbol().c_str(), &symbol_id)) {
+            events->push_back(FeedMapping::TradeFrame(
+                entry.get_SeqNo().value(), symbol_id, price_1e4(entry.get_Price()),
+                entry.get_LevelQty().value(), FeedMapping::ParseSide(entry.get_Side().c_str())));
         }
     }
-    return 0;
 }
 
-static bool map_symbol_id(const char* symbol, uint32_t* out)
+// Indexed by template id - kTemplateLevelUpdate.
+static const TemplateHandler kTemplateHandlers[] = {
+    &on_level_update,  // 100 SimpleMD
+    &on_level_delete,  // 101 LevelDelete
+    &on_book_reset,    // 102 BookReset
+    &on_trade,         // 103 Trade
+};
+
+static TemplateHandler find_template_handler(uint32_t template_id)
 {
-    if (symbol == nullptr || out == nullptr) {
+    const uint32_t index = template_id - FeedMapping::kTemplateLevelUpdate;
+    if (template_id < FeedMapping::kTemplateLevelUpdate ||
+        index >= sizeof(kTemplateHandlers) / sizeof(kTemplateHandlers[0])) {
+        return nullptr;
+    }
+    return kTemplateHandlers[index];
+}
+
+// HFT_VERIFY_SAMPLE=N checks FPGA responses for every N-th symbol id against
+// the software book; unset or 0 disables the check.
+static uint32_t init_verify_sample()
+{
+    const char* sample_env = std::getenv("HFT_VERIFY_SAMPLE");
+    uint64_t sample = 0;
+    if (sample_env == nullptr) {
+        return 0;
+    }
+    if (!parse_u64(sample_env, &sample) || sample > 0xFFFFFFFFull) {
+        std::cerr << "Invalid HFT_VERIFY_SAMPLE value: " << sample_env << "\n";
+        return 0;
+    }
+    return static_cast<uint32_t>(sample);
+}
+
+// Real-time profile for the receive thread, all optional:
+//   HFT_RT_CPU=N         pin to CPU N
+//   HFT_RT_PRIORITY=N    SCHED_FIFO priority N (1-99)
+//   HFT_RT_MLOCK=1       mlockall
+//   HFT_RT_PREFAULT=1    prefault the stack
+//   HFT_HICCUP_METER=1   run the platform stall meter, reported per connection
+//   HFT_HICCUP_CPU=N     pin the meter to CPU N (default: the receive CPU)
+static RtSetup::Config init_rt_config(bool* hiccup, HiccupMeter::Config* meter)
+{
+    RtSetup::Config config = RtSetup::DefaultConfig();
+    uint64_t value = 0;
+    const char* cpu_env = std::getenv("HFT_RT_CPU");
+    if (cpu_env != nullptr) {
+        if (parse_u64(cpu_env, &value) && value < CPU_SETSIZE) {
+            config.cpu = static_cast<int>(value);
+        } else {
+            std::cerr << "Invalid HFT_RT_CPU value: " << cpu_env << "\n";
+        }
+    }
+    const char* priority_env = std::getenv("HFT_RT_PRIORITY");
+    if (priority_env != nullptr) {
+        if (parse_u64(priority_env, &value) && value >= 1 && value <= 99) {
+            config.fifo_priority = static_cast<int>(value);
+        } else {
+            std::cerr << "Invalid HFT_RT_PRIORITY value: " << priority_env << "\n";
+        }
+    }
+    const char* mlock_env = std::getenv("HFT_RT_MLOCK");
+    config.lock_memory = mlock_env != nullptr && std::strcmp(mlock_env, "1") == 0;
+    const char* prefault_env = std::getenv("HFT_RT_PREFAULT");
+    config.prefault = prefault_env != nullptr && std::strcmp(prefault_env, "1") == 0;
+    const char* hiccup_env = std::getenv("HFT_HICCUP_METER");
+    *hiccup = hiccup_env != nullptr && std::strcmp(hiccup_env, "1") == 0;
+    *meter = HiccupMeter::DefaultConfig();
+    meter->fifo_priority = config.fifo_priority;
+    const char* hiccup_cpu_env = std::getenv("HFT_HICCUP_CPU");
+    if (hiccup_cpu_env != nullptr) {
+        if (parse_u64(hiccup_cpu_env, &value) && value < CPU_SETSIZE) {
+            meter->cpu = static_cast<int>(value);
+        } else {
+            std::cerr << "Invalid HFT_HICCUP_CPU value: " << hiccup_cpu_env << "\n";
+        }
+    }
+    return config;
+}
+
+// HFT_MD_BUS=path republishes level events and book/FPGA responses on a
+// shared-memory bus for local consumers (md_bus_reader, strategies);
+// HFT_MD_BUS_CAPACITY=N sizes it in messages. Unset leaves the bus off.
+static bool init_md_bus(MdBus::Writer* bus)
+{
+    const char* path_env = std::getenv("HFT_MD_BUS");
+    if (path_env == nullptr || path_env[0] == '\0') {
         return false;
     }
-    for (const SymbolMapping& mapping : kSymbolMappings) {
-        if (std::strcmp(mapping.name, symbol) == 0) {
-            *out = mapping.id;
-            return true;
+    uint64_t capacity = MdBus::kDefaultCapacity;
+    const char* capacity_env = std::getenv("HFT_MD_BUS_CAPACITY");
+    if (capacity_env != nullptr &&
+        (!parse_u64(capacity_env, &capacity) || capacity < 2 || capacity > (1u << 30))) {
+        std::cerr << "Invalid HFT_MD_BUS_CAPACITY value: " << capacity_env << "\n";
+        capacity = MdBus::kDefaultCapacity;
+    }
+    std::string error;
+    if (!bus->Create(path_env, static_cast<uint32_t>(capacity), &error)) {
+        std::cerr << "Market-data bus disabled: " << error << "\n";
+        return false;
+    }
+    std::cout << "Publishing on market-data bus " << path_env
+              << " capacity=" << bus->Capacity() << "\n";
+    return true;
+}
+
+// HFT_BRIDGE_JOURNAL=path journals every frame sent to the FPGA (or the
+// software book) and every response, for offline replay with
+// `fpga_benchmark --workload-file path`; HFT_BRIDGE_JOURNAL_RECORDS=N sizes
+// the preallocated file. Unset leaves the journal off.
+static bool init_bridge_journal(BridgeJournal* journal)
+{
+    const char* path_env = std::getenv("HFT_BRIDGE_JOURNAL");
+    if (path_env == nullptr || path_env[0] == '\0') {
+        return false;
+    }
+    uint64_t records = BridgeJournal::kDefaultRecords;
+    const char* records_env = std::getenv("HFT_BRIDGE_JOURNAL_RECORDS");
+    if (records_env != nullptr &&
+        (!parse_u64(records_env, &records) || records == 0 || records > (1ull << 32))) {
+        std::cerr << "Invalid HFT_BRIDGE_JOURNAL_RECORDS value: " << records_env << "\n";
+        records = BridgeJournal::kDefaultRecords;
+    }
+    std::string error;
+    if (!journal->Open(path_env, records, &error)) {
+        std::cerr << "Bridge journal disabled: " << error << "\n";
+        return false;
+    }
+    std::cout << "Journaling bridge traffic to " << path_env << " records=" << records << "\n";
+    return true;
+}
+
+static void print_hiccups(const HiccupMeter::Stats& stats)
+{
+    std::cout << "Hiccups: samples=" << stats.samples
+              << " p50_ns=" << stats.p50_ns
+              << " p99_ns=" << stats.p99_ns
+              << " p999_ns=" << stats.p999_ns
+              << " max_ns=" << stats.max_ns
+              << " total_ns=" << stats.total_ns
+              << "\n";
+}
+
+// On the first mismatch, the report also shows the FPGA's own book for the
+// symbol when the bitstream has the readback window.
+static void verify_response(ResponseVerifier* verifier, FpgaSharedStream* bridge,
+                            const FpgaSharedStream::Frame& rx)
+{
+    if (verifier->OnResponse(rx) != ResponseVerifier::kMismatch) {
+        return;
+    }
+    if (verifier->GetStats().mismatches == 1) {
+        const ResponseVerifier::Divergence& divergence = verifier->FirstDivergence();
+        ResponseVerifier::Print(std::cerr, divergence);
+        FpgaSharedStream::BookSnapshot book;
+        if (bridge->BookDepth() != 0 && bridge->ReadBook(divergence.event.word1, &book)) {
+            ResponseVerifier::PrintBook(std::cerr, book);
         }
+    } else {
+        std::cerr << "[VERIFY] mismatch seq=" << rx.word0
+                  << " total=" << verifier->GetStats().mismatches
+                  << " compared=" << verifier->GetStats().compared << "\n";
     }
-    return false;
 }
 
-static uint32_t price_to_fixed_1e4(const mfast::decimal_cref& price)
+// Sends a RESET_BOOK for every symbol so the FPGA and verifier (if given)
+// books start out equal. A full TX ring is retried while RX drains; returns
+// false if the FPGA stops taking frames for a second.
+static bool send_book_resets(FpgaSharedStream* bridge, ResponseVerifier* verifier,
+                             BridgeJournal* journal, uint32_t num_symbols)
 {
-    const double value = static_cast<double>(price.mantissa()) *
-                         std::pow(10.0, static_cast<double>(price.exponent()));
-    long long scaled = std::llround(value * 10000.0);
-    if (scaled < 0) {
-        scaled = 0;
-    } else if (scaled > 0xFFFFFFFFll) {
-        scaled = 0xFFFFFFFFll;
-    }
-    return static_cast<uint32_t>(scaled);
+    auto last_progress = std::chrono::steady_clock::now();
+    for (uint32_t symbol = 0; symbol < num_symbols;) {
+        const FpgaSharedStream::Frame reset = ResponseVerifier::ResetFrame(symbol);
+        if (bridge->Send(reset)) {
+            if (verifier != nullptr) {
+                verifier->OnEvent(reset);
+            }
+            if (journal != nullptr) {
+                journal->Append(BridgeJournal::kTx, reset);
+            }
+            ++symbol;
+            last_progress = std::chrono::steady_clock::now();
+            continue;
+        }
+        FpgaSharedStream::Frame rx{};
+        while (bridge->Receive(&rx)) {
+            if (journal != nullptr) {
+                journal->Append(BridgeJournal::kRx, rx);
+            }
+            if (verifier != nullptr) {
+                verify_response(verifier, bridge, rx);
+            }
+            last_progress = std::chrono::steady_clock::now();
+        }
+        if (std::chrono::steady_clock::now() - last_progress > std::chrono::seconds(1)) {
+            std::cerr << "Book reset: FPGA TX queue stuck at symbol=" << symbol << "\n";
+            return false;
+        }
+    }
+    return true;
 }
 
-static const char* action_to_string(uint32_t action)
+// Cold-starts the software books and, with the bridge, the FPGA book for a
+// new feed session. Returns false if the FPGA did not take the resets.
+static bool start_feed_session(SwOrderBook* sw_book, SwOrderBook* shadow_book,
+                               FpgaSharedStream* bridge, ResponseVerifier* verifier,
+                               BridgeJournal* journal)
 {
-    switch (action) {
-        case 1:
-            return "BUY";
-        case 2:
-            return "SELL";
-        default:
-            return "NOOP";
+    for (uint32_t symbol = 0; symbol < sw_book->NumSymbols(); ++symbol) {
+        const FpgaSharedStream::Frame reset = ResponseVerifier::ResetFrame(symbol);
+        sw_book->ApplyEvent(reset);
+        shadow_book->ApplyEvent(reset);
     }
+    return bridge == nullptr ||
+           send_book_resets(bridge, verifier, journal, sw_book->NumSymbols());
 }
 
-static int32_t decode_imbalance(uint32_t raw_value)
+// HFT_BOOK_CHECKPOINT=path checkpoints the software-side book and last SeqNo
+// every HFT_BOOK_CHECKPOINT_EVERY messages (default 1000) and on disconnect,
+// and reloads it on start. Unset leaves checkpoints off.
+static bool init_book_checkpoint(BookCheckpoint* checkpoint, const SwOrderBook::Config& config,
+                                 uint32_t* every)
 {
-    return static_cast<int32_t>(raw_value);
+    const char* path_env = std::getenv("HFT_BOOK_CHECKPOINT");
+    if (path_env == nullptr || path_env[0] == '\0') {
+        return false;
+    }
+    uint64_t value = 1000;
+    const char* every_env = std::getenv("HFT_BOOK_CHECKPOINT_EVERY");
+    if (every_env != nullptr &&
+        (!parse_u64(every_env, &value) || value == 0 || value > 0xFFFFFFFFull)) {
+        std::cerr << "Invalid HFT_BOOK_CHECKPOINT_EVERY value: " << every_env << "\n";
+        value = 1000;
+    }
+    *every = static_cast<uint32_t>(value);
+    bool discarded = false;
+    std::string error;
+    if (!checkpoint->Open(path_env, config, &discarded, &error)) {
+        std::cerr << "Book checkpoint disabled: " << error << "\n";
+        return false;
+    }
+    if (discarded) {
+        std::cerr << "Discarded book checkpoint " << path_env
+                  << " written for another book shape\n";
+    }
+    std::cout << "Checkpointing book to " << path_env << " every " << *every
+              << " message(s)\n";
+    return true;
+}
+
+// Rebuilds `book` and, with the bridge, the FPGA book from the latest
+// checkpoint: a reset and the saved levels of every symbol, sent as one
+// burst as fast as the TX ring drains. Sets `last_seq` to the checkpoint's
+// last SeqNo, or 0 without a checkpoint. Returns false if the FPGA stopped
+// responding before it acknowledged the whole burst.
+static bool warm_start(const BookCheckpoint& checkpoint, SwOrderBook* book,
+                       FpgaSharedStream* bridge, ResponseVerifier* verifier,
+                       BridgeJournal* journal, uint64_t* last_seq)
+{
+    *last_seq = 0;
+    BookCheckpoint::Snapshot snapshot;
+    if (!checkpoint.Load(&snapshot)) {
+        std::cout << "No book checkpoint; cold start\n";
+        return true;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<FpgaSharedStream::Frame> frames;
+    BookCheckpoint::ReplayFrames(snapshot, book->NumSymbols(), &frames);
+    for (const FpgaSharedStream::Frame& frame : frames) {
+        book->ApplyEvent(frame);
+    }
+
+    // Burst seqs run 1..frames.size(); responses to the verifier's startup
+    // resets may still be in flight and are not counted.
+    std::size_t sent = 0;
+    std::size_t received = 0;
+    auto last_progress = start;
+    while (bridge != nullptr && (sent < frames.size() || received < frames.size())) {
+        bool progress = false;
+        while (sent < frames.size() && bridge->Send(frames[sent])) {
+            if (journal != nullptr) {
+                journal->Append(BridgeJournal::kTx, frames[sent]);
+            }
+            if (verifier != nullptr) {
+                verifier->OnEvent(frames[sent]);
+            }
+            ++sent;
+            progress = true;
+        }
+        FpgaSharedStream::Frame rx{};
+        while (bridge->Receive(&rx)) {
+            if (journal != nullptr) {
+                journal->Append(BridgeJournal::kRx, rx);
+            }
+            if (verifier != nullptr) {
+                verify_response(verifier, bridge, rx);
+            }
+            if (rx.word0 >= 1 && rx.word0 <= frames.size()) {
+                ++received;
+            }
+            progress = true;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (progress) {
+            last_progress = now;
+        } else if (now - last_progress > std::chrono::seconds(1)) {
+            std::cerr << "Warm start: FPGA stopped responding after sent=" << sent
+                      << " received=" << received << "\n";
+            return false;
+        }
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+    const int64_t now_ns = static_cast<int64_t>(now.tv_sec) * 1000000000ll + now.tv_nsec;
+    std::cout << "Warm start: levels=" << snapshot.levels.size()
+              << " frames=" << frames.size()
+              << " last_seq=" << snapshot.last_seq
+              << " age_ms="
+              << (now_ns - static_cast<int64_t>(snapshot.saved_realtime_ns)) / 1000000
+              << " ready_us=" << elapsed.count() << "\n";
+    *last_seq = snapshot.last_seq;
+    return true;
 }
 
 static int connect_feed()
@@ -212,6 +592,26 @@ static bool init_fpga_bridge(FpgaSharedStream* bridge) {
   const char* dev_env = std::getenv("HFT_FPGA_MMIO_DEV");
   const std::string dev_path = dev_env == nullptr ? "/dev/mem" : dev_env;
 
+  const char* copy_env = std::getenv("HFT_FPGA_MMIO_COPY");
+  if (copy_env != nullptr) {
+    FpgaSharedStream::SlotCopyMode copy_mode = FpgaSharedStream::kSlotCopyScalar;
+    if (!FpgaSharedStream::ParseSlotCopyMode(copy_env, &copy_mode)) {
+      std::cerr << "Invalid HFT_FPGA_MMIO_COPY value: " << copy_env << "\n";
+      return false;
+    }
+    bridge->SetSlotCopyMode(copy_mode);
+  }
+
+  const char* map_env = std::getenv("HFT_FPGA_MMIO_MAP");
+  if (map_env != nullptr) {
+    FpgaSharedStream::MapMode map_mode = FpgaSharedStream::kMapUncached;
+    if (!FpgaSharedStream::ParseMapMode(map_env, &map_mode)) {
+      std::cerr << "Invalid HFT_FPGA_MMIO_MAP value: " << map_env << "\n";
+      return false;
+    }
+    bridge->SetMapMode(map_mode);
+  }
+
   if (!bridge->Open(base, span, dev_path)) {
     std::cerr << "Failed to open FPGA MMIO bridge at base=0x"
               << std::hex << base
@@ -240,6 +640,8 @@ static bool init_fpga_bridge(FpgaSharedStream* bridge) {
             << " rx_base=0x" << std::hex << bridge->RxBase()
             << std::dec
             << (bridge->IsLegacyMode() ? " mode=legacy" : " mode=new")
+            << " copy=" << FpgaSharedStream::SlotCopyModeName(bridge->ActiveSlotCopyMode())
+            << " map=" << FpgaSharedStream::MapModeName(bridge->GetMapMode())
             << "\n";
 
   return true;
@@ -247,14 +649,89 @@ static bool init_fpga_bridge(FpgaSharedStream* bridge) {
 
 int main()
 {
-    mfast::fast_decoder decoder;
+    // Decoded messages live in the decoder and are reused; with the arena,
+    // their strings and sequences stop reaching malloc after the first few.
+    MfastArenaAllocator alloc;
+    mfast::fast_decoder decoder(&alloc);
     const mfast::templates_description* descs[] = { SimpleMD::description() };
     decoder.include(descs);
 
     FpgaSharedStream bridge;
     const bool bridge_enabled = init_fpga_bridge(&bridge);
-    
+    // Without the bridge the same book/strategy runs in software.
+    SwOrderBook sw_book;
+    if (!bridge_enabled) {
+        std::cout << "Using software order book: symbols=" << sw_book.NumSymbols()
+                  << " depth=" << sw_book.Depth() << "\n";
+    }
+
+    BridgeJournal journal;
+    const bool journal_enabled = init_bridge_journal(&journal);
+
+    ResponseVerifier verifier;
+    uint32_t verify_sample = bridge_enabled ? init_verify_sample() : 0;
+    if (verify_sample != 0) {
+        ResponseVerifier::Config config = ResponseVerifier::DefaultConfig();
+        config.sample_every = verify_sample;
+        config.max_outstanding = std::max<uint32_t>(1, bridge.TxDepth());
+        verifier.Init(config);
+        // Line both books up before the first feed event.
+        if (send_book_resets(&bridge, &verifier, journal_enabled ? &journal : nullptr,
+                             config.book.num_symbols)) {
+            std::cout << "Verifying FPGA responses against the software book, every "
+                      << verify_sample << " symbol(s)\n";
+        } else {
+            std::cerr << "FPGA response verification disabled\n";
+            verify_sample = 0;
+        }
+    }
+
+    MdBus::Writer bus;
+    const bool bus_enabled = init_md_bus(&bus);
+
+    // With the bridge the checkpoint is taken from a software copy of the
+    // FPGA book, fed the same frames; without it, from sw_book itself.
+    SwOrderBook shadow_book;
+    SwOrderBook* checkpoint_book = bridge_enabled ? &shadow_book : &sw_book;
+    BookCheckpoint checkpoint;
+    uint32_t checkpoint_every = 0;
+    bool checkpoint_enabled =
+        init_book_checkpoint(&checkpoint, checkpoint_book->GetConfig(), &checkpoint_every);
+    uint64_t last_seq = 0;
+    uint64_t resume_seq = 0;
+    uint32_t since_checkpoint = 0;
+    if (checkpoint_enabled &&
+        !warm_start(checkpoint, checkpoint_book, bridge_enabled ? &bridge : nullptr,
+                    verify_sample != 0 ? &verifier : nullptr,
+                    journal_enabled ? &journal : nullptr, &last_seq)) {
+        // The FPGA does not hold the checkpointed book; keep the file for the
+        // next start instead of overwriting it from the shadow copy.
+        std::cerr << "Book checkpointing disabled\n";
+        checkpoint_enabled = false;
+        last_seq = 0;
+    }
+    resume_seq = last_seq;
+    // Last SeqNo seen from the feed, to notice it starting over.
+    uint64_t feed_seq = 0;
+
     std::vector<char> buf(8192);
+    FeedFraming framing;
+    std::vector<FpgaSharedStream::Frame> events;
+    events.reserve(64);
+
+    bool hiccup = false;
+    HiccupMeter meter;
+    HiccupMeter::Config meter_config{};
+    const RtSetup::Config rt_config = init_rt_config(&hiccup, &meter_config);
+    if (RtSetup::Enabled(rt_config)) {
+        const RtSetup::Report report = RtSetup::Apply(rt_config);
+        std::cout << "Real-time profile: cpu=" << (report.pinned ? rt_config.cpu : -1)
+                  << " fifo_priority=" << (report.fifo ? rt_config.fifo_priority : 0)
+                  << " mlock=" << (report.locked ? 1 : 0) << "\n";
+        if (!report.errors.empty()) {
+            std::cerr << "Real-time setup incomplete: " << report.errors << "\n";
+        }
+    }
 
     while (true) {
         int sock = connect_feed();
@@ -265,6 +742,12 @@ int main()
         }
 
         std::cout << "Connected to " << SERVER_IP << ":" << SERVER_PORT << "\n";
+        const TickArena::Stats arena_start = alloc.stats();
+        framing.Restart();
+        std::string meter_error;
+        if (hiccup && (!meter.Start(meter_config, &meter_error) || !meter_error.empty())) {
+            std::cerr << "Hiccup meter: " << meter_error << "\n";
+        }
 
         auto read_exact = [&](void* dst, size_t len) -> bool {
             char* p = static_cast<char*>(dst);
@@ -285,7 +768,8 @@ int main()
                 reconnect = true;
                 break;
             }
-            uint32_t msg_len = ntohl(frame_len_net);
+            const uint32_t frame_word = ntohl(frame_len_net);
+            const uint32_t msg_len = FeedFraming::Length(frame_word);
 
             if (msg_len > buf.size()) buf.resize(msg_len);
             if (!read_exact(buf.data(), msg_len)) {
@@ -293,59 +777,110 @@ int main()
                 break;
             }
 
+            // Stream mode: the dictionary only resets where the feed reset it.
+            // After a (re)connect, wait for the first reset frame.
+            if (!framing.Accept(frame_word)) {
+                continue;
+            }
+            framing.Record(frame_word);
+
             const char* p   = buf.data();
             const char* end = buf.data() + msg_len;
 
             try {
-                mfast::message_cref msg = decoder.decode(p, end, true);
-                SimpleMD::SimpleMD_cref typed(msg);
-
-                for (auto entry : typed.get_MDEntries()) {
-                    std::cout
-                        << "seq="    << entry.get_SeqNo().value()
-                        << " sym="   << entry.get_Symbol().c_str()
-                        << " side="  << entry.get_Side().c_str()
-                        << " price=" << entry.get_Price().value()
-                        << " qty="   << entry.get_Qty().value()
-                        << "\n";
-
-                    if (bridge_enabled) {
-                        uint32_t symbol_id = 0;
-                        if (!map_symbol_id(entry.get_Symbol().c_str(), &symbol_id)) {
-                            std::cerr << "Skipping unmapped symbol for FPGA path: "
-                                      << entry.get_Symbol().c_str() << "\n";
-                            continue;
+                mfast::message_cref msg =
+                    decoder.decode(p, end, FeedFraming::IsReset(frame_word));
+                const TemplateHandler handler = find_template_handler(msg.id());
+                events.clear();
+                if (handler == nullptr) {
+                    std::cerr << "Skipping unknown template id=" << msg.id() << "\n";
+                } else {
+                    handler(msg, &events);
+                }
+
+                // The feed numbers messages from 1 each time it starts. A seq
+                // at or below the warm-start checkpoint, or one that goes
+                // backwards, means a new feed session: the books built from
+                // the old one no longer apply.
+                if (!events.empty()) {
+                    const uint64_t first = events.front().word0;
+                    if (resume_seq != 0 ? first <= resume_seq : first < feed_seq) {
+                        std::cerr << "New feed session at seq=" << first << " (last seq="
+                                  << (resume_seq != 0 ? resume_seq : feed_seq)
+                                  << "); resetting the books\n";
+                        if (!start_feed_session(&sw_book, &shadow_book,
+                                                bridge_enabled ? &bridge : nullptr,
+                                                verify_sample != 0 ? &verifier : nullptr,
+                                                journal_enabled ? &journal : nullptr) &&
+                            verify_sample != 0) {
+                            std::cerr << "FPGA response verification disabled\n";
+                            verify_sample = 0;
+                        }
+                        since_checkpoint = 0;
+                    } else if (resume_seq != 0) {
+                        std::cout << "Feed resumed at seq=" << first
+                                  << " (checkpoint seq=" << resume_seq << ")\n";
+                        if (first > resume_seq + 1) {
+                            std::cerr << "Feed gap after warm start: seqs " << resume_seq + 1
+                                      << ".." << first - 1 << " missing\n";
                         }
+                    }
+                    resume_seq = 0;
+                    feed_seq = events.back().word0;
+                }
 
-                        FpgaSharedStream::Frame frame{};
-                        frame.word0 = entry.get_SeqNo().value();
-                        frame.word1 = symbol_id;
-                        frame.word2 = price_to_fixed_1e4(entry.get_Price());
-                        frame.word3 = entry.get_Qty().value();
-                        frame.word4 = kEventUpsertLevel;
-                        frame.word5 = parse_side_code(entry.get_Side().c_str());
-                        frame.word6 = 0;
-                        frame.word7 = 0;
-
-                        if (!bridge.Send(frame)) {
-                            std::cerr << "FPGA TX queue full, dropping seq="
-                                      << frame.word0 << "\n";
+                for (const FpgaSharedStream::Frame& frame : events) {
+                    if (!bridge_enabled) {
+                        const FpgaSharedStream::Frame response = sw_book.Process(frame);
+                        print_response("[SW]", response);
+                        if (journal_enabled) {
+                            journal.Append(BridgeJournal::kTx, frame);
+                            journal.Append(BridgeJournal::kRx, response);
+                        }
+                        if (bus_enabled) {
+                            bus.Publish(MdBus::kEvent, frame);
+                            bus.Publish(MdBus::kResponse, response);
+                        }
+                    } else if (!bridge.Send(frame)) {
+                        std::cerr << "FPGA TX queue full, dropping seq="
+                                  << frame.word0 << "\n";
+                    } else {
+                        if (journal_enabled) {
+                            journal.Append(BridgeJournal::kTx, frame);
+                        }
+                        if (checkpoint_enabled) {
+                            shadow_book.ApplyEvent(frame);
                         }
+                        if (bus_enabled) {
+                            bus.Publish(MdBus::kEvent, frame);
+                        }
+                        if (verify_sample != 0) {
+                            verifier.OnEvent(frame);
+                        }
+                    }
+                }
+
+                if (checkpoint_enabled && !events.empty()) {
+                    last_seq = events.back().word0;
+                    if (++since_checkpoint >= checkpoint_every) {
+                        checkpoint.Save(*checkpoint_book, last_seq);
+                        since_checkpoint = 0;
                     }
                 }
 
                 if (bridge_enabled) {
                     FpgaSharedStream::Frame rx{};
                     while (bridge.Receive(&rx)) {
-                        std::cout << "[FPGA->ARM] seq=" << rx.word0
-                                  << " action=" << action_to_string(rx.word1)
-                                  << " best_bid_px_1e4=" << rx.word2
-                                  << " best_bid_qty=" << rx.word3
-                                  << " best_ask_px_1e4=" << rx.word4
-                                  << " best_ask_qty=" << rx.word5
-                                  << " spread_1e4=" << rx.word6
-                                  << " imbalance=" << decode_imbalance(rx.word7)
-                                  << "\n";
+                        print_response("[FPGA->ARM]", rx);
+                        if (journal_enabled) {
+                            journal.Append(BridgeJournal::kRx, rx);
+                        }
+                        if (bus_enabled) {
+                            bus.Publish(MdBus::kResponse, rx);
+                        }
+                        if (verify_sample != 0) {
+                            verify_response(&verifier, &bridge, rx);
+                        }
                     }
                 }
             } catch (const boost::exception& e) {
@@ -359,6 +894,31 @@ int main()
         }
 
         close(sock);
+        if (checkpoint_enabled) {
+            checkpoint.Save(*checkpoint_book, last_seq);
+            since_checkpoint = 0;
+            std::cout << "Book checkpoint: saves=" << checkpoint.Saves()
+                      << " last_seq=" << last_seq << "\n";
+        }
+        const FeedFraming::Stats& stream = framing.GetStats();
+        std::cout << "Feed stream: messages=" << stream.messages
+                  << " bytes_per_msg=" << framing.BytesPerMessage()
+                  << " resets=" << stream.resets
+                  << " skipped=" << stream.skipped << "\n";
+        const TickArena::Stats& arena = alloc.stats();
+        std::cout << "Decode arena: requests="
+                  << arena.allocations + arena.reallocations - arena_start.allocations -
+                         arena_start.reallocations
+                  << " heap_allocations="
+                  << arena.heap_allocations - arena_start.heap_allocations << "\n";
+        if (journal_enabled) {
+            std::cout << "Bridge journal: written=" << journal.Written()
+                      << " dropped=" << journal.Dropped() << "\n";
+        }
+        if (hiccup) {
+            meter.Stop();
+            print_hiccups(meter.Summarize());
+        }
         std::cout << "Feed disconnected; waiting to reconnect...\n";
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
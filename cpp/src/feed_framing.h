@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+// Framing between fast_data_feed and fast_receiver: each FAST message is
+// preceded by a 4-byte big-endian word holding its length in the low 31
+// bits. Bit 31 is set when the encoder reset its dictionary before this
+// message, so the decoder resets at exactly the same points.
+//
+// In stream mode the dictionary carries over between messages, so the
+// copy/delta/increment operators in SimpleMD.xml can drop fields that
+// repeat. A reader that joins mid-stream, or reconnects, has no dictionary
+// state. It skips messages until the next reset frame (Accept()), and the
+// feed resets whenever a client joins and every `reset_every` messages.
+// `reset_every` 1 resets on every message, which is the old behaviour.
+class FeedFraming {
+ public:
+  static const uint32_t kResetFlag = 0x80000000u;
+  static const uint32_t kMaxLength = 0x7FFFFFFFu;
+  static const uint32_t kDefaultResetEvery = 256;
+
+  static uint32_t Pack(uint32_t length, bool reset) {
+    return (length & kMaxLength) | (reset ? kResetFlag : 0u);
+  }
+  static uint32_t Length(uint32_t word) { return word & kMaxLength; }
+  static bool IsReset(uint32_t word) { return (word & kResetFlag) != 0; }
+
+  struct Stats {
+    uint64_t messages;
+    uint64_t bytes;
+    uint64_t resets;
+    // Receiver only: messages dropped while waiting for a reset frame.
+    uint64_t skipped;
+  };
+
+  explicit FeedFraming(uint32_t reset_every = kDefaultResetEvery)
+      : reset_every_(reset_every), since_reset_(0), synced_(false), stats_() {}
+
+  // Encoder side: whether the next message resets the dictionary. `force`
+  // is set when a client has joined since the last message. `reset_every`
+  // 0 resets only when forced (and on the first message).
+  bool NextIsReset(bool force) {
+    const bool reset = force || !synced_ || (reset_every_ != 0 && since_reset_ >= reset_every_);
+    synced_ = true;
+    since_reset_ = reset ? 1 : since_reset_ + 1;
+    return reset;
+  }
+
+  // Decoder side: whether to decode the message behind `word`, which is false
+  // until the first reset frame after Restart().
+  bool Accept(uint32_t word) {
+    if (IsReset(word)) {
+      synced_ = true;
+    } else if (!synced_) {
+      ++stats_.skipped;
+      return false;
+    }
+    return true;
+  }
+
+  // Encoder or decoder side: count a framed message.
+  void Record(uint32_t word) {
+    ++stats_.messages;
+    stats_.bytes += Length(word);
+    stats_.resets += IsReset(word) ? 1 : 0;
+  }
+
+  // New connection: wait for (or send) a reset, and start counting afresh.
+  void Restart() {
+    synced_ = false;
+    since_reset_ = 0;
+    stats_ = Stats();
+  }
+
+  uint32_t ResetEvery() const { return reset_every_; }
+  const Stats& GetStats() const { return stats_; }
+  double BytesPerMessage() const {
+    return stats_.messages == 0 ? 0.0
+                                : static_cast<double>(stats_.bytes) /
+                                      static_cast<double>(stats_.messages);
+  }
+
+ private:
+  uint32_t reset_every_;
+  uint32_t since_reset_;
+  bool synced_;
+  Stats stats_;
+};
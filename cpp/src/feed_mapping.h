@@ -0,0 +1,119 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+#include "sw_order_book.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Feed-to-book translation used by fast_receiver: SimpleMD symbol names to
+// book symbol ids, side strings to side codes, FAST decimals to 1e-4 fixed
+// point, and the level event frames the FPGA and SwOrderBook consume.
+// hft_microbench times each step on its own.
+//
+// Each SimpleMD template maps onto one book event type:
+//
+//   SimpleMD     (100)  kEventUpsertLevel  price, qty
+//   LevelDelete  (101)  kEventDeleteLevel  price
+//   BookReset    (102)  kEventResetBook    symbol only
+//   Trade        (103)  kEventUpsertLevel  price, remaining level qty, or
+//                       kEventDeleteLevel when the trade cleared the level
+class FeedMapping {
+ public:
+  struct Symbol {
+    const char* name;
+    uint32_t id;
+  };
+
+  static const uint32_t kNumSymbols = 5;
+
+  // Template ids in templates/SimpleMD.xml.
+  static const uint32_t kTemplateLevelUpdate = 100;
+  static const uint32_t kTemplateLevelDelete = 101;
+  static const uint32_t kTemplateBookReset = 102;
+  static const uint32_t kTemplateTrade = 103;
+
+  static const Symbol* Symbols() {
+    static const Symbol kSymbols[kNumSymbols] = {
+        {"AAPL", 0}, {"MSFT", 1}, {"NVDA", 2}, {"GOOGL", 3}, {"TSLA", 4},
+    };
+    return kSymbols;
+  }
+
+  static bool MapSymbol(const char* symbol, uint32_t* out) {
+    if (symbol == nullptr || out == nullptr) {
+      return false;
+    }
+    const Symbol* symbols = Symbols();
+    for (uint32_t i = 0; i < kNumSymbols; ++i) {
+      if (std::strcmp(symbols[i].name, symbol) == 0) {
+        *out = symbols[i].id;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // "buy"/"sell" (first letter, any case) to kSideBuy/kSideSell, else 0.
+  static uint32_t ParseSide(const char* side) {
+    if (side != nullptr) {
+      if (side[0] == 'b' || side[0] == 'B') {
+        return SwOrderBook::kSideBuy;
+      }
+      if (side[0] == 's' || side[0] == 'S') {
+        return SwOrderBook::kSideSell;
+      }
+    }
+    return 0;
+  }
+
+  // mantissa * 10^exponent in 1e-4 units, rounded and clamped to uint32.
+  static uint32_t PriceToFixed1e4(int64_t mantissa, int32_t exponent) {
+    const double value =
+        static_cast<double>(mantissa) * std::pow(10.0, static_cast<double>(exponent));
+    long long scaled = std::llround(value * 10000.0);
+    if (scaled < 0) {
+      scaled = 0;
+    } else if (scaled > 0xFFFFFFFFll) {
+      scaled = 0xFFFFFFFFll;
+    }
+    return static_cast<uint32_t>(scaled);
+  }
+
+  static FpgaSharedStream::Frame LevelFrame(uint32_t seq, uint32_t symbol_id, uint32_t price_1e4,
+                                            uint32_t qty, uint32_t side) {
+    return EventFrame(seq, symbol_id, price_1e4, qty, SwOrderBook::kEventUpsertLevel, side);
+  }
+
+  static FpgaSharedStream::Frame DeleteFrame(uint32_t seq, uint32_t symbol_id, uint32_t price_1e4,
+                                             uint32_t side) {
+    return EventFrame(seq, symbol_id, price_1e4, 0, SwOrderBook::kEventDeleteLevel, side);
+  }
+
+  static FpgaSharedStream::Frame ResetFrame(uint32_t seq, uint32_t symbol_id) {
+    return EventFrame(seq, symbol_id, 0, 0, SwOrderBook::kEventResetBook, 0);
+  }
+
+  // A trade leaves `level_qty` at the resting level it hit.
+  static FpgaSharedStream::Frame TradeFrame(uint32_t seq, uint32_t symbol_id, uint32_t price_1e4,
+                                            uint32_t level_qty, uint32_t side) {
+    return level_qty == 0 ? DeleteFrame(seq, symbol_id, price_1e4, side)
+                          : LevelFrame(seq, symbol_id, price_1e4, level_qty, side);
+  }
+
+ private:
+  static FpgaSharedStream::Frame EventFrame(uint32_t seq, uint32_t symbol_id, uint32_t price_1e4,
+                                            uint32_t qty, uint32_t event_type, uint32_t side) {
+    FpgaSharedStream::Frame frame{};
+    frame.word0 = seq;
+    frame.word1 = symbol_id;
+    frame.word2 = price_1e4;
+    frame.word3 = qty;
+    frame.word4 = event_type;
+    frame.word5 = side;
+    frame.word6 = 0;
+    frame.word7 = 0;
+    return frame;
+  }
+};
@@ -1,4 +1,18 @@
+#include "bench_stats.h"
 #include "fpga_shared_stream.h"
+#include "hw_perf_events.h"
+#include "latency_histogram.h"
+#include "outstanding_tracker.h"
+#include "perf_sampler.h"
+#include "response_verifier.h"
+#include "rt_setup.h"
+#include "sharded_engine.h"
+#include "sw_batch.h"
+#include "sw_features.h"
+#include "sw_l3_book.h"
+#include "sw_order_book.h"
+#include "sw_strategies.h"
+#include "workloads.h"
 
 #include <algorithm>
 #include <cerrno>
@@ -7,36 +21,73 @@
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <sys/mman.h>
+#include <thread>
 #include <time.h>
 #include <unistd.h>
 #include <vector>
 
 namespace {
 
-const uint32_t kEventUpsertLevel = 1;
-const uint32_t kEventDeleteLevel = 2;
-const uint32_t kEventResetBook = 3;
-const uint32_t kSideBuy = 1;
-const uint32_t kSideSell = 2;
-const uint32_t kActionNoop = 0;
-const uint32_t kActionBuy = 1;
-const uint32_t kActionSell = 2;
-const uint32_t kNumSymbols = 8;
-const uint32_t kBookDepth = 8;
-const uint32_t kImbalanceThreshold = 500;
-const uint32_t kMaxSpread1e4 = 25000;
+// Symbols the event stream spreads over by default.
+const uint32_t kDefaultEventSymbols = 5;
 const double kLatencyJitterLimitNs = 1000.0;
 const double kThroughputLimitMsgS = 100000.0;
 const double kSpeedupLimit = 5.0;
+// Pipelined runs give up on outstanding responses after this much silence.
+const uint64_t kResponseTimeoutNs = 1000000000ull;
+// Resting orders the sw-l3 event stream keeps alive across all symbols.
+const uint32_t kL3RestingOrders = 65536;
+const uint64_t kDefaultBatch = 64;
+const uint64_t kDefaultOpenRateMsgS = 100000;
+// fpga-open knee: last rate that keeps up with its schedule and whose
+// corrected p99 stays within this factor of the lowest rate's.
+const double kKneeLatencyFactor = 2.0;
+const double kKneeMinAchieved = 0.95;
+// fpga-sweep knee: lowest-p99 point within this fraction of the best
+// throughput.
+const double kSweepKneeThroughput = 0.95;
 
 struct Options {
   std::string mode;
   uint64_t messages;
   uint64_t warmup;
+  uint64_t perf_sample_ms;
+  uint32_t symbols;
+  uint32_t threads;
+  uint32_t verify_sample;
+  uint64_t batch;
+  // fpga-open target rates, ascending.
+  std::vector<uint64_t> rates;
+  // fpga-sweep grid, each ascending. Outstanding defaults to powers of two up
+  // to the ring limit, batch to 1 and messages to --messages.
+  std::vector<uint64_t> sweep_outstanding;
+  std::vector<uint64_t> sweep_batches;
+  std::vector<uint64_t> sweep_messages;
+  std::string sweep_csv;
+  std::string strategy;
+  // Event stream for every mode but sw-l3; workload.num_symbols mirrors
+  // `symbols`.
+  Workloads::Config workload;
+  // Writes the generated events here before running.
+  std::string save_workload;
+  // Runs of the selected mode; per-metric statistics are printed when > 1.
+  uint64_t repeat;
+  std::string save_baseline;
+  std::string compare;
+  // With --compare: a second saved file to compare instead of running.
+  std::string candidate;
+  // Real-time profile for the measuring thread and the optional stall meter.
+  RtSetup::Config rt;
+  // Hardware counts around each warmup and measured phase.
+  bool hw_counters;
+  bool hiccup;
+  HiccupMeter::Config hiccup_meter;
   bool enable_bridges;
   bool enable_bridges_only;
 };
@@ -50,16 +101,115 @@ struct BenchmarkResult {
   uint64_t tx_full_spins;
   uint64_t rx_empty_spins;
   FpgaSharedStream::PerfCounters perf;
+  OutstandingTracker::Stats tracking;
+  OutstandingTracker::LatencySummary rtt;
+  // Whole-run and per-interval views of the FPGA perf block.
+  PerfSampler::Window perf_total;
+  std::vector<PerfSampler::Window> perf_windows;
 };
 
 struct SoftwareResult {
   bool ran;
+  const char* strategy;
   uint64_t messages;
   uint64_t duration_ns;
   double avg_ns;
+  uint64_t buys;
+  uint64_t sells;
   uint64_t checksum;
 };
 
+struct BatchResult {
+  bool ran;
+  uint64_t batch;
+  uint64_t messages;
+  uint64_t duration_ns;
+  double avg_ns;
+  double throughput_msg_s;
+  uint64_t responses;
+  uint64_t checksum;
+};
+
+struct L3Result {
+  bool ran;
+  uint64_t messages;
+  uint64_t duration_ns;
+  double avg_ns;
+  double throughput_msg_s;
+  uint64_t checksum;
+  uint32_t live_orders;
+  SwL3Book::Stats stats;
+};
+
+// One point of the sw-sharded scaling sweep.
+struct ShardedPoint {
+  uint32_t threads;
+  uint64_t duration_ns;
+  double throughput_msg_s;
+  // Rate relative to `threads` times the one-worker rate.
+  double efficiency;
+  // Busiest shard's event count over the mean.
+  double load_imbalance;
+  std::vector<uint64_t> shard_events;
+  uint64_t out_of_order;
+  uint64_t checksum;
+};
+
+struct ShardedResult {
+  bool ran;
+  std::vector<ShardedPoint> points;
+};
+
+// One fpga-open rate point.
+struct OpenLoopPoint {
+  uint64_t target_msg_s;
+  double achieved_msg_s;
+  uint64_t sent;
+  uint64_t matched;
+  uint64_t lost;
+  // Furthest any send fell behind its scheduled time.
+  uint64_t max_send_lag_ns;
+  // RTT from the actual send and from the scheduled send.
+  OutstandingTracker::LatencySummary service;
+  OutstandingTracker::LatencySummary corrected;
+};
+
+struct OpenLoopResult {
+  bool ran;
+  std::vector<OpenLoopPoint> points;
+};
+
+// One fpga-sweep grid point: a pipelined run with at most `max_outstanding`
+// requests in flight, sent in bursts of at least `batch`.
+struct SweepPoint {
+  uint64_t max_outstanding;
+  uint64_t batch;
+  uint64_t messages;
+  double throughput_msg_s;
+  OutstandingTracker::LatencySummary rtt;
+  uint64_t lost;
+  uint64_t tx_full_spins;
+  uint64_t rx_empty_spins;
+  uint32_t cmd_stall_cycles;
+  uint32_t rsp_stall_cycles;
+  double fpga_latency_avg_ns;
+};
+
+struct SweepResult {
+  bool ran;
+  std::vector<SweepPoint> points;
+};
+
+struct VerifyResult {
+  bool ran;
+  ResponseVerifier::Stats stats;
+  // Final FPGA book read back per sampled symbol and compared with the model;
+  // 0 symbols on bitstreams without the readback window.
+  uint32_t book_symbols;
+  uint32_t book_mismatches;
+  double book_read_ns;
+};
+
 struct SyncResult {
   bool ran;
   uint64_t messages;
@@ -71,14 +221,11 @@ struct SyncResult {
   double rtt_jitter_ns;
 };
 
-struct Level {
-  uint32_t price;
-  uint32_t qty;
-};
-
-struct Book {
-  Level bids[kNumSymbols][kBookDepth];
-  Level asks[kNumSymbols][kBookDepth];
+// --hw-counters: counts over one warmup or measured loop.
+struct HwPhase {
+  const char* name;
+  uint64_t messages;
+  HwPerfEvents::Counts counts;
 };
 
 uint64_t now_ns() {
@@ -107,10 +254,58 @@ bool parse_u64(const char* text, uint64_t* out) {
   return true;
 }
 
+// Comma-separated positive integers, returned in ascending order.
+bool parse_u64_list(const char* text, std::vector<uint64_t>* out) {
+  std::vector<uint64_t> values;
+  std::string item;
+  const std::string list(text);
+  for (std::size_t pos = 0; pos <= list.size(); ++pos) {
+    if (pos < list.size() && list[pos] != ',') {
+      item += list[pos];
+      continue;
+    }
+    uint64_t value = 0;
+    if (!parse_u64(item.c_str(), &value) || value == 0 || value > 1000000000ull) {
+      return false;
+    }
+    values.push_back(value);
+    item.clear();
+  }
+  std::sort(values.begin(), values.end());
+  out->swap(values);
+  return true;
+}
+
+// Everything one run of the selected mode produces.
+struct RunResults {
+  BenchmarkResult fpga;
+  SoftwareResult sw;
+  std::vector<SoftwareResult> strategies;
+  BatchResult batch;
+  L3Result l3;
+  ShardedResult sharded;
+  VerifyResult verify;
+  OpenLoopResult open;
+  SweepResult sweep;
+  SyncResult sync;
+  std::vector<HwPhase> hw_phases;
+};
+
 void usage(const char* argv0) {
   std::cerr
       << "Usage: " << argv0
-      << " [--mode fpga-mmio|fpga-sync|sw-core|full] [--messages N] [--warmup N]\n";
+      << " [--mode fpga-mmio|fpga-sync|fpga-open|fpga-sweep|verify|sw-core|sw-batch|sw-l3|"
+         "sw-sharded|full]"
+         " [--messages N] [--warmup N] [--perf-sample-ms N] [--symbols N] [--threads N]"
+         " [--verify-sample N] [--batch N] [--rate MSG_S | --rate-sweep R1,R2,...]"
+         " [--strategy imbalance|microprice|depth-weighted|spread-regime|order-flow|all]"
+         " [--sweep-outstanding N1,N2,...] [--sweep-batch N1,N2,...]"
+         " [--sweep-messages N1,N2,...] [--sweep-csv FILE]"
+         " [--repeat N] [--save-baseline FILE] [--compare FILE [--candidate FILE]]"
+         " [--workload round-robin|uniform|zipf|delete-heavy|reset-storm|crossing|depth-churn]"
+         " [--workload-file FILE] [--seed N] [--save-workload FILE]"
+         " [--cpu N] [--rt-priority N] [--mlock] [--prefault] [--huge-pages]"
+         " [--hiccup-meter] [--hiccup-cpu N] [--hiccup-interval-us N] [--hw-counters]\n";
   std::cerr << "       " << argv0 << " --enable-bridges-only\n";
 }
 
@@ -121,6 +316,20 @@ bool parse_args(int argc, char** argv, Options* options) {
   options->mode = "full";
   options->messages = 1000000;
   options->warmup = 10000;
+  options->perf_sample_ms = 0;
+  options->symbols = kDefaultEventSymbols;
+  options->threads = std::min(static_cast<uint32_t>(ShardedEngine::kMaxThreads),
+                              std::max(1u, std::thread::hardware_concurrency()));
+  options->verify_sample = 1;
+  options->batch = kDefaultBatch;
+  options->rates.assign(1, kDefaultOpenRateMsgS);
+  options->strategy = SwOrderBook::ImbalanceStrategy::Name();
+  options->repeat = 1;
+  options->workload = Workloads::DefaultConfig();
+  options->rt = RtSetup::DefaultConfig();
+  options->hw_counters = false;
+  options->hiccup = false;
+  options->hiccup_meter = HiccupMeter::DefaultConfig();
   options->enable_bridges = false;
   options->enable_bridges_only = false;
 
@@ -130,7 +339,17 @@ bool parse_args(int argc, char** argv, Options* options) {
       usage(argv[0]);
       std::exit(0);
     }
-    if ((arg == "--mode" || arg == "--messages" || arg == "--warmup") && i + 1 >= argc) {
+    if ((arg == "--mode" || arg == "--messages" || arg == "--warmup" ||
+         arg == "--perf-sample-ms" || arg == "--symbols" || arg == "--threads" ||
+         arg == "--verify-sample" || arg == "--batch" || arg == "--strategy" ||
+         arg == "--rate" || arg == "--rate-sweep" || arg == "--repeat" ||
+         arg == "--save-baseline" || arg == "--compare" || arg == "--candidate" ||
+         arg == "--workload" || arg == "--workload-file" || arg == "--seed" ||
+         arg == "--save-workload" || arg == "--cpu" || arg == "--rt-priority" ||
+         arg == "--hiccup-cpu" || arg == "--hiccup-interval-us" ||
+         arg == "--sweep-outstanding" || arg == "--sweep-batch" || arg == "--sweep-messages" ||
+         arg == "--sweep-csv") &&
+        i + 1 >= argc) {
       usage(argv[0]);
       return false;
     }
@@ -146,6 +365,136 @@ bool parse_args(int argc, char** argv, Options* options) {
         std::cerr << "Invalid --warmup value\n";
         return false;
       }
+    } else if (arg == "--perf-sample-ms") {
+      if (!parse_u64(argv[++i], &options->perf_sample_ms)) {
+        std::cerr << "Invalid --perf-sample-ms value\n";
+        return false;
+      }
+    } else if (arg == "--symbols") {
+      uint64_t symbols = 0;
+      if (!parse_u64(argv[++i], &symbols) || symbols == 0 || symbols > 0xFFFFFFFFull) {
+        std::cerr << "Invalid --symbols value\n";
+        return false;
+      }
+      options->symbols = static_cast<uint32_t>(symbols);
+    } else if (arg == "--threads") {
+      uint64_t threads = 0;
+      if (!parse_u64(argv[++i], &threads) || threads == 0 ||
+          threads > ShardedEngine::kMaxThreads) {
+        std::cerr << "Invalid --threads value\n";
+        return false;
+      }
+      options->threads = static_cast<uint32_t>(threads);
+    } else if (arg == "--verify-sample") {
+      uint64_t sample = 0;
+      if (!parse_u64(argv[++i], &sample) || sample == 0 || sample > 0xFFFFFFFFull) {
+        std::cerr << "Invalid --verify-sample value\n";
+        return false;
+      }
+      options->verify_sample = static_cast<uint32_t>(sample);
+    } else if (arg == "--batch") {
+      if (!parse_u64(argv[++i], &options->batch) || options->batch == 0) {
+        std::cerr << "Invalid --batch value\n";
+        return false;
+      }
+    } else if (arg == "--rate") {
+      uint64_t rate = 0;
+      if (!parse_u64(argv[++i], &rate) || rate == 0 || rate > 1000000000ull) {
+        std::cerr << "Invalid --rate value\n";
+        return false;
+      }
+      options->rates.assign(1, rate);
+    } else if (arg == "--rate-sweep") {
+      if (!parse_u64_list(argv[++i], &options->rates)) {
+        std::cerr << "Invalid --rate-sweep value\n";
+        return false;
+      }
+    } else if (arg == "--sweep-outstanding" || arg == "--sweep-batch" ||
+               arg == "--sweep-messages") {
+      std::vector<uint64_t>* list = arg == "--sweep-outstanding"
+                                        ? &options->sweep_outstanding
+                                        : (arg == "--sweep-batch" ? &options->sweep_batches
+                                                                  : &options->sweep_messages);
+      if (!parse_u64_list(argv[++i], list)) {
+        std::cerr << "Invalid " << arg << " value\n";
+        return false;
+      }
+    } else if (arg == "--sweep-csv") {
+      options->sweep_csv = argv[++i];
+    } else if (arg == "--repeat") {
+      if (!parse_u64(argv[++i], &options->repeat) || options->repeat == 0) {
+        std::cerr << "Invalid --repeat value\n";
+        return false;
+      }
+    } else if (arg == "--save-baseline") {
+      options->save_baseline = argv[++i];
+    } else if (arg == "--compare") {
+      options->compare = argv[++i];
+    } else if (arg == "--candidate") {
+      options->candidate = argv[++i];
+    } else if (arg == "--workload") {
+      if (!Workloads::Parse(argv[++i], &options->workload.kind) ||
+          options->workload.kind == Workloads::kFile) {
+        std::cerr << "Invalid --workload value\n";
+        return false;
+      }
+    } else if (arg == "--workload-file") {
+      options->workload.kind = Workloads::kFile;
+      options->workload.path = argv[++i];
+    } else if (arg == "--seed") {
+      if (!parse_u64(argv[++i], &options->workload.seed)) {
+        std::cerr << "Invalid --seed value\n";
+        return false;
+      }
+    } else if (arg == "--save-workload") {
+      options->save_workload = argv[++i];
+    } else if (arg == "--cpu" || arg == "--hiccup-cpu") {
+      uint64_t cpu = 0;
+      if (!parse_u64(argv[++i], &cpu) || cpu >= CPU_SETSIZE) {
+        std::cerr << "Invalid " << arg << " value\n";
+        return false;
+      }
+      if (arg == "--cpu") {
+        options->rt.cpu = static_cast<int>(cpu);
+      } else {
+        options->hiccup = true;
+        options->hiccup_meter.cpu = static_cast<int>(cpu);
+      }
+    } else if (arg == "--rt-priority") {
+      uint64_t priority = 0;
+      if (!parse_u64(argv[++i], &priority) || priority == 0 || priority > 99) {
+        std::cerr << "Invalid --rt-priority value\n";
+        return false;
+      }
+      options->rt.fifo_priority = static_cast<int>(priority);
+    } else if (arg == "--mlock") {
+      options->rt.lock_memory = true;
+    } else if (arg == "--prefault") {
+      options->rt.prefault = true;
+    } else if (arg == "--huge-pages") {
+      options->rt.huge_pages = true;
+    } else if (arg == "--hw-counters") {
+      options->hw_counters = true;
+    } else if (arg == "--hiccup-meter") {
+      options->hiccup = true;
+    } else if (arg == "--hiccup-interval-us") {
+      uint64_t interval_us = 0;
+      if (!parse_u64(argv[++i], &interval_us) || interval_us == 0 || interval_us > 1000000) {
+        std::cerr << "Invalid --hiccup-interval-us value\n";
+        return false;
+      }
+      options->hiccup = true;
+      options->hiccup_meter.interval_ns = interval_us * 1000u;
+    } else if (arg == "--strategy") {
+      options->strategy = argv[++i];
+      if (options->strategy != SwOrderBook::ImbalanceStrategy::Name() &&
+          options->strategy != MicropriceStrategy::Name() &&
+          options->strategy != DepthWeightedStrategy::Name() &&
+          options->strategy != SpreadRegimeStrategy::Name() &&
+          options->strategy != OrderFlowStrategy::Name() && options->strategy != "all") {
+        std::cerr << "Invalid --strategy value\n";
+        return false;
+      }
     } else if (arg == "--enable-bridges") {
       options->enable_bridges = true;
     } else if (arg == "--enable-bridges-only") {
@@ -157,11 +506,51 @@ bool parse_args(int argc, char** argv, Options* options) {
     }
   }
 
+  const bool software_only = options->mode == "sw-core" || options->mode == "sw-batch" ||
+                             options->mode == "sw-l3" || options->mode == "sw-sharded";
   if (options->mode != "fpga-mmio" && options->mode != "fpga-sync" &&
-      options->mode != "sw-core" && options->mode != "full") {
+      options->mode != "fpga-open" && options->mode != "fpga-sweep" &&
+      options->mode != "verify" && options->mode != "full" && !software_only) {
     std::cerr << "Invalid --mode value\n";
     return false;
   }
+  const bool sweep_options = !options->sweep_outstanding.empty() ||
+                             !options->sweep_batches.empty() ||
+                             !options->sweep_messages.empty() || !options->sweep_csv.empty();
+  if (sweep_options && options->mode != "fpga-sweep") {
+    std::cerr << "--sweep-* options need --mode fpga-sweep\n";
+    return false;
+  }
+  if (options->mode == "fpga-sweep") {
+    if (options->sweep_batches.empty()) {
+      options->sweep_batches.assign(1, 1);
+    }
+    if (options->sweep_messages.empty()) {
+      options->sweep_messages.assign(1, options->messages);
+    }
+    // The event stream covers the longest point.
+    options->messages = options->sweep_messages.back();
+  }
+  options->workload.num_symbols = options->symbols;
+  if (options->mode == "sw-l3" && options->workload.kind != Workloads::kRoundRobin) {
+    std::cerr << "--mode sw-l3 uses its own order stream; --workload does not apply\n";
+    return false;
+  }
+  if (options->mode == "sw-sharded" &&
+      (options->rt.cpu >= 0 || options->rt.fifo_priority > 0)) {
+    // Workers inherit the dispatcher's affinity and policy.
+    std::cerr << "--cpu and --rt-priority would pin every sw-sharded worker too\n";
+    return false;
+  }
+  options->hiccup_meter.fifo_priority = options->rt.fifo_priority;
+  if (!options->candidate.empty() && options->compare.empty()) {
+    std::cerr << "--candidate needs --compare\n";
+    return false;
+  }
+  if (!software_only && options->symbols > SwOrderBook::kDefaultNumSymbols) {
+    std::cerr << "Note: the FPGA book holds " << SwOrderBook::kDefaultNumSymbols
+              << " symbols; events for higher symbol ids get empty responses\n";
+  }
   return true;
 }
 
@@ -213,206 +602,346 @@ bool enable_hps_fpga_bridges() {
   return true;
 }
 
-FpgaSharedStream::Frame make_event(uint64_t idx) {
-  static const uint32_t base_prices_1e4[5] = {
-      1850000u, 4150000u, 8750000u, 1700000u, 1750000u,
+// Order-by-order stream for --mode sw-l3: adds around each symbol's base
+// price plus cancels, partial or full fills and modifies of resting orders,
+// with the resting population hovering around kL3RestingOrders. The generator
+// tracks what it has sent, so every cancel/modify/execute names a live order.
+std::vector<FpgaSharedStream::Frame> make_l3_events(uint64_t total, uint32_t num_symbols) {
+  struct Resting {
+    uint32_t id;
+    uint32_t symbol;
+    uint32_t side;
+    uint32_t qty;
   };
-
-  const uint32_t symbol = static_cast<uint32_t>(idx % 5);
-  const uint32_t side = (idx & 1u) == 0 ? kSideBuy : kSideSell;
-  const uint32_t ticks_1e4 = static_cast<uint32_t>(((idx * 17u) % 80u) + 1u) * 100u;
-  const uint32_t base = base_prices_1e4[symbol];
-  const uint32_t price = side == kSideBuy ? base - ticks_1e4 : base + ticks_1e4;
-  const uint32_t qty = 100u + static_cast<uint32_t>((idx * 37u) % 4901u);
-
-  FpgaSharedStream::Frame frame{};
-  frame.word0 = static_cast<uint32_t>(idx + 1u);
-  frame.word1 = symbol;
-  frame.word2 = price;
-  frame.word3 = qty;
-  frame.word4 = kEventUpsertLevel;
-  frame.word5 = side;
-  frame.word6 = 0;
-  frame.word7 = 0;
-  return frame;
-}
-
-std::vector<FpgaSharedStream::Frame> make_events(uint64_t total) {
+  std::vector<Resting> resting;
+  resting.reserve(kL3RestingOrders * 2u);
   std::vector<FpgaSharedStream::Frame> events;
   events.reserve(static_cast<std::size_t>(total));
+
+  uint64_t rng = 0x9E3779B97F4A7C15ull;
+  uint32_t next_id = 1;
   for (uint64_t i = 0; i < total; ++i) {
-    events.push_back(make_event(i));
+    const uint32_t r = Workloads::NextRandom(&rng);
+    const uint32_t ticks_1e4 = (Workloads::NextRandom(&rng) % 80u + 1u) * 100u;
+    const uint32_t qty = 100u + Workloads::NextRandom(&rng) % 4901u;
+    const bool below_target = resting.size() < kL3RestingOrders;
+
+    FpgaSharedStream::Frame frame{};
+    frame.word0 = static_cast<uint32_t>(i + 1u);
+    if (resting.empty() || (r & 3u) < (below_target ? 3u : 1u)) {
+      const uint32_t symbol = (r >> 8) % num_symbols;
+      const uint32_t side = ((r >> 2) & 1u) == 0 ? SwOrderBook::kSideBuy : SwOrderBook::kSideSell;
+      const uint32_t base = Workloads::BasePrice1e4(symbol);
+      frame.word1 = symbol;
+      frame.word2 = side == SwOrderBook::kSideBuy ? base - ticks_1e4 : base + ticks_1e4;
+      frame.word3 = qty;
+      frame.word4 = SwOrderBook::kEventAddOrder;
+      frame.word5 = side;
+      frame.word6 = next_id;
+      const Resting order = {next_id++, symbol, side, qty};
+      resting.push_back(order);
+    } else {
+      const std::size_t pick = (r >> 8) % resting.size();
+      Resting& order = resting[pick];
+      frame.word1 = order.symbol;
+      frame.word6 = order.id;
+      const uint32_t kind = (r >> 2) & 7u;
+      if (kind < 4u) {
+        frame.word4 = SwOrderBook::kEventCancelOrder;
+        order.qty = 0;
+      } else if (kind < 6u) {
+        frame.word4 = SwOrderBook::kEventExecuteOrder;
+        frame.word3 = std::min(order.qty, qty / 4u);
+        order.qty -= frame.word3;
+      } else {
+        const uint32_t base = Workloads::BasePrice1e4(order.symbol);
+        frame.word4 = SwOrderBook::kEventModifyOrder;
+        frame.word2 = order.side == SwOrderBook::kSideBuy ? base - ticks_1e4 : base + ticks_1e4;
+        frame.word3 = qty;
+        order.qty = qty;
+      }
+      if (order.qty == 0) {
+        order = resting.back();
+        resting.pop_back();
+      }
+    }
+    events.push_back(frame);
   }
   return events;
 }
 
-void clear_side(Level side[kBookDepth]) {
-  for (uint32_t i = 0; i < kBookDepth; ++i) {
-    side[i].price = 0;
-    side[i].qty = 0;
-  }
+uint64_t checksum_frame(const FpgaSharedStream::Frame& frame) {
+  uint64_t value = frame.word0;
+  value = (value * 1315423911ull) ^ frame.word1;
+  value = (value * 1315423911ull) ^ frame.word2;
+  value = (value * 1315423911ull) ^ frame.word3;
+  value = (value * 1315423911ull) ^ frame.word4;
+  value = (value * 1315423911ull) ^ frame.word5;
+  value = (value * 1315423911ull) ^ frame.word6;
+  value = (value * 1315423911ull) ^ frame.word7;
+  return value;
 }
 
-void delete_at(Level side[kBookDepth], uint32_t idx) {
-  for (uint32_t i = idx; i + 1 < kBookDepth; ++i) {
-    side[i] = side[i + 1];
-  }
-  side[kBookDepth - 1].price = 0;
-  side[kBookDepth - 1].qty = 0;
-}
+// Appends one HwPhase per Begin()/End() pair to `phases`; with no counters
+// both calls do nothing.
+class PhaseCounters {
+ public:
+  PhaseCounters(HwPerfEvents* counters, std::vector<HwPhase>* phases)
+      : counters_(counters), phases_(phases) {}
 
-void apply_level_update(Level side[kBookDepth], uint32_t price, uint32_t qty,
-                        bool is_delete, bool desc_sort) {
-  int match_idx = -1;
-  int insert_idx = -1;
-  for (uint32_t i = 0; i < kBookDepth; ++i) {
-    if (side[i].qty != 0 && side[i].price == price) {
-      match_idx = static_cast<int>(i);
+  void Begin() {
+    if (counters_ != nullptr) {
+      counters_->Start();
     }
   }
 
-  if (match_idx >= 0) {
-    if (is_delete || qty == 0) {
-      delete_at(side, static_cast<uint32_t>(match_idx));
-    } else {
-      side[match_idx].qty = qty;
+  void End(const char* name, uint64_t messages) {
+    if (counters_ == nullptr) {
+      return;
     }
-    return;
+    HwPhase phase{};
+    phase.counts = counters_->Stop();
+    phase.name = name;
+    phase.messages = messages;
+    phases_->push_back(phase);
   }
 
-  if (is_delete || qty == 0) {
-    return;
-  }
+ private:
+  HwPerfEvents* counters_;
+  std::vector<HwPhase>* phases_;
+};
 
-  for (uint32_t i = 0; i < kBookDepth; ++i) {
-    if (side[i].qty == 0) {
-      insert_idx = static_cast<int>(i);
-      break;
-    }
-    if ((desc_sort && price > side[i].price) ||
-        (!desc_sort && price < side[i].price)) {
-      insert_idx = static_cast<int>(i);
-      break;
-    }
+template <typename Strategy>
+SoftwareResult run_sw_core(const std::vector<FpgaSharedStream::Frame>& events, uint64_t warmup,
+                           uint64_t messages, uint32_t num_symbols, const Strategy& strategy,
+                           PhaseCounters* phases) {
+  SwOrderBook::Config config = SwOrderBook::DefaultConfig();
+  config.num_symbols = std::max(config.num_symbols, num_symbols);
+  SwOrderBook book(config);
+  phases->Begin();
+  for (uint64_t i = 0; i < warmup; ++i) {
+    book.Process(events[static_cast<std::size_t>(i)], strategy);
   }
+  phases->End("sw_core_warmup", warmup);
 
-  if (insert_idx < 0) {
-    return;
+  uint64_t checksum = 0;
+  uint64_t buys = 0;
+  uint64_t sells = 0;
+  phases->Begin();
+  const uint64_t start = now_ns();
+  for (uint64_t i = 0; i < messages; ++i) {
+    const FpgaSharedStream::Frame response =
+        book.Process(events[static_cast<std::size_t>(warmup + i)], strategy);
+    buys += response.word1 == SwOrderBook::kActionBuy ? 1u : 0u;
+    sells += response.word1 == SwOrderBook::kActionSell ? 1u : 0u;
+    checksum ^= checksum_frame(response);
   }
+  const uint64_t duration = now_ns() - start;
+  phases->End("sw_core", messages);
 
-  for (int i = static_cast<int>(kBookDepth) - 1; i > insert_idx; --i) {
-    side[i] = side[i - 1];
-  }
-  side[insert_idx].price = price;
-  side[insert_idx].qty = qty;
+  SoftwareResult result{};
+  result.ran = true;
+  result.strategy = Strategy::Name();
+  result.messages = messages;
+  result.duration_ns = duration;
+  result.avg_ns = messages == 0 ? 0.0 : static_cast<double>(duration) / messages;
+  result.buys = buys;
+  result.sells = sells;
+  result.checksum = checksum;
+  return result;
+}
+
+// The book with the FPGA's own imbalance rule; sw-sharded and the speedup
+// figures compare against this one.
+SoftwareResult run_sw_core(const std::vector<FpgaSharedStream::Frame>& events, uint64_t warmup,
+                           uint64_t messages, uint32_t num_symbols, PhaseCounters* phases) {
+  return run_sw_core(events, warmup, messages, num_symbols,
+                     SwOrderBook::ImbalanceStrategy::Default(), phases);
 }
 
-uint32_t decide_action(uint32_t best_bid_px, uint32_t best_bid_qty,
-                       uint32_t best_ask_px, uint32_t best_ask_qty,
-                       uint32_t spread_1e4, int32_t imbalance) {
-  if (best_bid_qty == 0 || best_ask_qty == 0 || best_ask_px <= best_bid_px) {
-    return kActionNoop;
+// sw-core runs for `name`, or every policy in sw_strategies.h and
+// sw_features.h for "all". Only the first run is counted in `phases`.
+std::vector<SoftwareResult> run_sw_strategies(const std::vector<FpgaSharedStream::Frame>& events,
+                                              uint64_t warmup, uint64_t messages,
+                                              uint32_t num_symbols, const std::string& name,
+                                              PhaseCounters* phases) {
+  const bool all = name == "all";
+  std::vector<SoftwareResult> results;
+  PhaseCounters uncounted(nullptr, nullptr);
+  if (all || name == SwOrderBook::ImbalanceStrategy::Name()) {
+    results.push_back(run_sw_core(events, warmup, messages, num_symbols, phases));
   }
-  if (spread_1e4 <= kMaxSpread1e4 &&
-      imbalance >= static_cast<int32_t>(kImbalanceThreshold)) {
-    return kActionBuy;
+  if (all || name == MicropriceStrategy::Name()) {
+    results.push_back(run_sw_core(events, warmup, messages, num_symbols,
+                                  MicropriceStrategy::Default(),
+                                  results.empty() ? phases : &uncounted));
   }
-  if (spread_1e4 <= kMaxSpread1e4 &&
-      imbalance <= -static_cast<int32_t>(kImbalanceThreshold)) {
-    return kActionSell;
+  if (all || name == DepthWeightedStrategy::Name()) {
+    results.push_back(run_sw_core(events, warmup, messages, num_symbols,
+                                  DepthWeightedStrategy::Default(),
+                                  results.empty() ? phases : &uncounted));
   }
-  return kActionNoop;
+  if (all || name == SpreadRegimeStrategy::Name()) {
+    results.push_back(run_sw_core(events, warmup, messages, num_symbols,
+                                  SpreadRegimeStrategy::Default(),
+                                  results.empty() ? phases : &uncounted));
+  }
+  if (all || name == OrderFlowStrategy::Name()) {
+    SwFeatures::Config config = SwFeatures::DefaultConfig();
+    config.num_symbols = std::max(config.num_symbols, num_symbols);
+    SwFeatures features(config);
+    results.push_back(run_sw_core(events, warmup, messages, num_symbols,
+                                  OrderFlowStrategy::Default(&features),
+                                  results.empty() ? phases : &uncounted));
+  }
+  return results;
 }
 
-FpgaSharedStream::Frame process_sw(Book* book, const FpgaSharedStream::Frame& event) {
-  const uint32_t symbol = event.word1;
-  const uint32_t price = event.word2;
-  const uint32_t qty = event.word3;
-  const uint32_t event_type = event.word4;
-  const uint32_t side = event.word5;
-
-  uint32_t best_bid_px = 0;
-  uint32_t best_bid_qty = 0;
-  uint32_t best_ask_px = 0;
-  uint32_t best_ask_qty = 0;
-  uint32_t spread = 0;
-  int32_t imbalance = 0;
-
-  if (book != nullptr && symbol < kNumSymbols) {
-    if (event_type == kEventResetBook) {
-      clear_side(book->bids[symbol]);
-      clear_side(book->asks[symbol]);
-    } else if (side == kSideBuy) {
-      if (event_type == kEventDeleteLevel || book->asks[symbol][0].qty == 0 ||
-          price < book->asks[symbol][0].price) {
-        apply_level_update(book->bids[symbol], price, qty,
-                           event_type == kEventDeleteLevel, true);
-      }
-    } else if (side == kSideSell) {
-      if (event_type == kEventDeleteLevel || book->bids[symbol][0].qty == 0 ||
-          price > book->bids[symbol][0].price) {
-        apply_level_update(book->asks[symbol], price, qty,
-                           event_type == kEventDeleteLevel, false);
-      }
-    }
+// The sw-core stream through SwBatchBook, `batch` events per ProcessBatch().
+BatchResult run_sw_batch(const std::vector<FpgaSharedStream::Frame>& events, uint64_t warmup,
+                         uint64_t messages, uint32_t num_symbols, uint64_t batch) {
+  SwOrderBook::Config config = SwOrderBook::DefaultConfig();
+  config.num_symbols = std::max(config.num_symbols, num_symbols);
+  SwBatchBook book(config);
+  std::vector<FpgaSharedStream::Frame> responses(
+      static_cast<std::size_t>(std::min<uint64_t>(batch, config.num_symbols)));
+  for (uint64_t i = 0; i < warmup; i += batch) {
+    book.ProcessBatch(&events[static_cast<std::size_t>(i)],
+                      static_cast<std::size_t>(std::min(batch, warmup - i)), responses.data());
+  }
 
-    best_bid_px = book->bids[symbol][0].price;
-    best_bid_qty = book->bids[symbol][0].qty;
-    best_ask_px = book->asks[symbol][0].price;
-    best_ask_qty = book->asks[symbol][0].qty;
-    if (best_bid_qty != 0 && best_ask_qty != 0 && best_ask_px > best_bid_px) {
-      spread = best_ask_px - best_bid_px;
+  uint64_t checksum = 0;
+  uint64_t total = 0;
+  const FpgaSharedStream::Frame* measured = &events[static_cast<std::size_t>(warmup)];
+  const uint64_t start = now_ns();
+  for (uint64_t i = 0; i < messages; i += batch) {
+    const std::size_t written =
+        book.ProcessBatch(measured + i, static_cast<std::size_t>(std::min(batch, messages - i)),
+                          responses.data());
+    for (std::size_t k = 0; k < written; ++k) {
+      checksum ^= checksum_frame(responses[k]);
     }
-    imbalance = static_cast<int32_t>(best_bid_qty) - static_cast<int32_t>(best_ask_qty);
+    total += written;
   }
+  const uint64_t duration = now_ns() - start;
 
-  FpgaSharedStream::Frame response{};
-  response.word0 = event.word0;
-  response.word1 = decide_action(best_bid_px, best_bid_qty, best_ask_px, best_ask_qty,
-                                 spread, imbalance);
-  response.word2 = best_bid_px;
-  response.word3 = best_bid_qty;
-  response.word4 = best_ask_px;
-  response.word5 = best_ask_qty;
-  response.word6 = spread;
-  response.word7 = static_cast<uint32_t>(imbalance);
-  return response;
-}
-
-uint64_t checksum_frame(const FpgaSharedStream::Frame& frame) {
-  uint64_t value = frame.word0;
-  value = (value * 1315423911ull) ^ frame.word1;
-  value = (value * 1315423911ull) ^ frame.word2;
-  value = (value * 1315423911ull) ^ frame.word3;
-  value = (value * 1315423911ull) ^ frame.word4;
-  value = (value * 1315423911ull) ^ frame.word5;
-  value = (value * 1315423911ull) ^ frame.word6;
-  value = (value * 1315423911ull) ^ frame.word7;
-  return value;
+  BatchResult result{};
+  result.ran = true;
+  result.batch = batch;
+  result.messages = messages;
+  result.duration_ns = duration;
+  result.avg_ns = messages == 0 ? 0.0 : static_cast<double>(duration) / messages;
+  result.throughput_msg_s =
+      duration == 0 ? 0.0 : static_cast<double>(messages) * 1000000000.0 / duration;
+  result.responses = total;
+  result.checksum = checksum;
+  return result;
 }
 
-SoftwareResult run_sw_core(const std::vector<FpgaSharedStream::Frame>& events,
-                           uint64_t warmup, uint64_t messages) {
-  Book book{};
+L3Result run_sw_l3(const std::vector<FpgaSharedStream::Frame>& events, uint64_t warmup,
+                   uint64_t messages, uint32_t num_symbols) {
+  SwL3Book::Config config = SwL3Book::DefaultConfig();
+  config.num_symbols = std::max(config.num_symbols, num_symbols);
+  config.max_orders = kL3RestingOrders * 2u;
+  SwL3Book book(config);
   for (uint64_t i = 0; i < warmup; ++i) {
-    process_sw(&book, events[static_cast<std::size_t>(i)]);
+    book.Process(events[static_cast<std::size_t>(i)]);
   }
 
   uint64_t checksum = 0;
   const uint64_t start = now_ns();
   for (uint64_t i = 0; i < messages; ++i) {
     const FpgaSharedStream::Frame response =
-        process_sw(&book, events[static_cast<std::size_t>(warmup + i)]);
+        book.Process(events[static_cast<std::size_t>(warmup + i)]);
     checksum ^= checksum_frame(response);
   }
   const uint64_t duration = now_ns() - start;
 
-  SoftwareResult result{};
+  L3Result result{};
   result.ran = true;
   result.messages = messages;
   result.duration_ns = duration;
-  result.avg_ns = messages == 0 ? 0.0 : static_cast<double>(duration) / messages;
+  result.avg_ns = static_cast<double>(duration) / messages;
+  result.throughput_msg_s =
+      duration == 0 ? 0.0 : static_cast<double>(messages) * 1000000000.0 / duration;
   result.checksum = checksum;
+  result.live_orders = book.LiveOrders();
+  result.stats = book.GetStats();
+  return result;
+}
+
+// Checksums merged responses and checks they come back in input order.
+struct ShardedSink {
+  const FpgaSharedStream::Frame* events;
+  std::size_t next;
+  uint64_t checksum;
+  uint64_t out_of_order;
+
+  void operator()(const FpgaSharedStream::Frame& response) {
+    if (response.word0 != events[next].word0) {
+      ++out_of_order;
+    }
+    checksum ^= checksum_frame(response);
+    ++next;
+  }
+};
+
+bool run_sharded_point(const std::vector<FpgaSharedStream::Frame>& events, uint64_t warmup,
+                       uint64_t messages, uint32_t num_symbols, uint32_t threads,
+                       ShardedPoint* point) {
+  ShardedEngine::Config config = ShardedEngine::DefaultConfig();
+  config.threads = threads;
+  config.book.num_symbols = std::max(config.book.num_symbols, num_symbols);
+  ShardedEngine engine;
+  if (!engine.Start(config)) {
+    std::cerr << "Failed to start " << threads << " shard workers\n";
+    return false;
+  }
+
+  ShardedSink warm{events.data(), 0, 0, 0};
+  engine.Run(events.data(), static_cast<std::size_t>(warmup), warm);
+  std::vector<uint64_t> before(threads);
+  for (uint32_t s = 0; s < threads; ++s) {
+    before[s] = engine.GetShardStats(s).events;
+  }
+
+  ShardedSink sink{events.data() + warmup, 0, 0, 0};
+  const uint64_t start = now_ns();
+  engine.Run(events.data() + warmup, static_cast<std::size_t>(messages), sink);
+  const uint64_t duration = now_ns() - start;
+
+  point->threads = threads;
+  point->duration_ns = duration;
+  point->throughput_msg_s =
+      duration == 0 ? 0.0 : static_cast<double>(messages) * 1000000000.0 / duration;
+  point->shard_events.assign(threads, 0);
+  uint64_t busiest = 0;
+  for (uint32_t s = 0; s < threads; ++s) {
+    point->shard_events[s] = engine.GetShardStats(s).events - before[s];
+    busiest = std::max(busiest, point->shard_events[s]);
+  }
+  const double mean = static_cast<double>(messages) / threads;
+  point->load_imbalance = mean > 0.0 ? static_cast<double>(busiest) / mean : 0.0;
+  point->out_of_order = sink.out_of_order;
+  point->checksum = sink.checksum;
+  return true;
+}
+
+// Runs the sharded engine with 1..max_threads workers.
+ShardedResult run_sw_sharded(const std::vector<FpgaSharedStream::Frame>& events, uint64_t warmup,
+                             uint64_t messages, uint32_t num_symbols, uint32_t max_threads) {
+  ShardedResult result{};
+  for (uint32_t threads = 1; threads <= max_threads; ++threads) {
+    ShardedPoint point{};
+    if (!run_sharded_point(events, warmup, messages, num_symbols, threads, &point)) {
+      return result;
+    }
+    const double base = result.points.empty() ? point.throughput_msg_s
+                                              : result.points[0].throughput_msg_s;
+    point.efficiency = base > 0.0 ? point.throughput_msg_s / (base * threads) : 0.0;
+    result.points.push_back(point);
+  }
+  result.ran = true;
   return result;
 }
 
@@ -439,6 +968,26 @@ bool open_bridge(FpgaSharedStream* bridge) {
   const char* dev_env = std::getenv("HFT_FPGA_MMIO_DEV");
   const std::string dev_path = dev_env == nullptr ? "/dev/mem" : dev_env;
 
+  const char* copy_env = std::getenv("HFT_FPGA_MMIO_COPY");
+  if (copy_env != nullptr) {
+    FpgaSharedStream::SlotCopyMode copy_mode = FpgaSharedStream::kSlotCopyScalar;
+    if (!FpgaSharedStream::ParseSlotCopyMode(copy_env, &copy_mode)) {
+      std::cerr << "Invalid HFT_FPGA_MMIO_COPY value (scalar|pair64|vector)\n";
+      return false;
+    }
+    bridge->SetSlotCopyMode(copy_mode);
+  }
+
+  const char* map_env = std::getenv("HFT_FPGA_MMIO_MAP");
+  if (map_env != nullptr) {
+    FpgaSharedStream::MapMode map_mode = FpgaSharedStream::kMapUncached;
+    if (!FpgaSharedStream::ParseMapMode(map_env, &map_mode)) {
+      std::cerr << "Invalid HFT_FPGA_MMIO_MAP value (sync|wc)\n";
+      return false;
+    }
+    bridge->SetMapMode(map_mode);
+  }
+
   if (!bridge->Open(base, static_cast<std::size_t>(span_value), dev_path)) {
     std::cerr << "Failed to open FPGA MMIO bridge: " << bridge->LastError() << "\n";
     return false;
@@ -446,78 +995,167 @@ bool open_bridge(FpgaSharedStream* bridge) {
   return true;
 }
 
+double cycles_to_ns(double cycles, uint32_t clock_hz) {
+  if (clock_hz == 0) {
+    return 0.0;
+  }
+  return cycles * 1000000000.0 / static_cast<double>(clock_hz);
+}
+
+double fpga_latency_avg_ns(const FpgaSharedStream::PerfCounters& perf) {
+  return perf.count == 0 ? 0.0
+                         : cycles_to_ns(static_cast<double>(perf.sum_latency_cycles) /
+                                            static_cast<double>(perf.count),
+                                        perf.clock_hz);
+}
+
+// Deepest pipeline the rings allow: TX capacity, and half of RX so
+// responses never back up into the FPGA.
+uint64_t ring_outstanding_limit(const FpgaSharedStream::Header& header) {
+  const uint64_t tx_capacity = header.tx_depth > 1 ? header.tx_depth - 1 : 1;
+  const uint64_t rx_capacity = header.rx_depth > 1 ? header.rx_depth - 1 : 1;
+  return std::max<uint64_t>(1, std::min(tx_capacity, std::max<uint64_t>(1, rx_capacity / 2)));
+}
+
+// At most `outstanding_limit` requests are in flight (0: the ring limit).
+// Sends wait until `batch` of them fit (1: send whenever there is room).
+// `perf_sample_ns` > 0 snapshots the FPGA perf block inline at that period
+// (one register sweep per window, taken between passes). A non-null
+// `verifier` checks every response against the software model.
 bool run_fpga_messages(FpgaSharedStream* bridge,
                        const std::vector<FpgaSharedStream::Frame>& events,
                        uint64_t start_index, uint64_t messages,
+                       uint64_t outstanding_limit, uint64_t batch,
+                       uint64_t perf_sample_ns, ResponseVerifier* verifier,
                        BenchmarkResult* result) {
   const FpgaSharedStream::Header header = bridge->ObservedHeader();
-  const uint64_t tx_capacity = header.tx_depth > 1 ? header.tx_depth - 1 : 1;
   const uint64_t rx_capacity = header.rx_depth > 1 ? header.rx_depth - 1 : 1;
+  const uint64_t ring_limit = ring_outstanding_limit(header);
   const uint64_t max_outstanding =
-      std::max<uint64_t>(1, std::min(tx_capacity, std::max<uint64_t>(1, rx_capacity / 2)));
+      outstanding_limit == 0 ? ring_limit : std::min(outstanding_limit, ring_limit);
+  batch = std::max<uint64_t>(1, std::min(batch, max_outstanding));
   uint64_t sent = 0;
-  uint64_t received = 0;
   uint64_t checksum = 0;
   uint64_t tx_full_spins = 0;
   uint64_t rx_empty_spins = 0;
+
+  OutstandingTracker tracker;
+  tracker.Reset(max_outstanding);
+  std::vector<uint32_t> drained(static_cast<std::size_t>(rx_capacity + 1));
+
+  PerfSampler sampler;
+  PerfSampler::Snapshot first_snapshot{};
+  std::vector<PerfSampler::Window> perf_windows;
+  perf_windows.reserve(perf_sample_ns > 0 ? 1024 : 0);
+  PerfSampler::Capture(*bridge, now_ns(), &first_snapshot);
+  sampler.Add(first_snapshot, nullptr);
+
   const uint64_t start = now_ns();
+  uint64_t last_progress_ns = start;
+  uint64_t next_sample_ns = start + perf_sample_ns;
 
-  while (received < messages) {
+  while (tracker.Matched() < messages) {
     bool made_progress = false;
 
+    // One clock read per pass: it closes the RTT of every response drained
+    // in this pass and opens the RTT of every request sent right after it.
     FpgaSharedStream::Frame response{};
-    bool received_any = false;
-    while (bridge->Receive(&response)) {
+    std::size_t drained_count = 0;
+    while (drained_count < drained.size() && bridge->Receive(&response)) {
       checksum ^= checksum_frame(response);
-      ++received;
-      received_any = true;
-      made_progress = true;
-      if (received == messages) {
-        break;
+      drained[drained_count++] = response.word0;
+      if (verifier != nullptr) {
+        verifier->OnResponse(response);
       }
     }
-
-    while (sent < messages && (sent - received) < max_outstanding &&
-           bridge->Send(events[static_cast<std::size_t>(start_index + sent)])) {
-      ++sent;
-      made_progress = true;
+    const uint64_t pass_ns = now_ns();
+    for (std::size_t i = 0; i < drained_count; ++i) {
+      tracker.OnResponse(drained[i], pass_ns);
     }
+    const bool received_any = drained_count != 0;
+    made_progress = received_any;
+
+    if (sent < messages &&
+        max_outstanding - tracker.Pending() >= std::min(batch, messages - sent)) {
+      while (sent < messages && tracker.Pending() < max_outstanding) {
+        const FpgaSharedStream::Frame& event =
+            events[static_cast<std::size_t>(start_index + sent)];
+        if (!bridge->Send(event)) {
+          break;
+        }
+        tracker.OnSend(event.word0, pass_ns);
+        if (verifier != nullptr) {
+          verifier->OnEvent(event);
+        }
+        ++sent;
+        made_progress = true;
+      }
 
-    if (sent < messages && (sent - received) < max_outstanding) {
-      ++tx_full_spins;
+      if (sent < messages && tracker.Pending() < max_outstanding) {
+        ++tx_full_spins;
+      }
     }
 
-    if (!received_any && sent > received) {
+    if (!received_any && tracker.Pending() > 0) {
       ++rx_empty_spins;
     }
 
-    if (!made_progress) {
+    if (perf_sample_ns > 0 && pass_ns >= next_sample_ns) {
+      PerfSampler::Window window{};
+      if (sampler.Sample(*bridge, pass_ns, &window)) {
+        perf_windows.push_back(window);
+      }
+      next_sample_ns = pass_ns + perf_sample_ns;
+    }
+
+    if (made_progress) {
+      last_progress_ns = pass_ns;
+    } else {
+      if (pass_ns - last_progress_ns > kResponseTimeoutNs) {
+        std::cerr << "Timed out waiting for " << tracker.Pending()
+                  << " outstanding FPGA responses\n";
+        break;
+      }
       __sync_synchronize();
     }
   }
 
-  const uint64_t duration = now_ns() - start;
+  const uint64_t end = now_ns();
+  const uint64_t duration = end - start;
+  tracker.Finish();
   FpgaSharedStream::PerfCounters perf{};
   bridge->ReadPerfCounters(&perf);
 
+  PerfSampler::Snapshot last_snapshot{};
+  PerfSampler::Capture(*bridge, end, &last_snapshot);
+  PerfSampler::Window tail_window{};
+  if (perf_sample_ns > 0 && sampler.Add(last_snapshot, &tail_window) &&
+      tail_window.duration_ns > 0) {
+    perf_windows.push_back(tail_window);
+  }
+
   if (result != nullptr) {
     result->ran = true;
     result->messages = messages;
     result->duration_ns = duration;
     result->throughput_msg_s =
-        duration == 0 ? 0.0 : (static_cast<double>(messages) * 1000000000.0) /
+        duration == 0 ? 0.0 : (static_cast<double>(tracker.Matched()) * 1000000000.0) /
                                   static_cast<double>(duration);
     result->checksum = checksum;
     result->tx_full_spins = tx_full_spins;
     result->rx_empty_spins = rx_empty_spins;
     result->perf = perf;
+    result->tracking = tracker.GetStats();
+    result->rtt = tracker.Summarize();
+    result->perf_total = PerfSampler::Diff(first_snapshot, last_snapshot);
+    result->perf_windows.swap(perf_windows);
   }
   return true;
 }
 
 bool run_fpga_benchmark(const std::vector<FpgaSharedStream::Frame>& events,
-                        uint64_t warmup, uint64_t messages,
-                        BenchmarkResult* result) {
+                        uint64_t warmup, uint64_t messages, uint64_t perf_sample_ns,
+                        PhaseCounters* phases, BenchmarkResult* result) {
   FpgaSharedStream bridge;
   if (!open_bridge(&bridge)) {
     return false;
@@ -528,20 +1166,313 @@ bool run_fpga_benchmark(const std::vector<FpgaSharedStream::Frame>& events,
   }
 
   BenchmarkResult ignored{};
-  if (warmup > 0 && !run_fpga_messages(&bridge, events, 0, warmup, &ignored)) {
+  phases->Begin();
+  if (warmup > 0 &&
+      !run_fpga_messages(&bridge, events, 0, warmup, 0, 1, 0, nullptr, &ignored)) {
     return false;
   }
+  phases->End("fpga_mmio_warmup", warmup);
 
   if (!bridge.ResetQueues() || !bridge.ResetPerfCounters()) {
     std::cerr << "Failed to reset FPGA before measured run\n";
     return false;
   }
 
-  return run_fpga_messages(&bridge, events, warmup, messages, result);
+  phases->Begin();
+  const bool ok =
+      run_fpga_messages(&bridge, events, warmup, messages, 0, 1, perf_sample_ns, nullptr, result);
+  phases->End("fpga_mmio", messages);
+  return ok;
+}
+
+// Open-loop run: event i is due at start + i / rate and goes out at the
+// first pass at or after that time, however far behind the FPGA is. Only the
+// in-flight limit can hold a due event back. Every request records both its
+// scheduled and actual send time, so `corrected` includes the time a request
+// spent waiting for its turn.
+bool run_fpga_open_point(FpgaSharedStream* bridge,
+                         const std::vector<FpgaSharedStream::Frame>& events, uint64_t start_index,
+                         uint64_t messages, uint64_t rate_msg_s, OpenLoopPoint* point) {
+  const uint64_t max_outstanding = ring_outstanding_limit(bridge->ObservedHeader());
+  const double period_ns = 1000000000.0 / static_cast<double>(rate_msg_s);
+
+  OutstandingTracker tracker;
+  tracker.Reset(max_outstanding);
+  uint64_t sent = 0;
+  uint64_t max_lag = 0;
+  const uint64_t start = now_ns();
+  uint64_t last_progress_ns = start;
+  uint64_t next_due = start;
+
+  while (tracker.Matched() < messages) {
+    FpgaSharedStream::Frame response{};
+    bool received_any = false;
+    uint64_t pass_ns = 0;
+    while (bridge->Receive(&response)) {
+      if (!received_any) {
+        pass_ns = now_ns();
+        received_any = true;
+      }
+      tracker.OnResponse(response.word0, pass_ns);
+    }
+    if (!received_any) {
+      pass_ns = now_ns();
+    }
+    if (received_any || tracker.Pending() == 0) {
+      last_progress_ns = pass_ns;
+    }
+
+    while (sent < messages && next_due <= pass_ns && tracker.Pending() < max_outstanding) {
+      const FpgaSharedStream::Frame& event = events[static_cast<std::size_t>(start_index + sent)];
+      if (!bridge->Send(event)) {
+        break;
+      }
+      tracker.OnSend(event.word0, pass_ns, next_due);
+      max_lag = std::max(max_lag, pass_ns - next_due);
+      ++sent;
+      next_due = start + static_cast<uint64_t>(static_cast<double>(sent) * period_ns);
+    }
+
+    if (pass_ns - last_progress_ns > kResponseTimeoutNs) {
+      std::cerr << "Timed out waiting for " << tracker.Pending()
+                << " outstanding FPGA responses at " << rate_msg_s << " msg/s\n";
+      break;
+    }
+  }
+
+  const uint64_t duration = now_ns() - start;
+  tracker.Finish();
+  point->target_msg_s = rate_msg_s;
+  point->achieved_msg_s =
+      duration == 0 ? 0.0 : static_cast<double>(tracker.Matched()) * 1000000000.0 / duration;
+  point->sent = sent;
+  point->matched = tracker.Matched();
+  point->lost = tracker.GetStats().lost;
+  point->max_send_lag_ns = max_lag;
+  point->service = tracker.Summarize();
+  point->corrected = tracker.SummarizeIntended();
+  return tracker.Matched() == messages;
+}
+
+// fpga-open: the measured events once per rate, lowest rate first, with the
+// queues reset in between. Warmup runs once at the lowest rate.
+OpenLoopResult run_fpga_open(const std::vector<FpgaSharedStream::Frame>& events, uint64_t warmup,
+                             uint64_t messages, const std::vector<uint64_t>& rates) {
+  OpenLoopResult result{};
+  FpgaSharedStream bridge;
+  if (!open_bridge(&bridge)) {
+    return result;
+  }
+  if (!bridge.ResetQueues() || !bridge.ResetPerfCounters()) {
+    std::cerr << "Failed to reset FPGA queues/performance counters\n";
+    return result;
+  }
+  OpenLoopPoint ignored{};
+  if (warmup > 0 && !run_fpga_open_point(&bridge, events, 0, warmup, rates.front(), &ignored)) {
+    return result;
+  }
+  for (std::size_t i = 0; i < rates.size(); ++i) {
+    if (!bridge.ResetQueues() || !bridge.ResetPerfCounters()) {
+      std::cerr << "Failed to reset FPGA before open-loop point\n";
+      return result;
+    }
+    OpenLoopPoint point{};
+    const bool complete = run_fpga_open_point(&bridge, events, warmup, messages, rates[i], &point);
+    result.points.push_back(point);
+    if (!complete) {
+      return result;
+    }
+  }
+  result.ran = true;
+  return result;
+}
+
+// Highest rate that keeps up with its schedule while its corrected p99 stays
+// within kKneeLatencyFactor of the lowest rate's; 0 if none does.
+uint64_t open_loop_knee(const std::vector<OpenLoopPoint>& points) {
+  uint64_t knee = 0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const OpenLoopPoint& p = points[i];
+    const bool keeps_up =
+        p.achieved_msg_s >= kKneeMinAchieved * static_cast<double>(p.target_msg_s);
+    const bool flat = p.corrected.p99_ns <= kKneeLatencyFactor * points[0].corrected.p99_ns;
+    if (!keeps_up || !flat) {
+      break;
+    }
+    knee = p.target_msg_s;
+  }
+  return knee;
+}
+
+// Pipelined runs over the outstanding x batch x messages grid on one bridge,
+// after one default-pipeline warmup. Batches above the outstanding limit
+// would be clamped to it and are skipped.
+SweepResult run_fpga_sweep(const std::vector<FpgaSharedStream::Frame>& events, uint64_t warmup,
+                           const Options& options) {
+  SweepResult result{};
+  FpgaSharedStream bridge;
+  if (!open_bridge(&bridge)) {
+    return result;
+  }
+  if (!bridge.ResetQueues() || !bridge.ResetPerfCounters()) {
+    std::cerr << "Failed to reset FPGA queues/performance counters\n";
+    return result;
+  }
+  BenchmarkResult ignored{};
+  if (warmup > 0 &&
+      !run_fpga_messages(&bridge, events, 0, warmup, 0, 1, 0, nullptr, &ignored)) {
+    return result;
+  }
+
+  const uint64_t ring_limit = ring_outstanding_limit(bridge.ObservedHeader());
+  std::vector<uint64_t> outstanding;
+  for (std::size_t i = 0; i < options.sweep_outstanding.size(); ++i) {
+    if (options.sweep_outstanding[i] > ring_limit) {
+      std::cerr << "Note: outstanding " << options.sweep_outstanding[i]
+                << " is above the ring limit " << ring_limit << "; skipped\n";
+    } else {
+      outstanding.push_back(options.sweep_outstanding[i]);
+    }
+  }
+  if (options.sweep_outstanding.empty()) {
+    for (uint64_t depth = 1; depth < ring_limit; depth *= 2) {
+      outstanding.push_back(depth);
+    }
+    outstanding.push_back(ring_limit);
+  }
+
+  for (std::size_t m = 0; m < options.sweep_messages.size(); ++m) {
+    for (std::size_t b = 0; b < options.sweep_batches.size(); ++b) {
+      for (std::size_t o = 0; o < outstanding.size(); ++o) {
+        if (options.sweep_batches[b] > outstanding[o]) {
+          continue;
+        }
+        if (!bridge.ResetQueues() || !bridge.ResetPerfCounters()) {
+          std::cerr << "Failed to reset FPGA before sweep point\n";
+          return result;
+        }
+        BenchmarkResult run{};
+        const uint64_t messages = options.sweep_messages[m];
+        if (!run_fpga_messages(&bridge, events, warmup, messages, outstanding[o],
+                               options.sweep_batches[b], 0, nullptr, &run)) {
+          return result;
+        }
+        SweepPoint point{};
+        point.max_outstanding = outstanding[o];
+        point.batch = options.sweep_batches[b];
+        point.messages = messages;
+        point.throughput_msg_s = run.throughput_msg_s;
+        point.rtt = run.rtt;
+        point.lost = run.tracking.lost;
+        point.tx_full_spins = run.tx_full_spins;
+        point.rx_empty_spins = run.rx_empty_spins;
+        point.cmd_stall_cycles = run.perf.cmd_stall_cycles;
+        point.rsp_stall_cycles = run.perf.rsp_stall_cycles;
+        point.fpga_latency_avg_ns = fpga_latency_avg_ns(run.perf);
+        result.points.push_back(point);
+      }
+    }
+  }
+  result.ran = true;
+  return result;
+}
+
+// Lowest-p99 lossless point whose throughput is within kSweepKneeThroughput
+// of the best one, fewer outstanding on ties; points.size() if none.
+std::size_t sweep_knee(const std::vector<SweepPoint>& points) {
+  double best = 0.0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    if (points[i].lost == 0) {
+      best = std::max(best, points[i].throughput_msg_s);
+    }
+  }
+  std::size_t knee = points.size();
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const SweepPoint& p = points[i];
+    if (p.lost != 0 || p.throughput_msg_s < kSweepKneeThroughput * best) {
+      continue;
+    }
+    if (knee == points.size() || p.rtt.p99_ns < points[knee].rtt.p99_ns ||
+        (p.rtt.p99_ns == points[knee].rtt.p99_ns &&
+         p.max_outstanding < points[knee].max_outstanding)) {
+      knee = i;
+    }
+  }
+  return knee;
+}
+
+// Resync check: with every response in, the FPGA book must equal the model
+// on each sampled symbol. Reads it back directly instead of trusting the
+// per-event top of book.
+void check_fpga_book(FpgaSharedStream* bridge, const ResponseVerifier& verifier,
+                     VerifyResult* result) {
+  const SwOrderBook& model = verifier.Model();
+  const uint32_t symbols = std::min(bridge->BookSymbols(), model.NumSymbols());
+  if (bridge->BookDepth() == 0 || symbols == 0) {
+    return;
+  }
+  FpgaSharedStream::BookSnapshot book;
+  uint64_t read_ns = 0;
+  for (uint32_t symbol = 0; symbol < symbols; ++symbol) {
+    if (!verifier.Sampled(symbol)) {
+      continue;
+    }
+    const uint64_t start = now_ns();
+    if (!bridge->ReadBook(symbol, &book)) {
+      std::cerr << "Book readback failed: " << bridge->LastError() << "\n";
+      return;
+    }
+    read_ns += now_ns() - start;
+    ++result->book_symbols;
+    if (ResponseVerifier::BookDiffs(model, book) != 0 && result->book_mismatches++ == 0) {
+      ResponseVerifier::PrintBook(std::cerr, book);
+    }
+  }
+  if (result->book_symbols != 0) {
+    result->book_read_ns = static_cast<double>(read_ns) / result->book_symbols;
+  }
+}
+
+// Pipelined run with every response checked against SwOrderBook. Both books
+// start from RESET_BOOK on every FPGA symbol; warmup events are verified too.
+bool run_fpga_verify(const std::vector<FpgaSharedStream::Frame>& events, uint64_t warmup,
+                     uint64_t messages, uint32_t sample_every, BenchmarkResult* fpga,
+                     VerifyResult* result) {
+  FpgaSharedStream bridge;
+  if (!open_bridge(&bridge)) {
+    return false;
+  }
+  if (!bridge.ResetQueues() || !bridge.ResetPerfCounters()) {
+    std::cerr << "Failed to reset FPGA queues/performance counters\n";
+    return false;
+  }
+
+  ResponseVerifier::Config config = ResponseVerifier::DefaultConfig();
+  config.sample_every = sample_every;
+  config.max_outstanding = std::max<uint32_t>(1, bridge.ObservedHeader().tx_depth);
+  ResponseVerifier verifier(config);
+
+  std::vector<FpgaSharedStream::Frame> resets;
+  for (uint32_t symbol = 0; symbol < config.book.num_symbols; ++symbol) {
+    resets.push_back(ResponseVerifier::ResetFrame(symbol));
+  }
+  BenchmarkResult ignored{};
+  if (!run_fpga_messages(&bridge, resets, 0, resets.size(), 0, 1, 0, &verifier, &ignored) ||
+      !run_fpga_messages(&bridge, events, 0, warmup + messages, 0, 1, 0, &verifier, fpga)) {
+    return false;
+  }
+
+  result->ran = true;
+  result->stats = verifier.GetStats();
+  if (verifier.HasDivergence()) {
+    ResponseVerifier::Print(std::cerr, verifier.FirstDivergence());
+  }
+  check_fpga_book(&bridge, verifier, result);
+  return true;
 }
 
 SyncResult run_fpga_sync(const std::vector<FpgaSharedStream::Frame>& events,
-                         uint64_t warmup, uint64_t messages) {
+                         uint64_t warmup, uint64_t messages, PhaseCounters* phases) {
   FpgaSharedStream bridge;
   if (!open_bridge(&bridge)) {
     return SyncResult{};
@@ -551,6 +1482,7 @@ SyncResult run_fpga_sync(const std::vector<FpgaSharedStream::Frame>& events,
     return SyncResult{};
   }
 
+  phases->Begin();
   for (uint64_t i = 0; i < warmup; ++i) {
     while (!bridge.Send(events[static_cast<std::size_t>(i)])) {
       __sync_synchronize();
@@ -560,15 +1492,15 @@ SyncResult run_fpga_sync(const std::vector<FpgaSharedStream::Frame>& events,
       __sync_synchronize();
     }
   }
+  phases->End("fpga_sync_warmup", warmup);
 
   if (!bridge.ResetQueues() || !bridge.ResetPerfCounters()) {
     std::cerr << "Failed to reset FPGA before sync measurement\n";
     return SyncResult{};
   }
 
-  std::vector<double> rtts;
-  rtts.reserve(static_cast<std::size_t>(messages));
-
+  LatencyHistogram rtts;
+  phases->Begin();
   for (uint64_t i = 0; i < messages; ++i) {
     const uint64_t t0 = now_ns();
     while (!bridge.Send(events[static_cast<std::size_t>(warmup + i)])) {
@@ -579,36 +1511,311 @@ SyncResult run_fpga_sync(const std::vector<FpgaSharedStream::Frame>& events,
       __sync_synchronize();
     }
     const uint64_t t1 = now_ns();
-    rtts.push_back(static_cast<double>(t1 - t0));
-  }
-
-  std::sort(rtts.begin(), rtts.end());
-  double sum = 0.0;
-  for (double v : rtts) {
-    sum += v;
+    rtts.Record(t1 - t0);
   }
+  phases->End("fpga_sync", messages);
 
   SyncResult result{};
   result.ran = true;
   result.messages = messages;
-  result.rtt_min_ns = rtts.front();
-  result.rtt_max_ns = rtts.back();
-  result.rtt_avg_ns = sum / static_cast<double>(messages);
-  result.rtt_p50_ns = rtts[static_cast<std::size_t>(messages * 50u / 100u)];
-  result.rtt_p99_ns = rtts[static_cast<std::size_t>(messages * 99u / 100u)];
+  result.rtt_min_ns = static_cast<double>(rtts.Min());
+  result.rtt_max_ns = static_cast<double>(rtts.Max());
+  result.rtt_avg_ns = rtts.Mean();
+  result.rtt_p50_ns = static_cast<double>(rtts.ValueAt(0.50));
+  result.rtt_p99_ns = static_cast<double>(rtts.ValueAt(0.99));
   result.rtt_jitter_ns = result.rtt_max_ns - result.rtt_min_ns;
   return result;
 }
 
-double cycles_to_ns(double cycles, uint32_t clock_hz) {
-  if (clock_hz == 0) {
-    return 0.0;
+void print_perf_windows(const std::vector<PerfSampler::Window>& windows, uint32_t clock_hz) {
+  std::cout << "  \"perf_windows\": [";
+  for (std::size_t i = 0; i < windows.size(); ++i) {
+    const PerfSampler::Window& w = windows[i];
+    std::cout << (i == 0 ? "\n" : ",\n");
+    std::cout << "    {\"duration_ns\": " << w.duration_ns
+              << ", \"responses\": " << w.responses
+              << ", \"responses_per_s\": " << w.responses_per_s
+              << ", \"avg_ns\": " << cycles_to_ns(w.avg_latency_cycles, clock_hz)
+              << ", \"p50_ns\": " << cycles_to_ns(w.p50_latency_cycles, clock_hz)
+              << ", \"p99_ns\": " << cycles_to_ns(w.p99_latency_cycles, clock_hz)
+              << ", \"p999_ns\": " << cycles_to_ns(w.p999_latency_cycles, clock_hz)
+              << ", \"cmd_stall_ratio\": " << w.cmd_stall_ratio
+              << ", \"rsp_stall_ratio\": " << w.rsp_stall_ratio
+              << ", \"saturated\": " << (w.saturated ? "true" : "false") << "}";
   }
-  return cycles * 1000000000.0 / static_cast<double>(clock_hz);
+  std::cout << (windows.empty() ? "],\n" : "\n  ],\n");
+}
+
+void print_sharded(const ShardedResult& sharded, const SoftwareResult& sw) {
+  std::cout << "  \"sw_sharded\": [";
+  for (std::size_t i = 0; i < sharded.points.size(); ++i) {
+    const ShardedPoint& p = sharded.points[i];
+    const double inline_msg_s = sw.avg_ns > 0.0 ? 1000000000.0 / sw.avg_ns : 0.0;
+    std::cout << (i == 0 ? "\n" : ",\n");
+    std::cout << "    {\"threads\": " << p.threads
+              << ", \"msg_s\": " << p.throughput_msg_s
+              << ", \"efficiency\": " << p.efficiency
+              << ", \"speedup_vs_inline\": "
+              << (inline_msg_s > 0.0 ? p.throughput_msg_s / inline_msg_s : 0.0)
+              << ", \"load_imbalance\": " << p.load_imbalance
+              << ", \"shard_events\": [";
+    for (std::size_t s = 0; s < p.shard_events.size(); ++s) {
+      std::cout << (s == 0 ? "" : ", ") << p.shard_events[s];
+    }
+    std::cout << "], \"out_of_order\": " << p.out_of_order
+              << ", \"checksum_match\": " << (p.checksum == sw.checksum ? "true" : "false")
+              << "}";
+  }
+  std::cout << (sharded.points.empty() ? "],\n" : "\n  ],\n");
+}
+
+void print_open_loop(const OpenLoopResult& open) {
+  std::cout << "  \"open_loop\": [";
+  for (std::size_t i = 0; i < open.points.size(); ++i) {
+    const OpenLoopPoint& p = open.points[i];
+    std::cout << (i == 0 ? "\n" : ",\n");
+    std::cout << "    {\"target_msg_s\": " << p.target_msg_s
+              << ", \"achieved_msg_s\": " << p.achieved_msg_s
+              << ", \"sent\": " << p.sent
+              << ", \"matched\": " << p.matched
+              << ", \"lost\": " << p.lost
+              << ", \"max_send_lag_ns\": " << p.max_send_lag_ns
+              << ", \"p50_ns\": " << p.service.p50_ns
+              << ", \"p99_ns\": " << p.service.p99_ns
+              << ", \"p999_ns\": " << p.service.p999_ns
+              << ", \"max_ns\": " << p.service.max_ns
+              << ", \"corrected_p50_ns\": " << p.corrected.p50_ns
+              << ", \"corrected_p99_ns\": " << p.corrected.p99_ns
+              << ", \"corrected_p999_ns\": " << p.corrected.p999_ns
+              << ", \"corrected_max_ns\": " << p.corrected.max_ns << "}";
+  }
+  std::cout << (open.points.empty() ? "],\n" : "\n  ],\n");
+  std::cout << "  \"open_loop_knee_msg_s\": " << open_loop_knee(open.points) << ",\n";
+}
+
+void print_sweep(const SweepResult& sweep) {
+  std::cout << "  \"fpga_sweep\": [";
+  for (std::size_t i = 0; i < sweep.points.size(); ++i) {
+    const SweepPoint& p = sweep.points[i];
+    std::cout << (i == 0 ? "\n" : ",\n");
+    std::cout << "    {\"max_outstanding\": " << p.max_outstanding
+              << ", \"batch\": " << p.batch
+              << ", \"messages\": " << p.messages
+              << ", \"throughput_msg_s\": " << p.throughput_msg_s
+              << ", \"rtt_avg_ns\": " << p.rtt.avg_ns
+              << ", \"rtt_p50_ns\": " << p.rtt.p50_ns
+              << ", \"rtt_p99_ns\": " << p.rtt.p99_ns
+              << ", \"lost\": " << p.lost
+              << ", \"tx_full_spins\": " << p.tx_full_spins
+              << ", \"rx_empty_spins\": " << p.rx_empty_spins
+              << ", \"cmd_stall_cycles\": " << p.cmd_stall_cycles
+              << ", \"rsp_stall_cycles\": " << p.rsp_stall_cycles
+              << ", \"fpga_latency_avg_ns\": " << p.fpga_latency_avg_ns << "}";
+  }
+  std::cout << (sweep.points.empty() ? "],\n" : "\n  ],\n");
+  const std::size_t knee = sweep_knee(sweep.points);
+  const bool found = knee < sweep.points.size();
+  std::cout << "  \"fpga_sweep_knee_outstanding\": "
+            << (found ? sweep.points[knee].max_outstanding : 0) << ",\n";
+  std::cout << "  \"fpga_sweep_knee_batch\": " << (found ? sweep.points[knee].batch : 0)
+            << ",\n";
+}
+
+bool write_sweep_csv(const std::string& path, const SweepResult& sweep) {
+  std::ofstream out(path.c_str());
+  if (!out) {
+    return false;
+  }
+  const std::size_t knee = sweep_knee(sweep.points);
+  out << std::fixed << std::setprecision(3);
+  out << "max_outstanding,batch,messages,throughput_msg_s,rtt_avg_ns,rtt_p50_ns,rtt_p99_ns,"
+         "lost,tx_full_spins,rx_empty_spins,cmd_stall_cycles,rsp_stall_cycles,"
+         "fpga_latency_avg_ns,knee\n";
+  for (std::size_t i = 0; i < sweep.points.size(); ++i) {
+    const SweepPoint& p = sweep.points[i];
+    out << p.max_outstanding << "," << p.batch << "," << p.messages << ","
+        << p.throughput_msg_s << "," << p.rtt.avg_ns << "," << p.rtt.p50_ns << ","
+        << p.rtt.p99_ns << "," << p.lost << "," << p.tx_full_spins << "," << p.rx_empty_spins
+        << "," << p.cmd_stall_cycles << "," << p.rsp_stall_cycles << ","
+        << p.fpga_latency_avg_ns << "," << (i == knee ? 1 : 0) << "\n";
+  }
+  return static_cast<bool>(out);
+}
+
+void print_strategies(const std::vector<SoftwareResult>& strategies) {
+  std::cout << "  \"sw_strategies\": [";
+  for (std::size_t i = 0; i < strategies.size(); ++i) {
+    const SoftwareResult& r = strategies[i];
+    std::cout << (i == 0 ? "\n" : ",\n");
+    std::cout << "    {\"name\": \"" << r.strategy << "\""
+              << ", \"avg_ns\": " << r.avg_ns
+              << ", \"buys\": " << r.buys
+              << ", \"sells\": " << r.sells
+              << ", \"checksum\": " << r.checksum << "}";
+  }
+  std::cout << (strategies.empty() ? "],\n" : "\n  ],\n");
+}
+
+// Raw counts and per-message rates; counters the host lacks are left out.
+void print_hw_phases(const std::vector<HwPhase>& phases) {
+  std::cout << "  \"hw_counters\": [";
+  for (std::size_t i = 0; i < phases.size(); ++i) {
+    const HwPhase& phase = phases[i];
+    const double messages = static_cast<double>(std::max<uint64_t>(phase.messages, 1));
+    std::cout << (i == 0 ? "\n" : ",\n");
+    std::cout << "    {\"phase\": \"" << phase.name << "\", \"messages\": " << phase.messages;
+    for (int c = 0; c < HwPerfEvents::kNumCounters; ++c) {
+      if (!phase.counts.valid[c]) {
+        continue;
+      }
+      const char* name = HwPerfEvents::Name(static_cast<HwPerfEvents::Counter>(c));
+      std::cout << ", \"" << name << "\": " << phase.counts.value[c] << ", \"" << name
+                << "_per_msg\": " << static_cast<double>(phase.counts.value[c]) / messages;
+    }
+    const uint64_t cycles = phase.counts.value[HwPerfEvents::kCycles];
+    if (phase.counts.valid[HwPerfEvents::kCycles] &&
+        phase.counts.valid[HwPerfEvents::kInstructions] && cycles != 0) {
+      std::cout << ", \"ipc\": "
+                << static_cast<double>(phase.counts.value[HwPerfEvents::kInstructions]) /
+                       static_cast<double>(cycles);
+    }
+    std::cout << "}";
+  }
+  std::cout << (phases.empty() ? "],\n" : "\n  ],\n");
+}
+
+// Headline numbers of one run, added to `stats` as one sample each. Names
+// follow the JSON fields; per-strategy, per-thread-count and per-rate points
+// get the variant in the name.
+void collect_metrics(const RunResults& r, BenchStats* stats) {
+  const BenchStats::Better lower = BenchStats::kLowerIsBetter;
+  const BenchStats::Better higher = BenchStats::kHigherIsBetter;
+  if (r.sw.ran) {
+    stats->Add("sw_core_avg_ns", lower, r.sw.avg_ns);
+  }
+  for (std::size_t i = 1; i < r.strategies.size(); ++i) {
+    stats->Add(std::string("sw_strategy_") + r.strategies[i].strategy + "_avg_ns", lower,
+               r.strategies[i].avg_ns);
+  }
+  if (r.batch.ran) {
+    stats->Add("sw_batch_avg_ns", lower, r.batch.avg_ns);
+  }
+  if (r.l3.ran) {
+    stats->Add("sw_l3_avg_ns", lower, r.l3.avg_ns);
+  }
+  for (std::size_t i = 0; i < r.sharded.points.size(); ++i) {
+    std::ostringstream name;
+    name << "sw_sharded_t" << r.sharded.points[i].threads << "_msg_s";
+    stats->Add(name.str(), higher, r.sharded.points[i].throughput_msg_s);
+  }
+  if (r.fpga.ran) {
+    stats->Add("throughput_msg_s", higher, r.fpga.throughput_msg_s);
+    stats->Add("fpga_latency_avg_ns", lower, fpga_latency_avg_ns(r.fpga.perf));
+    stats->Add("pipelined_rtt_p50_ns", lower, r.fpga.rtt.p50_ns);
+    stats->Add("pipelined_rtt_p99_ns", lower, r.fpga.rtt.p99_ns);
+  }
+  for (std::size_t i = 0; i < r.open.points.size(); ++i) {
+    const OpenLoopPoint& p = r.open.points[i];
+    std::ostringstream name;
+    name << "open_" << p.target_msg_s << "_corrected_p99_ns";
+    stats->Add(name.str(), lower, p.corrected.p99_ns);
+  }
+  if (r.sync.ran) {
+    stats->Add("sync_rtt_p50_ns", lower, r.sync.rtt_p50_ns);
+    stats->Add("sync_rtt_p99_ns", lower, r.sync.rtt_p99_ns);
+  }
+}
+
+void print_stats(const BenchStats& stats, uint64_t repeat) {
+  std::cout << "  \"repeat\": " << repeat << ",\n";
+  std::cout << "  \"stats\": [";
+  const std::vector<BenchStats::Metric>& metrics = stats.Metrics();
+  for (std::size_t i = 0; i < metrics.size(); ++i) {
+    const BenchStats::Summary s = BenchStats::Summarize(metrics[i].samples);
+    std::cout << (i == 0 ? "\n" : ",\n");
+    std::cout << "    {\"metric\": \"" << metrics[i].name
+              << "\", \"better\": \"" << BenchStats::BetterName(metrics[i].better)
+              << "\", \"n\": " << s.n
+              << ", \"mean\": " << s.mean
+              << ", \"stddev\": " << s.stddev
+              << ", \"median\": " << s.median
+              << ", \"min\": " << s.min
+              << ", \"max\": " << s.max
+              << ", \"ci95_low\": " << s.ci95_low
+              << ", \"ci95_high\": " << s.ci95_high << "}";
+  }
+  std::cout << (metrics.empty() ? "],\n" : "\n  ],\n");
+}
+
+// Compares every metric present in both sets; returns the regression count.
+uint64_t print_compare(const BenchStats& baseline, const BenchStats& current) {
+  uint64_t regressions = 0;
+  bool first = true;
+  std::cout << "  \"compare\": [";
+  const std::vector<BenchStats::Metric>& metrics = current.Metrics();
+  for (std::size_t i = 0; i < metrics.size(); ++i) {
+    const BenchStats::Metric* base = baseline.Find(metrics[i].name);
+    if (base == nullptr) {
+      continue;
+    }
+    const BenchStats::Comparison c = BenchStats::Compare(*base, metrics[i]);
+    regressions += c.regression ? 1 : 0;
+    std::cout << (first ? "\n" : ",\n");
+    first = false;
+    std::cout << "    {\"metric\": \"" << metrics[i].name
+              << "\", \"baseline_mean\": " << c.baseline_mean
+              << ", \"mean\": " << c.mean
+              << ", \"change_pct\": " << c.change_pct
+              << ", \"t\": " << c.t
+              << ", \"dof\": " << c.dof
+              << ", \"significant\": " << (c.significant ? "true" : "false")
+              << ", \"regression\": " << (c.regression ? "true" : "false") << "}";
+  }
+  std::cout << (first ? "],\n" : "\n  ],\n");
+  std::cout << "  \"compare_regressions\": " << regressions << ",\n";
+  std::cout << "  \"pass_compare\": " << (regressions == 0 ? "true" : "false") << ",\n";
+  return regressions;
+}
+
+bool load_baseline(const std::string& path, BenchStats* stats) {
+  uint64_t bad_line = 0;
+  if (stats->Load(path, &bad_line)) {
+    return true;
+  }
+  if (bad_line == 0) {
+    std::cerr << "Failed to read baseline " << path << "\n";
+  } else {
+    std::cerr << "Malformed baseline " << path << " at line " << bad_line << "\n";
+  }
+  return false;
+}
+
+// --compare OLD --candidate NEW: both sides from files, nothing is run.
+int compare_files(const Options& options) {
+  BenchStats baseline;
+  BenchStats candidate;
+  if (!load_baseline(options.compare, &baseline) ||
+      !load_baseline(options.candidate, &candidate)) {
+    return 2;
+  }
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "{\n";
+  std::cout << "  \"mode\": \"compare\",\n";
+  const uint64_t regressions = print_compare(baseline, candidate);
+  std::cout << "  \"baseline\": \"" << options.compare << "\",\n";
+  std::cout << "  \"candidate\": \"" << options.candidate << "\"\n";
+  std::cout << "}\n";
+  return regressions == 0 ? 0 : 1;
 }
 
 void print_json(const Options& options, const BenchmarkResult& fpga,
-                const SoftwareResult& sw, const SyncResult& sync) {
+                const SoftwareResult& sw, const std::vector<SoftwareResult>& strategies,
+                const BatchResult& batch, const L3Result& l3, const ShardedResult& sharded,
+                const VerifyResult& verify, const OpenLoopResult& open,
+                const SweepResult& sweep, const SyncResult& sync,
+                const BenchStats& stats, const BenchStats* baseline,
+                const RtSetup::Report& rt, const HiccupMeter::Stats* hiccup,
+                const std::vector<HwPhase>* hw_phases, uint64_t* regressions) {
   const double avg_cycles =
       fpga.perf.count == 0
           ? 0.0
@@ -616,7 +1823,7 @@ void print_json(const Options& options, const BenchmarkResult& fpga,
                 static_cast<double>(fpga.perf.count);
   const double min_ns = cycles_to_ns(fpga.perf.min_latency_cycles, fpga.perf.clock_hz);
   const double max_ns = cycles_to_ns(fpga.perf.max_latency_cycles, fpga.perf.clock_hz);
-  const double avg_ns = cycles_to_ns(avg_cycles, fpga.perf.clock_hz);
+  const double avg_ns = fpga_latency_avg_ns(fpga.perf);
   const double jitter_ns = max_ns >= min_ns ? max_ns - min_ns : 0.0;
   const double speedup_core = (sw.ran && avg_ns > 0.0) ? sw.avg_ns / avg_ns : 0.0;
 
@@ -625,7 +1832,36 @@ void print_json(const Options& options, const BenchmarkResult& fpga,
   std::cout << "  \"mode\": \"" << options.mode << "\",\n";
   std::cout << "  \"messages\": " << options.messages << ",\n";
   std::cout << "  \"warmup\": " << options.warmup << ",\n";
-  std::cout << "  \"duration_ns\": " << (fpga.ran ? fpga.duration_ns : sw.duration_ns) << ",\n";
+  std::cout << "  \"symbols\": " << options.symbols << ",\n";
+  std::cout << "  \"workload\": \""
+            << (options.mode == "sw-l3" ? "l3" : Workloads::Name(options.workload.kind))
+            << "\",\n";
+  std::cout << "  \"seed\": " << options.workload.seed << ",\n";
+  if (RtSetup::Enabled(options.rt)) {
+    std::cout << "  \"rt_cpu\": " << options.rt.cpu << ",\n";
+    std::cout << "  \"rt_pinned\": " << (rt.pinned ? "true" : "false") << ",\n";
+    std::cout << "  \"rt_fifo_priority\": " << (rt.fifo ? options.rt.fifo_priority : 0) << ",\n";
+    std::cout << "  \"rt_mlock\": " << (rt.locked ? "true" : "false") << ",\n";
+    std::cout << "  \"rt_prefaulted_bytes\": " << rt.prefaulted_bytes << ",\n";
+    std::cout << "  \"rt_huge_page_bytes\": " << rt.huge_page_bytes << ",\n";
+  }
+  if (hiccup != nullptr) {
+    std::cout << "  \"hiccup_interval_ns\": " << options.hiccup_meter.interval_ns << ",\n";
+    std::cout << "  \"hiccup_samples\": " << hiccup->samples << ",\n";
+    std::cout << "  \"hiccup_p50_ns\": " << hiccup->p50_ns << ",\n";
+    std::cout << "  \"hiccup_p99_ns\": " << hiccup->p99_ns << ",\n";
+    std::cout << "  \"hiccup_p999_ns\": " << hiccup->p999_ns << ",\n";
+    std::cout << "  \"hiccup_max_ns\": " << hiccup->max_ns << ",\n";
+    std::cout << "  \"hiccup_total_ns\": " << hiccup->total_ns << ",\n";
+  }
+  if (hw_phases != nullptr) {
+    print_hw_phases(*hw_phases);
+  }
+  std::cout << "  \"duration_ns\": "
+            << (fpga.ran ? fpga.duration_ns
+                         : (l3.ran ? l3.duration_ns
+                                   : (batch.ran ? batch.duration_ns : sw.duration_ns)))
+            << ",\n";
   std::cout << "  \"throughput_msg_s\": " << (fpga.ran ? fpga.throughput_msg_s : 0.0) << ",\n";
   std::cout << "  \"fpga_latency_min_cycles\": " << fpga.perf.min_latency_cycles << ",\n";
   std::cout << "  \"fpga_latency_max_cycles\": " << fpga.perf.max_latency_cycles << ",\n";
@@ -634,13 +1870,70 @@ void print_json(const Options& options, const BenchmarkResult& fpga,
   std::cout << "  \"fpga_latency_max_ns\": " << max_ns << ",\n";
   std::cout << "  \"fpga_latency_avg_ns\": " << avg_ns << ",\n";
   std::cout << "  \"fpga_latency_jitter_ns\": " << jitter_ns << ",\n";
+  std::cout << "  \"sw_level_kernel\": \"" << SwLevelKernel::Name() << "\",\n";
   std::cout << "  \"sw_core_avg_ns\": " << (sw.ran ? sw.avg_ns : 0.0) << ",\n";
   std::cout << "  \"speedup_core\": " << speedup_core << ",\n";
+  print_strategies(strategies);
+  std::cout << "  \"sw_batch_kernel\": \"" << SwBatchBook::KernelName() << "\",\n";
+  std::cout << "  \"sw_batch_size\": " << (batch.ran ? batch.batch : 0) << ",\n";
+  std::cout << "  \"sw_batch_avg_ns\": " << (batch.ran ? batch.avg_ns : 0.0) << ",\n";
+  std::cout << "  \"sw_batch_msg_s\": " << (batch.ran ? batch.throughput_msg_s : 0.0) << ",\n";
+  std::cout << "  \"sw_batch_responses\": " << batch.responses << ",\n";
+  std::cout << "  \"sw_batch_speedup\": "
+            << (batch.ran && sw.ran && batch.avg_ns > 0.0 ? sw.avg_ns / batch.avg_ns : 0.0)
+            << ",\n";
+  std::cout << "  \"sw_batch_checksum\": " << batch.checksum << ",\n";
+  std::cout << "  \"sw_l3_avg_ns\": " << (l3.ran ? l3.avg_ns : 0.0) << ",\n";
+  std::cout << "  \"sw_l3_msg_s\": " << (l3.ran ? l3.throughput_msg_s : 0.0) << ",\n";
+  std::cout << "  \"sw_l3_live_orders\": " << l3.live_orders << ",\n";
+  std::cout << "  \"sw_l3_rejected\": " << l3.stats.rejected << ",\n";
+  std::cout << "  \"sw_l3_checksum\": " << l3.checksum << ",\n";
+  print_sharded(sharded, sw);
   std::cout << "  \"tx_full_spins\": " << fpga.tx_full_spins << ",\n";
   std::cout << "  \"rx_empty_spins\": " << fpga.rx_empty_spins << ",\n";
   std::cout << "  \"cmd_stall_cycles\": " << fpga.perf.cmd_stall_cycles << ",\n";
   std::cout << "  \"rsp_stall_cycles\": " << fpga.perf.rsp_stall_cycles << ",\n";
   std::cout << "  \"fpga_measured_count\": " << fpga.perf.count << ",\n";
+  std::cout << "  \"fpga_latency_p50_ns\": "
+            << cycles_to_ns(fpga.perf_total.p50_latency_cycles, fpga.perf.clock_hz) << ",\n";
+  std::cout << "  \"fpga_latency_p99_ns\": "
+            << cycles_to_ns(fpga.perf_total.p99_latency_cycles, fpga.perf.clock_hz) << ",\n";
+  std::cout << "  \"fpga_latency_p999_ns\": "
+            << cycles_to_ns(fpga.perf_total.p999_latency_cycles, fpga.perf.clock_hz) << ",\n";
+  std::cout << "  \"fpga_latency_hist\": [";
+  for (uint32_t i = 0; i < fpga.perf_total.hist_buckets; ++i) {
+    std::cout << (i == 0 ? "" : ", ") << fpga.perf_total.hist[i];
+  }
+  std::cout << "],\n";
+  print_perf_windows(fpga.perf_windows, fpga.perf.clock_hz);
+  std::cout << "  \"pipelined_rtt_min_ns\": " << fpga.rtt.min_ns << ",\n";
+  std::cout << "  \"pipelined_rtt_avg_ns\": " << fpga.rtt.avg_ns << ",\n";
+  std::cout << "  \"pipelined_rtt_p50_ns\": " << fpga.rtt.p50_ns << ",\n";
+  std::cout << "  \"pipelined_rtt_p99_ns\": " << fpga.rtt.p99_ns << ",\n";
+  std::cout << "  \"pipelined_rtt_p999_ns\": " << fpga.rtt.p999_ns << ",\n";
+  std::cout << "  \"pipelined_rtt_max_ns\": " << fpga.rtt.max_ns << ",\n";
+  std::cout << "  \"pipelined_matched\": " << fpga.tracking.matched << ",\n";
+  std::cout << "  \"pipelined_lost\": " << fpga.tracking.lost << ",\n";
+  std::cout << "  \"pipelined_duplicates\": " << fpga.tracking.duplicates << ",\n";
+  std::cout << "  \"pipelined_unknown\": " << fpga.tracking.unknown << ",\n";
+  std::cout << "  \"pipelined_reordered\": " << fpga.tracking.reordered << ",\n";
+  print_open_loop(open);
+  print_sweep(sweep);
+  std::cout << "  \"verify_sample_every\": " << options.verify_sample << ",\n";
+  std::cout << "  \"verify_compared\": " << verify.stats.compared << ",\n";
+  std::cout << "  \"verify_mismatches\": " << verify.stats.mismatches << ",\n";
+  std::cout << "  \"verify_skipped\": " << verify.stats.skipped << ",\n";
+  std::cout << "  \"verify_unknown\": " << verify.stats.unknown << ",\n";
+  std::cout << "  \"verify_unanswered\": " << verify.stats.unanswered << ",\n";
+  std::cout << "  \"verify_book_symbols\": " << verify.book_symbols << ",\n";
+  std::cout << "  \"verify_book_mismatches\": " << verify.book_mismatches << ",\n";
+  std::cout << "  \"verify_book_read_ns\": " << verify.book_read_ns << ",\n";
+  std::cout << "  \"pass_verify\": "
+            << (verify.ran && verify.stats.mismatches == 0 && verify.book_mismatches == 0 &&
+                        verify.stats.compared > 0
+                    ? "true"
+                    : "false")
+            << ",\n";
   std::cout << "  \"fpga_checksum\": " << fpga.checksum << ",\n";
   std::cout << "  \"sw_checksum\": " << sw.checksum << ",\n";
   std::cout << "  \"pass_latency_jitter\": "
@@ -649,6 +1942,12 @@ void print_json(const Options& options, const BenchmarkResult& fpga,
             << (fpga.ran && fpga.throughput_msg_s >= kThroughputLimitMsgS ? "true" : "false") << ",\n";
   std::cout << "  \"pass_speedup\": "
             << (sw.ran && fpga.ran && speedup_core >= kSpeedupLimit ? "true" : "false") << ",\n";
+  if (options.repeat > 1 || !options.save_baseline.empty() || baseline != nullptr) {
+    print_stats(stats, options.repeat);
+  }
+  if (baseline != nullptr) {
+    *regressions = print_compare(*baseline, stats);
+  }
   std::cout << "  \"sync_rtt_min_ns\": " << (sync.ran ? sync.rtt_min_ns : 0.0) << ",\n";
   std::cout << "  \"sync_rtt_avg_ns\": " << (sync.ran ? sync.rtt_avg_ns : 0.0) << ",\n";
   std::cout << "  \"sync_rtt_p50_ns\": " << (sync.ran ? sync.rtt_p50_ns : 0.0) << ",\n";
@@ -658,6 +1957,75 @@ void print_json(const Options& options, const BenchmarkResult& fpga,
   std::cout << "}\n";
 }
 
+// One run of options.mode into `r`; false if an FPGA run failed.
+bool run_mode(const Options& options, const std::vector<FpgaSharedStream::Frame>& events,
+              const std::vector<FpgaSharedStream::Frame>& l3_events, HwPerfEvents* counters,
+              RunResults* r) {
+  PhaseCounters phases(counters, &r->hw_phases);
+  if (options.mode == "sw-l3") {
+    r->l3 = run_sw_l3(l3_events, options.warmup, options.messages, options.symbols);
+  }
+
+  if (options.mode == "sw-core") {
+    r->strategies = run_sw_strategies(events, options.warmup, options.messages,
+                                      options.symbols, options.strategy, &phases);
+    r->sw = r->strategies.front();
+  } else if (options.mode == "sw-batch" || options.mode == "sw-sharded" ||
+             options.mode == "full") {
+    r->sw = run_sw_core(events, options.warmup, options.messages, options.symbols, &phases);
+  }
+
+  if (options.mode == "sw-batch") {
+    r->batch = run_sw_batch(events, options.warmup, options.messages, options.symbols,
+                            options.batch);
+  }
+
+  if (options.mode == "sw-sharded") {
+    r->sharded = run_sw_sharded(events, options.warmup, options.messages, options.symbols,
+                                options.threads);
+    if (!r->sharded.ran) {
+      return false;
+    }
+  }
+
+  if (options.mode == "fpga-mmio" || options.mode == "full") {
+    if (!run_fpga_benchmark(events, options.warmup, options.messages,
+                            options.perf_sample_ms * 1000000ull, &phases, &r->fpga)) {
+      return false;
+    }
+  }
+
+  if (options.mode == "verify") {
+    if (!run_fpga_verify(events, options.warmup, options.messages, options.verify_sample,
+                         &r->fpga, &r->verify)) {
+      return false;
+    }
+  }
+
+  if (options.mode == "fpga-open") {
+    r->open = run_fpga_open(events, options.warmup, options.messages, options.rates);
+    if (!r->open.ran) {
+      return false;
+    }
+  }
+
+  if (options.mode == "fpga-sweep") {
+    r->sweep = run_fpga_sweep(events, options.warmup, options);
+    if (!r->sweep.ran) {
+      return false;
+    }
+  }
+
+  if (options.mode == "fpga-sync" || options.mode == "full") {
+    r->sync = run_fpga_sync(events, options.warmup, options.messages, &phases);
+    if (!r->sync.ran) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
@@ -673,30 +2041,96 @@ int main(int argc, char** argv) {
     return 0;
   }
 
-  const uint64_t total = options.warmup + options.messages;
-  const std::vector<FpgaSharedStream::Frame> events = make_events(total);
-
-  BenchmarkResult fpga{};
-  SoftwareResult sw{};
-  SyncResult sync{};
-
-  if (options.mode == "sw-core" || options.mode == "full") {
-    sw = run_sw_core(events, options.warmup, options.messages);
+  if (!options.candidate.empty()) {
+    return compare_files(options);
+  }
+  BenchStats baseline;
+  if (!options.compare.empty() && !load_baseline(options.compare, &baseline)) {
+    return 2;
   }
 
-  if (options.mode == "fpga-mmio" || options.mode == "full") {
-    if (!run_fpga_benchmark(events, options.warmup, options.messages, &fpga)) {
+  const uint64_t total = options.warmup + options.messages;
+  std::vector<FpgaSharedStream::Frame> events;
+  std::string workload_error;
+  if (options.mode != "sw-l3" &&
+      !Workloads::Generate(options.workload, total, &events, &workload_error)) {
+    std::cerr << "Failed to load workload file " << options.workload.path << ": "
+              << workload_error << "\n";
+    return 2;
+  }
+  if (!options.save_workload.empty() && !Workloads::SaveFile(options.save_workload, events)) {
+    std::cerr << "Failed to write workload file " << options.save_workload << "\n";
+    return 1;
+  }
+  std::vector<FpgaSharedStream::Frame> l3_events =
+      options.mode == "sw-l3" ? make_l3_events(total, options.symbols)
+                              : std::vector<FpgaSharedStream::Frame>();
+
+  // The meter starts first so it does not inherit this thread's CPU.
+  HiccupMeter meter;
+  if (options.hiccup) {
+    std::string error;
+    if (!meter.Start(options.hiccup_meter, &error)) {
+      std::cerr << "Failed to start hiccup meter: " << error << "\n";
       return 1;
     }
+    if (!error.empty()) {
+      std::cerr << "Hiccup meter: " << error << "\n";
+    }
+  }
+  RtSetup::Report rt = RtSetup::Apply(options.rt);
+  RtSetup::PrepareBuffer(options.rt, events.data(), events.size() * sizeof(events[0]), &rt);
+  RtSetup::PrepareBuffer(options.rt, l3_events.data(), l3_events.size() * sizeof(l3_events[0]),
+                         &rt);
+  if (!rt.errors.empty()) {
+    std::cerr << "Real-time setup incomplete: " << rt.errors << "\n";
+  }
+  HwPerfEvents counters;
+  bool counting = false;
+  if (options.hw_counters) {
+    std::string error;
+    counting = counters.Open(&error);
+    if (!error.empty()) {
+      std::cerr << "Hardware counters unavailable: " << error << "\n";
+    }
   }
 
-  if (options.mode == "fpga-sync" || options.mode == "full") {
-    sync = run_fpga_sync(events, options.warmup, options.messages);
-    if (!sync.ran) {
+  // Every repetition is a full run, warmup included; the JSON shows the last
+  // one and the stats cover them all.
+  RunResults r{};
+  BenchStats stats;
+  uint64_t mismatches = 0;
+  for (uint64_t run = 0; run < options.repeat; ++run) {
+    r = RunResults{};
+    if (!run_mode(options, events, l3_events, counting ? &counters : nullptr, &r)) {
+      return 1;
+    }
+    collect_metrics(r, &stats);
+    mismatches += r.verify.stats.mismatches + r.verify.book_mismatches;
+  }
+  meter.Stop();
+  const HiccupMeter::Stats hiccup = meter.Summarize();
+
+  if (!options.save_baseline.empty()) {
+    std::ostringstream comment;
+    comment << "mode " << options.mode << " workload " << Workloads::Name(options.workload.kind)
+            << " seed " << options.workload.seed << " messages " << options.messages << " warmup "
+            << options.warmup << " symbols " << options.symbols << " repeat " << options.repeat;
+    if (!stats.Save(options.save_baseline, comment.str())) {
+      std::cerr << "Failed to write baseline " << options.save_baseline << "\n";
       return 1;
     }
   }
 
-  print_json(options, fpga, sw, sync);
-  return 0;
+  if (!options.sweep_csv.empty() && !write_sweep_csv(options.sweep_csv, r.sweep)) {
+    std::cerr << "Failed to write sweep table " << options.sweep_csv << "\n";
+    return 1;
+  }
+
+  uint64_t regressions = 0;
+  print_json(options, r.fpga, r.sw, r.strategies, r.batch, r.l3, r.sharded, r.verify, r.open,
+             r.sweep, r.sync, stats, options.compare.empty() ? nullptr : &baseline, rt,
+             options.hiccup ? &hiccup : nullptr, options.hw_counters ? &r.hw_phases : nullptr,
+             &regressions);
+  return mismatches == 0 && regressions == 0 ? 0 : 1;
 }
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Stand-in for the FPGA side of a file-backed FpgaSharedStream: a temporary
+// file laid out like the bridge window plus a second mapping of it. Open the
+// stream on path() with base 0 and span kSpan. The peer never consumes or
+// answers frames by itself; the caller rewinds the ring pointers and
+// publishes RX slots outside its timed sections.
+class FpgaFilePeer {
+ public:
+  static const std::size_t kSpan = 0x2000;
+  static const uint32_t kDepth = 64;
+
+  FpgaFilePeer() : fd_(-1), map_(MAP_FAILED) {}
+  ~FpgaFilePeer() { Destroy(); }
+
+  FpgaFilePeer(const FpgaFilePeer&) = delete;
+  FpgaFilePeer& operator=(const FpgaFilePeer&) = delete;
+
+  bool Create() {
+    char tmpl[] = "/tmp/fpga_file_peer_XXXXXX";
+    fd_ = mkstemp(tmpl);
+    if (fd_ < 0) {
+      std::perror("mkstemp");
+      return false;
+    }
+    path_ = tmpl;
+    if (ftruncate(fd_, static_cast<off_t>(kSpan)) != 0) {
+      std::perror("ftruncate");
+      return false;
+    }
+    map_ = mmap(nullptr, kSpan, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map_ == MAP_FAILED) {
+      std::perror("mmap");
+      return false;
+    }
+    Write(kRegMagic, FpgaSharedStream::kMagic);
+    Write(kRegVersion, 1);
+    Write(kRegTxDepth, kDepth);
+    Write(kRegRxDepth, kDepth);
+    Write(kRegSlotWords, FpgaSharedStream::kFrameWords);
+    Rewind();
+    return true;
+  }
+
+  void Destroy() {
+    if (map_ != MAP_FAILED) {
+      munmap(map_, kSpan);
+      map_ = MAP_FAILED;
+    }
+    if (fd_ >= 0) {
+      close(fd_);
+      fd_ = -1;
+      unlink(path_.c_str());
+    }
+  }
+
+  const std::string& path() const { return path_; }
+
+  void Rewind() {
+    Write(kRegTxHead, 0);
+    Write(kRegTxTail, 0);
+    Write(kRegRxHead, 0);
+    Write(kRegRxTail, 0);
+  }
+
+  // Marks `count` RX slots as published by the "FPGA".
+  void PublishRx(uint32_t count) {
+    Write(kRegRxTail, 0);
+    Write(kRegRxHead, count);
+  }
+
+ private:
+  static const uint32_t kRegMagic = 0x000;
+  static const uint32_t kRegVersion = 0x004;
+  static const uint32_t kRegTxHead = 0x010;
+  static const uint32_t kRegTxTail = 0x014;
+  static const uint32_t kRegRxHead = 0x018;
+  static const uint32_t kRegRxTail = 0x01C;
+  static const uint32_t kRegTxDepth = 0x020;
+  static const uint32_t kRegRxDepth = 0x024;
+  static const uint32_t kRegSlotWords = 0x028;
+
+  void Write(uint32_t offset, uint32_t value) {
+    *reinterpret_cast<volatile uint32_t*>(static_cast<uint8_t*>(map_) + offset) = value;
+  }
+
+  int fd_;
+  void* map_;
+  std::string path_;
+};
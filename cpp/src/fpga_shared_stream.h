@@ -1,13 +1,28 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HFT_FPGA_VECTOR_COPY_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define HFT_FPGA_VECTOR_COPY_SSE2 1
+#endif
+
+// Build-time default for the slot copy backend (see FpgaSharedStream::SlotCopyMode).
+#ifndef HFT_FPGA_SLOT_COPY_DEFAULT
+#define HFT_FPGA_SLOT_COPY_DEFAULT 0
+#endif
+
 class FpgaSharedStream {
  public:
   struct Frame {
@@ -40,19 +55,123 @@ class FpgaSharedStream {
     uint32_t rsp_stall_cycles;
   };
 
+  static const uint32_t kPerfHistMaxBuckets = 16;
+
+  // Log2 latency histogram: counts[0] holds latencies below 2 cycles,
+  // counts[i] holds [2^i, 2^(i+1)) and the last bucket is open-ended. Bucket
+  // counters wrap at 32 bits. `buckets` is 0 on bitstreams without it.
+  struct PerfHistogram {
+    uint32_t buckets;
+    uint32_t counts[kPerfHistMaxBuckets];
+  };
+
+  static const uint32_t kBookMaxDepth = 64;
+
+  // One level of both sides of the FPGA book; a qty of 0 marks an empty level.
+  struct BookLevel {
+    uint32_t bid_px;
+    uint32_t bid_qty;
+    uint32_t ask_px;
+    uint32_t ask_qty;
+  };
+
+  // Every level of one symbol, best first, as captured by ReadBook().
+  // `last_seq` is the seq of the last event the book accepted before the
+  // capture, for any symbol, not the last one that touched `symbol`; levels
+  // past `depth` are zero.
+  struct BookSnapshot {
+    uint32_t symbol;
+    uint32_t depth;
+    uint32_t last_seq;
+    BookLevel levels[kBookMaxDepth];
+  };
+
+  // How a 32-byte frame is moved between the host and a ring slot.
+  enum SlotCopyMode {
+    kSlotCopyScalar = 0,    // eight volatile 32-bit accesses
+    kSlotCopyPaired64 = 1,  // four volatile 64-bit accesses
+    kSlotCopyVector = 2,    // two 128-bit NEON/SSE2 accesses
+  };
+
+  // How the MMIO window is mapped.
+  enum MapMode {
+    kMapUncached = 0,      // O_SYNC: device/strongly-ordered mapping
+    kMapWriteCombine = 1,  // no O_SYNC: stores may merge into bursts; ordering
+                           // comes only from the barriers at publish points
+  };
+
   static const uint32_t kMagic = 0x48465431;  // "HFT1"
   static const std::size_t kDefaultSpan = 0x2000;
   static const uint32_t kFrameWords = 8;
 
+  static bool HasVectorCopy() {
+#if defined(HFT_FPGA_VECTOR_COPY_NEON) || defined(HFT_FPGA_VECTOR_COPY_SSE2)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  static const char* SlotCopyModeName(SlotCopyMode mode) {
+    switch (mode) {
+      case kSlotCopyPaired64:
+        return "pair64";
+      case kSlotCopyVector:
+        return "vector";
+      default:
+        return "scalar";
+    }
+  }
+
+  static bool ParseSlotCopyMode(const char* text, SlotCopyMode* out) {
+    if (text == nullptr || out == nullptr) {
+      return false;
+    }
+    const std::string value(text);
+    if (value == "scalar") {
+      *out = kSlotCopyScalar;
+    } else if (value == "pair64") {
+      *out = kSlotCopyPaired64;
+    } else if (value == "vector") {
+      *out = kSlotCopyVector;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  static const char* MapModeName(MapMode mode) {
+    return mode == kMapWriteCombine ? "wc" : "sync";
+  }
+
+  static bool ParseMapMode(const char* text, MapMode* out) {
+    if (text == nullptr || out == nullptr) {
+      return false;
+    }
+    const std::string value(text);
+    if (value == "sync") {
+      *out = kMapUncached;
+    } else if (value == "wc") {
+      *out = kMapWriteCombine;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
   FpgaSharedStream()
       : fd_(-1),
         map_base_(MAP_FAILED),
         map_len_(0),
+        span_(0),
         mmio_(nullptr),
         tx_depth_(kDefaultDepth),
         rx_depth_(kDefaultDepth),
         slot_words_(kDefaultSlotWords),
         legacy_mode_(false),
+        copy_mode_(static_cast<SlotCopyMode>(HFT_FPGA_SLOT_COPY_DEFAULT)),
+        active_copy_mode_(kSlotCopyScalar),
+        map_mode_(kMapUncached),
         observed_header_{} {}
 
   ~FpgaSharedStream() { Close(); }
@@ -72,7 +191,8 @@ class FpgaSharedStream {
     const std::size_t page_off = static_cast<std::size_t>(phys_base - aligned_base);
     const std::size_t map_len = page_off + span;
 
-    fd_ = open(dev_path.c_str(), O_RDWR | O_SYNC);
+    const int open_flags = map_mode_ == kMapUncached ? (O_RDWR | O_SYNC) : O_RDWR;
+    fd_ = open(dev_path.c_str(), open_flags);
     if (fd_ < 0) {
       last_error_ = "failed to open MMIO device";
       return false;
@@ -88,6 +208,7 @@ class FpgaSharedStream {
     }
 
     map_len_ = map_len;
+    span_ = span;
     mmio_ = reinterpret_cast<volatile uint8_t*>(map_base_) + page_off;
 
     observed_header_.magic = ReadReg(kRegMagic);
@@ -112,6 +233,7 @@ class FpgaSharedStream {
         return false;
       }
 
+      active_copy_mode_ = ResolveCopyMode(copy_mode_);
       return true;
     }
 
@@ -136,6 +258,7 @@ class FpgaSharedStream {
         return false;
       }
 
+      active_copy_mode_ = ResolveCopyMode(copy_mode_);
       return true;
     }
 
@@ -156,15 +279,34 @@ class FpgaSharedStream {
     }
     mmio_ = nullptr;
     map_len_ = 0;
+    span_ = 0;
     tx_depth_ = kDefaultDepth;
     rx_depth_ = kDefaultDepth;
     slot_words_ = kDefaultSlotWords;
     legacy_mode_ = false;
+    active_copy_mode_ = kSlotCopyScalar;
     observed_header_ = {};
   }
 
   bool IsOpen() const { return mmio_ != nullptr; }
 
+  // Takes effect immediately. Falls back to a narrower backend when the
+  // requested one is not compiled in or the slots are not suitably aligned;
+  // ActiveSlotCopyMode() reports what is actually used.
+  void SetSlotCopyMode(SlotCopyMode mode) {
+    copy_mode_ = mode;
+    if (IsOpen()) {
+      active_copy_mode_ = ResolveCopyMode(copy_mode_);
+    }
+  }
+
+  SlotCopyMode RequestedSlotCopyMode() const { return copy_mode_; }
+  SlotCopyMode ActiveSlotCopyMode() const { return active_copy_mode_; }
+
+  // Applies to the next Open().
+  void SetMapMode(MapMode mode) { map_mode_ = mode; }
+  MapMode GetMapMode() const { return map_mode_; }
+
   const std::string& LastError() const { return last_error_; }
 
   Header ObservedHeader() const { return observed_header_; }
@@ -216,6 +358,96 @@ class FpgaSharedStream {
     return true;
   }
 
+  bool ReadPerfHistogram(PerfHistogram* histogram) const {
+    if (!IsOpen() || legacy_mode_ || histogram == nullptr) {
+      return false;
+    }
+    uint32_t buckets = ReadReg(kRegPerfHistBuckets);
+    if (buckets > kPerfHistMaxBuckets) {
+      buckets = kPerfHistMaxBuckets;
+    }
+    histogram->buckets = buckets;
+    for (uint32_t i = 0; i < kPerfHistMaxBuckets; ++i) {
+      histogram->counts[i] = i < buckets ? ReadReg(kRegPerfHistBase + i * 4u) : 0u;
+    }
+    return true;
+  }
+
+  // Book readback window geometry; 0 on bitstreams without it.
+  uint32_t BookSymbols() const {
+    return IsOpen() && !legacy_mode_ ? ReadReg(kRegBookInfo) >> 16 : 0u;
+  }
+  uint32_t BookDepth() const {
+    return IsOpen() && !legacy_mode_ ? ReadReg(kRegBookInfo) & 0xFFFFu : 0u;
+  }
+
+  // Captures every level of `symbol` from the FPGA book: one register write,
+  // a poll until the capture lands (two FPGA clocks) and four register reads
+  // per level. The capture is taken between two events, so it is consistent
+  // with `last_seq` even while frames are in flight. False, with LastError()
+  // set, if the bitstream has no readback window, the symbol is outside the
+  // book or the capture never lands.
+  bool ReadBook(uint32_t symbol, BookSnapshot* snapshot) {
+    if (!IsOpen() || legacy_mode_ || snapshot == nullptr) {
+      return false;
+    }
+    const uint32_t info = ReadReg(kRegBookInfo);
+    const uint32_t symbols = info >> 16;
+    const uint32_t depth = info & 0xFFFFu;
+    const uint32_t base = ReadReg(kRegBookBase);
+    if (depth == 0) {
+      last_error_ = "bitstream has no book readback window";
+      return false;
+    }
+    const uint64_t rx_end =
+        static_cast<uint64_t>(RxBase()) + rx_depth_ * slot_words_ * sizeof(uint32_t);
+    if (depth > kBookMaxDepth || base < rx_end || (base % sizeof(uint32_t)) != 0 ||
+        static_cast<uint64_t>(base) + depth * sizeof(BookLevel) > span_) {
+      last_error_ = "unexpected book readback geometry";
+      return false;
+    }
+    if (symbol >= symbols) {
+      last_error_ = "symbol outside the FPGA book";
+      return false;
+    }
+
+    const uint32_t count = ReadReg(kRegBookCount);
+    WriteReg(kRegBookCtrl, symbol);
+    const std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<int64_t>(kBookTimeoutUs));
+    while (ReadReg(kRegBookCount) == count) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        last_error_ = "book readback capture timed out";
+        return false;
+      }
+    }
+    if (map_mode_ != kMapUncached) {
+      // Order the level reads after the BOOK_COUNT read, as in Receive().
+      __sync_synchronize();
+    }
+    if (ReadReg(kRegBookCtrl) != symbol) {
+      last_error_ = "book readback raced another capture";
+      return false;
+    }
+
+    snapshot->symbol = symbol;
+    snapshot->depth = depth;
+    snapshot->last_seq = ReadReg(kRegBookSeq);
+    for (uint32_t i = 0; i < kBookMaxDepth; ++i) {
+      BookLevel& level = snapshot->levels[i];
+      if (i < depth) {
+        const uint32_t offset = base + i * static_cast<uint32_t>(sizeof(BookLevel));
+        level.bid_px = ReadReg(offset);
+        level.bid_qty = ReadReg(offset + 4u);
+        level.ask_px = ReadReg(offset + 8u);
+        level.ask_qty = ReadReg(offset + 12u);
+      } else {
+        level = BookLevel{0, 0, 0, 0};
+      }
+    }
+    return true;
+  }
+
   bool Send(const Frame& frame) {
     if (!IsOpen()) {
       return false;
@@ -232,6 +464,8 @@ class FpgaSharedStream {
     }
 
     WriteSlot(TxBase(), head, frame);
+    // Publish point: the slot payload must be visible before TX_HEAD moves.
+    __sync_synchronize();
     WriteReg(TxHeadOffset(), next);
     return true;
   }
@@ -258,6 +492,10 @@ class FpgaSharedStream {
     if (head == tail) {
       return false;
     }
+    if (map_mode_ != kMapUncached) {
+      // Without a device mapping, order the slot reads after the RX_HEAD read.
+      __sync_synchronize();
+    }
 
     ReadSlot(RxBase(), tail, frame);
     WriteReg(RxTailOffset(), Next(tail, rx_depth_));
@@ -310,6 +548,17 @@ class FpgaSharedStream {
   static const uint32_t kRegPerfSumLatencyCyclesHi = 0x04C;
   static const uint32_t kRegPerfCmdStallCycles = 0x050;
   static const uint32_t kRegPerfRspStallCycles = 0x054;
+  static const uint32_t kRegPerfHistBuckets = 0x058;
+  static const uint32_t kRegPerfHistBase = 0x060;
+  static const uint32_t kRegBookInfo = 0x0A0;
+  static const uint32_t kRegBookBase = 0x0A4;
+  static const uint32_t kRegBookCtrl = 0x0A8;
+  static const uint32_t kRegBookCount = 0x0AC;
+  static const uint32_t kRegBookSeq = 0x0B0;
+
+  // A capture lands two FPGA clocks after the BOOK_CTRL write; the bound only
+  // guards against a bitstream that never answers.
+  static const uint32_t kBookTimeoutUs = 50000;
 
   // Legacy layout
   static const uint32_t kLegacyRegTxDepth = 0x000;
@@ -393,9 +642,58 @@ class FpgaSharedStream {
     __sync_synchronize();
   }
 
+  SlotCopyMode ResolveCopyMode(SlotCopyMode mode) const {
+    const uintptr_t slot_base =
+        reinterpret_cast<uintptr_t>(mmio_) + kRingBase;
+    const uintptr_t slot_bytes = slot_words_ * sizeof(uint32_t);
+    if (mode == kSlotCopyVector &&
+        (!HasVectorCopy() || (slot_base % 16) != 0 || (slot_bytes % 16) != 0)) {
+      mode = kSlotCopyPaired64;
+    }
+    if (mode == kSlotCopyPaired64 && ((slot_base % 8) != 0 || (slot_bytes % 8) != 0)) {
+      mode = kSlotCopyScalar;
+    }
+    return mode;
+  }
+
+  volatile uint32_t* SlotPtr(uint32_t base, uint32_t index) const {
+    return reinterpret_cast<volatile uint32_t*>(
+        const_cast<volatile uint8_t*>(mmio_) +
+        base + index * (slot_words_ * sizeof(uint32_t)));
+  }
+
+  // The caller issues the publish barrier; the copy itself carries none.
   void WriteSlot(uint32_t base, uint32_t index, const Frame& frame) {
-    volatile uint32_t* slot = reinterpret_cast<volatile uint32_t*>(
-        mmio_ + base + index * (slot_words_ * sizeof(uint32_t)));
+    volatile uint32_t* slot = SlotPtr(base, index);
+    switch (active_copy_mode_) {
+      case kSlotCopyVector:
+        WriteSlotVector(slot, frame);
+        break;
+      case kSlotCopyPaired64:
+        WriteSlotPaired64(slot, frame);
+        break;
+      default:
+        WriteSlotScalar(slot, frame);
+        break;
+    }
+  }
+
+  void ReadSlot(uint32_t base, uint32_t index, Frame* frame) const {
+    volatile uint32_t* slot = SlotPtr(base, index);
+    switch (active_copy_mode_) {
+      case kSlotCopyVector:
+        ReadSlotVector(slot, frame);
+        break;
+      case kSlotCopyPaired64:
+        ReadSlotPaired64(slot, frame);
+        break;
+      default:
+        ReadSlotScalar(slot, frame);
+        break;
+    }
+  }
+
+  static void WriteSlotScalar(volatile uint32_t* slot, const Frame& frame) {
     slot[0] = frame.word0;
     slot[1] = frame.word1;
     slot[2] = frame.word2;
@@ -404,13 +702,9 @@ class FpgaSharedStream {
     slot[5] = frame.word5;
     slot[6] = frame.word6;
     slot[7] = frame.word7;
-    __sync_synchronize();
   }
 
-  void ReadSlot(uint32_t base, uint32_t index, Frame* frame) const {
-    volatile uint32_t* slot = reinterpret_cast<volatile uint32_t*>(
-        const_cast<volatile uint8_t*>(mmio_) +
-        base + index * (slot_words_ * sizeof(uint32_t)));
+  static void ReadSlotScalar(volatile uint32_t* slot, Frame* frame) {
     frame->word0 = slot[0];
     frame->word1 = slot[1];
     frame->word2 = slot[2];
@@ -421,14 +715,87 @@ class FpgaSharedStream {
     frame->word7 = slot[7];
   }
 
+  // Word pairs are packed little-endian, matching the 32-bit lane order.
+  static void WriteSlotPaired64(volatile uint32_t* slot, const Frame& frame) {
+    volatile uint64_t* slot64 = reinterpret_cast<volatile uint64_t*>(slot);
+    slot64[0] = static_cast<uint64_t>(frame.word0) | (static_cast<uint64_t>(frame.word1) << 32);
+    slot64[1] = static_cast<uint64_t>(frame.word2) | (static_cast<uint64_t>(frame.word3) << 32);
+    slot64[2] = static_cast<uint64_t>(frame.word4) | (static_cast<uint64_t>(frame.word5) << 32);
+    slot64[3] = static_cast<uint64_t>(frame.word6) | (static_cast<uint64_t>(frame.word7) << 32);
+  }
+
+  static void ReadSlotPaired64(volatile uint32_t* slot, Frame* frame) {
+    volatile uint64_t* slot64 = reinterpret_cast<volatile uint64_t*>(slot);
+    const uint64_t v0 = slot64[0];
+    const uint64_t v1 = slot64[1];
+    const uint64_t v2 = slot64[2];
+    const uint64_t v3 = slot64[3];
+    frame->word0 = static_cast<uint32_t>(v0);
+    frame->word1 = static_cast<uint32_t>(v0 >> 32);
+    frame->word2 = static_cast<uint32_t>(v1);
+    frame->word3 = static_cast<uint32_t>(v1 >> 32);
+    frame->word4 = static_cast<uint32_t>(v2);
+    frame->word5 = static_cast<uint32_t>(v2 >> 32);
+    frame->word6 = static_cast<uint32_t>(v3);
+    frame->word7 = static_cast<uint32_t>(v3 >> 32);
+  }
+
+  // Vector accesses drop the volatile qualifier; the empty asm statements keep
+  // the compiler from merging or eliding them across the surrounding MMIO.
+  static void WriteSlotVector(volatile uint32_t* slot, const Frame& frame) {
+#if defined(HFT_FPGA_VECTOR_COPY_NEON) || defined(HFT_FPGA_VECTOR_COPY_SSE2)
+    uint32_t words[kFrameWords];
+    std::memcpy(words, &frame, sizeof(words));
+    uint32_t* dst = const_cast<uint32_t*>(slot);
+    __asm__ __volatile__("" ::: "memory");
+#if defined(HFT_FPGA_VECTOR_COPY_NEON)
+    vst1q_u32(dst, vld1q_u32(words));
+    vst1q_u32(dst + 4, vld1q_u32(words + 4));
+#else
+    _mm_store_si128(reinterpret_cast<__m128i*>(dst),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(words)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(dst + 4),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + 4)));
+#endif
+    __asm__ __volatile__("" ::: "memory");
+#else
+    WriteSlotPaired64(slot, frame);
+#endif
+  }
+
+  static void ReadSlotVector(volatile uint32_t* slot, Frame* frame) {
+#if defined(HFT_FPGA_VECTOR_COPY_NEON) || defined(HFT_FPGA_VECTOR_COPY_SSE2)
+    uint32_t words[kFrameWords];
+    const uint32_t* src = const_cast<const uint32_t*>(slot);
+    __asm__ __volatile__("" ::: "memory");
+#if defined(HFT_FPGA_VECTOR_COPY_NEON)
+    vst1q_u32(words, vld1q_u32(src));
+    vst1q_u32(words + 4, vld1q_u32(src + 4));
+#else
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(words),
+                     _mm_load_si128(reinterpret_cast<const __m128i*>(src)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(words + 4),
+                     _mm_load_si128(reinterpret_cast<const __m128i*>(src + 4)));
+#endif
+    __asm__ __volatile__("" ::: "memory");
+    std::memcpy(frame, words, sizeof(words));
+#else
+    ReadSlotPaired64(slot, frame);
+#endif
+  }
+
   int fd_;
   void* map_base_;
   std::size_t map_len_;
+  std::size_t span_;
   volatile uint8_t* mmio_;
   uint32_t tx_depth_;
   uint32_t rx_depth_;
   uint32_t slot_words_;
   bool legacy_mode_;
+  SlotCopyMode copy_mode_;
+  SlotCopyMode active_copy_mode_;
+  MapMode map_mode_;
   Header observed_header_;
   std::string last_error_;
 };
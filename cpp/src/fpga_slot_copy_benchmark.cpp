@@ -0,0 +1,289 @@
+#include "fpga_file_peer.h"
+#include "fpga_shared_stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Compares the FpgaSharedStream slot copy backends. On the file target a
+// temporary file (FpgaFilePeer) stands in for the MMIO window and the
+// benchmark plays the FPGA side by rewinding the ring pointers between
+// (untimed) batches. On the bridge target the real FPGA consumes TX frames
+// and produces RX responses.
+
+struct Options {
+  std::string target;
+  uint64_t iterations;
+};
+
+struct BackendResult {
+  FpgaSharedStream::SlotCopyMode copy_mode;
+  FpgaSharedStream::MapMode map_mode;
+  bool ran;
+  uint64_t frames;
+  double send_ns;
+  double receive_ns;
+};
+
+uint64_t now_ns() {
+  timespec ts{};
+#ifdef CLOCK_MONOTONIC_RAW
+  const clockid_t clock_id = CLOCK_MONOTONIC_RAW;
+#else
+  const clockid_t clock_id = CLOCK_MONOTONIC;
+#endif
+  clock_gettime(clock_id, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+bool parse_u64(const char* text, uint64_t* out) {
+  if (text == nullptr || out == nullptr) {
+    return false;
+  }
+  errno = 0;
+  char* end = nullptr;
+  const unsigned long long value = std::strtoull(text, &end, 0);
+  if (errno != 0 || end == text || *end != '\0') {
+    return false;
+  }
+  *out = static_cast<uint64_t>(value);
+  return true;
+}
+
+void usage(const char* argv0) {
+  std::cerr << "Usage: " << argv0 << " [--target file|bridge] [--iterations N]\n";
+}
+
+bool parse_args(int argc, char** argv, Options* options) {
+  options->target = "file";
+  options->iterations = 200000;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    if (arg == "--help" || arg == "-h") {
+      usage(argv[0]);
+      std::exit(0);
+    }
+    if ((arg == "--target" || arg == "--iterations") && i + 1 >= argc) {
+      usage(argv[0]);
+      return false;
+    }
+    if (arg == "--target") {
+      options->target = argv[++i];
+    } else if (arg == "--iterations") {
+      if (!parse_u64(argv[++i], &options->iterations) || options->iterations == 0) {
+        std::cerr << "Invalid --iterations value\n";
+        return false;
+      }
+    } else {
+      usage(argv[0]);
+      return false;
+    }
+  }
+
+  if (options->target != "file" && options->target != "bridge") {
+    std::cerr << "Invalid --target value\n";
+    return false;
+  }
+  return true;
+}
+
+bool open_bridge(FpgaSharedStream* bridge) {
+  const char* base_env = std::getenv("HFT_FPGA_MMIO_BASE");
+  if (base_env == nullptr) {
+    std::cerr << "HFT_FPGA_MMIO_BASE is required for --target bridge\n";
+    return false;
+  }
+  uint64_t base = 0;
+  if (!parse_u64(base_env, &base)) {
+    std::cerr << "Invalid HFT_FPGA_MMIO_BASE value\n";
+    return false;
+  }
+  uint64_t span_value = FpgaSharedStream::kDefaultSpan;
+  const char* span_env = std::getenv("HFT_FPGA_MMIO_SPAN");
+  if (span_env != nullptr && !parse_u64(span_env, &span_value)) {
+    std::cerr << "Invalid HFT_FPGA_MMIO_SPAN value\n";
+    return false;
+  }
+  const char* dev_env = std::getenv("HFT_FPGA_MMIO_DEV");
+  const std::string dev_path = dev_env == nullptr ? "/dev/mem" : dev_env;
+
+  if (!bridge->Open(base, static_cast<std::size_t>(span_value), dev_path)) {
+    std::cerr << "Failed to open FPGA MMIO bridge: " << bridge->LastError() << "\n";
+    return false;
+  }
+  return bridge->ResetQueues();
+}
+
+FpgaSharedStream::Frame make_frame(uint64_t idx) {
+  FpgaSharedStream::Frame frame{};
+  frame.word0 = static_cast<uint32_t>(idx + 1u);
+  frame.word1 = static_cast<uint32_t>(idx % 5u);
+  frame.word2 = 1850000u - static_cast<uint32_t>(idx % 80u) * 100u;
+  frame.word3 = 100u + static_cast<uint32_t>(idx % 4901u);
+  frame.word4 = 1;
+  frame.word5 = (idx & 1u) == 0 ? 1u : 2u;
+  return frame;
+}
+
+// Waits until the FPGA has had time to publish the whole batch without
+// consuming it, so the timed receive loop only measures slot reads and
+// pointer updates.
+void wait_for_bridge_responses(FpgaSharedStream* bridge) {
+  while (!bridge->HasRx()) {
+    __sync_synchronize();
+  }
+  const uint64_t settle_until = now_ns() + 20000;
+  while (now_ns() < settle_until) {
+    __sync_synchronize();
+  }
+}
+
+BackendResult run_backend(const Options& options, FpgaFilePeer* peer,
+                          FpgaSharedStream::SlotCopyMode copy_mode,
+                          FpgaSharedStream::MapMode map_mode) {
+  BackendResult result{};
+  result.copy_mode = copy_mode;
+  result.map_mode = map_mode;
+
+  FpgaSharedStream stream;
+  stream.SetMapMode(map_mode);
+  stream.SetSlotCopyMode(copy_mode);
+  const bool is_file = peer != nullptr;
+  if (is_file) {
+    if (!stream.Open(0, FpgaFilePeer::kSpan, peer->path())) {
+      std::cerr << "Failed to open file target: " << stream.LastError() << "\n";
+      return result;
+    }
+  } else if (!open_bridge(&stream)) {
+    return result;
+  }
+  if (stream.ActiveSlotCopyMode() != copy_mode) {
+    return result;
+  }
+
+  const uint64_t tx_capacity = stream.TxDepth() - 1;
+  const uint64_t rx_capacity = stream.RxDepth() - 1;
+  const uint64_t batch =
+      is_file ? std::min(tx_capacity, rx_capacity) : std::min(tx_capacity, rx_capacity / 2);
+
+  uint64_t send_total_ns = 0;
+  uint64_t receive_total_ns = 0;
+  uint64_t frames = 0;
+  volatile uint32_t sink = 0;
+
+  while (frames < options.iterations) {
+    const uint64_t count = std::min<uint64_t>(batch, options.iterations - frames);
+    if (is_file) {
+      peer->Rewind();
+    }
+
+    const uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < count; ++i) {
+      if (!stream.Send(make_frame(frames + i))) {
+        std::cerr << "Send failed inside a batch\n";
+        return result;
+      }
+    }
+    const uint64_t t1 = now_ns();
+
+    if (is_file) {
+      peer->PublishRx(static_cast<uint32_t>(count));
+    } else {
+      wait_for_bridge_responses(&stream);
+    }
+
+    FpgaSharedStream::Frame response{};
+    uint64_t received = 0;
+    const uint64_t t2 = now_ns();
+    while (received < count) {
+      if (stream.Receive(&response)) {
+        sink ^= response.word0;
+        ++received;
+      }
+    }
+    const uint64_t t3 = now_ns();
+
+    send_total_ns += t1 - t0;
+    receive_total_ns += t3 - t2;
+    frames += count;
+  }
+
+  result.ran = true;
+  result.frames = frames;
+  result.send_ns = static_cast<double>(send_total_ns) / static_cast<double>(frames);
+  result.receive_ns = static_cast<double>(receive_total_ns) / static_cast<double>(frames);
+  return result;
+}
+
+void print_json(const Options& options, const std::vector<BackendResult>& results) {
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "{\n";
+  std::cout << "  \"target\": \"" << options.target << "\",\n";
+  std::cout << "  \"iterations\": " << options.iterations << ",\n";
+  std::cout << "  \"backends\": [\n";
+  bool first = true;
+  for (const BackendResult& r : results) {
+    if (!r.ran) {
+      continue;
+    }
+    std::cout << (first ? "" : ",\n");
+    first = false;
+    std::cout << "    {\"copy\": \"" << FpgaSharedStream::SlotCopyModeName(r.copy_mode)
+              << "\", \"map\": \"" << FpgaSharedStream::MapModeName(r.map_mode)
+              << "\", \"frames\": " << r.frames
+              << ", \"send_ns\": " << r.send_ns
+              << ", \"receive_ns\": " << r.receive_ns << "}";
+  }
+  std::cout << "\n  ]\n";
+  std::cout << "}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options{};
+  if (!parse_args(argc, argv, &options)) {
+    return 2;
+  }
+
+  FpgaFilePeer peer;
+  FpgaFilePeer* peer_ptr = nullptr;
+  if (options.target == "file") {
+    if (!peer.Create()) {
+      return 1;
+    }
+    peer_ptr = &peer;
+  }
+
+  const FpgaSharedStream::SlotCopyMode copy_modes[] = {
+      FpgaSharedStream::kSlotCopyScalar,
+      FpgaSharedStream::kSlotCopyPaired64,
+      FpgaSharedStream::kSlotCopyVector,
+  };
+  const FpgaSharedStream::MapMode map_modes[] = {
+      FpgaSharedStream::kMapUncached,
+      FpgaSharedStream::kMapWriteCombine,
+  };
+
+  std::vector<BackendResult> results;
+  for (FpgaSharedStream::MapMode map_mode : map_modes) {
+    for (FpgaSharedStream::SlotCopyMode copy_mode : copy_modes) {
+      results.push_back(run_backend(options, peer_ptr, copy_mode, map_mode));
+    }
+  }
+
+  print_json(options, results);
+  return 0;
+}
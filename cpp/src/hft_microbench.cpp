@@ -0,0 +1,504 @@
+#include "SimpleMD.h"
+#include "bench_stats.h"
+#include "bridge_journal.h"
+#include "feed_framing.h"
+#include "feed_mapping.h"
+#include "fpga_file_peer.h"
+#include "fpga_shared_stream.h"
+#include "mfast_arena_allocator.h"
+#include "sw_order_book.h"
+#include "workloads.h"
+
+#include <mfast/coder/fast_decoder.h>
+#include <mfast/coder/fast_encoder.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Per-stage timings of the ARM-side receive path, each stage on its own:
+//
+//   fast_decode     mFAST decode of one single-entry SimpleMD message; with
+//                   --fast-reset-every N > 1 the inputs are one FAST stream
+//                   and the dictionary resets only every N messages
+//   symbol_map      FeedMapping::MapSymbol
+//   price_convert   FeedMapping::PriceToFixed1e4
+//   frame_pack      FeedMapping::LevelFrame into a frame buffer
+//   stream_send     FpgaSharedStream::Send into a file-backed window
+//   stream_receive  FpgaSharedStream::Receive from a file-backed window
+//   journal_append  BridgeJournal::Append of a TX frame, with the writer
+//                   thread draining into a small journal (once it is full the
+//                   writer drops, which leaves the caller's cost unchanged)
+//   book_update     SwOrderBook::ApplyEvent
+//   strategy        spread, imbalance and ImbalanceStrategy::Decide on a top
+//
+// Inputs are built once, kInputs of each, and cycled. Every stage gets one
+// untimed pass, then `repeat` timed passes of `iterations` operations; the
+// per-operation times of the passes are summarised with BenchStats, so a
+// stage's baseline can be saved and compared like fpga_benchmark's.
+// The decoder allocates from a MfastArenaAllocator; each stage reports the
+// arena's heap allocations during its timed passes, which should be zero.
+
+const uint64_t kDefaultIterations = 200000;
+const uint64_t kDefaultRepeat = 7;
+const uint32_t kInputs = 4096;  // power of two
+const uint32_t kBookSymbols = 8;
+const uint64_t kJournalRecords = 1u << 16;
+
+struct Options {
+  uint64_t iterations;
+  uint64_t repeat;
+  // Comma-separated stage names; empty runs all.
+  std::string stages;
+  uint64_t fast_reset_every;
+  std::string save_baseline;
+  std::string compare;
+};
+
+uint64_t now_ns() {
+  timespec ts{};
+#ifdef CLOCK_MONOTONIC_RAW
+  const clockid_t clock_id = CLOCK_MONOTONIC_RAW;
+#else
+  const clockid_t clock_id = CLOCK_MONOTONIC;
+#endif
+  clock_gettime(clock_id, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+bool parse_u64(const char* text, uint64_t* out) {
+  if (text == nullptr || out == nullptr) {
+    return false;
+  }
+  errno = 0;
+  char* end = nullptr;
+  const unsigned long long value = std::strtoull(text, &end, 0);
+  if (errno != 0 || end == text || *end != '\0') {
+    return false;
+  }
+  *out = static_cast<uint64_t>(value);
+  return true;
+}
+
+void usage(const char* argv0) {
+  std::cerr << "Usage: " << argv0
+            << " [--iterations N] [--repeat N] [--stage NAME[,NAME...]]"
+               " [--fast-reset-every N] [--save-baseline FILE] [--compare FILE]\n";
+}
+
+bool parse_args(int argc, char** argv, Options* options) {
+  options->iterations = kDefaultIterations;
+  options->repeat = kDefaultRepeat;
+  options->fast_reset_every = 1;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    if (arg == "--help" || arg == "-h") {
+      usage(argv[0]);
+      std::exit(0);
+    }
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+      return false;
+    }
+    if (arg == "--iterations") {
+      if (!parse_u64(argv[++i], &options->iterations) || options->iterations == 0) {
+        std::cerr << "Invalid --iterations value\n";
+        return false;
+      }
+    } else if (arg == "--repeat") {
+      if (!parse_u64(argv[++i], &options->repeat) || options->repeat == 0) {
+        std::cerr << "Invalid --repeat value\n";
+        return false;
+      }
+    } else if (arg == "--stage") {
+      options->stages = argv[++i];
+    } else if (arg == "--fast-reset-every") {
+      if (!parse_u64(argv[++i], &options->fast_reset_every) ||
+          options->fast_reset_every > 0xFFFFFFFFull) {
+        std::cerr << "Invalid --fast-reset-every value\n";
+        return false;
+      }
+    } else if (arg == "--save-baseline") {
+      options->save_baseline = argv[++i];
+    } else if (arg == "--compare") {
+      options->compare = argv[++i];
+    } else {
+      usage(argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+class Microbench {
+ public:
+  typedef uint64_t (Microbench::*StageFn)(uint64_t iterations);
+
+  struct Stage {
+    const char* name;
+    StageFn run;
+  };
+
+  static const Stage* Stages(std::size_t* count) {
+    static const Stage kStages[] = {
+        {"fast_decode", &Microbench::FastDecode},
+        {"symbol_map", &Microbench::SymbolMap},
+        {"price_convert", &Microbench::PriceConvert},
+        {"frame_pack", &Microbench::FramePack},
+        {"stream_send", &Microbench::StreamSend},
+        {"stream_receive", &Microbench::StreamReceive},
+        {"journal_append", &Microbench::JournalAppend},
+        {"book_update", &Microbench::BookUpdate},
+        {"strategy", &Microbench::Strategy},
+    };
+    *count = sizeof(kStages) / sizeof(kStages[0]);
+    return kStages;
+  }
+
+  Microbench() : decoder_(&alloc_), sink_(0) {}
+
+  // Builds every stage's inputs from one uniform Workloads stream. The FAST
+  // inputs are encoded in order as one stream, resetting the dictionary as
+  // FeedFraming(fast_reset_every) would.
+  bool Init(uint32_t fast_reset_every) {
+    Workloads::Config workload = Workloads::DefaultConfig();
+    workload.kind = Workloads::kUniform;
+    workload.num_symbols = kBookSymbols;
+    if (!Workloads::Generate(workload, kInputs, &events_)) {
+      return false;
+    }
+
+    const mfast::templates_description* descs[] = {SimpleMD::description()};
+    decoder_.include(descs);
+    mfast::fast_encoder encoder(&alloc_);
+    encoder.include(descs);
+    char buf[1024];
+    SimpleMD::SimpleMD message(&alloc_);
+    SimpleMD::SimpleMD_mref ref = message.ref();
+    FeedFraming framing(fast_reset_every);
+    offsets_.push_back(0);
+    for (uint32_t i = 0; i < kInputs; ++i) {
+      const FpgaSharedStream::Frame& event = events_[i];
+      const char* name = FeedMapping::Symbols()[event.word1 % FeedMapping::kNumSymbols].name;
+      // The feed quotes in cents.
+      cents_.push_back(static_cast<int64_t>(event.word2 / 100u));
+      names_.push_back(name);
+      sides_.push_back(event.word5 == SwOrderBook::kSideBuy ? "buy" : "sell");
+
+      ref.set_MDEntries().resize(1);
+      SimpleMD::SimpleMD_mref::MDEntries_element_mref entry(ref.set_MDEntries()[0]);
+      entry.set_Symbol().as(name);
+      entry.set_Side().as(sides_.back());
+      entry.set_Price().as(static_cast<double>(cents_.back()) / 100.0);
+      entry.set_Qty().as(event.word3);
+      entry.set_SeqNo().as(event.word0);
+      const bool reset = framing.NextIsReset(false);
+      const std::size_t length = encoder.encode(ref, buf, sizeof(buf), reset);
+      resets_.push_back(reset ? 1u : 0u);
+      encoded_.insert(encoded_.end(), buf, buf + length);
+      offsets_.push_back(static_cast<uint32_t>(encoded_.size()));
+    }
+
+    frames_.resize(kInputs);
+    if (!peer_.Create() || !stream_.Open(0, FpgaFilePeer::kSpan, peer_.path())) {
+      std::cerr << "Failed to open file-backed stream: " << stream_.LastError() << "\n";
+      return false;
+    }
+    batch_ = std::min(stream_.TxDepth(), stream_.RxDepth()) - 1u;
+
+    // The mapping outlives the name, so nothing is left behind in /tmp.
+    const std::string journal_path = "/tmp/hft_microbench_journal_" + std::to_string(getpid());
+    std::string journal_error;
+    if (!journal_.Open(journal_path, kJournalRecords, &journal_error)) {
+      std::cerr << "Failed to open bridge journal: " << journal_error << "\n";
+      return false;
+    }
+    unlink(journal_path.c_str());
+
+    SwOrderBook::Config config = SwOrderBook::DefaultConfig();
+    config.num_symbols = kBookSymbols;
+    book_.Init(config);
+    for (uint32_t i = 0; i < kInputs; ++i) {
+      book_.ApplyEvent(events_[i]);
+      tops_.push_back(book_.Top(events_[i].word1));
+    }
+    return true;
+  }
+
+  uint64_t Sink() const { return sink_; }
+  double FastBytesPerMessage() const {
+    return static_cast<double>(encoded_.size()) / static_cast<double>(kInputs);
+  }
+  uint64_t HeapAllocations() const { return alloc_.stats().heap_allocations; }
+
+ private:
+  uint64_t FastDecode(uint64_t iterations) {
+    uint64_t sum = 0;
+    const uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      const uint32_t k = static_cast<uint32_t>(i) & (kInputs - 1u);
+      const char* first = encoded_.data() + offsets_[k];
+      const char* last = encoded_.data() + offsets_[k + 1u];
+      mfast::message_cref msg = decoder_.decode(first, last, resets_[k] != 0);
+      SimpleMD::SimpleMD_cref typed(msg);
+      for (auto entry : typed.get_MDEntries()) {
+        sum += entry.get_SeqNo().value() + entry.get_Qty().value();
+      }
+    }
+    const uint64_t elapsed = now_ns() - t0;
+    sink_ += sum;
+    return elapsed;
+  }
+
+  uint64_t SymbolMap(uint64_t iterations) {
+    uint64_t sum = 0;
+    const uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      uint32_t id = 0;
+      FeedMapping::MapSymbol(names_[static_cast<uint32_t>(i) & (kInputs - 1u)], &id);
+      sum += id;
+    }
+    const uint64_t elapsed = now_ns() - t0;
+    sink_ += sum;
+    return elapsed;
+  }
+
+  uint64_t PriceConvert(uint64_t iterations) {
+    uint64_t sum = 0;
+    const uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      sum += FeedMapping::PriceToFixed1e4(cents_[static_cast<uint32_t>(i) & (kInputs - 1u)], -2);
+    }
+    const uint64_t elapsed = now_ns() - t0;
+    sink_ += sum;
+    return elapsed;
+  }
+
+  uint64_t FramePack(uint64_t iterations) {
+    const uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      const uint32_t k = static_cast<uint32_t>(i) & (kInputs - 1u);
+      const FpgaSharedStream::Frame& event = events_[k];
+      frames_[k] = FeedMapping::LevelFrame(static_cast<uint32_t>(i), event.word1, event.word2,
+                                           event.word3, FeedMapping::ParseSide(sides_[k]));
+    }
+    const uint64_t elapsed = now_ns() - t0;
+    sink_ += frames_[static_cast<uint32_t>(iterations - 1u) & (kInputs - 1u)].word0;
+    return elapsed;
+  }
+
+  // The peer never drains TX, so each batch fits the ring and the pointers
+  // are rewound between batches outside the timed part.
+  uint64_t StreamSend(uint64_t iterations) {
+    uint64_t elapsed = 0;
+    for (uint64_t done = 0; done < iterations;) {
+      const uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(batch_, iterations - done));
+      peer_.Rewind();
+      const uint64_t t0 = now_ns();
+      for (uint32_t i = 0; i < count; ++i) {
+        stream_.Send(events_[static_cast<uint32_t>(done + i) & (kInputs - 1u)]);
+      }
+      elapsed += now_ns() - t0;
+      done += count;
+    }
+    return elapsed;
+  }
+
+  uint64_t StreamReceive(uint64_t iterations) {
+    uint64_t elapsed = 0;
+    uint64_t sum = 0;
+    FpgaSharedStream::Frame response{};
+    for (uint64_t done = 0; done < iterations;) {
+      const uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(batch_, iterations - done));
+      peer_.Rewind();
+      peer_.PublishRx(count);
+      const uint64_t t0 = now_ns();
+      for (uint32_t i = 0; i < count; ++i) {
+        stream_.Receive(&response);
+        sum += response.word0;
+      }
+      elapsed += now_ns() - t0;
+      done += count;
+    }
+    sink_ += sum;
+    return elapsed;
+  }
+
+  uint64_t JournalAppend(uint64_t iterations) {
+    const uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      journal_.Append(BridgeJournal::kTx, events_[static_cast<uint32_t>(i) & (kInputs - 1u)]);
+    }
+    return now_ns() - t0;
+  }
+
+  uint64_t BookUpdate(uint64_t iterations) {
+    uint64_t applied = 0;
+    const uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      applied += book_.ApplyEvent(events_[static_cast<uint32_t>(i) & (kInputs - 1u)]) ? 1u : 0u;
+    }
+    const uint64_t elapsed = now_ns() - t0;
+    sink_ += applied;
+    return elapsed;
+  }
+
+  uint64_t Strategy(uint64_t iterations) {
+    const SwOrderBook::ImbalanceStrategy strategy = SwOrderBook::ImbalanceStrategy::Default();
+    uint64_t sum = 0;
+    const uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      const uint32_t k = static_cast<uint32_t>(i) & (kInputs - 1u);
+      const SwOrderBook::TopOfBook& top = tops_[k];
+      const uint32_t spread = SwOrderBook::Spread(top);
+      const int32_t imbalance = SwOrderBook::Imbalance(top);
+      sum += strategy.Decide(book_, events_[k].word1, top, spread, imbalance) + spread;
+    }
+    const uint64_t elapsed = now_ns() - t0;
+    sink_ += sum;
+    return elapsed;
+  }
+
+  std::vector<FpgaSharedStream::Frame> events_;
+  std::vector<char> encoded_;
+  std::vector<uint32_t> offsets_;
+  std::vector<uint8_t> resets_;
+  std::vector<const char*> names_;
+  std::vector<const char*> sides_;
+  std::vector<int64_t> cents_;
+  std::vector<FpgaSharedStream::Frame> frames_;
+  std::vector<SwOrderBook::TopOfBook> tops_;
+  MfastArenaAllocator alloc_;
+  mfast::fast_decoder decoder_;
+  FpgaFilePeer peer_;
+  FpgaSharedStream stream_;
+  uint32_t batch_;
+  BridgeJournal journal_;
+  SwOrderBook book_;
+  uint64_t sink_;
+};
+
+bool selected(const std::string& stages, const char* name) {
+  return stages.empty() || ("," + stages + ",").find(std::string(",") + name + ",") !=
+                               std::string::npos;
+}
+
+void print_json(const Options& options, const BenchStats& stats,
+                const std::vector<uint64_t>& heap_allocations, double fast_bytes_per_msg,
+                const BenchStats* baseline, uint64_t checksum, uint64_t* regressions) {
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "{\n";
+  std::cout << "  \"iterations\": " << options.iterations << ",\n";
+  std::cout << "  \"repeat\": " << options.repeat << ",\n";
+  std::cout << "  \"sw_level_kernel\": \"" << SwLevelKernel::Name() << "\",\n";
+  std::cout << "  \"fast_reset_every\": " << options.fast_reset_every << ",\n";
+  std::cout << "  \"fast_bytes_per_msg\": " << fast_bytes_per_msg << ",\n";
+  std::cout << "  \"stages\": [";
+  double pipeline_ns = 0.0;
+  const std::vector<BenchStats::Metric>& metrics = stats.Metrics();
+  for (std::size_t i = 0; i < metrics.size(); ++i) {
+    const BenchStats::Summary s = BenchStats::Summarize(metrics[i].samples);
+    pipeline_ns += s.median;
+    std::cout << (i == 0 ? "\n" : ",\n");
+    std::cout << "    {\"stage\": \"" << metrics[i].name.substr(0, metrics[i].name.size() - 3)
+              << "\", \"median_ns\": " << s.median
+              << ", \"mean_ns\": " << s.mean
+              << ", \"min_ns\": " << s.min
+              << ", \"stddev_ns\": " << s.stddev
+              << ", \"ci95_low_ns\": " << s.ci95_low
+              << ", \"ci95_high_ns\": " << s.ci95_high
+              << ", \"arena_heap_allocations\": " << heap_allocations[i] << "}";
+  }
+  std::cout << (metrics.empty() ? "],\n" : "\n  ],\n");
+  if (baseline != nullptr) {
+    std::cout << "  \"compare\": [";
+    bool first = true;
+    for (std::size_t i = 0; i < metrics.size(); ++i) {
+      const BenchStats::Metric* base = baseline->Find(metrics[i].name);
+      if (base == nullptr) {
+        continue;
+      }
+      const BenchStats::Comparison c = BenchStats::Compare(*base, metrics[i]);
+      *regressions += c.regression ? 1 : 0;
+      std::cout << (first ? "\n" : ",\n");
+      first = false;
+      std::cout << "    {\"metric\": \"" << metrics[i].name
+                << "\", \"baseline_mean\": " << c.baseline_mean
+                << ", \"mean\": " << c.mean
+                << ", \"change_pct\": " << c.change_pct
+                << ", \"significant\": " << (c.significant ? "true" : "false")
+                << ", \"regression\": " << (c.regression ? "true" : "false") << "}";
+    }
+    std::cout << (first ? "],\n" : "\n  ],\n");
+    std::cout << "  \"pass_compare\": " << (*regressions == 0 ? "true" : "false") << ",\n";
+  }
+  // Sum of the stage medians: one feed entry from bytes to decision.
+  std::cout << "  \"pipeline_ns\": " << pipeline_ns << ",\n";
+  std::cout << "  \"checksum\": " << checksum << "\n";
+  std::cout << "}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options{};
+  if (!parse_args(argc, argv, &options)) {
+    return 2;
+  }
+  BenchStats baseline;
+  if (!options.compare.empty()) {
+    uint64_t bad_line = 0;
+    if (!baseline.Load(options.compare, &bad_line)) {
+      std::cerr << "Failed to read baseline " << options.compare << " (line " << bad_line
+                << ")\n";
+      return 2;
+    }
+  }
+
+  Microbench bench;
+  if (!bench.Init(static_cast<uint32_t>(options.fast_reset_every))) {
+    return 1;
+  }
+
+  std::size_t count = 0;
+  const Microbench::Stage* stages = Microbench::Stages(&count);
+  BenchStats stats;
+  std::vector<uint64_t> heap_allocations;
+  for (std::size_t s = 0; s < count; ++s) {
+    if (!selected(options.stages, stages[s].name)) {
+      continue;
+    }
+    (bench.*stages[s].run)(options.iterations);
+    const uint64_t heap_before = bench.HeapAllocations();
+    for (uint64_t r = 0; r < options.repeat; ++r) {
+      const uint64_t elapsed = (bench.*stages[s].run)(options.iterations);
+      stats.Add(std::string(stages[s].name) + "_ns", BenchStats::kLowerIsBetter,
+                static_cast<double>(elapsed) / static_cast<double>(options.iterations));
+    }
+    heap_allocations.push_back(bench.HeapAllocations() - heap_before);
+  }
+  if (stats.Metrics().empty()) {
+    std::cerr << "No stage matches --stage " << options.stages << "\n";
+    return 2;
+  }
+
+  if (!options.save_baseline.empty() && !stats.Save(options.save_baseline, "hft_microbench")) {
+    std::cerr << "Failed to write baseline " << options.save_baseline << "\n";
+    return 1;
+  }
+  uint64_t regressions = 0;
+  print_json(options, stats, heap_allocations, bench.FastBytesPerMessage(),
+             options.compare.empty() ? nullptr : &baseline, bench.Sink(), &regressions);
+  return regressions == 0 ? 0 : 1;
+}
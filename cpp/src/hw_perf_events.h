@@ -0,0 +1,160 @@
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// CPU counters for the calling thread through perf_event_open(2): cycles,
+// instructions, cache misses and branch misses (user space only), plus
+// context switches (a kernel software event).
+//
+// Each counter is opened on its own rather than as a group, so a machine or
+// VM without a PMU still gets whatever it has. A counter that fails to open
+// is marked invalid in every Counts, and the others keep working. When the
+// kernel multiplexes counters, the values are scaled by enabled / running
+// time. Start() and Stop() are one ioctl per counter, so a phase should span
+// thousands of messages for the skew between counters not to matter.
+class HwPerfEvents {
+ public:
+  enum Counter {
+    kCycles = 0,
+    kInstructions,
+    kCacheMisses,
+    kBranchMisses,
+    kContextSwitches,
+    kNumCounters
+  };
+
+  struct Counts {
+    bool valid[kNumCounters];
+    uint64_t value[kNumCounters];
+  };
+
+  static const char* Name(Counter counter) {
+    switch (counter) {
+      case kCycles:
+        return "cycles";
+      case kInstructions:
+        return "instructions";
+      case kCacheMisses:
+        return "cache_misses";
+      case kBranchMisses:
+        return "branch_misses";
+      case kContextSwitches:
+        return "context_switches";
+      default:
+        return "unknown";
+    }
+  }
+
+  HwPerfEvents() {
+    for (int i = 0; i < kNumCounters; ++i) {
+      fds_[i] = -1;
+    }
+  }
+  ~HwPerfEvents() { Close(); }
+
+  HwPerfEvents(const HwPerfEvents&) = delete;
+  HwPerfEvents& operator=(const HwPerfEvents&) = delete;
+
+  // Opens every counter it can for the calling thread, disabled. Fails only
+  // when none opens; `error` names each counter that did not, and why.
+  bool Open(std::string* error) {
+    Close();
+    error->clear();
+    static const struct {
+      uint32_t type;
+      uint64_t config;
+    } kEvents[kNumCounters] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+    bool any = false;
+    for (int i = 0; i < kNumCounters; ++i) {
+      // Switches happen in the kernel; counting them needs kernel events,
+      // which perf_event_paranoid >= 2 only allows to privileged users.
+      const bool user_only = kEvents[i].type == PERF_TYPE_HARDWARE;
+      fds_[i] = OpenCounter(kEvents[i].type, kEvents[i].config, user_only);
+      if (fds_[i] < 0) {
+        if (!error->empty()) {
+          *error += "; ";
+        }
+        *error += std::string(Name(static_cast<Counter>(i))) + ": " + std::strerror(errno);
+      }
+      any = any || fds_[i] >= 0;
+    }
+    return any;
+  }
+
+  bool IsOpen(Counter counter) const { return fds_[counter] >= 0; }
+
+  void Close() {
+    for (int i = 0; i < kNumCounters; ++i) {
+      if (fds_[i] >= 0) {
+        close(fds_[i]);
+        fds_[i] = -1;
+      }
+    }
+  }
+
+  void Start() {
+    for (int i = 0; i < kNumCounters; ++i) {
+      if (fds_[i] >= 0) {
+        ioctl(fds_[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  // Counts since Start(); a counter that never got scheduled is invalid.
+  Counts Stop() {
+    Counts counts{};
+    for (int i = 0; i < kNumCounters; ++i) {
+      if (fds_[i] >= 0) {
+        ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+    for (int i = 0; i < kNumCounters; ++i) {
+      uint64_t data[3] = {0, 0, 0};  // value, time enabled, time running
+      if (fds_[i] < 0 || read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+        continue;
+      }
+      if (data[2] == 0) {
+        counts.valid[i] = data[1] == 0;
+        continue;
+      }
+      counts.valid[i] = true;
+      counts.value[i] = data[2] >= data[1]
+                            ? data[0]
+                            : static_cast<uint64_t>(static_cast<double>(data[0]) *
+                                                    static_cast<double>(data[1]) /
+                                                    static_cast<double>(data[2]));
+    }
+    return counts;
+  }
+
+ private:
+  static int OpenCounter(uint32_t type, uint64_t config, bool user_only) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = user_only ? 1 : 0;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  int fds_[kNumCounters];
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed-size log-linear latency histogram (HdrHistogram layout).
+//
+// Values below 2 * kSubBuckets are counted exactly. Above that, every power
+// of two is split into kSubBuckets equal buckets, so a recorded value is
+// off by less than 1 / kSubBuckets (under 0.8%). Values up to 2^kMaxBits ns
+// (about 18 minutes) are covered; larger ones land in the last bucket and are
+// counted in Saturated(). Recording is a count-leading-zeros, a shift and an
+// increment, and never allocates, so it can run inside measurement loops.
+// Count, min, max and mean are exact.
+class LatencyHistogram {
+ public:
+  static const uint32_t kSubBucketBits = 7;
+  static const uint32_t kSubBuckets = 1u << kSubBucketBits;
+  static const uint32_t kMaxBits = 40;
+  static const uint32_t kBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+  LatencyHistogram() : counts_(kBuckets, 0), count_(0), sum_(0), min_(0), max_(0), saturated_(0) {}
+
+  void Reset() {
+    counts_.assign(kBuckets, 0);
+    count_ = 0;
+    sum_ = 0;
+    min_ = 0;
+    max_ = 0;
+    saturated_ = 0;
+  }
+
+  void Record(uint64_t value) {
+    if (value >> kMaxBits != 0) {
+      ++saturated_;
+    }
+    ++counts_[BucketOf(value)];
+    if (count_ == 0 || value < min_) {
+      min_ = value;
+    }
+    if (value > max_) {
+      max_ = value;
+    }
+    sum_ += value;
+    ++count_;
+  }
+
+  // Adds `other`'s samples, e.g. per-thread histograms into one.
+  void Merge(const LatencyHistogram& other) {
+    if (other.count_ == 0) {
+      return;
+    }
+    for (uint32_t i = 0; i < kBuckets; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    if (count_ == 0 || other.min_ < min_) {
+      min_ = other.min_;
+    }
+    if (other.max_ > max_) {
+      max_ = other.max_;
+    }
+    sum_ += other.sum_;
+    count_ += other.count_;
+    saturated_ += other.saturated_;
+  }
+
+  uint64_t Count() const { return count_; }
+  uint64_t Min() const { return min_; }
+  uint64_t Max() const { return max_; }
+  uint64_t Saturated() const { return saturated_; }
+  double Mean() const { return count_ == 0 ? 0.0 : static_cast<double>(sum_) / count_; }
+
+  // Value at quantile `fraction` (0..1]: the top of the bucket holding that
+  // rank, clamped to [Min(), Max()].
+  uint64_t ValueAt(double fraction) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(count_) + 0.5);
+    rank = rank == 0 ? 1 : (rank > count_ ? count_ : rank);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kBuckets; ++i) {
+      seen += counts_[i];
+      if (seen >= rank) {
+        const uint64_t top = BucketTop(i);
+        return top < max_ ? (top > min_ ? top : min_) : max_;
+      }
+    }
+    return max_;
+  }
+
+  static uint32_t BucketOf(uint64_t value) {
+    if (value >> kMaxBits != 0) {
+      return kBuckets - 1;
+    }
+    if (value < 2u * kSubBuckets) {
+      return static_cast<uint32_t>(value);
+    }
+    const uint32_t msb = 63u - static_cast<uint32_t>(__builtin_clzll(value));
+    const uint32_t shift = msb - kSubBucketBits;
+    return shift * kSubBuckets + static_cast<uint32_t>(value >> shift);
+  }
+
+  // Largest value that maps to bucket `index`.
+  static uint64_t BucketTop(uint32_t index) {
+    if (index < 2u * kSubBuckets) {
+      return index;
+    }
+    const uint32_t shift = index / kSubBuckets - 1u;
+    const uint64_t mantissa = index - shift * kSubBuckets;
+    return ((mantissa + 1u) << shift) - 1u;
+  }
+
+ private:
+  std::vector<uint64_t> counts_;
+  uint64_t count_;
+  uint64_t sum_;
+  uint64_t min_;
+  uint64_t max_;
+  uint64_t saturated_;
+};
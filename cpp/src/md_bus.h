@@ -0,0 +1,383 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <signal.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+// Single-producer, multi-consumer market-data bus in shared memory.
+//
+// One process (fast_receiver) publishes decoded level events and book/FPGA
+// responses once. Any number of local processes map the same file and read
+// them at memory speed, without decoding or sockets of their own.
+//
+// The ring is a broadcast ring. The producer never waits for readers: it
+// overwrites the oldest slot, and each slot is a seqlock. The slot version is
+// 2 * position + 1 while it is written and 2 * position + 2 once complete, so
+// a reader can tell a slot it was copying got reused under it. Each reader
+// keeps its own cursor. A reader that falls more than Capacity() messages
+// behind is lapped: it counts the skipped messages in Lost() and resumes
+// at the oldest message still in the ring.
+//
+// Readers also register in a table in the header (pid, cursor, lost), so
+// the producer or a monitor can see who is lagging without asking them.
+//
+// Layout (little-endian, 64-byte lines):
+//   line 0        magic, version, capacity, slot bytes, writer pid
+//   line 1        write position (messages published so far)
+//   lines 2..17   reader table, one line per reader
+//   then          `capacity` slots of 64 bytes
+class MdBus {
+ public:
+  static const uint32_t kMagic = 0x5355424Du;  // "MBUS"
+  static const uint32_t kVersion = 1;
+  static const uint32_t kMaxReaders = 16;
+  static const uint32_t kDefaultCapacity = 65536;
+  static const char* DefaultPath() { return "/dev/shm/hft_md_bus"; }
+
+  enum Kind {
+    // Level event as sent to the FPGA or software book.
+    kEvent = 1,
+    // The FPGA's or software book's response to an event.
+    kResponse = 2,
+  };
+
+  struct Message {
+    // Bus position, 0-based, gapless for the producer.
+    uint64_t position;
+    // Producer CLOCK_MONOTONIC at publish, comparable across processes.
+    uint64_t publish_ns;
+    uint32_t kind;
+    FpgaSharedStream::Frame frame;
+  };
+
+  struct ReaderInfo {
+    uint32_t pid;
+    uint64_t cursor;
+    uint64_t lost;
+  };
+
+  static uint64_t NowNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(ts.tv_nsec);
+  }
+
+ private:
+  static const std::size_t kLine = 64;
+
+  struct ReaderSlot {
+    std::atomic<uint32_t> pid;
+    std::atomic<uint64_t> cursor;
+    std::atomic<uint64_t> lost;
+    char pad[kLine - 3 * sizeof(uint64_t)];
+  };
+
+  struct Slot {
+    std::atomic<uint64_t> version;
+    uint64_t publish_ns;
+    uint32_t kind;
+    uint32_t reserved;
+    FpgaSharedStream::Frame frame;
+    char pad[kLine - 3 * sizeof(uint64_t) - sizeof(FpgaSharedStream::Frame)];
+  };
+
+  struct Layout {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t slot_bytes;
+    uint32_t writer_pid;
+    char pad0[kLine - 5 * sizeof(uint32_t)];
+    std::atomic<uint64_t> write_position;
+    char pad1[kLine - sizeof(uint64_t)];
+    ReaderSlot readers[kMaxReaders];
+  };
+
+  static_assert(sizeof(ReaderSlot) == kLine, "reader table entries are one line");
+  static_assert(sizeof(Slot) == kLine, "bus slots are one line");
+
+  static std::size_t BytesFor(uint32_t capacity) {
+    return sizeof(Layout) + static_cast<std::size_t>(capacity) * sizeof(Slot);
+  }
+
+  static Slot* SlotsOf(Layout* layout) {
+    return reinterpret_cast<Slot*>(reinterpret_cast<char*>(layout) + sizeof(Layout));
+  }
+
+  // The bus relies on address-free atomics in the shared mapping.
+  static bool LockFree(std::string* error) {
+    std::atomic<uint64_t> probe(0);
+    if (!probe.is_lock_free()) {
+      *error = "64-bit atomics are not lock-free on this target";
+      return false;
+    }
+    return true;
+  }
+
+  static std::vector<ReaderInfo> ListReaders(Layout* layout, bool reap) {
+    std::vector<ReaderInfo> readers;
+    for (uint32_t i = 0; i < kMaxReaders; ++i) {
+      ReaderInfo info{};
+      info.pid = layout->readers[i].pid.load(std::memory_order_acquire);
+      if (info.pid == 0) {
+        continue;
+      }
+      if (reap && kill(static_cast<pid_t>(info.pid), 0) != 0 && errno == ESRCH) {
+        uint32_t expected = info.pid;
+        layout->readers[i].pid.compare_exchange_strong(expected, 0);
+        continue;
+      }
+      info.cursor = layout->readers[i].cursor.load(std::memory_order_relaxed);
+      info.lost = layout->readers[i].lost.load(std::memory_order_relaxed);
+      readers.push_back(info);
+    }
+    return readers;
+  }
+
+ public:
+  class Writer {
+   public:
+    Writer() : map_(nullptr), bytes_(0), mask_(0), position_(0) {}
+    ~Writer() { Close(); }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // Replaces any bus at `path`. The old file is unlinked rather than
+    // truncated, so readers still mapping it keep a stale but valid view.
+    // `capacity` is rounded up to a power of two.
+    bool Create(const std::string& path, uint32_t capacity, std::string* error) {
+      Close();
+      uint32_t slots = 2;
+      while (slots < capacity && slots < (1u << 30)) {
+        slots <<= 1;
+      }
+      if (!LockFree(error)) {
+        return false;
+      }
+      unlink(path.c_str());
+      const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+      if (fd < 0) {
+        *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+      }
+      const std::size_t bytes = BytesFor(slots);
+      if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        *error = "ftruncate " + path + ": " + std::strerror(errno);
+        close(fd);
+        return false;
+      }
+      void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (map == MAP_FAILED) {
+        *error = "mmap " + path + ": " + std::strerror(errno);
+        return false;
+      }
+      map_ = static_cast<Layout*>(map);
+      bytes_ = bytes;
+      mask_ = slots - 1;
+      position_ = 0;
+
+      new (&map_->write_position) std::atomic<uint64_t>(0);
+      for (uint32_t i = 0; i < kMaxReaders; ++i) {
+        new (&map_->readers[i].pid) std::atomic<uint32_t>(0);
+        new (&map_->readers[i].cursor) std::atomic<uint64_t>(0);
+        new (&map_->readers[i].lost) std::atomic<uint64_t>(0);
+      }
+      Slot* slots_base = SlotsOf(map_);
+      for (uint32_t i = 0; i < slots; ++i) {
+        new (&slots_base[i].version) std::atomic<uint64_t>(0);
+      }
+      map_->capacity = slots;
+      map_->slot_bytes = sizeof(Slot);
+      map_->version = kVersion;
+      map_->writer_pid = static_cast<uint32_t>(getpid());
+      std::atomic_thread_fence(std::memory_order_release);
+      // Written last, so a reader attaching mid-create rejects the file.
+      map_->magic = kMagic;
+      return true;
+    }
+
+    void Close() {
+      if (map_ != nullptr) {
+        munmap(map_, bytes_);
+        map_ = nullptr;
+      }
+    }
+
+    bool IsOpen() const { return map_ != nullptr; }
+    uint32_t Capacity() const { return static_cast<uint32_t>(mask_ + 1); }
+    uint64_t Published() const { return position_; }
+
+    void Publish(uint32_t kind, const FpgaSharedStream::Frame& frame) {
+      Slot& slot = SlotsOf(map_)[position_ & mask_];
+      slot.version.store(2 * position_ + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      slot.publish_ns = NowNs();
+      slot.kind = kind;
+      slot.frame = frame;
+      slot.version.store(2 * position_ + 2, std::memory_order_release);
+      ++position_;
+      map_->write_position.store(position_, std::memory_order_release);
+    }
+
+    // Registered readers, with slots of exited processes released.
+    std::vector<ReaderInfo> Readers() { return ListReaders(map_, true); }
+
+   private:
+    Layout* map_;
+    std::size_t bytes_;
+    uint64_t mask_;
+    uint64_t position_;
+  };
+
+  class Reader {
+   public:
+    Reader() : map_(nullptr), bytes_(0), mask_(0), cursor_(0), lost_(0), index_(kMaxReaders) {}
+    ~Reader() { Detach(); }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    // Maps the bus at `path` and starts at the next message published, or at
+    // the oldest one still held with `from_oldest`. Fails if the reader table
+    // is full.
+    bool Attach(const std::string& path, bool from_oldest, std::string* error) {
+      Detach();
+      if (!LockFree(error)) {
+        return false;
+      }
+      const int fd = open(path.c_str(), O_RDWR);
+      if (fd < 0) {
+        *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+      }
+      struct stat st;
+      if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < BytesFor(2)) {
+        *error = path + " is not a market-data bus";
+        close(fd);
+        return false;
+      }
+      const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+      void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (map == MAP_FAILED) {
+        *error = "mmap " + path + ": " + std::strerror(errno);
+        return false;
+      }
+      Layout* layout = static_cast<Layout*>(map);
+      const uint32_t magic = layout->magic;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const uint32_t capacity = layout->capacity;
+      if (magic != kMagic || layout->version != kVersion || layout->slot_bytes != sizeof(Slot) ||
+          capacity < 2 || (capacity & (capacity - 1)) != 0 || BytesFor(capacity) > bytes) {
+        *error = path + " is not a version " + std::to_string(kVersion) + " market-data bus";
+        munmap(map, bytes);
+        return false;
+      }
+      const uint32_t pid = static_cast<uint32_t>(getpid());
+      uint32_t index = kMaxReaders;
+      for (uint32_t i = 0; i < kMaxReaders && index == kMaxReaders; ++i) {
+        uint32_t expected = 0;
+        if (layout->readers[i].pid.compare_exchange_strong(expected, pid)) {
+          index = i;
+        }
+      }
+      if (index == kMaxReaders) {
+        *error = "reader table of " + path + " is full";
+        munmap(map, bytes);
+        return false;
+      }
+      map_ = layout;
+      bytes_ = bytes;
+      mask_ = capacity - 1;
+      index_ = index;
+      lost_ = 0;
+      const uint64_t head = map_->write_position.load(std::memory_order_acquire);
+      cursor_ = from_oldest && head > capacity ? head - capacity : (from_oldest ? 0 : head);
+      map_->readers[index_].lost.store(0, std::memory_order_relaxed);
+      map_->readers[index_].cursor.store(cursor_, std::memory_order_relaxed);
+      return true;
+    }
+
+    void Detach() {
+      if (map_ != nullptr) {
+        map_->readers[index_].pid.store(0, std::memory_order_release);
+        munmap(map_, bytes_);
+        map_ = nullptr;
+        index_ = kMaxReaders;
+      }
+    }
+
+    bool IsAttached() const { return map_ != nullptr; }
+    uint32_t Capacity() const { return static_cast<uint32_t>(mask_ + 1); }
+
+    // Next message, or false when caught up. Never blocks the producer; when
+    // lapped, skips to the oldest message still held and counts the gap.
+    bool Poll(Message* out) {
+      while (true) {
+        const uint64_t head = map_->write_position.load(std::memory_order_acquire);
+        if (cursor_ == head) {
+          return false;
+        }
+        if (head - cursor_ > mask_ + 1) {
+          Skip(head - (mask_ + 1));
+        }
+        const Slot& slot = SlotsOf(map_)[cursor_ & mask_];
+        const uint64_t expected = 2 * cursor_ + 2;
+        const uint64_t before = slot.version.load(std::memory_order_acquire);
+        if (before == expected) {
+          out->position = cursor_;
+          out->publish_ns = slot.publish_ns;
+          out->kind = slot.kind;
+          out->frame = slot.frame;
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (slot.version.load(std::memory_order_relaxed) == expected) {
+            ++cursor_;
+            map_->readers[index_].cursor.store(cursor_, std::memory_order_relaxed);
+            return true;
+          }
+        }
+        // The producer reused the slot: this reader was lapped mid-read.
+        Skip(cursor_ + 1);
+      }
+    }
+
+    uint64_t Lost() const { return lost_; }
+    uint64_t Published() const {
+      return map_->write_position.load(std::memory_order_acquire);
+    }
+    // Messages published but not yet read.
+    uint64_t Lag() const { return Published() - cursor_; }
+    uint32_t WriterPid() const { return map_->writer_pid; }
+    std::vector<ReaderInfo> Readers() const { return ListReaders(map_, false); }
+
+   private:
+    void Skip(uint64_t cursor) {
+      lost_ += cursor - cursor_;
+      cursor_ = cursor;
+      map_->readers[index_].lost.store(lost_, std::memory_order_relaxed);
+    }
+
+    Layout* map_;
+    std::size_t bytes_;
+    uint64_t mask_;
+    uint64_t cursor_;
+    uint64_t lost_;
+    uint32_t index_;
+  };
+};
@@ -0,0 +1,176 @@
+#include "latency_histogram.h"
+#include "md_bus.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <time.h>
+#include <vector>
+
+namespace {
+
+// Example consumer of the market-data bus fast_receiver publishes with
+// HFT_MD_BUS: prints events and responses as they arrive, or just counts them
+// (--quiet), and reports how many it lost to being lapped and how long
+// messages took from publish to read.
+
+struct Options {
+  std::string path;
+  bool from_oldest;
+  bool quiet;
+  bool spin;
+  bool list;
+  uint64_t count;
+  uint64_t idle_us;
+};
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void on_signal(int) { g_stop = 1; }
+
+bool parse_u64(const char* text, uint64_t* out) {
+  if (text == nullptr || out == nullptr) {
+    return false;
+  }
+  errno = 0;
+  char* end = nullptr;
+  const unsigned long long value = std::strtoull(text, &end, 0);
+  if (errno != 0 || end == text || *end != '\0') {
+    return false;
+  }
+  *out = static_cast<uint64_t>(value);
+  return true;
+}
+
+void usage(const char* argv0) {
+  std::cerr << "Usage: " << argv0
+            << " [--path FILE] [--from-oldest] [--count N] [--quiet] [--spin | --idle-us N]"
+               " [--list]\n";
+}
+
+bool parse_args(int argc, char** argv, Options* options) {
+  options->path = MdBus::DefaultPath();
+  options->from_oldest = false;
+  options->quiet = false;
+  options->spin = false;
+  options->list = false;
+  options->count = 0;
+  options->idle_us = 50;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    if (arg == "--help" || arg == "-h") {
+      usage(argv[0]);
+      std::exit(0);
+    }
+    if ((arg == "--path" || arg == "--count" || arg == "--idle-us") && i + 1 >= argc) {
+      usage(argv[0]);
+      return false;
+    }
+    if (arg == "--path") {
+      options->path = argv[++i];
+    } else if (arg == "--count") {
+      if (!parse_u64(argv[++i], &options->count)) {
+        std::cerr << "Invalid --count value\n";
+        return false;
+      }
+    } else if (arg == "--idle-us") {
+      if (!parse_u64(argv[++i], &options->idle_us) || options->idle_us >= 1000000) {
+        std::cerr << "Invalid --idle-us value\n";
+        return false;
+      }
+    } else if (arg == "--from-oldest") {
+      options->from_oldest = true;
+    } else if (arg == "--quiet") {
+      options->quiet = true;
+    } else if (arg == "--spin") {
+      options->spin = true;
+    } else if (arg == "--list") {
+      options->list = true;
+    } else {
+      usage(argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+void print_message(const MdBus::Message& message) {
+  const FpgaSharedStream::Frame& f = message.frame;
+  if (message.kind == MdBus::kEvent) {
+    std::cout << "[EVENT] pos=" << message.position << " seq=" << f.word0
+              << " symbol=" << f.word1 << " price_1e4=" << f.word2 << " qty=" << f.word3
+              << " type=" << f.word4 << " side=" << f.word5 << "\n";
+  } else {
+    std::cout << "[RESPONSE] pos=" << message.position << " seq=" << f.word0
+              << " action=" << f.word1 << " best_bid_px_1e4=" << f.word2
+              << " best_bid_qty=" << f.word3 << " best_ask_px_1e4=" << f.word4
+              << " best_ask_qty=" << f.word5 << " spread_1e4=" << f.word6
+              << " imbalance=" << static_cast<int32_t>(f.word7) << "\n";
+  }
+}
+
+void print_readers(const std::vector<MdBus::ReaderInfo>& readers, uint64_t head) {
+  for (const MdBus::ReaderInfo& reader : readers) {
+    std::cout << "reader pid=" << reader.pid << " cursor=" << reader.cursor
+              << " lag=" << head - reader.cursor << " lost=" << reader.lost << "\n";
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options{};
+  if (!parse_args(argc, argv, &options)) {
+    return 2;
+  }
+
+  MdBus::Reader reader;
+  std::string error;
+  if (!reader.Attach(options.path, options.from_oldest, &error)) {
+    std::cerr << "md_bus_reader: " << error << "\n";
+    return 1;
+  }
+  if (options.list) {
+    print_readers(reader.Readers(), reader.Published());
+    return 0;
+  }
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  LatencyHistogram latency;
+  uint64_t events = 0;
+  uint64_t responses = 0;
+  const timespec idle = {0, static_cast<long>(options.idle_us * 1000)};
+  MdBus::Message message;
+  while (!g_stop && (options.count == 0 || events + responses < options.count)) {
+    if (!reader.Poll(&message)) {
+      if (!options.spin) {
+        nanosleep(&idle, nullptr);
+      }
+      continue;
+    }
+    const uint64_t now = MdBus::NowNs();
+    latency.Record(now > message.publish_ns ? now - message.publish_ns : 0);
+    if (message.kind == MdBus::kEvent) {
+      ++events;
+    } else {
+      ++responses;
+    }
+    if (!options.quiet) {
+      print_message(message);
+    }
+  }
+
+  std::cout << "md_bus_reader: events=" << events << " responses=" << responses
+            << " lost=" << reader.Lost() << " lag=" << reader.Lag()
+            << " latency_p50_ns=" << latency.ValueAt(0.50)
+            << " latency_p99_ns=" << latency.ValueAt(0.99)
+            << " latency_max_ns=" << latency.Max() << "\n";
+  return 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "tick_arena.h"
+
+#include <mfast/allocator.h>
+
+// mFAST allocator hook backed by a TickArena. Pass it to the fast_encoder or
+// fast_decoder and to recycled message objects, e.g.
+//
+//   MfastArenaAllocator alloc;
+//   mfast::fast_decoder decoder(&alloc);
+//
+// Declare it before them: it must outlive everything it allocated for.
+class MfastArenaAllocator : public mfast::allocator {
+ public:
+  void* allocate(std::size_t bytes) override { return arena_.Allocate(bytes); }
+
+  std::size_t reallocate(void*& pointer, std::size_t old_size, std::size_t new_size) override {
+    return arena_.Reallocate(pointer, old_size, new_size);
+  }
+
+  void deallocate(void* pointer, std::size_t) override { arena_.Deallocate(pointer); }
+
+  TickArena& arena() { return arena_; }
+  const TickArena::Stats& stats() const { return arena_.GetStats(); }
+
+ private:
+  TickArena arena_;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "latency_histogram.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Outstanding-request table for pipelined traffic over FpgaSharedStream.
+//
+// Requests are keyed by their sequence number (frame word0). The table is a
+// power-of-two ring indexed by `seq & mask`, sized well above the maximum
+// number of in-flight requests so completed entries stay around long enough
+// to recognise duplicated responses. All storage is allocated up front.
+//
+// Each request may carry an intended send time next to the actual one. For
+// open-loop traffic on a fixed schedule the RTT from the intended time is the
+// latency a client of that schedule sees, including time spent waiting to be
+// sent (no coordinated omission). Both RTTs go into LatencyHistograms.
+class OutstandingTracker {
+ public:
+  enum ResponseStatus {
+    kMatched = 0,    // first response for a pending request
+    kDuplicate = 1,  // second response for an already completed request
+    kUnknown = 2,    // no request with this sequence number is tracked
+  };
+
+  struct Stats {
+    uint64_t sent;
+    uint64_t matched;
+    uint64_t duplicates;
+    uint64_t unknown;
+    uint64_t reordered;
+    uint64_t lost;
+  };
+
+  struct LatencySummary {
+    uint64_t count;
+    double min_ns;
+    double avg_ns;
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+  };
+
+  OutstandingTracker() : mask_(0), highest_matched_seq_(0), any_matched_(false), stats_{} {}
+
+  // `max_outstanding` bounds in-flight requests.
+  void Reset(uint64_t max_outstanding) {
+    uint64_t capacity = 64;
+    while (capacity < max_outstanding * 4) {
+      capacity <<= 1;
+    }
+    entries_.assign(static_cast<std::size_t>(capacity), Entry());
+    mask_ = capacity - 1;
+    latency_ns_.Reset();
+    intended_latency_ns_.Reset();
+    highest_matched_seq_ = 0;
+    any_matched_ = false;
+    stats_ = Stats{};
+  }
+
+  void OnSend(uint32_t seq, uint64_t send_ns) { OnSend(seq, send_ns, send_ns); }
+
+  void OnSend(uint32_t seq, uint64_t send_ns, uint64_t intended_ns) {
+    Entry& entry = entries_[seq & mask_];
+    if (entry.state == kPending) {
+      // The slot is being reused while its request never completed.
+      ++stats_.lost;
+    }
+    entry.seq = seq;
+    entry.state = kPending;
+    entry.send_ns = send_ns;
+    entry.intended_ns = intended_ns;
+    ++stats_.sent;
+  }
+
+  ResponseStatus OnResponse(uint32_t seq, uint64_t recv_ns) {
+    Entry& entry = entries_[seq & mask_];
+    if (entry.seq != seq || entry.state == kEmpty) {
+      ++stats_.unknown;
+      return kUnknown;
+    }
+    if (entry.state == kDone) {
+      ++stats_.duplicates;
+      return kDuplicate;
+    }
+
+    entry.state = kDone;
+    ++stats_.matched;
+    if (any_matched_ && SeqBefore(seq, highest_matched_seq_)) {
+      ++stats_.reordered;
+    } else {
+      highest_matched_seq_ = seq;
+      any_matched_ = true;
+    }
+    latency_ns_.Record(recv_ns >= entry.send_ns ? recv_ns - entry.send_ns : 0);
+    intended_latency_ns_.Record(recv_ns >= entry.intended_ns ? recv_ns - entry.intended_ns : 0);
+    return kMatched;
+  }
+
+  // Counts every still-pending request as lost. Call once at end of run.
+  void Finish() {
+    for (Entry& entry : entries_) {
+      if (entry.state == kPending) {
+        entry.state = kEmpty;
+        ++stats_.lost;
+      }
+    }
+  }
+
+  uint64_t Matched() const { return stats_.matched; }
+  uint64_t Pending() const { return stats_.sent - stats_.matched - stats_.lost; }
+  const Stats& GetStats() const { return stats_; }
+
+  // RTT from the actual send.
+  const LatencyHistogram& Latency() const { return latency_ns_; }
+  // RTT from the intended send time.
+  const LatencyHistogram& IntendedLatency() const { return intended_latency_ns_; }
+
+  LatencySummary Summarize() const { return Summarize(latency_ns_); }
+  LatencySummary SummarizeIntended() const { return Summarize(intended_latency_ns_); }
+
+  static LatencySummary Summarize(const LatencyHistogram& histogram) {
+    LatencySummary summary{};
+    summary.count = histogram.Count();
+    summary.min_ns = static_cast<double>(histogram.Min());
+    summary.max_ns = static_cast<double>(histogram.Max());
+    summary.avg_ns = histogram.Mean();
+    summary.p50_ns = static_cast<double>(histogram.ValueAt(0.50));
+    summary.p99_ns = static_cast<double>(histogram.ValueAt(0.99));
+    summary.p999_ns = static_cast<double>(histogram.ValueAt(0.999));
+    return summary;
+  }
+
+ private:
+  enum EntryState { kEmpty = 0, kPending = 1, kDone = 2 };
+
+  struct Entry {
+    Entry() : seq(0), state(kEmpty), send_ns(0), intended_ns(0) {}
+    uint32_t seq;
+    uint32_t state;
+    uint64_t send_ns;
+    uint64_t intended_ns;
+  };
+
+  // Serial-number comparison so 32-bit sequence wraparound is not reordering.
+  static bool SeqBefore(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+  }
+
+  std::vector<Entry> entries_;
+  uint64_t mask_;
+  uint32_t highest_matched_seq_;
+  bool any_matched_;
+  Stats stats_;
+  LatencyHistogram latency_ns_;
+  LatencyHistogram intended_latency_ns_;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+
+#include <cstdint>
+
+// Time-series view of the FPGA performance block.
+//
+// Every Sample() snapshots all perf registers and turns the difference to the
+// previous snapshot into a Window: per-second rates, average latency and
+// latency percentiles estimated from the log2 histogram. Histogram buckets
+// wrap in hardware and are differenced modulo 2^32, so a bucket that wrapped
+// once between two samples still yields the right delta; sample often enough
+// that none can wrap twice. PERF_COUNT and the stall counters saturate
+// instead: once pinned at 0xFFFFFFFF they stop producing deltas, which is
+// flagged per window.
+class PerfSampler {
+ public:
+  struct Snapshot {
+    uint64_t host_ns;
+    FpgaSharedStream::PerfCounters counters;
+    FpgaSharedStream::PerfHistogram histogram;
+  };
+
+  struct Window {
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint64_t responses;
+    uint64_t cmd_stall_cycles;
+    uint64_t rsp_stall_cycles;
+    double responses_per_s;
+    double cmd_stall_ratio;  // stalled cycles / elapsed FPGA cycles
+    double rsp_stall_ratio;
+    double avg_latency_cycles;
+    // Percentiles are 0 when the bitstream has no histogram.
+    uint32_t hist_buckets;
+    uint64_t hist[FpgaSharedStream::kPerfHistMaxBuckets];
+    double p50_latency_cycles;
+    double p99_latency_cycles;
+    double p999_latency_cycles;
+    bool saturated;
+  };
+
+  PerfSampler() : has_previous_(false), previous_{} {}
+
+  // Forgets the previous snapshot; call after ResetPerfCounters().
+  void Reset() { has_previous_ = false; }
+
+  // Takes a baseline snapshot without producing a window.
+  bool Start(const FpgaSharedStream& stream, uint64_t now_ns) {
+    Snapshot snapshot{};
+    if (!Capture(stream, now_ns, &snapshot)) {
+      return false;
+    }
+    previous_ = snapshot;
+    has_previous_ = true;
+    return true;
+  }
+
+  // Reads the perf registers and, if a previous snapshot exists, fills
+  // `window` with the interval since then. Returns false if no window was
+  // produced (first sample or bridge not readable).
+  bool Sample(const FpgaSharedStream& stream, uint64_t now_ns, Window* window) {
+    Snapshot snapshot{};
+    if (!Capture(stream, now_ns, &snapshot)) {
+      return false;
+    }
+    return Add(snapshot, window);
+  }
+
+  // Same as Sample() for an already captured snapshot.
+  bool Add(const Snapshot& snapshot, Window* window) {
+    const bool produced = has_previous_ && window != nullptr;
+    if (produced) {
+      *window = Diff(previous_, snapshot);
+    }
+    previous_ = snapshot;
+    has_previous_ = true;
+    return produced;
+  }
+
+  static bool Capture(const FpgaSharedStream& stream, uint64_t now_ns, Snapshot* snapshot) {
+    snapshot->host_ns = now_ns;
+    return stream.ReadPerfCounters(&snapshot->counters) &&
+           stream.ReadPerfHistogram(&snapshot->histogram);
+  }
+
+  static Window Diff(const Snapshot& from, const Snapshot& to) {
+    const FpgaSharedStream::PerfCounters& a = from.counters;
+    const FpgaSharedStream::PerfCounters& b = to.counters;
+
+    Window w{};
+    w.start_ns = from.host_ns;
+    w.duration_ns = to.host_ns - from.host_ns;
+    w.responses = Delta32(a.count, b.count);
+    w.cmd_stall_cycles = Delta32(a.cmd_stall_cycles, b.cmd_stall_cycles);
+    w.rsp_stall_cycles = Delta32(a.rsp_stall_cycles, b.rsp_stall_cycles);
+    w.saturated = b.count == 0xFFFFFFFFu || b.cmd_stall_cycles == 0xFFFFFFFFu ||
+                  b.rsp_stall_cycles == 0xFFFFFFFFu;
+
+    const double seconds = static_cast<double>(w.duration_ns) / 1000000000.0;
+    if (seconds > 0.0) {
+      w.responses_per_s = static_cast<double>(w.responses) / seconds;
+      const double fpga_cycles = seconds * static_cast<double>(b.clock_hz);
+      if (fpga_cycles > 0.0) {
+        w.cmd_stall_ratio = static_cast<double>(w.cmd_stall_cycles) / fpga_cycles;
+        w.rsp_stall_ratio = static_cast<double>(w.rsp_stall_cycles) / fpga_cycles;
+      }
+    }
+    if (w.responses > 0) {
+      w.avg_latency_cycles =
+          static_cast<double>(b.sum_latency_cycles - a.sum_latency_cycles) /
+          static_cast<double>(w.responses);
+    }
+
+    w.hist_buckets = to.histogram.buckets;
+    for (uint32_t i = 0; i < w.hist_buckets; ++i) {
+      w.hist[i] = Delta32(from.histogram.counts[i], to.histogram.counts[i]);
+    }
+    w.p50_latency_cycles = Percentile(w.hist, w.hist_buckets, 0.50);
+    w.p99_latency_cycles = Percentile(w.hist, w.hist_buckets, 0.99);
+    w.p999_latency_cycles = Percentile(w.hist, w.hist_buckets, 0.999);
+    return w;
+  }
+
+  // Lower bound of bucket i in cycles (bucket 0 starts at 0).
+  static double BucketLow(uint32_t bucket) {
+    return bucket == 0 ? 0.0 : static_cast<double>(1ull << bucket);
+  }
+
+  // Quantile `q` in cycles, interpolated linearly inside the bucket holding
+  // it. The open-ended last bucket reports its lower bound.
+  static double Percentile(const uint64_t* counts, uint32_t buckets, double q) {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < buckets; ++i) {
+      total += counts[i];
+    }
+    if (total == 0) {
+      return 0.0;
+    }
+    const double rank = q * static_cast<double>(total);
+    double below = 0.0;
+    for (uint32_t i = 0; i < buckets; ++i) {
+      const double in_bucket = static_cast<double>(counts[i]);
+      if (in_bucket > 0.0 && below + in_bucket >= rank) {
+        const double low = BucketLow(i);
+        if (i + 1 == buckets) {
+          return low;
+        }
+        const double high = BucketLow(i + 1);
+        const double fraction = (rank - below) / in_bucket;
+        return low + (high - low) * fraction;
+      }
+      below += in_bucket;
+    }
+    return BucketLow(buckets - 1);
+  }
+
+ private:
+  static uint64_t Delta32(uint32_t from, uint32_t to) {
+    return static_cast<uint32_t>(to - from);
+  }
+
+  bool has_previous_;
+  Snapshot previous_;
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+#include "sw_order_book.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+// Differential check of live responses against the software model.
+//
+// Every sent event goes through OnEvent(), which runs it through a private
+// SwOrderBook and parks the expected response in a ring indexed by
+// `seq & mask` (the same scheme as OutstandingTracker). OnResponse() looks
+// the response up by seq and compares all eight words. The first divergence
+// is kept together with the model's book for that symbol.
+//
+// Book state is per symbol, so sampling by symbol is exact: with
+// `sample_every` = N only symbols with `symbol % N == 0` are modelled and
+// compared, and every other event costs one modulo and one ring store.
+class ResponseVerifier {
+ public:
+  static const uint32_t kMaxReportDepth = 8;
+  // Sequence numbers for the RESET_BOOK frames that line up both books.
+  static const uint32_t kResetSeqBase = 0xFFFFFF00u;
+
+  enum Result {
+    kMatch = 0,
+    kMismatch = 1,
+    kSkipped = 2,  // event's symbol is not sampled
+    kUnknown = 3,  // no pending event with this seq
+  };
+
+  struct Config {
+    SwOrderBook::Config book;
+    uint32_t sample_every;
+    uint32_t max_outstanding;
+  };
+
+  struct Stats {
+    uint64_t events;
+    uint64_t compared;
+    uint64_t mismatches;
+    uint64_t skipped;
+    uint64_t unknown;
+    // Sampled events whose slot was reused before a response came back.
+    uint64_t unanswered;
+  };
+
+  struct Divergence {
+    FpgaSharedStream::Frame event;
+    FpgaSharedStream::Frame expected;
+    FpgaSharedStream::Frame actual;
+    // Bit i set when word i differs.
+    uint32_t word_mask;
+    // Model book for the event's symbol when the divergence was seen, best
+    // first. With pipelined traffic later in-flight events may be applied.
+    uint32_t depth;
+    uint32_t bid_px[kMaxReportDepth];
+    uint32_t bid_qty[kMaxReportDepth];
+    uint32_t ask_px[kMaxReportDepth];
+    uint32_t ask_qty[kMaxReportDepth];
+  };
+
+  static Config DefaultConfig() {
+    Config config{};
+    config.book = SwOrderBook::DefaultConfig();
+    config.sample_every = 1;
+    config.max_outstanding = 64;
+    return config;
+  }
+
+  ResponseVerifier() : config_{}, mask_(0), stats_{}, has_divergence_(false), divergence_{} {
+    Init(DefaultConfig());
+  }
+
+  explicit ResponseVerifier(const Config& config)
+      : config_{}, mask_(0), stats_{}, has_divergence_(false), divergence_{} {
+    Init(config);
+  }
+
+  ResponseVerifier(const ResponseVerifier&) = delete;
+  ResponseVerifier& operator=(const ResponseVerifier&) = delete;
+
+  // Starts from an empty model book, which must match the peer (see
+  // ResetFrame()).
+  bool Init(const Config& config) {
+    if (config.sample_every == 0 || config.max_outstanding == 0 || !model_.Init(config.book)) {
+      return false;
+    }
+    config_ = config;
+    uint64_t capacity = 64;
+    while (capacity < static_cast<uint64_t>(config.max_outstanding) * 4u) {
+      capacity <<= 1;
+    }
+    entries_.assign(static_cast<std::size_t>(capacity), Entry());
+    mask_ = capacity - 1;
+    stats_ = Stats{};
+    has_divergence_ = false;
+    divergence_ = Divergence{};
+    return true;
+  }
+
+  const Stats& GetStats() const { return stats_; }
+  bool HasDivergence() const { return has_divergence_; }
+  const Divergence& FirstDivergence() const { return divergence_; }
+  const SwOrderBook& Model() const { return model_; }
+
+  // RESET_BOOK for `symbol`; send one per symbol through the peer and
+  // OnEvent() before the real stream.
+  static FpgaSharedStream::Frame ResetFrame(uint32_t symbol) {
+    FpgaSharedStream::Frame frame{};
+    frame.word0 = kResetSeqBase + symbol;
+    frame.word1 = symbol;
+    frame.word4 = SwOrderBook::kEventResetBook;
+    return frame;
+  }
+
+  bool Sampled(uint32_t symbol) const { return symbol % config_.sample_every == 0; }
+
+  // Call in send order, before or right after the event goes out.
+  void OnEvent(const FpgaSharedStream::Frame& event) {
+    Entry& entry = entries_[event.word0 & mask_];
+    if (entry.state == kPending) {
+      ++stats_.unanswered;
+    }
+    ++stats_.events;
+    entry.seq = event.word0;
+    if (!Sampled(event.word1)) {
+      entry.state = kUnsampled;
+      return;
+    }
+    entry.state = kPending;
+    entry.event = event;
+    entry.expected = model_.Process(event);
+  }
+
+  Result OnResponse(const FpgaSharedStream::Frame& response) {
+    Entry& entry = entries_[response.word0 & mask_];
+    if (entry.seq != response.word0 || entry.state == kEmpty || entry.state == kDone) {
+      ++stats_.unknown;
+      return kUnknown;
+    }
+    if (entry.state == kUnsampled) {
+      entry.state = kDone;
+      ++stats_.skipped;
+      return kSkipped;
+    }
+    entry.state = kDone;
+    ++stats_.compared;
+    const uint32_t word_mask = Diff(entry.expected, response);
+    if (word_mask == 0) {
+      return kMatch;
+    }
+    ++stats_.mismatches;
+    if (!has_divergence_) {
+      Capture(entry, response, word_mask);
+    }
+    return kMismatch;
+  }
+
+  static uint32_t Diff(const FpgaSharedStream::Frame& a, const FpgaSharedStream::Frame& b) {
+    uint32_t wa[FpgaSharedStream::kFrameWords];
+    uint32_t wb[FpgaSharedStream::kFrameWords];
+    std::memcpy(wa, &a, sizeof(wa));
+    std::memcpy(wb, &b, sizeof(wb));
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < FpgaSharedStream::kFrameWords; ++i) {
+      mask |= (wa[i] != wb[i]) ? 1u << i : 0u;
+    }
+    return mask;
+  }
+
+  // Levels of `symbol` at which a book read back with
+  // FpgaSharedStream::ReadBook() differs from `model`; 0 when they agree.
+  // Levels past the shallower book must be empty in the deeper one.
+  static uint32_t BookDiffs(const SwOrderBook& model, const FpgaSharedStream::BookSnapshot& book) {
+    if (book.symbol >= model.NumSymbols()) {
+      return book.depth;
+    }
+    const uint32_t depth = model.Depth() > book.depth ? model.Depth() : book.depth;
+    uint32_t diffs = 0;
+    for (uint32_t i = 0; i < depth; ++i) {
+      FpgaSharedStream::BookLevel expected{0, 0, 0, 0};
+      if (i < model.Depth()) {
+        expected.bid_px = model.BidPrices(book.symbol)[i];
+        expected.bid_qty = model.BidQtys(book.symbol)[i];
+        expected.ask_px = model.AskPrices(book.symbol)[i];
+        expected.ask_qty = model.AskQtys(book.symbol)[i];
+      }
+      FpgaSharedStream::BookLevel actual{0, 0, 0, 0};
+      if (i < FpgaSharedStream::kBookMaxDepth) {
+        actual = book.levels[i];
+      }
+      if (std::memcmp(&expected, &actual, sizeof(expected)) != 0) {
+        ++diffs;
+      }
+    }
+    return diffs;
+  }
+
+  static void PrintBook(std::ostream& out, const FpgaSharedStream::BookSnapshot& book) {
+    out << "  fpga book (symbol " << book.symbol << ", read back after seq " << book.last_seq
+        << "):\n";
+    for (uint32_t i = 0; i < book.depth; ++i) {
+      const FpgaSharedStream::BookLevel& level = book.levels[i];
+      out << "    L" << i << "  bid " << level.bid_qty << " @ " << level.bid_px << "  ask "
+          << level.ask_qty << " @ " << level.ask_px << "\n";
+    }
+  }
+
+  // Multi-line human-readable report of a divergence.
+  static void Print(std::ostream& out, const Divergence& d) {
+    static const char* const kWordNames[8] = {
+        "seq", "action", "bid_px", "bid_qty", "ask_px", "ask_qty", "spread", "imbalance",
+    };
+    uint32_t expected[FpgaSharedStream::kFrameWords];
+    uint32_t actual[FpgaSharedStream::kFrameWords];
+    std::memcpy(expected, &d.expected, sizeof(expected));
+    std::memcpy(actual, &d.actual, sizeof(actual));
+    out << "first divergence at seq " << d.event.word0 << ": symbol=" << d.event.word1
+        << " type=" << d.event.word4 << " side=" << d.event.word5 << " price=" << d.event.word2
+        << " qty=" << d.event.word3 << "\n";
+    for (uint32_t i = 0; i < FpgaSharedStream::kFrameWords; ++i) {
+      if ((d.word_mask & (1u << i)) != 0) {
+        out << "  " << kWordNames[i] << ": expected " << expected[i] << " got " << actual[i]
+            << "\n";
+      }
+    }
+    out << "  model book:\n";
+    for (uint32_t i = 0; i < d.depth; ++i) {
+      out << "    L" << i << "  bid " << d.bid_qty[i] << " @ " << d.bid_px[i] << "  ask "
+          << d.ask_qty[i] << " @ " << d.ask_px[i] << "\n";
+    }
+  }
+
+ private:
+  enum State {
+    kEmpty = 0,
+    kPending = 1,
+    kUnsampled = 2,
+    kDone = 3,
+  };
+
+  struct Entry {
+    Entry() : seq(0), state(kEmpty), event{}, expected{} {}
+    uint32_t seq;
+    State state;
+    FpgaSharedStream::Frame event;
+    FpgaSharedStream::Frame expected;
+  };
+
+  void Capture(const Entry& entry, const FpgaSharedStream::Frame& actual, uint32_t word_mask) {
+    has_divergence_ = true;
+    divergence_.event = entry.event;
+    divergence_.expected = entry.expected;
+    divergence_.actual = actual;
+    divergence_.word_mask = word_mask;
+    const uint32_t symbol = entry.event.word1;
+    if (symbol >= model_.NumSymbols()) {
+      divergence_.depth = 0;
+      return;
+    }
+    divergence_.depth = model_.Depth() < kMaxReportDepth ? model_.Depth() : kMaxReportDepth;
+    for (uint32_t i = 0; i < divergence_.depth; ++i) {
+      divergence_.bid_px[i] = model_.BidPrices(symbol)[i];
+      divergence_.bid_qty[i] = model_.BidQtys(symbol)[i];
+      divergence_.ask_px[i] = model_.AskPrices(symbol)[i];
+      divergence_.ask_qty[i] = model_.AskQtys(symbol)[i];
+    }
+  }
+
+  Config config_;
+  SwOrderBook model_;
+  std::vector<Entry> entries_;
+  uint64_t mask_;
+  Stats stats_;
+  bool has_divergence_;
+  Divergence divergence_;
+};
@@ -0,0 +1,318 @@
+#pragma once
+
+#include "latency_histogram.h"
+
+#include <alloca.h>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+// Real-time execution profile for a measuring thread: CPU affinity,
+// SCHED_FIFO priority, mlockall, stack and buffer prefaulting, and
+// transparent huge pages for large buffers.
+//
+// Every step is optional and best effort. A step that fails, e.g. without
+// CAP_SYS_NICE or with a small RLIMIT_MEMLOCK, is listed in Report::errors
+// and the run goes on without it. Affinity and scheduling class are inherited
+// by threads created afterwards.
+class RtSetup {
+ public:
+  static const std::size_t kHugePageBytes = 2u << 20;
+  static const std::size_t kPrefaultStackBytes = 256u << 10;
+
+  struct Config {
+    // CPU for the calling thread; -1 leaves affinity alone.
+    int cpu;
+    // SCHED_FIFO priority (1-99); 0 leaves the policy alone.
+    int fifo_priority;
+    // mlockall(MCL_CURRENT | MCL_FUTURE). Later allocations are faulted in
+    // and locked as they are made, and fail once RLIMIT_MEMLOCK is reached.
+    bool lock_memory;
+    // Touches kPrefaultStackBytes of stack up front, and every page of the
+    // buffers passed to PrepareBuffer().
+    bool prefault;
+    // madvise(MADV_HUGEPAGE) on buffers passed to PrepareBuffer().
+    bool huge_pages;
+  };
+
+  struct Report {
+    bool pinned;
+    bool fifo;
+    bool locked;
+    uint64_t prefaulted_bytes;
+    uint64_t huge_page_bytes;
+    // "; "-separated, empty when every requested step worked.
+    std::string errors;
+  };
+
+  static Config DefaultConfig() {
+    Config config{};
+    config.cpu = -1;
+    config.fifo_priority = 0;
+    config.lock_memory = false;
+    config.prefault = false;
+    config.huge_pages = false;
+    return config;
+  }
+
+  static bool Enabled(const Config& config) {
+    return config.cpu >= 0 || config.fifo_priority > 0 || config.lock_memory ||
+           config.prefault || config.huge_pages;
+  }
+
+  // Applies `config` to the calling thread. Memory is locked first so the
+  // prefaulted stack stays resident.
+  static Report Apply(const Config& config) {
+    Report report{};
+    std::string error;
+    if (config.lock_memory) {
+      report.locked = LockMemory(&error);
+      AddError(&report, error);
+    }
+    if (config.cpu >= 0) {
+      report.pinned = PinThread(pthread_self(), config.cpu, &error);
+      AddError(&report, error);
+    }
+    if (config.fifo_priority > 0) {
+      report.fifo = SetFifo(pthread_self(), config.fifo_priority, &error);
+      AddError(&report, error);
+    }
+    if (config.prefault) {
+      PrefaultStack(kPrefaultStackBytes);
+      report.prefaulted_bytes += kPrefaultStackBytes;
+    }
+    return report;
+  }
+
+  // Readies a buffer the timed loop will use: advises huge pages for its
+  // 2 MiB-aligned interior, then touches every page so neither the faults nor
+  // the huge-page promotion land inside the measurement.
+  static void PrepareBuffer(const Config& config, void* data, std::size_t bytes,
+                            Report* report) {
+    if (data == nullptr || bytes == 0) {
+      return;
+    }
+    if (config.huge_pages) {
+      const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+      const uintptr_t first = (begin + kHugePageBytes - 1) & ~uintptr_t(kHugePageBytes - 1);
+      const uintptr_t last = (begin + bytes) & ~uintptr_t(kHugePageBytes - 1);
+      if (last > first) {
+        if (madvise(reinterpret_cast<void*>(first), last - first, MADV_HUGEPAGE) == 0) {
+          report->huge_page_bytes += last - first;
+        } else {
+          AddError(report, std::string("madvise(MADV_HUGEPAGE): ") + std::strerror(errno));
+        }
+      }
+    }
+    if (config.prefault) {
+      PrefaultPages(data, bytes);
+      report->prefaulted_bytes += bytes;
+    }
+  }
+
+  static bool PinThread(pthread_t thread, int cpu, std::string* error) {
+    error->clear();
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      *error = "invalid cpu " + std::to_string(cpu);
+      return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    const int rc = pthread_setaffinity_np(thread, sizeof(set), &set);
+    if (rc != 0) {
+      *error = "pin to cpu " + std::to_string(cpu) + ": " + std::strerror(rc);
+      return false;
+    }
+    return true;
+  }
+
+  static bool SetFifo(pthread_t thread, int priority, std::string* error) {
+    error->clear();
+    sched_param param{};
+    param.sched_priority = priority;
+    const int rc = pthread_setschedparam(thread, SCHED_FIFO, &param);
+    if (rc != 0) {
+      *error = "SCHED_FIFO priority " + std::to_string(priority) + ": " + std::strerror(rc);
+      return false;
+    }
+    return true;
+  }
+
+  static bool LockMemory(std::string* error) {
+    error->clear();
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+      *error = std::string("mlockall: ") + std::strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+  // Writes every page of [data, data + bytes) back with its own value.
+  static void PrefaultPages(void* data, std::size_t bytes) {
+    volatile uint8_t* p = static_cast<volatile uint8_t*>(data);
+    const std::size_t page = PageBytes();
+    for (std::size_t i = 0; i < bytes; i += page) {
+      p[i] = p[i];
+    }
+    if (bytes != 0) {
+      p[bytes - 1] = p[bytes - 1];
+    }
+  }
+
+  // Grows the stack by `bytes` once so later deep calls do not fault.
+  static __attribute__((noinline)) void PrefaultStack(std::size_t bytes) {
+    volatile uint8_t* p = static_cast<volatile uint8_t*>(alloca(bytes));
+    const std::size_t page = PageBytes();
+    for (std::size_t i = 0; i < bytes; i += page) {
+      p[i] = 0;
+    }
+  }
+
+  static std::size_t PageBytes() {
+    const long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? static_cast<std::size_t>(page) : 4096u;
+  }
+
+ private:
+  static void AddError(Report* report, const std::string& error) {
+    if (error.empty()) {
+      return;
+    }
+    if (!report->errors.empty()) {
+      report->errors += "; ";
+    }
+    report->errors += error;
+  }
+};
+
+// Platform stall meter (jHiccup style): a thread that sleeps to an absolute
+// deadline every interval and records how late it wakes up. None of our code
+// runs on it, so its lateness is time the OS and hardware took away:
+// preemption, interrupts, timer slack, page faults. Compare its tail with a
+// benchmark's jitter to see how much of that jitter is the platform.
+//
+// Give it its own CPU where possible. On the measuring CPU it competes with
+// the measured thread, and under SCHED_FIFO at equal priority it only gets to
+// run when that thread blocks.
+class HiccupMeter {
+ public:
+  static const uint64_t kDefaultIntervalNs = 1000000;
+
+  struct Config {
+    uint64_t interval_ns;
+    int cpu;
+    int fifo_priority;
+  };
+
+  struct Stats {
+    uint64_t samples;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+    // Sum of all wake-up delays.
+    uint64_t total_ns;
+  };
+
+  static Config DefaultConfig() {
+    Config config{};
+    config.interval_ns = kDefaultIntervalNs;
+    config.cpu = -1;
+    config.fifo_priority = 0;
+    return config;
+  }
+
+  HiccupMeter() : running_(false), interval_ns_(kDefaultIntervalNs), total_ns_(0) {}
+  ~HiccupMeter() { Stop(); }
+
+  HiccupMeter(const HiccupMeter&) = delete;
+  HiccupMeter& operator=(const HiccupMeter&) = delete;
+
+  // Starts the meter thread. Pinning or priority failures are returned in
+  // `error` and leave the meter running unpinned or at normal priority.
+  bool Start(const Config& config, std::string* error) {
+    error->clear();
+    if (running_.load() || config.interval_ns == 0) {
+      *error = running_.load() ? "hiccup meter already running" : "zero hiccup interval";
+      return false;
+    }
+    histogram_.Reset();
+    total_ns_ = 0;
+    interval_ns_ = config.interval_ns;
+    running_.store(true);
+    thread_ = std::thread([this]() { Loop(); });
+    std::string step;
+    if (config.cpu >= 0 && !RtSetup::PinThread(thread_.native_handle(), config.cpu, &step)) {
+      *error = step;
+    }
+    if (config.fifo_priority > 0 &&
+        !RtSetup::SetFifo(thread_.native_handle(), config.fifo_priority, &step)) {
+      *error += (error->empty() ? "" : "; ") + step;
+    }
+    return true;
+  }
+
+  void Stop() {
+    if (!running_.load()) {
+      return;
+    }
+    running_.store(false);
+    thread_.join();
+  }
+
+  // Valid after Stop().
+  Stats Summarize() const {
+    Stats stats{};
+    stats.samples = histogram_.Count();
+    stats.p50_ns = histogram_.ValueAt(0.50);
+    stats.p99_ns = histogram_.ValueAt(0.99);
+    stats.p999_ns = histogram_.ValueAt(0.999);
+    stats.max_ns = histogram_.Max();
+    stats.total_ns = total_ns_;
+    return stats;
+  }
+
+  const LatencyHistogram& Histogram() const { return histogram_; }
+
+ private:
+  static uint64_t Now() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(ts.tv_nsec);
+  }
+
+  void Loop() {
+    uint64_t deadline = Now() + interval_ns_;
+    while (running_.load(std::memory_order_relaxed)) {
+      timespec ts{};
+      ts.tv_sec = static_cast<time_t>(deadline / 1000000000ull);
+      ts.tv_nsec = static_cast<long>(deadline % 1000000000ull);
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+      }
+      const uint64_t now = Now();
+      const uint64_t late = now > deadline ? now - deadline : 0;
+      histogram_.Record(late);
+      total_ns_ += late;
+      // After a long stall, restart the schedule instead of recording a run
+      // of back-to-back catch-up wake-ups.
+      deadline = late >= interval_ns_ ? now + interval_ns_ : deadline + interval_ns_;
+    }
+  }
+
+  std::atomic<bool> running_;
+  uint64_t interval_ns_;
+  uint64_t total_ns_;
+  LatencyHistogram histogram_;
+  std::thread thread_;
+};
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+#include "spsc_ring.h"
+#include "sw_order_book.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Symbol-sharded SwOrderBook on worker threads.
+//
+// Symbol `s` belongs to shard `s % threads`, which keeps it as local symbol
+// `s / threads` in its own book, so a worker only touches its own memory. The
+// calling thread runs both the dispatcher and the merger: it pushes each event
+// onto its shard's input ring, logs the shard in a route ring, and pops
+// responses back in route order. Each shard answers in arrival order, so the
+// merged output is exactly the input order with no reordering buffer.
+//
+// Every book keeps per-symbol state only, so the responses are identical to a
+// single SwOrderBook processing the same stream.
+class ShardedEngine {
+ public:
+  static const uint32_t kDefaultRingCapacity = 1024;
+  static const uint32_t kMaxThreads = 64;
+
+  struct Config {
+    uint32_t threads;
+    uint32_t ring_capacity;
+    // Whole-feed book settings; num_symbols is split across the shards.
+    SwOrderBook::Config book;
+  };
+
+  struct ShardStats {
+    uint64_t events;
+    // Polls that found the input ring empty or the output ring full, up to
+    // the shard's last event.
+    uint64_t idle_polls;
+    uint64_t blocked_polls;
+  };
+
+  static Config DefaultConfig() {
+    Config config{};
+    config.threads = 2;
+    config.ring_capacity = kDefaultRingCapacity;
+    config.book = SwOrderBook::DefaultConfig();
+    return config;
+  }
+
+  ShardedEngine() : config_{}, route_mask_(0), dispatch_stalls_(0) {}
+  ~ShardedEngine() { Stop(); }
+
+  ShardedEngine(const ShardedEngine&) = delete;
+  ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+  // Builds the shards and starts one worker thread per shard. Fails for zero
+  // or more than kMaxThreads threads, or an invalid book config.
+  bool Start(const Config& config) {
+    Stop();
+    if (config.threads == 0 || config.threads > kMaxThreads || config.ring_capacity == 0 ||
+        config.book.num_symbols == 0 || config.book.depth == 0) {
+      return false;
+    }
+    config_ = config;
+
+    SwOrderBook::Config local = config.book;
+    local.num_symbols = (config.book.num_symbols + config.threads - 1) / config.threads;
+    for (uint32_t i = 0; i < config.threads; ++i) {
+      shards_.push_back(std::unique_ptr<Shard>(new Shard(local, config.ring_capacity)));
+    }
+
+    // Events in flight per shard are bounded by its two rings plus the one
+    // the worker holds.
+    const std::size_t ring = shards_[0]->input.Capacity();
+    std::size_t route = 2;
+    while (route < static_cast<std::size_t>(config.threads) * (2 * ring + 1)) {
+      route <<= 1;
+    }
+    route_.assign(route, 0);
+    route_mask_ = route - 1;
+    dispatch_stalls_ = 0;
+
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+      Shard* shard = shards_[i].get();
+      shard->worker = std::thread([shard]() { shard->Loop(); });
+    }
+    return true;
+  }
+
+  // Joins the workers. Queued events are still processed unless their
+  // responses can no longer be delivered.
+  void Stop() {
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i]->running.store(false, std::memory_order_release);
+    }
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+      if (shards_[i]->worker.joinable()) {
+        shards_[i]->worker.join();
+      }
+    }
+    shards_.clear();
+  }
+
+  uint32_t Threads() const { return static_cast<uint32_t>(shards_.size()); }
+
+  uint32_t ShardOf(uint32_t symbol) const { return symbol % config_.threads; }
+
+  // Stable once Run() has returned: a shard stores its counters before it
+  // pushes the response Run() waits for. Call from the thread that runs Run().
+  ShardStats GetShardStats(uint32_t shard) const {
+    const Shard& s = *shards_[shard];
+    ShardStats stats{};
+    stats.events = s.events.load(std::memory_order_acquire);
+    stats.idle_polls = s.idle_polls.load(std::memory_order_relaxed);
+    stats.blocked_polls = s.blocked_polls.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  // Passes where the dispatcher could neither push nor merge anything.
+  uint64_t DispatchStalls() const { return dispatch_stalls_; }
+
+  // Feeds `count` events and calls `sink(response)` for each response, in
+  // input order, before returning.
+  template <typename Sink>
+  void Run(const FpgaSharedStream::Frame* events, std::size_t count, Sink& sink) {
+    const uint32_t threads = config_.threads;
+    const uint32_t symbols = config_.book.num_symbols;
+    std::size_t sent = 0;
+    std::size_t merged = 0;
+    uint32_t idle = 0;
+    while (merged < count) {
+      bool progress = false;
+      while (sent < count && sent - merged <= route_mask_) {
+        FpgaSharedStream::Frame event = events[sent];
+        const uint32_t symbol = event.word1;
+        uint32_t shard = 0;
+        if (symbol < symbols) {
+          shard = symbol % threads;
+          event.word1 = symbol / threads;
+        } else {
+          // Still answered in order, with the usual all-zero response.
+          event.word1 = 0xFFFFFFFFu;
+        }
+        if (!shards_[shard]->input.TryPush(event)) {
+          break;
+        }
+        route_[sent & route_mask_] = static_cast<uint8_t>(shard);
+        ++sent;
+        progress = true;
+      }
+
+      FpgaSharedStream::Frame response{};
+      while (merged < sent && shards_[route_[merged & route_mask_]]->output.TryPop(&response)) {
+        sink(response);
+        ++merged;
+        progress = true;
+      }
+
+      if (progress) {
+        idle = 0;
+      } else {
+        ++dispatch_stalls_;
+        Backoff(&idle);
+      }
+    }
+  }
+
+ private:
+  static void Backoff(uint32_t* idle) {
+    // Spin briefly, then give the core away; workers may share it with us.
+    if (++*idle >= 64) {
+      std::this_thread::yield();
+      *idle = 0;
+    }
+  }
+
+  struct Shard {
+    Shard(const SwOrderBook::Config& config, std::size_t ring_capacity)
+        : book(config), input(ring_capacity), output(ring_capacity), running(true), events(0),
+          idle_polls(0), blocked_polls(0) {}
+
+    void Loop() {
+      FpgaSharedStream::Frame event{};
+      uint64_t processed = 0;
+      uint64_t idle_count = 0;
+      uint64_t blocked_count = 0;
+      uint32_t idle = 0;
+      for (;;) {
+        if (!input.TryPop(&event)) {
+          if (!running.load(std::memory_order_acquire) && input.Empty()) {
+            break;
+          }
+          ++idle_count;
+          Backoff(&idle);
+          continue;
+        }
+        idle = 0;
+        const FpgaSharedStream::Frame response = book.Process(event);
+        // The counters are stored before the push that publishes the response
+        // (a release store), so the merger sees them once it has popped it.
+        idle_polls.store(idle_count, std::memory_order_relaxed);
+        events.store(++processed, std::memory_order_release);
+        for (;;) {
+          blocked_polls.store(blocked_count, std::memory_order_relaxed);
+          if (output.TryPush(response)) {
+            break;
+          }
+          if (!running.load(std::memory_order_acquire)) {
+            return;
+          }
+          ++blocked_count;
+          Backoff(&idle);
+        }
+      }
+    }
+
+    SwOrderBook book;
+    SpscRing<FpgaSharedStream::Frame> input;
+    SpscRing<FpgaSharedStream::Frame> output;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> events;
+    std::atomic<uint64_t> idle_polls;
+    std::atomic<uint64_t> blocked_polls;
+    std::thread worker;
+  };
+
+  Config config_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::vector<uint8_t> route_;
+  std::size_t route_mask_;
+  uint64_t dispatch_stalls_;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bounded single-producer/single-consumer ring between two threads.
+//
+// Capacity is rounded up to a power of two. Producer and consumer indices sit
+// on separate cache lines, and each side keeps a private copy of the other
+// side's index so the shared line is only re-read when the ring looks full
+// (producer) or empty (consumer).
+template <typename T>
+class SpscRing {
+ public:
+  explicit SpscRing(std::size_t capacity)
+      : head_(0), cached_tail_(0), tail_(0), cached_head_(0), mask_(0) {
+    std::size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    buffer_.resize(size);
+    mask_ = size - 1;
+  }
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  std::size_t Capacity() const { return mask_ + 1; }
+
+  // Producer side.
+  bool TryPush(const T& item) {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ > mask_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ > mask_) {
+        return false;
+      }
+    }
+    buffer_[static_cast<std::size_t>(head) & mask_] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side.
+  bool TryPop(T* item) {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail == cached_head_) {
+        return false;
+      }
+    }
+    *item = buffer_[static_cast<std::size_t>(tail) & mask_];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Either side; exact only while the other side is idle.
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  static const std::size_t kCacheLine = 64;
+
+  std::atomic<uint64_t> head_;
+  uint64_t cached_tail_;
+  char pad0_[kCacheLine - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+  std::atomic<uint64_t> tail_;
+  uint64_t cached_head_;
+  char pad1_[kCacheLine - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+  std::size_t mask_;
+  std::vector<T> buffer_;
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+#include "sw_order_book.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Batched update-then-decide on top of SwOrderBook.
+//
+// ProcessBatch() applies every event of a batch to the book first and only
+// records which symbols changed. The tops of the changed symbols are then
+// gathered into a struct-of-arrays table and the strategy policy decides over
+// it. The built-in SwOrderBook::ImbalanceStrategy runs four symbols per
+// instruction (SSE2/AVX2, or NEON with -mfpu=neon, as for SwLevelKernel);
+// any other policy (sw_strategies.h) runs its Decide() once per changed
+// symbol. One response comes out per changed symbol, carrying the seq of
+// that symbol's last event in the batch. It equals the response
+// SwOrderBook::Process() gives for that event with the same policy;
+// responses for the earlier events of the same symbol are never built.
+//
+// Events for symbols outside the book are counted and get no response.
+class SwBatchBook {
+ public:
+  static const uint32_t kLanes = 4;
+
+  // Changed symbols of one batch, struct-of-arrays, padded to kLanes.
+  struct TopOfBookBatch {
+    uint32_t count;
+    std::vector<uint32_t> symbol;
+    std::vector<uint32_t> seq;
+    std::vector<uint32_t> bid_px;
+    std::vector<uint32_t> bid_qty;
+    std::vector<uint32_t> ask_px;
+    std::vector<uint32_t> ask_qty;
+    // Outputs of DecideBatch().
+    std::vector<uint32_t> spread;
+    std::vector<uint32_t> imbalance;  // int32 bits
+    std::vector<uint32_t> action;
+  };
+
+  struct Stats {
+    uint64_t batches;
+    uint64_t events;
+    uint64_t responses;
+  };
+
+  static const char* KernelName() {
+#if defined(HFT_SW_LEVEL_KERNEL_AVX2) || defined(HFT_SW_LEVEL_KERNEL_SSE2)
+    return "sse2";
+#elif defined(HFT_SW_LEVEL_KERNEL_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+  }
+
+  SwBatchBook() : stats_{} { Init(SwOrderBook::DefaultConfig()); }
+
+  explicit SwBatchBook(const SwOrderBook::Config& config) : stats_{} { Init(config); }
+
+  SwBatchBook(const SwBatchBook&) = delete;
+  SwBatchBook& operator=(const SwBatchBook&) = delete;
+
+  bool Init(const SwOrderBook::Config& config) {
+    if (!book_.Init(config)) {
+      return false;
+    }
+    const std::size_t padded =
+        (static_cast<std::size_t>(config.num_symbols) + kLanes - 1) / kLanes * kLanes;
+    batch_.count = 0;
+    batch_.symbol.assign(padded, 0);
+    batch_.seq.assign(padded, 0);
+    batch_.bid_px.assign(padded, 0);
+    batch_.bid_qty.assign(padded, 0);
+    batch_.ask_px.assign(padded, 0);
+    batch_.ask_qty.assign(padded, 0);
+    batch_.spread.assign(padded, 0);
+    batch_.imbalance.assign(padded, 0);
+    batch_.action.assign(padded, 0);
+    slot_.assign(config.num_symbols, uint32_t(kNoSlot));
+    stats_ = Stats{};
+    return true;
+  }
+
+  const SwOrderBook& Book() const { return book_; }
+  const Stats& GetStats() const { return stats_; }
+
+  // Table of the last batch, valid until the next ProcessBatch().
+  const TopOfBookBatch& LastBatch() const { return batch_; }
+
+  // Applies `count` events and writes one response per changed symbol, in
+  // order of first change, to `responses`. It must have room for
+  // min(count, NumSymbols()) frames. Returns the number written.
+  std::size_t ProcessBatch(const FpgaSharedStream::Frame* events, std::size_t count,
+                           FpgaSharedStream::Frame* responses) {
+    return ProcessBatch(events, count, responses, book_.DefaultStrategy());
+  }
+
+  // Same, with the decision taken by `strategy`.
+  template <typename Strategy>
+  std::size_t ProcessBatch(const FpgaSharedStream::Frame* events, std::size_t count,
+                           FpgaSharedStream::Frame* responses, const Strategy& strategy) {
+    uint32_t changed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      const FpgaSharedStream::Frame& event = events[i];
+      if (!book_.ApplyEvent(event)) {
+        continue;
+      }
+      uint32_t& slot = slot_[event.word1];
+      if (slot == kNoSlot) {
+        slot = changed;
+        batch_.symbol[changed++] = event.word1;
+      }
+      batch_.seq[slot] = event.word0;
+    }
+
+    for (uint32_t i = 0; i < changed; ++i) {
+      const SwOrderBook::TopOfBook& top = book_.Top(batch_.symbol[i]);
+      batch_.bid_px[i] = top.bid_px;
+      batch_.bid_qty[i] = top.bid_qty;
+      batch_.ask_px[i] = top.ask_px;
+      batch_.ask_qty[i] = top.ask_qty;
+    }
+    batch_.count = changed;
+    DecideBatch(book_, &batch_, strategy);
+
+    for (uint32_t i = 0; i < changed; ++i) {
+      FpgaSharedStream::Frame& response = responses[i];
+      response.word0 = batch_.seq[i];
+      response.word1 = batch_.action[i];
+      response.word2 = batch_.bid_px[i];
+      response.word3 = batch_.bid_qty[i];
+      response.word4 = batch_.ask_px[i];
+      response.word5 = batch_.ask_qty[i];
+      response.word6 = batch_.spread[i];
+      response.word7 = batch_.imbalance[i];
+      slot_[batch_.symbol[i]] = kNoSlot;
+    }
+    ++stats_.batches;
+    stats_.events += count;
+    stats_.responses += changed;
+    return changed;
+  }
+
+  // `strategy` over the first `batch->count` entries of `book`, filling
+  // spread, imbalance and action: the scalar path for any policy.
+  template <typename Strategy>
+  static void DecideBatch(const SwOrderBook& book, TopOfBookBatch* batch,
+                          const Strategy& strategy) {
+    for (uint32_t i = 0; i < batch->count; ++i) {
+      const SwOrderBook::TopOfBook top = TopAt(*batch, i);
+      const uint32_t spread = SwOrderBook::Spread(top);
+      const int32_t imbalance = SwOrderBook::Imbalance(top);
+      batch->spread[i] = spread;
+      batch->imbalance[i] = static_cast<uint32_t>(imbalance);
+      batch->action[i] = strategy.Decide(book, batch->symbol[i], top, spread, imbalance);
+    }
+  }
+
+  // The built-in rule only reads the top of book, so it takes the vector path.
+  static void DecideBatch(const SwOrderBook&, TopOfBookBatch* batch,
+                          const SwOrderBook::ImbalanceStrategy& strategy) {
+    DecideBatch(batch, strategy.imbalance_threshold, strategy.max_spread_1e4);
+  }
+
+  // SwOrderBook::ImbalanceDecision over the first `batch->count` entries,
+  // filling spread, imbalance and action.
+  static void DecideBatch(TopOfBookBatch* batch, uint32_t imbalance_threshold,
+                          uint32_t max_spread_1e4) {
+    uint32_t i = 0;
+#if defined(HFT_SW_LEVEL_KERNEL_AVX2) || defined(HFT_SW_LEVEL_KERNEL_SSE2)
+    for (; i + kLanes <= batch->count; i += kLanes) {
+      DecideSse2(batch, i, imbalance_threshold, max_spread_1e4);
+    }
+#elif defined(HFT_SW_LEVEL_KERNEL_NEON)
+    for (; i + kLanes <= batch->count; i += kLanes) {
+      DecideNeon(batch, i, imbalance_threshold, max_spread_1e4);
+    }
+#endif
+    for (; i < batch->count; ++i) {
+      const SwOrderBook::TopOfBook top = TopAt(*batch, i);
+      const uint32_t spread = SwOrderBook::Spread(top);
+      const int32_t imbalance = SwOrderBook::Imbalance(top);
+      batch->spread[i] = spread;
+      batch->imbalance[i] = static_cast<uint32_t>(imbalance);
+      batch->action[i] = SwOrderBook::ImbalanceDecision(top, spread, imbalance,
+                                                        imbalance_threshold, max_spread_1e4);
+    }
+  }
+
+ private:
+  static const uint32_t kNoSlot = 0xFFFFFFFFu;
+
+  static SwOrderBook::TopOfBook TopAt(const TopOfBookBatch& batch, uint32_t i) {
+    SwOrderBook::TopOfBook top{};
+    top.bid_px = batch.bid_px[i];
+    top.bid_qty = batch.bid_qty[i];
+    top.ask_px = batch.ask_px[i];
+    top.ask_qty = batch.ask_qty[i];
+    return top;
+  }
+
+#if defined(HFT_SW_LEVEL_KERNEL_AVX2) || defined(HFT_SW_LEVEL_KERNEL_SSE2)
+  static void DecideSse2(TopOfBookBatch* batch, uint32_t i, uint32_t imbalance_threshold,
+                         uint32_t max_spread_1e4) {
+    const __m128i bid_px = Load(&batch->bid_px[i]);
+    const __m128i bid_qty = Load(&batch->bid_qty[i]);
+    const __m128i ask_px = Load(&batch->ask_px[i]);
+    const __m128i ask_qty = Load(&batch->ask_qty[i]);
+    // SSE2 only compares signed; flipping the sign bit orders unsigned values.
+    const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    const __m128i zero = _mm_setzero_si128();
+
+    const __m128i empty =
+        _mm_or_si128(_mm_cmpeq_epi32(bid_qty, zero), _mm_cmpeq_epi32(ask_qty, zero));
+    const __m128i uncrossed =
+        _mm_cmpgt_epi32(_mm_xor_si128(ask_px, bias), _mm_xor_si128(bid_px, bias));
+    const __m128i valid = _mm_andnot_si128(empty, uncrossed);
+    const __m128i spread = _mm_and_si128(valid, _mm_sub_epi32(ask_px, bid_px));
+    const __m128i imbalance = _mm_sub_epi32(bid_qty, ask_qty);
+
+    const __m128i max_spread = _mm_set1_epi32(static_cast<int>(max_spread_1e4 ^ 0x80000000u));
+    const __m128i tradable =
+        _mm_andnot_si128(_mm_cmpgt_epi32(_mm_xor_si128(spread, bias), max_spread), valid);
+    const int32_t threshold_value = static_cast<int32_t>(imbalance_threshold);
+    const __m128i threshold = _mm_set1_epi32(threshold_value);
+    const __m128i neg_threshold = _mm_set1_epi32(-threshold_value);
+    const __m128i buy = _mm_andnot_si128(_mm_cmpgt_epi32(threshold, imbalance), tradable);
+    const __m128i sell = _mm_andnot_si128(
+        buy, _mm_andnot_si128(_mm_cmpgt_epi32(imbalance, neg_threshold), tradable));
+    const __m128i buy_code = _mm_set1_epi32(static_cast<int>(SwOrderBook::kActionBuy));
+    const __m128i sell_code = _mm_set1_epi32(static_cast<int>(SwOrderBook::kActionSell));
+    const __m128i action =
+        _mm_or_si128(_mm_and_si128(buy, buy_code), _mm_and_si128(sell, sell_code));
+
+    Store(&batch->spread[i], spread);
+    Store(&batch->imbalance[i], imbalance);
+    Store(&batch->action[i], action);
+  }
+
+  static __m128i Load(const uint32_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+
+  static void Store(uint32_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+#elif defined(HFT_SW_LEVEL_KERNEL_NEON)
+  static void DecideNeon(TopOfBookBatch* batch, uint32_t i, uint32_t imbalance_threshold,
+                         uint32_t max_spread_1e4) {
+    const uint32x4_t bid_px = vld1q_u32(&batch->bid_px[i]);
+    const uint32x4_t bid_qty = vld1q_u32(&batch->bid_qty[i]);
+    const uint32x4_t ask_px = vld1q_u32(&batch->ask_px[i]);
+    const uint32x4_t ask_qty = vld1q_u32(&batch->ask_qty[i]);
+    const uint32x4_t zero = vdupq_n_u32(0);
+
+    const uint32x4_t empty = vorrq_u32(vceqq_u32(bid_qty, zero), vceqq_u32(ask_qty, zero));
+    const uint32x4_t valid = vbicq_u32(vcgtq_u32(ask_px, bid_px), empty);
+    const uint32x4_t spread = vandq_u32(valid, vsubq_u32(ask_px, bid_px));
+    const int32x4_t imbalance =
+        vsubq_s32(vreinterpretq_s32_u32(bid_qty), vreinterpretq_s32_u32(ask_qty));
+
+    const uint32x4_t tradable = vandq_u32(valid, vcleq_u32(spread, vdupq_n_u32(max_spread_1e4)));
+    const int32_t threshold = static_cast<int32_t>(imbalance_threshold);
+    const uint32x4_t buy = vandq_u32(tradable, vcgeq_s32(imbalance, vdupq_n_s32(threshold)));
+    const uint32x4_t sell =
+        vbicq_u32(vandq_u32(tradable, vcleq_s32(imbalance, vdupq_n_s32(-threshold))), buy);
+    const uint32x4_t action = vorrq_u32(vandq_u32(buy, vdupq_n_u32(SwOrderBook::kActionBuy)),
+                                        vandq_u32(sell, vdupq_n_u32(SwOrderBook::kActionSell)));
+
+    vst1q_u32(&batch->spread[i], spread);
+    vst1q_u32(&batch->imbalance[i], vreinterpretq_u32_s32(imbalance));
+    vst1q_u32(&batch->action[i], action);
+  }
+#endif
+
+  SwOrderBook book_;
+  TopOfBookBatch batch_;
+  // Per symbol: index into batch_ while it has changed in this batch.
+  std::vector<uint32_t> slot_;
+  Stats stats_;
+};
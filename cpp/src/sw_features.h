@@ -0,0 +1,213 @@
+#pragma once
+
+#include "sw_order_book.h"
+#include "sw_strategies.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// Incremental per-symbol features of the top of book.
+//
+// Update() is called with a symbol's top of book after every event and
+// advances all features in O(1) from the previous top, kept in the record:
+//   - EWMA of the mid price;
+//   - EWMA of the squared mid change (short-horizon realized variance);
+//   - order-flow imbalance (Cont, Kukanov, Stoikov): the size added on the
+//     bid or removed from the ask at the best, minus the opposite, summed with
+//     exponential decay;
+//   - trade-through counters: how often the best level on a side was taken
+//     out, i.e. the best bid fell or the best ask rose.
+// The decays are powers of two, given as shifts. Everything is kept in
+// integers; the floating-point views are computed on read only.
+//
+// Each symbol's record is one 64-byte cache line, so an update touches that
+// line and the book's top record.
+class SwFeatures {
+ public:
+  static const uint32_t kDefaultMidShift = 4;         // alpha 1/16
+  static const uint32_t kDefaultVolatilityShift = 5;  // alpha 1/32
+  static const uint32_t kDefaultOrderFlowShift = 4;   // decay 1/16 per event
+  // Fixed-point fraction bits of the mid and variance averages.
+  static const uint32_t kFractionBits = 8;
+  // Mid changes are clamped to this before squaring, keeping the variance
+  // in 64 bits for any input.
+  static const int64_t kMaxMidChange = int64_t(1) << 24;
+
+  struct Config {
+    uint32_t num_symbols;
+    uint32_t mid_shift;
+    uint32_t volatility_shift;
+    uint32_t order_flow_shift;
+  };
+
+  struct Record {
+    // Top of book at the previous update.
+    uint32_t bid_px;
+    uint32_t bid_qty;
+    uint32_t ask_px;
+    uint32_t ask_qty;
+    // Mid prices are kept doubled (bid + ask), so they stay integral.
+    int64_t ewma_mid2;      // Q8
+    int64_t variance_mid2;  // Q8, squared change of bid + ask
+    int64_t order_flow;     // decayed sum, quantity units
+    int64_t order_flow_total;
+    uint32_t updates;
+    uint32_t mid_changes;
+    uint32_t bid_throughs;
+    uint32_t ask_throughs;
+  };
+  static_assert(sizeof(Record) == 64, "feature record should be one cache line");
+
+  static Config DefaultConfig() {
+    Config config{};
+    config.num_symbols = SwOrderBook::kDefaultNumSymbols;
+    config.mid_shift = kDefaultMidShift;
+    config.volatility_shift = kDefaultVolatilityShift;
+    config.order_flow_shift = kDefaultOrderFlowShift;
+    return config;
+  }
+
+  SwFeatures() : config_{}, records_(nullptr) { Init(DefaultConfig()); }
+
+  explicit SwFeatures(const Config& config) : config_{}, records_(nullptr) { Init(config); }
+
+  ~SwFeatures() { std::free(records_); }
+
+  SwFeatures(const SwFeatures&) = delete;
+  SwFeatures& operator=(const SwFeatures&) = delete;
+
+  // Fails for a zero symbol count or a shift of 32 or more.
+  bool Init(const Config& config) {
+    if (config.num_symbols == 0 || config.mid_shift >= 32 || config.volatility_shift >= 32 ||
+        config.order_flow_shift >= 32) {
+      return false;
+    }
+    void* records = nullptr;
+    const std::size_t bytes = static_cast<std::size_t>(config.num_symbols) * sizeof(Record);
+    if (posix_memalign(&records, 64, bytes) != 0) {
+      return false;
+    }
+    std::free(records_);
+    records_ = static_cast<Record*>(records);
+    config_ = config;
+    Clear();
+    return true;
+  }
+
+  void Clear() {
+    for (uint32_t s = 0; s < config_.num_symbols; ++s) {
+      records_[s] = Record{};
+    }
+  }
+
+  const Config& GetConfig() const { return config_; }
+  uint32_t NumSymbols() const { return config_.num_symbols; }
+
+  const Record& Get(uint32_t symbol) const { return records_[symbol]; }
+
+  // Advances `symbol` to the new top of book. `symbol` must be in range.
+  const Record& Update(uint32_t symbol, const SwOrderBook::TopOfBook& top) {
+    Record& r = records_[symbol];
+    const bool had_bid = r.bid_qty != 0;
+    const bool had_ask = r.ask_qty != 0;
+    const bool has_bid = top.bid_qty != 0;
+    const bool has_ask = top.ask_qty != 0;
+    // An empty side compares as the worst possible price.
+    const uint32_t prev_bid = had_bid ? r.bid_px : 0u;
+    const uint32_t prev_ask = had_ask ? r.ask_px : 0xFFFFFFFFu;
+    const uint32_t bid = has_bid ? top.bid_px : 0u;
+    const uint32_t ask = has_ask ? top.ask_px : 0xFFFFFFFFu;
+
+    int64_t flow = 0;
+    flow += bid >= prev_bid ? static_cast<int64_t>(top.bid_qty) : 0;
+    flow -= bid <= prev_bid ? static_cast<int64_t>(r.bid_qty) : 0;
+    flow -= ask <= prev_ask ? static_cast<int64_t>(top.ask_qty) : 0;
+    flow += ask >= prev_ask ? static_cast<int64_t>(r.ask_qty) : 0;
+    r.order_flow += flow - r.order_flow / (int64_t(1) << config_.order_flow_shift);
+    r.order_flow_total += flow;
+
+    r.bid_throughs += had_bid && bid < prev_bid ? 1u : 0u;
+    r.ask_throughs += had_ask && ask > prev_ask ? 1u : 0u;
+
+    if (has_bid && has_ask) {
+      const int64_t mid2 = static_cast<int64_t>(top.bid_px) + top.ask_px;
+      const int64_t mid2_q = mid2 << kFractionBits;
+      if (had_bid && had_ask) {
+        const int64_t change = mid2 - (static_cast<int64_t>(r.bid_px) + r.ask_px);
+        const int64_t limit = kMaxMidChange;
+        const int64_t clamped = std::min(std::max(change, -limit), limit);
+        const int64_t square_q = (clamped * clamped) << kFractionBits;
+        r.variance_mid2 += (square_q - r.variance_mid2) / (int64_t(1) << config_.volatility_shift);
+        r.ewma_mid2 += (mid2_q - r.ewma_mid2) / (int64_t(1) << config_.mid_shift);
+        r.mid_changes += change != 0 ? 1u : 0u;
+      } else {
+        r.ewma_mid2 = mid2_q;  // first two-sided book seeds the average
+      }
+    }
+
+    r.bid_px = top.bid_px;
+    r.bid_qty = top.bid_qty;
+    r.ask_px = top.ask_px;
+    r.ask_qty = top.ask_qty;
+    ++r.updates;
+    return r;
+  }
+
+  // 0 until the symbol has been two-sided once.
+  static double EwmaMid1e4(const Record& r) {
+    return static_cast<double>(r.ewma_mid2) / static_cast<double>(2u << kFractionBits);
+  }
+
+  // Standard deviation of the per-event mid change, 1e-4 price units.
+  static double Volatility1e4(const Record& r) {
+    return std::sqrt(static_cast<double>(r.variance_mid2) /
+                     static_cast<double>(1u << kFractionBits)) / 2.0;
+  }
+
+  // Compares the variance against `limit_1e4` without the square root.
+  static bool VolatilityAtMost(const Record& r, uint32_t limit_1e4) {
+    const int64_t limit_mid2 = static_cast<int64_t>(limit_1e4) * 2;
+    if (limit_mid2 >= kMaxMidChange) {
+      return true;
+    }
+    return r.variance_mid2 <= (limit_mid2 * limit_mid2) << kFractionBits;
+  }
+
+ private:
+  Config config_;
+  Record* records_;
+};
+
+// Trades in the direction of the decayed order-flow imbalance while the
+// realized volatility is calm. Decide() also advances `features`, so one
+// instance must see every event of the book it is used with.
+struct OrderFlowStrategy {
+  SwFeatures* features;
+  int64_t order_flow_threshold;
+  uint32_t max_volatility_1e4;
+  uint32_t max_spread_1e4;
+
+  static const char* Name() { return "order-flow"; }
+
+  static OrderFlowStrategy Default(SwFeatures* features) {
+    OrderFlowStrategy strategy{};
+    strategy.features = features;
+    strategy.order_flow_threshold = 2000;
+    strategy.max_volatility_1e4 = 2000;
+    strategy.max_spread_1e4 = SwOrderBook::kDefaultMaxSpread1e4;
+    return strategy;
+  }
+
+  uint32_t Decide(const SwOrderBook&, uint32_t symbol, const SwOrderBook::TopOfBook& top,
+                  uint32_t spread_1e4, int32_t) const {
+    const SwFeatures::Record& f = features->Update(symbol, top);
+    if (!SwStrategyRules::Tradable(top, spread_1e4, max_spread_1e4) ||
+        !SwFeatures::VolatilityAtMost(f, max_volatility_1e4)) {
+      return SwOrderBook::kActionNoop;
+    }
+    return SwStrategyRules::Signed(f.order_flow, order_flow_threshold);
+  }
+};
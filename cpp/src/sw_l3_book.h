@@ -0,0 +1,501 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+#include "sw_order_book.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Order-by-order (L3) book feeding the same decision logic as SwOrderBook.
+//
+// Events carry an order id in word6 (see SwOrderBook::kEventAddOrder and
+// friends). All storage is sized by Init() and Process() never allocates:
+// - orders live in a fixed pool threaded onto a free list;
+// - each price level keeps its orders in an intrusive FIFO (prev/next pool
+//   indices), so time priority is explicit;
+// - an open-addressing hash maps order id -> pool index, so cancel, modify
+//   and execute are O(1);
+// - each side of each symbol keeps its live levels in a sorted array with
+//   the best price at the back, so updates near the touch move few entries.
+//
+// The aggregated best level of each side is published as a
+// SwOrderBook::TopOfBook and turned into the usual response frame.
+class SwL3Book {
+ public:
+  static const uint32_t kNone = 0xFFFFFFFFu;
+  static const uint32_t kDefaultMaxOrders = 1u << 20;
+  static const uint32_t kDefaultMaxLevelsPerSide = 256;
+
+  struct Config {
+    uint32_t num_symbols;
+    uint32_t max_orders;
+    // Distinct prices per side per symbol; adds that would open one more
+    // level are rejected.
+    uint32_t max_levels_per_side;
+    uint32_t imbalance_threshold;
+    uint32_t max_spread_1e4;
+  };
+
+  struct Stats {
+    uint64_t adds;
+    uint64_t modifies;
+    uint64_t cancels;
+    uint64_t executes;
+    uint64_t resets;
+    // Unknown or duplicate order ids, bad sides, full pool or full side.
+    uint64_t rejected;
+    uint64_t out_of_range;
+  };
+
+  struct Order {
+    uint32_t id;
+    uint32_t symbol;
+    uint32_t side;
+    uint32_t price;
+    uint32_t qty;
+    uint32_t level;
+    uint32_t prev;
+    uint32_t next;
+  };
+
+  struct Level {
+    uint64_t total_qty;
+    uint32_t price;
+    uint32_t orders;
+    uint32_t head;
+    uint32_t tail;
+  };
+
+  static Config DefaultConfig() {
+    Config config{};
+    config.num_symbols = SwOrderBook::kDefaultNumSymbols;
+    config.max_orders = kDefaultMaxOrders;
+    config.max_levels_per_side = kDefaultMaxLevelsPerSide;
+    config.imbalance_threshold = SwOrderBook::kDefaultImbalanceThreshold;
+    config.max_spread_1e4 = SwOrderBook::kDefaultMaxSpread1e4;
+    return config;
+  }
+
+  SwL3Book() : config_{}, decision_{}, hash_mask_(0), free_order_(kNone), free_level_(kNone),
+               live_orders_(0), stats_{} {
+    Init(DefaultConfig());
+  }
+
+  explicit SwL3Book(const Config& config)
+      : config_{}, decision_{}, hash_mask_(0), free_order_(kNone), free_level_(kNone),
+        live_orders_(0), stats_{} {
+    Init(config);
+  }
+
+  SwL3Book(const SwL3Book&) = delete;
+  SwL3Book& operator=(const SwL3Book&) = delete;
+
+  // (Re)allocates an empty book. Fails for zero symbols, orders or levels.
+  bool Init(const Config& config) {
+    if (config.num_symbols == 0 || config.max_orders == 0 || config.max_levels_per_side == 0 ||
+        config.max_orders > (1u << 30)) {
+      return false;
+    }
+    config_ = config;
+    decision_ = SwOrderBook::DefaultConfig();
+    decision_.num_symbols = config.num_symbols;
+    decision_.imbalance_threshold = config.imbalance_threshold;
+    decision_.max_spread_1e4 = config.max_spread_1e4;
+
+    // A level holds at least one order, so the pool never needs more levels
+    // than orders.
+    const std::size_t sides = static_cast<std::size_t>(config.num_symbols) * 2u;
+    const std::size_t level_slots = sides * config.max_levels_per_side;
+    const std::size_t max_levels = std::min<std::size_t>(config.max_orders, level_slots);
+
+    std::size_t hash_size = 1;
+    while (hash_size < static_cast<std::size_t>(config.max_orders) * 2u) {
+      hash_size <<= 1;
+    }
+
+    orders_.assign(config.max_orders, Order{});
+    levels_.assign(max_levels, Level{});
+    hash_.assign(hash_size, uint32_t(kNone));
+    hash_mask_ = static_cast<uint32_t>(hash_size - 1u);
+    side_count_.assign(sides, 0u);
+    side_key_.assign(level_slots, 0u);
+    side_level_.assign(level_slots, uint32_t(kNone));
+    top_.assign(config.num_symbols, SwOrderBook::TopOfBook{});
+    Clear();
+    return true;
+  }
+
+  void Clear() {
+    for (std::size_t i = 0; i < orders_.size(); ++i) {
+      orders_[i].next = i + 1 < orders_.size() ? static_cast<uint32_t>(i + 1) : kNone;
+    }
+    for (std::size_t i = 0; i < levels_.size(); ++i) {
+      levels_[i].head = i + 1 < levels_.size() ? static_cast<uint32_t>(i + 1) : kNone;
+    }
+    free_order_ = orders_.empty() ? kNone : 0u;
+    free_level_ = levels_.empty() ? kNone : 0u;
+    std::fill(hash_.begin(), hash_.end(), uint32_t(kNone));
+    std::fill(side_count_.begin(), side_count_.end(), 0u);
+    std::fill(top_.begin(), top_.end(), SwOrderBook::TopOfBook{});
+    live_orders_ = 0;
+    stats_ = Stats{};
+  }
+
+  const Config& GetConfig() const { return config_; }
+  uint32_t NumSymbols() const { return config_.num_symbols; }
+  uint32_t LiveOrders() const { return live_orders_; }
+  const Stats& GetStats() const { return stats_; }
+  const SwOrderBook::TopOfBook& Top(uint32_t symbol) const { return top_[symbol]; }
+
+  // Pool record of a live order, or nullptr.
+  const Order* FindOrder(uint32_t id) const {
+    const uint32_t idx = Lookup(id);
+    return idx == kNone ? nullptr : &orders_[idx];
+  }
+
+  // Number of price levels on one side of one symbol.
+  uint32_t LevelCount(uint32_t symbol, uint32_t side) const {
+    return side_count_[SideIndex(symbol, side)];
+  }
+
+  // `rank` 0 is the best level. Returns nullptr past the last level.
+  const Level* LevelAt(uint32_t symbol, uint32_t side, uint32_t rank) const {
+    const std::size_t s = SideIndex(symbol, side);
+    if (rank >= side_count_[s]) {
+      return nullptr;
+    }
+    return &levels_[side_level_[SideBase(s) + side_count_[s] - 1u - rank]];
+  }
+
+  const Order& OrderAt(uint32_t idx) const { return orders_[idx]; }
+
+  // Applies one event and returns the response for the symbol it touched.
+  // Cancel, modify and execute resolve the symbol from the order itself.
+  FpgaSharedStream::Frame Process(const FpgaSharedStream::Frame& event) {
+    uint32_t symbol = event.word1;
+    switch (event.word4) {
+      case SwOrderBook::kEventAddOrder:
+        if (symbol < config_.num_symbols) {
+          Add(symbol, event.word5, event.word6, event.word2, event.word3);
+        }
+        break;
+      case SwOrderBook::kEventModifyOrder:
+        symbol = Modify(event.word6, event.word2, event.word3, symbol);
+        break;
+      case SwOrderBook::kEventCancelOrder:
+        symbol = Cancel(event.word6, symbol);
+        break;
+      case SwOrderBook::kEventExecuteOrder:
+        symbol = Execute(event.word6, event.word3, symbol);
+        break;
+      case SwOrderBook::kEventResetBook:
+        if (symbol < config_.num_symbols) {
+          ResetSymbol(symbol);
+        }
+        break;
+      default:
+        // Level events belong to SwOrderBook.
+        if (symbol < config_.num_symbols) {
+          ++stats_.rejected;
+        }
+        break;
+    }
+
+    if (symbol >= config_.num_symbols) {
+      ++stats_.out_of_range;
+      return SwOrderBook::MakeResponse(event.word0, SwOrderBook::TopOfBook{}, decision_);
+    }
+    return SwOrderBook::MakeResponse(event.word0, top_[symbol], decision_);
+  }
+
+ private:
+  std::size_t SideIndex(uint32_t symbol, uint32_t side) const {
+    return static_cast<std::size_t>(symbol) * 2u + (side == SwOrderBook::kSideSell ? 1u : 0u);
+  }
+
+  std::size_t SideBase(std::size_t side_index) const {
+    return side_index * config_.max_levels_per_side;
+  }
+
+  // Sort key that is ascending towards the best price on both sides.
+  static uint32_t SideKey(uint32_t side, uint32_t price) {
+    return side == SwOrderBook::kSideSell ? ~price : price;
+  }
+
+  uint32_t HashSlot(uint32_t id) const { return (id * 0x9E3779B1u) & hash_mask_; }
+
+  uint32_t Lookup(uint32_t id) const {
+    for (uint32_t slot = HashSlot(id);; slot = (slot + 1u) & hash_mask_) {
+      const uint32_t idx = hash_[slot];
+      if (idx == kNone || orders_[idx].id == id) {
+        return idx;
+      }
+    }
+  }
+
+  void HashInsert(uint32_t id, uint32_t idx) {
+    uint32_t slot = HashSlot(id);
+    while (hash_[slot] != kNone) {
+      slot = (slot + 1u) & hash_mask_;
+    }
+    hash_[slot] = idx;
+  }
+
+  // Linear probing with backward-shift deletion, so there are no tombstones
+  // and probe lengths stay short under heavy add/cancel churn.
+  void HashErase(uint32_t id) {
+    uint32_t hole = HashSlot(id);
+    while (orders_[hash_[hole]].id != id) {
+      hole = (hole + 1u) & hash_mask_;
+    }
+    uint32_t slot = hole;
+    for (;;) {
+      slot = (slot + 1u) & hash_mask_;
+      const uint32_t idx = hash_[slot];
+      if (idx == kNone) {
+        break;
+      }
+      const uint32_t home = HashSlot(orders_[idx].id);
+      // Move the entry back unless its home lies cyclically in (hole, slot].
+      if (((slot - home) & hash_mask_) >= ((slot - hole) & hash_mask_)) {
+        hash_[hole] = idx;
+        hole = slot;
+      }
+    }
+    hash_[hole] = kNone;
+  }
+
+  // Position of `key` in the side array, or where it would be inserted.
+  uint32_t LowerBound(std::size_t base, uint32_t count, uint32_t key) const {
+    const uint32_t* first = &side_key_[base];
+    return static_cast<uint32_t>(std::lower_bound(first, first + count, key) - first);
+  }
+
+  uint32_t FindOrCreateLevel(uint32_t symbol, uint32_t side, uint32_t price) {
+    const std::size_t s = SideIndex(symbol, side);
+    const std::size_t base = SideBase(s);
+    const uint32_t key = SideKey(side, price);
+    const uint32_t count = side_count_[s];
+    const uint32_t pos = LowerBound(base, count, key);
+    if (pos < count && side_key_[base + pos] == key) {
+      return side_level_[base + pos];
+    }
+    if (count == config_.max_levels_per_side || free_level_ == kNone) {
+      return kNone;
+    }
+
+    const uint32_t lvl = free_level_;
+    free_level_ = levels_[lvl].head;
+    Level& level = levels_[lvl];
+    level.total_qty = 0;
+    level.price = price;
+    level.orders = 0;
+    level.head = kNone;
+    level.tail = kNone;
+
+    uint32_t* keys = &side_key_[base];
+    uint32_t* lvls = &side_level_[base];
+    std::copy_backward(keys + pos, keys + count, keys + count + 1);
+    std::copy_backward(lvls + pos, lvls + count, lvls + count + 1);
+    keys[pos] = key;
+    lvls[pos] = lvl;
+    side_count_[s] = count + 1u;
+    return lvl;
+  }
+
+  void RemoveLevel(uint32_t symbol, uint32_t side, uint32_t lvl) {
+    const std::size_t s = SideIndex(symbol, side);
+    const std::size_t base = SideBase(s);
+    const uint32_t count = side_count_[s];
+    const uint32_t pos = LowerBound(base, count, SideKey(side, levels_[lvl].price));
+    uint32_t* keys = &side_key_[base];
+    uint32_t* lvls = &side_level_[base];
+    std::copy(keys + pos + 1, keys + count, keys + pos);
+    std::copy(lvls + pos + 1, lvls + count, lvls + pos);
+    side_count_[s] = count - 1u;
+
+    levels_[lvl].head = free_level_;
+    free_level_ = lvl;
+  }
+
+  void RefreshTop(uint32_t symbol, uint32_t side) {
+    const Level* best = LevelAt(symbol, side, 0);
+    const uint32_t px = best == nullptr ? 0u : best->price;
+    const uint32_t qty =
+        best == nullptr ? 0u : static_cast<uint32_t>(std::min<uint64_t>(best->total_qty, 0xFFFFFFFFull));
+    SwOrderBook::TopOfBook& top = top_[symbol];
+    if (side == SwOrderBook::kSideBuy) {
+      top.bid_px = px;
+      top.bid_qty = qty;
+    } else {
+      top.ask_px = px;
+      top.ask_qty = qty;
+    }
+  }
+
+  // Links a free pool entry at the tail of its price level.
+  bool Insert(uint32_t symbol, uint32_t side, uint32_t id, uint32_t price, uint32_t qty) {
+    if (free_order_ == kNone) {
+      return false;
+    }
+    const uint32_t lvl = FindOrCreateLevel(symbol, side, price);
+    if (lvl == kNone) {
+      return false;
+    }
+    const uint32_t idx = free_order_;
+    Order& order = orders_[idx];
+    free_order_ = order.next;
+
+    Level& level = levels_[lvl];
+    order.id = id;
+    order.symbol = symbol;
+    order.side = side;
+    order.price = price;
+    order.qty = qty;
+    order.level = lvl;
+    order.prev = level.tail;
+    order.next = kNone;
+    if (level.tail == kNone) {
+      level.head = idx;
+    } else {
+      orders_[level.tail].next = idx;
+    }
+    level.tail = idx;
+    ++level.orders;
+    level.total_qty += qty;
+
+    HashInsert(id, idx);
+    ++live_orders_;
+    return true;
+  }
+
+  // Unlinks an order, drops its level when it empties and frees the entry.
+  void Remove(uint32_t idx) {
+    Order& order = orders_[idx];
+    Level& level = levels_[order.level];
+    if (order.prev == kNone) {
+      level.head = order.next;
+    } else {
+      orders_[order.prev].next = order.next;
+    }
+    if (order.next == kNone) {
+      level.tail = order.prev;
+    } else {
+      orders_[order.next].prev = order.prev;
+    }
+    level.total_qty -= order.qty;
+    if (--level.orders == 0) {
+      RemoveLevel(order.symbol, order.side, order.level);
+    }
+
+    HashErase(order.id);
+    order.next = free_order_;
+    free_order_ = idx;
+    --live_orders_;
+  }
+
+  void Add(uint32_t symbol, uint32_t side, uint32_t id, uint32_t price, uint32_t qty) {
+    if ((side != SwOrderBook::kSideBuy && side != SwOrderBook::kSideSell) || qty == 0 ||
+        Lookup(id) != kNone || !Insert(symbol, side, id, price, qty)) {
+      ++stats_.rejected;
+      return;
+    }
+    ++stats_.adds;
+    RefreshTop(symbol, side);
+  }
+
+  // The rejection paths below report `fallback` (the event's word1) so an
+  // unknown id still gets a response for the symbol the feed named.
+  uint32_t Modify(uint32_t id, uint32_t price, uint32_t qty, uint32_t fallback) {
+    const uint32_t idx = Lookup(id);
+    if (idx == kNone) {
+      ++stats_.rejected;
+      return fallback;
+    }
+    Order& order = orders_[idx];
+    const uint32_t symbol = order.symbol;
+    const uint32_t side = order.side;
+    if (qty == 0) {
+      Remove(idx);
+    } else if (price == order.price && qty <= order.qty) {
+      // Size reductions at the same price keep queue position.
+      levels_[order.level].total_qty -= order.qty - qty;
+      order.qty = qty;
+    } else {
+      // Price changes and size increases lose priority. The freed entry is
+      // reused, so re-inserting cannot run out of pool.
+      Remove(idx);
+      if (!Insert(symbol, side, id, price, qty)) {
+        ++stats_.rejected;
+        RefreshTop(symbol, side);
+        return symbol;
+      }
+    }
+    ++stats_.modifies;
+    RefreshTop(symbol, side);
+    return symbol;
+  }
+
+  uint32_t Cancel(uint32_t id, uint32_t fallback) {
+    const uint32_t idx = Lookup(id);
+    if (idx == kNone) {
+      ++stats_.rejected;
+      return fallback;
+    }
+    const uint32_t symbol = orders_[idx].symbol;
+    const uint32_t side = orders_[idx].side;
+    Remove(idx);
+    ++stats_.cancels;
+    RefreshTop(symbol, side);
+    return symbol;
+  }
+
+  // Fills `qty` against the order; a fill at or above its size removes it.
+  uint32_t Execute(uint32_t id, uint32_t qty, uint32_t fallback) {
+    const uint32_t idx = Lookup(id);
+    if (idx == kNone) {
+      ++stats_.rejected;
+      return fallback;
+    }
+    Order& order = orders_[idx];
+    const uint32_t symbol = order.symbol;
+    const uint32_t side = order.side;
+    if (qty >= order.qty) {
+      Remove(idx);
+    } else {
+      levels_[order.level].total_qty -= qty;
+      order.qty -= qty;
+    }
+    ++stats_.executes;
+    RefreshTop(symbol, side);
+    return symbol;
+  }
+
+  void ResetSymbol(uint32_t symbol) {
+    for (uint32_t side = SwOrderBook::kSideBuy; side <= SwOrderBook::kSideSell; ++side) {
+      const std::size_t s = SideIndex(symbol, side);
+      while (side_count_[s] != 0) {
+        Remove(levels_[side_level_[SideBase(s) + side_count_[s] - 1u]].head);
+      }
+    }
+    top_[symbol] = SwOrderBook::TopOfBook{};
+    ++stats_.resets;
+  }
+
+  Config config_;
+  SwOrderBook::Config decision_;
+  uint32_t hash_mask_;
+  uint32_t free_order_;
+  uint32_t free_level_;
+  uint32_t live_orders_;
+  Stats stats_;
+  std::vector<Order> orders_;
+  std::vector<Level> levels_;
+  std::vector<uint32_t> hash_;
+  std::vector<uint32_t> side_count_;
+  std::vector<uint32_t> side_key_;
+  std::vector<uint32_t> side_level_;
+  std::vector<SwOrderBook::TopOfBook> top_;
+};
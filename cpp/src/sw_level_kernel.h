@@ -0,0 +1,316 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(HFT_SW_LEVEL_KERNEL_FORCE_SCALAR)
+// Vector kernels disabled at build time.
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define HFT_SW_LEVEL_KERNEL_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define HFT_SW_LEVEL_KERNEL_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HFT_SW_LEVEL_KERNEL_NEON 1
+#endif
+
+#if defined(HFT_SW_LEVEL_KERNEL_AVX2) || defined(HFT_SW_LEVEL_KERNEL_SSE2) || \
+    defined(HFT_SW_LEVEL_KERNEL_NEON)
+#define HFT_SW_LEVEL_KERNEL_VECTOR 1
+#endif
+
+// Depth-8 level update for one side of one symbol, as used by SwOrderBook.
+//
+// One compare pass over all eight levels yields two lane masks: levels whose
+// price matches (and are live), and levels the new price would go in front
+// of (empty, or worse than the new price). The match is the highest set bit
+// and the insert point the lowest, exactly what the scalar loops pick. The
+// shift for delete or insert is a one-lane move of the whole side followed by
+// a blend on the lane index, with no per-level branches.
+//
+// Results are bit-identical to SwOrderBook::ApplyLevelUpdateScalar for
+// depth 8; tests/sw_level_kernel_test.cpp checks this on random books.
+// Without SSE2/AVX2/NEON (or with HFT_SW_LEVEL_KERNEL_FORCE_SCALAR) the book
+// keeps the scalar loops: a branchless scalar version of this algorithm was
+// measured slower than them.
+class SwLevelKernel {
+ public:
+  static const uint32_t kDepth = 8;
+
+  static const char* Name() {
+#if defined(HFT_SW_LEVEL_KERNEL_AVX2)
+    return "avx2";
+#elif defined(HFT_SW_LEVEL_KERNEL_SSE2)
+    return "sse2";
+#elif defined(HFT_SW_LEVEL_KERNEL_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+  }
+
+#if defined(HFT_SW_LEVEL_KERNEL_VECTOR)
+  // `px`/`qty` hold eight levels, best first. Bids sort descending
+  // (`desc_sort`), asks ascending.
+  static void Apply(uint32_t* px, uint32_t* qty, uint32_t price, uint32_t new_qty,
+                    bool is_delete, bool desc_sort) {
+#if defined(HFT_SW_LEVEL_KERNEL_AVX2)
+    ApplyAvx2(px, qty, price, new_qty, is_delete, desc_sort);
+#elif defined(HFT_SW_LEVEL_KERNEL_SSE2)
+    ApplySse2(px, qty, price, new_qty, is_delete, desc_sort);
+#else
+    ApplyNeon(px, qty, price, new_qty, is_delete, desc_sort);
+#endif
+  }
+
+ private:
+  enum Outcome { kNone = 0, kUpdateQty = 1, kRemove = 2, kInsert = 3 };
+
+  static Outcome Classify(uint32_t match_bits, uint32_t insert_bits, bool is_delete,
+                          uint32_t new_qty, uint32_t* lane) {
+    const bool remove = is_delete || new_qty == 0;
+    if (match_bits != 0) {
+      *lane = 31u - static_cast<uint32_t>(__builtin_clz(match_bits));
+      return remove ? kRemove : kUpdateQty;
+    }
+    if (remove || insert_bits == 0) {
+      return kNone;
+    }
+    *lane = static_cast<uint32_t>(__builtin_ctz(insert_bits));
+    return kInsert;
+  }
+
+#if defined(HFT_SW_LEVEL_KERNEL_AVX2)
+  static __m256i GreaterU32(__m256i a, __m256i b) {
+    const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    return _mm256_cmpgt_epi32(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+  }
+
+  static uint32_t MoveMask(__m256i m) {
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+  }
+
+  static __m256i ShiftOutAvx2(__m256i v, __m256i from_k) {
+    // next[i] = v[i + 1], lane 7 = 0
+    const __m256i next = _mm256_blend_epi32(
+        _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 7)),
+        _mm256_setzero_si256(), 0x80);
+    return _mm256_blendv_epi8(v, next, from_k);
+  }
+
+  static __m256i ShiftInAvx2(__m256i v, __m256i after_k, __m256i at_k, uint32_t value) {
+    // prev[i] = v[i - 1]
+    const __m256i prev =
+        _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6));
+    const __m256i shifted = _mm256_blendv_epi8(v, prev, after_k);
+    return _mm256_blendv_epi8(shifted, _mm256_set1_epi32(static_cast<int>(value)), at_k);
+  }
+
+  static void ApplyAvx2(uint32_t* px, uint32_t* qty, uint32_t price, uint32_t new_qty,
+                        bool is_delete, bool desc_sort) {
+    const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(px));
+    const __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(qty));
+    const __m256i target = _mm256_set1_epi32(static_cast<int>(price));
+    const __m256i empty = _mm256_cmpeq_epi32(q, _mm256_setzero_si256());
+    const __m256i match = _mm256_andnot_si256(empty, _mm256_cmpeq_epi32(p, target));
+    const __m256i better = desc_sort ? GreaterU32(target, p) : GreaterU32(p, target);
+    const uint32_t match_bits = MoveMask(match);
+    const uint32_t insert_bits = MoveMask(_mm256_or_si256(empty, better));
+
+    uint32_t k = 0;
+    const Outcome outcome = Classify(match_bits, insert_bits, is_delete, new_qty, &k);
+    if (outcome == kUpdateQty) {
+      qty[k] = new_qty;
+      return;
+    }
+    if (outcome == kNone) {
+      return;
+    }
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i kv = _mm256_set1_epi32(static_cast<int>(k));
+    const __m256i at_k = _mm256_cmpeq_epi32(lanes, kv);
+    const __m256i after_k = _mm256_cmpgt_epi32(lanes, kv);
+    if (outcome == kRemove) {
+      const __m256i from_k = _mm256_or_si256(at_k, after_k);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(px), ShiftOutAvx2(p, from_k));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(qty), ShiftOutAvx2(q, from_k));
+    } else {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(px), ShiftInAvx2(p, after_k, at_k, price));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(qty),
+                          ShiftInAvx2(q, after_k, at_k, new_qty));
+    }
+  }
+#endif
+
+#if defined(HFT_SW_LEVEL_KERNEL_SSE2)
+  // Eight lanes as two registers: lo = levels 0..3, hi = levels 4..7.
+  static __m128i GreaterU32(__m128i a, __m128i b) {
+    const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+  }
+
+  static uint32_t MoveMask(__m128i lo, __m128i hi) {
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(lo))) |
+           (static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(hi))) << 4);
+  }
+
+  static __m128i Select(__m128i mask, __m128i a, __m128i b) {
+    // mask ? a : b
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+  }
+
+  static void ShiftOutSse2(__m128i* lo, __m128i* hi, __m128i from_k_lo, __m128i from_k_hi) {
+    const __m128i next_lo = _mm_or_si128(_mm_srli_si128(*lo, 4), _mm_slli_si128(*hi, 12));
+    const __m128i next_hi = _mm_srli_si128(*hi, 4);
+    *lo = Select(from_k_lo, next_lo, *lo);
+    *hi = Select(from_k_hi, next_hi, *hi);
+  }
+
+  static void ShiftInSse2(__m128i* lo, __m128i* hi, __m128i after_lo, __m128i after_hi,
+                          __m128i at_lo, __m128i at_hi, uint32_t value) {
+    const __m128i prev_lo = _mm_slli_si128(*lo, 4);
+    const __m128i prev_hi = _mm_or_si128(_mm_slli_si128(*hi, 4), _mm_srli_si128(*lo, 12));
+    const __m128i v = _mm_set1_epi32(static_cast<int>(value));
+    *lo = Select(at_lo, v, Select(after_lo, prev_lo, *lo));
+    *hi = Select(at_hi, v, Select(after_hi, prev_hi, *hi));
+  }
+
+  static void ApplySse2(uint32_t* px, uint32_t* qty, uint32_t price, uint32_t new_qty,
+                        bool is_delete, bool desc_sort) {
+    __m128i p_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(px));
+    __m128i p_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(px + 4));
+    __m128i q_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(qty));
+    __m128i q_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(qty + 4));
+    const __m128i target = _mm_set1_epi32(static_cast<int>(price));
+    const __m128i zero = _mm_setzero_si128();
+
+    const __m128i empty_lo = _mm_cmpeq_epi32(q_lo, zero);
+    const __m128i empty_hi = _mm_cmpeq_epi32(q_hi, zero);
+    const __m128i match_lo = _mm_andnot_si128(empty_lo, _mm_cmpeq_epi32(p_lo, target));
+    const __m128i match_hi = _mm_andnot_si128(empty_hi, _mm_cmpeq_epi32(p_hi, target));
+    const __m128i better_lo = desc_sort ? GreaterU32(target, p_lo) : GreaterU32(p_lo, target);
+    const __m128i better_hi = desc_sort ? GreaterU32(target, p_hi) : GreaterU32(p_hi, target);
+    const uint32_t match_bits = MoveMask(match_lo, match_hi);
+    const uint32_t insert_bits =
+        MoveMask(_mm_or_si128(empty_lo, better_lo), _mm_or_si128(empty_hi, better_hi));
+
+    uint32_t k = 0;
+    const Outcome outcome = Classify(match_bits, insert_bits, is_delete, new_qty, &k);
+    if (outcome == kUpdateQty) {
+      qty[k] = new_qty;
+      return;
+    }
+    if (outcome == kNone) {
+      return;
+    }
+    const __m128i kv = _mm_set1_epi32(static_cast<int>(k));
+    const __m128i lanes_lo = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i lanes_hi = _mm_setr_epi32(4, 5, 6, 7);
+    const __m128i at_lo = _mm_cmpeq_epi32(lanes_lo, kv);
+    const __m128i at_hi = _mm_cmpeq_epi32(lanes_hi, kv);
+    const __m128i after_lo = _mm_cmpgt_epi32(lanes_lo, kv);
+    const __m128i after_hi = _mm_cmpgt_epi32(lanes_hi, kv);
+    if (outcome == kRemove) {
+      const __m128i from_lo = _mm_or_si128(at_lo, after_lo);
+      const __m128i from_hi = _mm_or_si128(at_hi, after_hi);
+      ShiftOutSse2(&p_lo, &p_hi, from_lo, from_hi);
+      ShiftOutSse2(&q_lo, &q_hi, from_lo, from_hi);
+    } else {
+      ShiftInSse2(&p_lo, &p_hi, after_lo, after_hi, at_lo, at_hi, price);
+      ShiftInSse2(&q_lo, &q_hi, after_lo, after_hi, at_lo, at_hi, new_qty);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(px), p_lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(px + 4), p_hi);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(qty), q_lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(qty + 4), q_hi);
+  }
+#endif
+
+#if defined(HFT_SW_LEVEL_KERNEL_NEON)
+  // Eight lanes as two registers: lo = levels 0..3, hi = levels 4..7.
+  static uint32_t MoveMask(uint32x4_t lo, uint32x4_t hi) {
+    static const uint32_t kBitsLo[4] = {1u, 2u, 4u, 8u};
+    static const uint32_t kBitsHi[4] = {16u, 32u, 64u, 128u};
+    const uint32x4_t bits =
+        vorrq_u32(vandq_u32(lo, vld1q_u32(kBitsLo)), vandq_u32(hi, vld1q_u32(kBitsHi)));
+    // ARMv7 has no horizontal add across a q register.
+    uint32x2_t sum = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+    sum = vpadd_u32(sum, sum);
+    return vget_lane_u32(sum, 0);
+  }
+
+  static void ShiftOutNeon(uint32x4_t* lo, uint32x4_t* hi, uint32x4_t from_lo,
+                           uint32x4_t from_hi) {
+    const uint32x4_t zero = vdupq_n_u32(0);
+    const uint32x4_t next_lo = vextq_u32(*lo, *hi, 1);
+    const uint32x4_t next_hi = vextq_u32(*hi, zero, 1);
+    *lo = vbslq_u32(from_lo, next_lo, *lo);
+    *hi = vbslq_u32(from_hi, next_hi, *hi);
+  }
+
+  static void ShiftInNeon(uint32x4_t* lo, uint32x4_t* hi, uint32x4_t after_lo,
+                          uint32x4_t after_hi, uint32x4_t at_lo, uint32x4_t at_hi,
+                          uint32_t value) {
+    const uint32x4_t zero = vdupq_n_u32(0);
+    const uint32x4_t prev_lo = vextq_u32(zero, *lo, 3);
+    const uint32x4_t prev_hi = vextq_u32(*lo, *hi, 3);
+    const uint32x4_t v = vdupq_n_u32(value);
+    *lo = vbslq_u32(at_lo, v, vbslq_u32(after_lo, prev_lo, *lo));
+    *hi = vbslq_u32(at_hi, v, vbslq_u32(after_hi, prev_hi, *hi));
+  }
+
+  static void ApplyNeon(uint32_t* px, uint32_t* qty, uint32_t price, uint32_t new_qty,
+                        bool is_delete, bool desc_sort) {
+    uint32x4_t p_lo = vld1q_u32(px);
+    uint32x4_t p_hi = vld1q_u32(px + 4);
+    uint32x4_t q_lo = vld1q_u32(qty);
+    uint32x4_t q_hi = vld1q_u32(qty + 4);
+    const uint32x4_t target = vdupq_n_u32(price);
+    const uint32x4_t zero = vdupq_n_u32(0);
+
+    const uint32x4_t empty_lo = vceqq_u32(q_lo, zero);
+    const uint32x4_t empty_hi = vceqq_u32(q_hi, zero);
+    const uint32x4_t match_lo = vbicq_u32(vceqq_u32(p_lo, target), empty_lo);
+    const uint32x4_t match_hi = vbicq_u32(vceqq_u32(p_hi, target), empty_hi);
+    const uint32x4_t better_lo = desc_sort ? vcgtq_u32(target, p_lo) : vcltq_u32(target, p_lo);
+    const uint32x4_t better_hi = desc_sort ? vcgtq_u32(target, p_hi) : vcltq_u32(target, p_hi);
+    const uint32_t match_bits = MoveMask(match_lo, match_hi);
+    const uint32_t insert_bits =
+        MoveMask(vorrq_u32(empty_lo, better_lo), vorrq_u32(empty_hi, better_hi));
+
+    uint32_t k = 0;
+    const Outcome outcome = Classify(match_bits, insert_bits, is_delete, new_qty, &k);
+    if (outcome == kUpdateQty) {
+      qty[k] = new_qty;
+      return;
+    }
+    if (outcome == kNone) {
+      return;
+    }
+    static const uint32_t kLanesLo[4] = {0u, 1u, 2u, 3u};
+    static const uint32_t kLanesHi[4] = {4u, 5u, 6u, 7u};
+    const uint32x4_t kv = vdupq_n_u32(k);
+    const uint32x4_t lanes_lo = vld1q_u32(kLanesLo);
+    const uint32x4_t lanes_hi = vld1q_u32(kLanesHi);
+    const uint32x4_t at_lo = vceqq_u32(lanes_lo, kv);
+    const uint32x4_t at_hi = vceqq_u32(lanes_hi, kv);
+    const uint32x4_t after_lo = vcgtq_u32(lanes_lo, kv);
+    const uint32x4_t after_hi = vcgtq_u32(lanes_hi, kv);
+    if (outcome == kRemove) {
+      const uint32x4_t from_lo = vorrq_u32(at_lo, after_lo);
+      const uint32x4_t from_hi = vorrq_u32(at_hi, after_hi);
+      ShiftOutNeon(&p_lo, &p_hi, from_lo, from_hi);
+      ShiftOutNeon(&q_lo, &q_hi, from_lo, from_hi);
+    } else {
+      ShiftInNeon(&p_lo, &p_hi, after_lo, after_hi, at_lo, at_hi, price);
+      ShiftInNeon(&q_lo, &q_hi, after_lo, after_hi, at_lo, at_hi, new_qty);
+    }
+    vst1q_u32(px, p_lo);
+    vst1q_u32(px + 4, p_hi);
+    vst1q_u32(qty, q_lo);
+    vst1q_u32(qty + 4, q_hi);
+  }
+#endif
+#endif  // HFT_SW_LEVEL_KERNEL_VECTOR
+};
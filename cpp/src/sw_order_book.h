@@ -0,0 +1,373 @@
+#pragma once
+
+#include "fpga_shared_stream.h"
+#include "sw_level_kernel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Software model of order_book_core + trade_decision_core.
+//
+// Consumes the same 8-word event frames as the FPGA and produces the same
+// response frames, so benchmarks, receivers and tests share one engine.
+//
+// Layout: levels are struct-of-arrays, one price array and one quantity array
+// per side, each holding `depth` contiguous levels per symbol. The per-symbol
+// top of book is kept separately in 16-byte records, four per 64-byte cache
+// line, so building a response touches one line no matter how deep the book is.
+class SwOrderBook {
+ public:
+  static const uint32_t kEventUpsertLevel = 1;
+  static const uint32_t kEventDeleteLevel = 2;
+  static const uint32_t kEventResetBook = 3;
+  // Order-by-order events, order id in word6. Only SwL3Book understands
+  // them; the level book (like the FPGA) treats unknown types as upserts.
+  static const uint32_t kEventAddOrder = 4;
+  static const uint32_t kEventModifyOrder = 5;
+  static const uint32_t kEventCancelOrder = 6;
+  static const uint32_t kEventExecuteOrder = 7;
+  static const uint32_t kSideBuy = 1;
+  static const uint32_t kSideSell = 2;
+  static const uint32_t kActionNoop = 0;
+  static const uint32_t kActionBuy = 1;
+  static const uint32_t kActionSell = 2;
+
+  static const uint32_t kDefaultNumSymbols = 8;
+  static const uint32_t kDefaultDepth = 8;
+  static const uint32_t kDefaultImbalanceThreshold = 500;
+  static const uint32_t kDefaultMaxSpread1e4 = 25000;
+
+  struct Config {
+    uint32_t num_symbols;
+    uint32_t depth;
+    uint32_t imbalance_threshold;
+    uint32_t max_spread_1e4;
+  };
+
+  struct TopOfBook {
+    uint32_t bid_px;
+    uint32_t bid_qty;
+    uint32_t ask_px;
+    uint32_t ask_qty;
+  };
+
+  // Default strategy policy: the FPGA's trade_decision_core rule
+  // (matlab/strategy.m), trading on top-of-book size imbalance while the
+  // spread is tight enough.
+  //
+  // A strategy policy is any type with
+  //   uint32_t Decide(const SwOrderBook& book, uint32_t symbol,
+  //                   const TopOfBook& top, uint32_t spread_1e4,
+  //                   int32_t imbalance) const;
+  // returning a kAction* code. It is a template argument of Process(), so the
+  // call inlines into the caller's loop; `book` and `symbol` give access to
+  // the full depth. More policies are in sw_strategies.h.
+  struct ImbalanceStrategy {
+    uint32_t imbalance_threshold;
+    uint32_t max_spread_1e4;
+
+    static const char* Name() { return "imbalance"; }
+
+    static ImbalanceStrategy Default() {
+      ImbalanceStrategy strategy{};
+      strategy.imbalance_threshold = kDefaultImbalanceThreshold;
+      strategy.max_spread_1e4 = kDefaultMaxSpread1e4;
+      return strategy;
+    }
+
+    uint32_t Decide(const SwOrderBook&, uint32_t, const TopOfBook& top, uint32_t spread_1e4,
+                    int32_t imbalance) const {
+      return ImbalanceDecision(top, spread_1e4, imbalance, imbalance_threshold, max_spread_1e4);
+    }
+  };
+
+  // Matches the FPGA build (8 symbols, depth 8).
+  static Config DefaultConfig() {
+    Config config{};
+    config.num_symbols = kDefaultNumSymbols;
+    config.depth = kDefaultDepth;
+    config.imbalance_threshold = kDefaultImbalanceThreshold;
+    config.max_spread_1e4 = kDefaultMaxSpread1e4;
+    return config;
+  }
+
+  SwOrderBook() : config_{}, top_(nullptr), out_of_range_events_(0) { Init(DefaultConfig()); }
+
+  explicit SwOrderBook(const Config& config)
+      : config_{}, top_(nullptr), out_of_range_events_(0) {
+    Init(config);
+  }
+
+  ~SwOrderBook() { std::free(top_); }
+
+  SwOrderBook(const SwOrderBook&) = delete;
+  SwOrderBook& operator=(const SwOrderBook&) = delete;
+
+  // (Re)allocates an empty book. Fails for a zero symbol count or depth.
+  bool Init(const Config& config) {
+    if (config.num_symbols == 0 || config.depth == 0) {
+      return false;
+    }
+    void* top = nullptr;
+    const std::size_t top_bytes = static_cast<std::size_t>(config.num_symbols) * sizeof(TopOfBook);
+    if (posix_memalign(&top, 64, top_bytes) != 0) {
+      return false;
+    }
+    std::free(top_);
+    top_ = static_cast<TopOfBook*>(top);
+    config_ = config;
+
+    const std::size_t levels = static_cast<std::size_t>(config.num_symbols) * config.depth;
+    bid_px_.assign(levels, 0);
+    bid_qty_.assign(levels, 0);
+    ask_px_.assign(levels, 0);
+    ask_qty_.assign(levels, 0);
+    Clear();
+    return true;
+  }
+
+  void Clear() {
+    std::fill(bid_px_.begin(), bid_px_.end(), 0u);
+    std::fill(bid_qty_.begin(), bid_qty_.end(), 0u);
+    std::fill(ask_px_.begin(), ask_px_.end(), 0u);
+    std::fill(ask_qty_.begin(), ask_qty_.end(), 0u);
+    for (uint32_t s = 0; s < config_.num_symbols; ++s) {
+      top_[s] = TopOfBook{};
+    }
+    out_of_range_events_ = 0;
+  }
+
+  const Config& GetConfig() const { return config_; }
+  uint32_t NumSymbols() const { return config_.num_symbols; }
+  uint32_t Depth() const { return config_.depth; }
+
+  // Events for symbols outside the book; they get an all-zero response like
+  // on the FPGA.
+  uint64_t OutOfRangeEvents() const { return out_of_range_events_; }
+
+  const TopOfBook& Top(uint32_t symbol) const { return top_[symbol]; }
+
+  const uint32_t* BidPrices(uint32_t symbol) const { return &bid_px_[LevelBase(symbol)]; }
+  const uint32_t* BidQtys(uint32_t symbol) const { return &bid_qty_[LevelBase(symbol)]; }
+  const uint32_t* AskPrices(uint32_t symbol) const { return &ask_px_[LevelBase(symbol)]; }
+  const uint32_t* AskQtys(uint32_t symbol) const { return &ask_qty_[LevelBase(symbol)]; }
+
+  // Applies one event and returns the response the FPGA would produce.
+  FpgaSharedStream::Frame Process(const FpgaSharedStream::Frame& event) {
+    return Process(event, DefaultStrategy());
+  }
+
+  // Book update only, for callers that decide later (SwBatchBook). Returns
+  // false for a symbol outside the book.
+  bool ApplyEvent(const FpgaSharedStream::Frame& event) {
+    if (event.word1 >= config_.num_symbols) {
+      ++out_of_range_events_;
+      return false;
+    }
+    Apply(event.word1, event.word2, event.word3, event.word4, event.word5);
+    return true;
+  }
+
+  // Same book update, with the decision taken by `strategy`.
+  template <typename Strategy>
+  FpgaSharedStream::Frame Process(const FpgaSharedStream::Frame& event, const Strategy& strategy) {
+    const uint32_t symbol = event.word1;
+    if (symbol >= config_.num_symbols) {
+      ++out_of_range_events_;
+      return BuildResponse(event.word0, TopOfBook{}, 0, 0, kActionNoop);
+    }
+    Apply(symbol, event.word2, event.word3, event.word4, event.word5);
+    const TopOfBook& top = top_[symbol];
+    const uint32_t spread = Spread(top);
+    const int32_t imbalance = Imbalance(top);
+    return BuildResponse(event.word0, top, spread, imbalance,
+                         strategy.Decide(*this, symbol, top, spread, imbalance));
+  }
+
+  // The built-in rule with this book's thresholds.
+  ImbalanceStrategy DefaultStrategy() const {
+    ImbalanceStrategy strategy{};
+    strategy.imbalance_threshold = config_.imbalance_threshold;
+    strategy.max_spread_1e4 = config_.max_spread_1e4;
+    return strategy;
+  }
+
+  FpgaSharedStream::Frame MakeResponse(uint32_t seq, const TopOfBook& top) const {
+    return MakeResponse(seq, top, config_);
+  }
+
+  uint32_t DecideAction(const TopOfBook& top, uint32_t spread_1e4, int32_t imbalance) const {
+    return DecideAction(top, spread_1e4, imbalance, config_);
+  }
+
+  // Response and decision for any top of book; other engines (SwL3Book)
+  // reuse these with their own thresholds.
+  static FpgaSharedStream::Frame MakeResponse(uint32_t seq, const TopOfBook& top,
+                                              const Config& config) {
+    const uint32_t spread = Spread(top);
+    const int32_t imbalance = Imbalance(top);
+    return BuildResponse(seq, top, spread, imbalance,
+                         DecideAction(top, spread, imbalance, config));
+  }
+
+  // Spread of a two-sided, uncrossed book, else 0.
+  static uint32_t Spread(const TopOfBook& top) {
+    if (top.bid_qty != 0 && top.ask_qty != 0 && top.ask_px > top.bid_px) {
+      return top.ask_px - top.bid_px;
+    }
+    return 0;
+  }
+
+  static int32_t Imbalance(const TopOfBook& top) {
+    return static_cast<int32_t>(top.bid_qty) - static_cast<int32_t>(top.ask_qty);
+  }
+
+  static FpgaSharedStream::Frame BuildResponse(uint32_t seq, const TopOfBook& top,
+                                               uint32_t spread_1e4, int32_t imbalance,
+                                               uint32_t action) {
+    FpgaSharedStream::Frame response{};
+    response.word0 = seq;
+    response.word1 = action;
+    response.word2 = top.bid_px;
+    response.word3 = top.bid_qty;
+    response.word4 = top.ask_px;
+    response.word5 = top.ask_qty;
+    response.word6 = spread_1e4;
+    response.word7 = static_cast<uint32_t>(imbalance);
+    return response;
+  }
+
+  static uint32_t DecideAction(const TopOfBook& top, uint32_t spread_1e4, int32_t imbalance,
+                               const Config& config) {
+    return ImbalanceDecision(top, spread_1e4, imbalance, config.imbalance_threshold,
+                             config.max_spread_1e4);
+  }
+
+  static uint32_t ImbalanceDecision(const TopOfBook& top, uint32_t spread_1e4, int32_t imbalance,
+                                    uint32_t imbalance_threshold, uint32_t max_spread_1e4) {
+    if (top.bid_qty == 0 || top.ask_qty == 0 || top.ask_px <= top.bid_px) {
+      return kActionNoop;
+    }
+    const int32_t threshold = static_cast<int32_t>(imbalance_threshold);
+    if (spread_1e4 <= max_spread_1e4 && imbalance >= threshold) {
+      return kActionBuy;
+    }
+    if (spread_1e4 <= max_spread_1e4 && imbalance <= -threshold) {
+      return kActionSell;
+    }
+    return kActionNoop;
+  }
+
+  // Level update on one side of one symbol: `px`/`qty` hold `depth` levels,
+  // best first. Bids sort descending, asks ascending. Depth 8 (the FPGA
+  // depth) runs the vector kernel when one is compiled in.
+  static void ApplyLevelUpdate(uint32_t* px, uint32_t* qty, uint32_t depth, uint32_t price,
+                               uint32_t new_qty, bool is_delete, bool desc_sort) {
+#if defined(HFT_SW_LEVEL_KERNEL_VECTOR)
+    if (depth == SwLevelKernel::kDepth) {
+      SwLevelKernel::Apply(px, qty, price, new_qty, is_delete, desc_sort);
+      return;
+    }
+#endif
+    ApplyLevelUpdateScalar(px, qty, depth, price, new_qty, is_delete, desc_sort);
+  }
+
+  // Reference implementation for any depth.
+  static void ApplyLevelUpdateScalar(uint32_t* px, uint32_t* qty, uint32_t depth,
+                                     uint32_t price, uint32_t new_qty, bool is_delete,
+                                     bool desc_sort) {
+    int match_idx = -1;
+    for (uint32_t i = 0; i < depth; ++i) {
+      if (qty[i] != 0 && px[i] == price) {
+        match_idx = static_cast<int>(i);
+      }
+    }
+
+    if (match_idx >= 0) {
+      if (is_delete || new_qty == 0) {
+        DeleteAt(px, qty, depth, static_cast<uint32_t>(match_idx));
+      } else {
+        qty[match_idx] = new_qty;
+      }
+      return;
+    }
+
+    if (is_delete || new_qty == 0) {
+      return;
+    }
+
+    int insert_idx = -1;
+    for (uint32_t i = 0; i < depth; ++i) {
+      if (qty[i] == 0 || (desc_sort && price > px[i]) || (!desc_sort && price < px[i])) {
+        insert_idx = static_cast<int>(i);
+        break;
+      }
+    }
+    if (insert_idx < 0) {
+      return;
+    }
+
+    for (int i = static_cast<int>(depth) - 1; i > insert_idx; --i) {
+      px[i] = px[i - 1];
+      qty[i] = qty[i - 1];
+    }
+    px[insert_idx] = price;
+    qty[insert_idx] = new_qty;
+  }
+
+  static void DeleteAt(uint32_t* px, uint32_t* qty, uint32_t depth, uint32_t idx) {
+    for (uint32_t i = idx; i + 1 < depth; ++i) {
+      px[i] = px[i + 1];
+      qty[i] = qty[i + 1];
+    }
+    px[depth - 1] = 0;
+    qty[depth - 1] = 0;
+  }
+
+ private:
+  std::size_t LevelBase(uint32_t symbol) const {
+    return static_cast<std::size_t>(symbol) * config_.depth;
+  }
+
+  void Apply(uint32_t symbol, uint32_t price, uint32_t qty, uint32_t event_type, uint32_t side) {
+    const std::size_t base = LevelBase(symbol);
+    const uint32_t depth = config_.depth;
+    TopOfBook& top = top_[symbol];
+
+    if (event_type == kEventResetBook) {
+      std::fill(&bid_px_[base], &bid_px_[base] + depth, 0u);
+      std::fill(&bid_qty_[base], &bid_qty_[base] + depth, 0u);
+      std::fill(&ask_px_[base], &ask_px_[base] + depth, 0u);
+      std::fill(&ask_qty_[base], &ask_qty_[base] + depth, 0u);
+      top = TopOfBook{};
+      return;
+    }
+
+    const bool is_delete = event_type == kEventDeleteLevel;
+    if (side == kSideBuy) {
+      // A bid at or through the best ask would cross the book; drop it.
+      if (is_delete || top.ask_qty == 0 || price < top.ask_px) {
+        ApplyLevelUpdate(&bid_px_[base], &bid_qty_[base], depth, price, qty, is_delete, true);
+        top.bid_px = bid_px_[base];
+        top.bid_qty = bid_qty_[base];
+      }
+    } else if (side == kSideSell) {
+      if (is_delete || top.bid_qty == 0 || price > top.bid_px) {
+        ApplyLevelUpdate(&ask_px_[base], &ask_qty_[base], depth, price, qty, is_delete, false);
+        top.ask_px = ask_px_[base];
+        top.ask_qty = ask_qty_[base];
+      }
+    }
+  }
+
+  Config config_;
+  TopOfBook* top_;
+  uint64_t out_of_range_events_;
+  std::vector<uint32_t> bid_px_;
+  std::vector<uint32_t> bid_qty_;
+  std::vector<uint32_t> ask_px_;
+  std::vector<uint32_t> ask_qty_;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "sw_order_book.h"
+
+#include <cstdint>
+
+// Strategy policies for SwOrderBook::Process(event, strategy).
+//
+// Each policy is a small aggregate of parameters with an inline Decide();
+// the book passes it as a template argument, so the decision compiles into
+// the caller's loop with no virtual call. All of them return kActionNoop for
+// a one-sided or crossed book and above `max_spread_1e4`, like the built-in
+// SwOrderBook::ImbalanceStrategy.
+
+// Shared pieces of the policies below.
+struct SwStrategyRules {
+  static bool Tradable(const SwOrderBook::TopOfBook& top, uint32_t spread_1e4,
+                       uint32_t max_spread_1e4) {
+    return top.bid_qty != 0 && top.ask_qty != 0 && top.ask_px > top.bid_px &&
+           spread_1e4 <= max_spread_1e4;
+  }
+
+  // Buy at or above +threshold, sell at or below -threshold.
+  static uint32_t Signed(int64_t signal, int64_t threshold) {
+    if (signal >= threshold) {
+      return SwOrderBook::kActionBuy;
+    }
+    if (signal <= -threshold) {
+      return SwOrderBook::kActionSell;
+    }
+    return SwOrderBook::kActionNoop;
+  }
+};
+
+// Trades when the size-weighted microprice sits far enough from the mid:
+//   microprice - mid = spread * (bid_qty - ask_qty) / (2 * (bid_qty + ask_qty))
+// evaluated in 64-bit integers without the division.
+struct MicropriceStrategy {
+  uint32_t min_edge_1e4;
+  uint32_t max_spread_1e4;
+
+  static const char* Name() { return "microprice"; }
+
+  static MicropriceStrategy Default() {
+    MicropriceStrategy strategy{};
+    strategy.min_edge_1e4 = 200;
+    strategy.max_spread_1e4 = SwOrderBook::kDefaultMaxSpread1e4;
+    return strategy;
+  }
+
+  uint32_t Decide(const SwOrderBook&, uint32_t, const SwOrderBook::TopOfBook& top,
+                  uint32_t spread_1e4, int32_t imbalance) const {
+    if (!SwStrategyRules::Tradable(top, spread_1e4, max_spread_1e4)) {
+      return SwOrderBook::kActionNoop;
+    }
+    const int64_t total_qty = static_cast<int64_t>(top.bid_qty) + top.ask_qty;
+    const int64_t scaled_edge = static_cast<int64_t>(spread_1e4) * imbalance;
+    return SwStrategyRules::Signed(scaled_edge, 2 * total_qty * min_edge_1e4);
+  }
+};
+
+// Imbalance over the first `levels` levels, level i weighted by 2^-i.
+struct DepthWeightedStrategy {
+  uint32_t levels;
+  uint32_t imbalance_threshold;
+  uint32_t max_spread_1e4;
+
+  static const char* Name() { return "depth-weighted"; }
+
+  static DepthWeightedStrategy Default() {
+    DepthWeightedStrategy strategy{};
+    strategy.levels = 4;
+    strategy.imbalance_threshold = 750;
+    strategy.max_spread_1e4 = SwOrderBook::kDefaultMaxSpread1e4;
+    return strategy;
+  }
+
+  uint32_t Decide(const SwOrderBook& book, uint32_t symbol, const SwOrderBook::TopOfBook& top,
+                  uint32_t spread_1e4, int32_t) const {
+    if (!SwStrategyRules::Tradable(top, spread_1e4, max_spread_1e4)) {
+      return SwOrderBook::kActionNoop;
+    }
+    const uint32_t* bid_qty = book.BidQtys(symbol);
+    const uint32_t* ask_qty = book.AskQtys(symbol);
+    const uint32_t count = levels < book.Depth() ? levels : book.Depth();
+    int64_t weighted = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+      weighted += static_cast<int64_t>(bid_qty[i] >> i) - static_cast<int64_t>(ask_qty[i] >> i);
+    }
+    return SwStrategyRules::Signed(weighted, imbalance_threshold);
+  }
+};
+
+// Top-of-book imbalance with a lower bar while the spread is tight and a
+// higher one once it widens.
+struct SpreadRegimeStrategy {
+  uint32_t tight_spread_1e4;
+  uint32_t tight_threshold;
+  uint32_t wide_threshold;
+  uint32_t max_spread_1e4;
+
+  static const char* Name() { return "spread-regime"; }
+
+  static SpreadRegimeStrategy Default() {
+    SpreadRegimeStrategy strategy{};
+    strategy.tight_spread_1e4 = 5000;
+    strategy.tight_threshold = 250;
+    strategy.wide_threshold = 1000;
+    strategy.max_spread_1e4 = SwOrderBook::kDefaultMaxSpread1e4;
+    return strategy;
+  }
+
+  uint32_t Decide(const SwOrderBook&, uint32_t, const SwOrderBook::TopOfBook& top,
+                  uint32_t spread_1e4, int32_t imbalance) const {
+    if (!SwStrategyRules::Tradable(top, spread_1e4, max_spread_1e4)) {
+      return SwOrderBook::kActionNoop;
+    }
+    const uint32_t threshold = spread_1e4 <= tight_spread_1e4 ? tight_threshold : wide_threshold;
+    return SwStrategyRules::Signed(imbalance, threshold);
+  }
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// Recycling arena for the per-message allocations of the FAST encoder and
+// decoder (sequence storage, strings, dictionary values).
+//
+// Blocks come in power-of-two size classes from 16 bytes to 64 KiB, carved
+// from 64 KiB chunks. A freed block goes onto its class's free list and is
+// handed out again by the next request of that class, so once the working
+// set has been seen, Allocate/Reallocate/Deallocate never reach malloc.
+// Requests above the largest class go to malloc on their own.
+//
+// GetStats() counts every request and every heap call. After warmup,
+// `heap_allocations` should not move; if it does, something on the tick path
+// is still growing. Not thread-safe: one arena per thread, and the arena must
+// outlive every object allocated from it.
+class TickArena {
+ public:
+  static const std::size_t kMinBlockBytes = 16;
+  static const uint32_t kNumClasses = 13;  // 16 B .. 64 KiB
+  static const std::size_t kMaxBlockBytes = kMinBlockBytes << (kNumClasses - 1);
+  static const std::size_t kDefaultChunkBytes = 64 * 1024;
+
+  struct Stats {
+    uint64_t allocations;
+    uint64_t reallocations;
+    uint64_t deallocations;
+    // malloc calls: new chunks plus blocks above the largest class.
+    uint64_t heap_allocations;
+    uint64_t heap_bytes;
+    uint64_t in_use_bytes;
+  };
+
+  explicit TickArena(std::size_t chunk_bytes = kDefaultChunkBytes)
+      : chunk_bytes_(chunk_bytes < kHeaderBytes + kMaxBlockBytes ? kHeaderBytes + kMaxBlockBytes
+                                                                 : chunk_bytes),
+        cursor_(nullptr),
+        limit_(nullptr),
+        stats_() {
+    for (uint32_t i = 0; i < kNumClasses; ++i) {
+      free_[i] = nullptr;
+    }
+  }
+
+  ~TickArena() {
+    for (std::size_t i = 0; i < chunks_.size(); ++i) {
+      std::free(chunks_[i]);
+    }
+  }
+
+  TickArena(const TickArena&) = delete;
+  TickArena& operator=(const TickArena&) = delete;
+
+  void* Allocate(std::size_t bytes) {
+    ++stats_.allocations;
+    return Take(bytes);
+  }
+
+  // realloc semantics: contents up to old_size are kept and `pointer` may
+  // move. Returns the usable size, which can exceed new_size, so callers that
+  // track capacity grow less often.
+  std::size_t Reallocate(void*& pointer, std::size_t old_size, std::size_t new_size) {
+    ++stats_.reallocations;
+    if (pointer == nullptr) {
+      pointer = Take(new_size);
+      return Usable(pointer);
+    }
+    const std::size_t usable = Usable(pointer);
+    if (new_size <= usable) {
+      return usable;
+    }
+    // Growing blocks tend to keep growing: at least double.
+    void* grown = Take(new_size < 2 * usable ? 2 * usable : new_size);
+    std::memcpy(grown, pointer, old_size < usable ? old_size : usable);
+    Release(pointer);
+    pointer = grown;
+    return Usable(grown);
+  }
+
+  void Deallocate(void* pointer) {
+    if (pointer == nullptr) {
+      return;
+    }
+    ++stats_.deallocations;
+    Release(pointer);
+  }
+
+  // Carves enough blocks of `bytes` into the free lists up front, so the
+  // first messages do not pay for chunk allocation either.
+  void Reserve(std::size_t bytes, uint32_t count) {
+    std::vector<void*> blocks;
+    for (uint32_t i = 0; i < count; ++i) {
+      blocks.push_back(Take(bytes));
+    }
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+      Release(blocks[i]);
+    }
+  }
+
+  const Stats& GetStats() const { return stats_; }
+
+ private:
+  // Keeps the returned blocks 16-byte aligned.
+  static const std::size_t kHeaderBytes = 16;
+  static const uint32_t kLargeClass = kNumClasses;
+
+  struct Header {
+    uint32_t size_class;
+    uint32_t reserved;
+    uint64_t large_bytes;
+  };
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  static Header* HeaderOf(void* pointer) {
+    return reinterpret_cast<Header*>(static_cast<char*>(pointer) - kHeaderBytes);
+  }
+
+  static uint32_t ClassFor(std::size_t bytes) {
+    uint32_t size_class = 0;
+    std::size_t block = kMinBlockBytes;
+    while (block < bytes) {
+      block <<= 1;
+      ++size_class;
+    }
+    return size_class;
+  }
+
+  static std::size_t Usable(void* pointer) {
+    const Header* header = HeaderOf(pointer);
+    return header->size_class == kLargeClass ? static_cast<std::size_t>(header->large_bytes)
+                                             : kMinBlockBytes << header->size_class;
+  }
+
+  void* Take(std::size_t bytes) {
+    if (bytes > kMaxBlockBytes) {
+      char* raw = static_cast<char*>(std::malloc(kHeaderBytes + bytes));
+      if (raw == nullptr) {
+        throw std::bad_alloc();
+      }
+      ++stats_.heap_allocations;
+      stats_.heap_bytes += kHeaderBytes + bytes;
+      stats_.in_use_bytes += bytes;
+      Header* header = reinterpret_cast<Header*>(raw);
+      header->size_class = kLargeClass;
+      header->large_bytes = bytes;
+      return raw + kHeaderBytes;
+    }
+    const uint32_t size_class = ClassFor(bytes);
+    const std::size_t block = kMinBlockBytes << size_class;
+    stats_.in_use_bytes += block;
+    if (free_[size_class] != nullptr) {
+      FreeBlock* head = free_[size_class];
+      free_[size_class] = head->next;
+      return head;
+    }
+    if (cursor_ == nullptr || static_cast<std::size_t>(limit_ - cursor_) < kHeaderBytes + block) {
+      char* chunk = static_cast<char*>(std::malloc(chunk_bytes_));
+      if (chunk == nullptr) {
+        stats_.in_use_bytes -= block;
+        throw std::bad_alloc();
+      }
+      ++stats_.heap_allocations;
+      stats_.heap_bytes += chunk_bytes_;
+      chunks_.push_back(chunk);
+      cursor_ = chunk;
+      limit_ = chunk + chunk_bytes_;
+    }
+    Header* header = reinterpret_cast<Header*>(cursor_);
+    header->size_class = size_class;
+    header->large_bytes = 0;
+    void* pointer = cursor_ + kHeaderBytes;
+    cursor_ += kHeaderBytes + block;
+    return pointer;
+  }
+
+  void Release(void* pointer) {
+    Header* header = HeaderOf(pointer);
+    if (header->size_class == kLargeClass) {
+      stats_.in_use_bytes -= header->large_bytes;
+      std::free(header);
+      return;
+    }
+    stats_.in_use_bytes -= kMinBlockBytes << header->size_class;
+    FreeBlock* block = static_cast<FreeBlock*>(pointer);
+    block->next = free_[header->size_class];
+    free_[header->size_class] = block;
+  }
+
+  const std::size_t chunk_bytes_;
+  char* cursor_;
+  char* limit_;
+  FreeBlock* free_[kNumClasses];
+  std::vector<char*> chunks_;
+  Stats stats_;
+};
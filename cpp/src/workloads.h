@@ -0,0 +1,361 @@
+#pragma once
+
+#include "bridge_journal.h"
+#include "fpga_shared_stream.h"
+#include "sw_order_book.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Level-event streams for the benchmarks and tests.
+//
+// Every scenario produces 8-word event frames with word0 = index + 1, so any
+// stream can go through SwOrderBook, ShardedEngine or the FPGA bridge and be
+// tracked by sequence number. Apart from kRoundRobin (the historical
+// fpga_benchmark pattern) the generators draw from a xorshift stream seeded
+// by Config::seed: the same config always gives the same events.
+//
+//   round-robin   symbols in turn, sides alternating, upserts only
+//   uniform       random symbol, side, price within 80 ticks, upserts
+//   zipf          uniform, but symbols drawn Zipf(kZipfExponent): a few hot
+//                 symbols take most of the traffic
+//   delete-heavy  half the events delete a level the stream added earlier
+//   reset-storm   uniform, with bursts of book resets every kStormPeriod
+//                 events
+//   crossing      prices drawn on both sides of the mid, so many updates
+//                 would cross the book and take the book's drop path
+//   depth-churn   12 candidate levels per side around a fixed mid, so all
+//                 depth-8 levels stay full and inserts shift them
+//   file          frames replayed from a file (see LoadFile), renumbered and
+//                 repeated to the requested length
+class Workloads {
+ public:
+  enum Kind {
+    kRoundRobin = 0,
+    kUniform,
+    kZipf,
+    kDeleteHeavy,
+    kResetStorm,
+    kCrossing,
+    kDepthChurn,
+    kFile,
+    kNumKinds
+  };
+
+  static const uint64_t kDefaultSeed = 1;
+  static const uint32_t kPriceTicks = 80;
+  static const uint32_t kTick1e4 = 100;
+  static const uint32_t kStormPeriod = 1024;
+  static const uint32_t kStormLength = 64;
+  static const uint32_t kChurnLevels = 12;
+  static constexpr double kZipfExponent = 1.2;
+
+  struct Config {
+    Kind kind;
+    uint32_t num_symbols;
+    uint64_t seed;
+    // kFile only.
+    std::string path;
+  };
+
+  static Config DefaultConfig() {
+    Config config;
+    config.kind = kRoundRobin;
+    config.num_symbols = 5;
+    config.seed = kDefaultSeed;
+    return config;
+  }
+
+  static const char* Name(Kind kind) {
+    switch (kind) {
+      case kRoundRobin:
+        return "round-robin";
+      case kUniform:
+        return "uniform";
+      case kZipf:
+        return "zipf";
+      case kDeleteHeavy:
+        return "delete-heavy";
+      case kResetStorm:
+        return "reset-storm";
+      case kCrossing:
+        return "crossing";
+      case kDepthChurn:
+        return "depth-churn";
+      case kFile:
+        return "file";
+      default:
+        return "unknown";
+    }
+  }
+
+  static bool Parse(const std::string& name, Kind* kind) {
+    for (int k = 0; k < kNumKinds; ++k) {
+      if (name == Name(static_cast<Kind>(k))) {
+        *kind = static_cast<Kind>(k);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Reference mid per symbol, cycling through five instruments.
+  static uint32_t BasePrice1e4(uint32_t symbol) {
+    static const uint32_t kBasePrices1e4[5] = {
+        1850000u, 4150000u, 8750000u, 1700000u, 1750000u,
+    };
+    return kBasePrices1e4[symbol % 5u];
+  }
+
+  static uint32_t NextRandom(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return static_cast<uint32_t>((*state * 2685821657736338717ull) >> 32);
+  }
+
+  // `total` events of `config`. Fails only for kFile (unreadable, malformed
+  // or empty file, described in `*error` if given) or a zero symbol count.
+  static bool Generate(const Config& config, uint64_t total,
+                       std::vector<FpgaSharedStream::Frame>* out, std::string* error = nullptr) {
+    out->clear();
+    if (config.kind == kFile) {
+      std::vector<FpgaSharedStream::Frame> recorded;
+      if (!LoadFile(config.path, &recorded, error)) {
+        return false;
+      }
+      if (recorded.empty()) {
+        SetError(error, config.path + " holds no frames");
+        return false;
+      }
+      out->reserve(static_cast<std::size_t>(total));
+      for (uint64_t i = 0; i < total; ++i) {
+        FpgaSharedStream::Frame frame = recorded[static_cast<std::size_t>(i % recorded.size())];
+        frame.word0 = static_cast<uint32_t>(i + 1u);
+        out->push_back(frame);
+      }
+      return true;
+    }
+    if (config.num_symbols == 0) {
+      return false;
+    }
+
+    Generator generator(config);
+    out->reserve(static_cast<std::size_t>(total));
+    for (uint64_t i = 0; i < total; ++i) {
+      FpgaSharedStream::Frame frame = generator.Next(i);
+      frame.word0 = static_cast<uint32_t>(i + 1u);
+      out->push_back(frame);
+    }
+    return true;
+  }
+
+  // Recorded frames: a flat file of 32-byte frames, eight native-endian
+  // uint32 words each, as written by SaveFile() or captured off the bridge,
+  // or a BridgeJournal, whose TX frames are taken in the order sent. A file
+  // starting with the journal magic is only ever read as a journal.
+  static bool LoadFile(const std::string& path, std::vector<FpgaSharedStream::Frame>* frames,
+                       std::string* error = nullptr) {
+    frames->clear();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+      SetError(error, "cannot open " + path);
+      return false;
+    }
+    uint32_t magic = 0;
+    if (std::fread(&magic, 1, sizeof(magic), file) == sizeof(magic) &&
+        magic == BridgeJournal::kMagic) {
+      std::fclose(file);
+      BridgeJournal::Reader journal;
+      std::string journal_error;
+      if (!journal.Open(path, &journal_error)) {
+        SetError(error, journal_error);
+        return false;
+      }
+      for (const BridgeJournal::Record& record : journal) {
+        if (record.direction == BridgeJournal::kTx) {
+          frames->push_back(record.frame);
+        }
+      }
+      return true;
+    }
+    std::rewind(file);
+    FpgaSharedStream::Frame frame{};
+    bool ok = true;
+    for (;;) {
+      const std::size_t got = std::fread(&frame, 1, sizeof(frame), file);
+      if (got == sizeof(frame)) {
+        frames->push_back(frame);
+        continue;
+      }
+      ok = got == 0 && std::feof(file) != 0;  // no torn trailing frame
+      break;
+    }
+    std::fclose(file);
+    if (!ok) {
+      SetError(error, path + " is not a whole number of 32-byte frames");
+    }
+    return ok;
+  }
+
+  static bool SaveFile(const std::string& path,
+                       const std::vector<FpgaSharedStream::Frame>& frames) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+      return false;
+    }
+    const bool ok = frames.empty() || std::fwrite(frames.data(), sizeof(frames[0]), frames.size(),
+                                                  file) == frames.size();
+    return std::fclose(file) == 0 && ok;
+  }
+
+ private:
+  static void SetError(std::string* error, const std::string& message) {
+    if (error != nullptr) {
+      *error = message;
+    }
+  }
+
+  class Generator {
+   public:
+    explicit Generator(const Config& config)
+        : config_(config), rng_(config.seed * 0x9E3779B97F4A7C15ull + 0x2545F4914F6CDD1Dull) {
+      if (rng_ == 0) {
+        rng_ = 0x2545F4914F6CDD1Dull;
+      }
+      if (config.kind == kZipf) {
+        zipf_cdf_.resize(config.num_symbols);
+        double sum = 0.0;
+        for (uint32_t s = 0; s < config.num_symbols; ++s) {
+          sum += 1.0 / std::pow(static_cast<double>(s + 1u), kZipfExponent);
+          zipf_cdf_[s] = sum;
+        }
+        for (uint32_t s = 0; s < config.num_symbols; ++s) {
+          zipf_cdf_[s] /= sum;
+        }
+      }
+      if (config.kind == kDeleteHeavy) {
+        live_ticks_.assign(static_cast<std::size_t>(config.num_symbols) * 2u, 0u);
+      }
+    }
+
+    FpgaSharedStream::Frame Next(uint64_t idx) {
+      switch (config_.kind) {
+        case kRoundRobin:
+          return RoundRobin(idx);
+        case kZipf:
+          return Upsert(Zipf(), Random() % kPriceTicks + 1u);
+        case kDeleteHeavy:
+          return DeleteHeavy();
+        case kResetStorm:
+          if (idx % kStormPeriod < kStormLength) {
+            return Reset(Random() % config_.num_symbols);
+          }
+          return Upsert(Random() % config_.num_symbols, Random() % kPriceTicks + 1u);
+        case kCrossing:
+          return Crossing();
+        case kDepthChurn:
+          return DepthChurn();
+        case kUniform:
+        default:
+          return Upsert(Random() % config_.num_symbols, Random() % kPriceTicks + 1u);
+      }
+    }
+
+   private:
+    uint32_t Random() { return NextRandom(&rng_); }
+
+    static uint32_t SidePrice(uint32_t symbol, uint32_t side, uint32_t ticks) {
+      const uint32_t base = BasePrice1e4(symbol);
+      return side == SwOrderBook::kSideBuy ? base - ticks * kTick1e4 : base + ticks * kTick1e4;
+    }
+
+    static FpgaSharedStream::Frame Level(uint32_t symbol, uint32_t side, uint32_t price,
+                                         uint32_t qty, uint32_t type) {
+      FpgaSharedStream::Frame frame{};
+      frame.word1 = symbol;
+      frame.word2 = price;
+      frame.word3 = qty;
+      frame.word4 = type;
+      frame.word5 = side;
+      return frame;
+    }
+
+    FpgaSharedStream::Frame RoundRobin(uint64_t idx) const {
+      const uint32_t symbol = static_cast<uint32_t>(idx % config_.num_symbols);
+      const uint32_t side = (idx & 1u) == 0 ? SwOrderBook::kSideBuy : SwOrderBook::kSideSell;
+      const uint32_t ticks = static_cast<uint32_t>((idx * 17u) % kPriceTicks) + 1u;
+      const uint32_t qty = 100u + static_cast<uint32_t>((idx * 37u) % 4901u);
+      return Level(symbol, side, SidePrice(symbol, side, ticks), qty,
+                   SwOrderBook::kEventUpsertLevel);
+    }
+
+    FpgaSharedStream::Frame Upsert(uint32_t symbol, uint32_t ticks) {
+      const uint32_t r = Random();
+      const uint32_t side = (r & 1u) == 0 ? SwOrderBook::kSideBuy : SwOrderBook::kSideSell;
+      return Level(symbol, side, SidePrice(symbol, side, ticks), 100u + (r >> 1) % 4901u,
+                   SwOrderBook::kEventUpsertLevel);
+    }
+
+    FpgaSharedStream::Frame Reset(uint32_t symbol) const {
+      return Level(symbol, SwOrderBook::kSideBuy, 0, 0, SwOrderBook::kEventResetBook);
+    }
+
+    uint32_t Zipf() {
+      const double u = static_cast<double>(Random()) / 4294967296.0;
+      const std::size_t s = static_cast<std::size_t>(
+          std::upper_bound(zipf_cdf_.begin(), zipf_cdf_.end(), u) - zipf_cdf_.begin());
+      return static_cast<uint32_t>(std::min<std::size_t>(s, zipf_cdf_.size() - 1u));
+    }
+
+    // One of the kDefaultDepth best ticks of a symbol side: deleted if the
+    // stream has it live, added otherwise. The levels always fit in the
+    // book, so every delete hits and about half the events are deletes.
+    FpgaSharedStream::Frame DeleteHeavy() {
+      const uint32_t r = Random();
+      const uint32_t symbol = (r >> 8) % config_.num_symbols;
+      const uint32_t side = (r & 1u) == 0 ? SwOrderBook::kSideBuy : SwOrderBook::kSideSell;
+      const uint32_t tick = (r >> 2) % SwOrderBook::kDefaultDepth;
+      uint8_t& live = live_ticks_[static_cast<std::size_t>(symbol) * 2u + (side - 1u)];
+      const uint32_t price = SidePrice(symbol, side, tick + 1u);
+      live = static_cast<uint8_t>(live ^ (1u << tick));
+      if ((live & (1u << tick)) == 0) {
+        return Level(symbol, side, price, 0, SwOrderBook::kEventDeleteLevel);
+      }
+      return Level(symbol, side, price, 100u + Random() % 4901u, SwOrderBook::kEventUpsertLevel);
+    }
+
+    // Offsets from kPriceTicks below to kPriceTicks above the mid on either
+    // side.
+    FpgaSharedStream::Frame Crossing() {
+      const uint32_t r = Random();
+      const uint32_t symbol = (r >> 8) % config_.num_symbols;
+      const uint32_t side = (r & 1u) == 0 ? SwOrderBook::kSideBuy : SwOrderBook::kSideSell;
+      const uint32_t offset = Random() % (2u * kPriceTicks + 1u);
+      const uint32_t price = BasePrice1e4(symbol) - kPriceTicks * kTick1e4 + offset * kTick1e4;
+      return Level(symbol, side, price, 100u + (r >> 1) % 4901u, SwOrderBook::kEventUpsertLevel);
+    }
+
+    FpgaSharedStream::Frame DepthChurn() {
+      const uint32_t r = Random();
+      const uint32_t symbol = (r >> 8) % config_.num_symbols;
+      const uint32_t side = (r & 1u) == 0 ? SwOrderBook::kSideBuy : SwOrderBook::kSideSell;
+      const uint32_t price = SidePrice(symbol, side, (r >> 2) % kChurnLevels + 1u);
+      if ((r >> 28) == 0) {
+        return Level(symbol, side, price, 0, SwOrderBook::kEventDeleteLevel);
+      }
+      return Level(symbol, side, price, 100u + Random() % 4901u, SwOrderBook::kEventUpsertLevel);
+    }
+
+    Config config_;
+    uint64_t rng_;
+    std::vector<double> zipf_cdf_;
+    // delete-heavy: live ticks per symbol side, one bit per level.
+    std::vector<uint8_t> live_ticks_;
+  };
+};
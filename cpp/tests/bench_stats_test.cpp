@@ -0,0 +1,134 @@
+#include "bench_stats.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool near(double a, double b) { return std::fabs(a - b) < 1e-3; }
+
+BenchStats::Metric metric(BenchStats::Better better, const double* values, std::size_t count) {
+  BenchStats::Metric m;
+  m.name = "m";
+  m.better = better;
+  m.samples.assign(values, values + count);
+  return m;
+}
+
+bool test_summary() {
+  const double values[] = {10.0, 12.0, 11.0, 13.0, 9.0};
+  const BenchStats::Summary s =
+      BenchStats::Summarize(std::vector<double>(values, values + 5));
+  if (!check(s.n == 5 && near(s.mean, 11.0) && near(s.median, 11.0), "mean/median")) return false;
+  if (!check(near(s.min, 9.0) && near(s.max, 13.0), "min/max")) return false;
+  if (!check(near(s.stddev, std::sqrt(2.5)), "sample stddev")) return false;
+  // t(4) = 2.776
+  const double half = 2.776 * std::sqrt(2.5) / std::sqrt(5.0);
+  if (!check(near(s.ci95_low, 11.0 - half) && near(s.ci95_high, 11.0 + half), "95% CI")) {
+    return false;
+  }
+  const BenchStats::Summary even = BenchStats::Summarize(std::vector<double>(values, values + 4));
+  if (!check(near(even.median, 11.5), "even-count median")) return false;
+  const BenchStats::Summary one = BenchStats::Summarize(std::vector<double>(1, 7.0));
+  return check(one.stddev == 0.0 && one.ci95_low == 7.0 && one.ci95_high == 7.0,
+               "single sample has no spread");
+}
+
+bool test_t_table() {
+  return check(near(BenchStats::StudentT975(1.0), 12.706) &&
+                   near(BenchStats::StudentT975(4.9), 2.776) &&
+                   near(BenchStats::StudentT975(30.0), 2.042) &&
+                   near(BenchStats::StudentT975(1e6), 1.960),
+               "t critical values");
+}
+
+bool test_compare() {
+  const BenchStats::Better lower = BenchStats::kLowerIsBetter;
+  const BenchStats::Better higher = BenchStats::kHigherIsBetter;
+  const double base[] = {100.0, 101.0, 99.0, 100.5, 99.5, 100.2, 99.8};
+  const double slower[] = {105.0, 106.0, 104.0, 105.5, 104.5, 105.2, 104.8};
+  const double noisy[] = {80.0, 130.0, 95.0, 120.0, 90.0, 125.0, 100.0};
+
+  // A clean 5% slowdown is caught; the same shift is an improvement when
+  // higher is better.
+  BenchStats::Comparison c = BenchStats::Compare(metric(lower, base, 7), metric(lower, slower, 7));
+  if (!check(c.significant && c.regression && near(c.change_pct, 5.0), "5% regression")) {
+    return false;
+  }
+  c = BenchStats::Compare(metric(higher, base, 7), metric(higher, slower, 7));
+  if (!check(c.significant && !c.regression, "higher-is-better improvement")) return false;
+
+  // Identical sets, or a shift lost in noise, are not regressions.
+  c = BenchStats::Compare(metric(lower, base, 7), metric(lower, base, 7));
+  if (!check(!c.significant && !c.regression && c.t == 0.0, "identical sets")) return false;
+  c = BenchStats::Compare(metric(lower, base, 7), metric(lower, noisy, 7));
+  if (!check(!c.significant && !c.regression, "noise is not significant")) return false;
+
+  // One run per side cannot be judged.
+  c = BenchStats::Compare(metric(lower, base, 1), metric(lower, slower, 1));
+  if (!check(!c.significant && !c.regression, "single runs are never significant")) return false;
+
+  // Significant but below kMinRegressionPct.
+  const double tiny[] = {100.0, 100.0, 100.0};
+  const double tiny_slower[] = {100.5, 100.5, 100.5};
+  c = BenchStats::Compare(metric(lower, tiny, 3), metric(lower, tiny_slower, 3));
+  return check(c.significant && !c.regression, "sub-percent shifts are not regressions");
+}
+
+bool test_save_load() {
+  char path[] = "/tmp/bench_stats_testXXXXXX";
+  const int fd = mkstemp(path);
+  if (!check(fd >= 0, "temp file")) return false;
+  close(fd);
+
+  BenchStats stats;
+  stats.Add("sw_core_avg_ns", BenchStats::kLowerIsBetter, 12.25);
+  stats.Add("throughput_msg_s", BenchStats::kHigherIsBetter, 1e6 / 3.0);
+  stats.Add("sw_core_avg_ns", BenchStats::kLowerIsBetter, 13.5);
+  bool ok = check(stats.Save(path, "mode sw-core"), "save");
+
+  BenchStats loaded;
+  uint64_t bad_line = 0;
+  ok = ok && check(loaded.Load(path, &bad_line), "load");
+  const BenchStats::Metric* core = loaded.Find("sw_core_avg_ns");
+  const BenchStats::Metric* rate = loaded.Find("throughput_msg_s");
+  ok = ok && check(core != nullptr && rate != nullptr && loaded.Metrics().size() == 2,
+                   "metrics survive a round trip");
+  ok = ok && check(core->samples.size() == 2 && core->samples[1] == 13.5 &&
+                       rate->samples[0] == 1e6 / 3.0 && rate->better == BenchStats::kHigherIsBetter,
+                   "samples are exact after a round trip");
+
+  {
+    std::ofstream out(path, std::ios::app);
+    out << "metric broken sideways 1 2\n";
+  }
+  ok = ok && check(!loaded.Load(path, &bad_line) && bad_line == 5, "malformed line is reported");
+  ok = ok && check(loaded.Metrics().size() == 2, "failed load keeps the old contents");
+  std::remove(path);
+  return ok && check(!loaded.Load(path, &bad_line) && bad_line == 0, "missing file");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_summary();
+  ok = ok && test_t_table();
+  ok = ok && test_compare();
+  ok = ok && test_save_load();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] bench_stats_test\n";
+  return 0;
+}
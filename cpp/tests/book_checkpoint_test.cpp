@@ -0,0 +1,157 @@
+#include "book_checkpoint.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+std::string checkpoint_path() {
+  return "/tmp/book_checkpoint_test_" + std::to_string(getpid());
+}
+
+void fill_book(SwOrderBook* book, uint32_t offset) {
+  uint32_t seq = 1;
+  for (uint32_t symbol = 0; symbol < book->NumSymbols(); symbol += 2) {
+    for (uint32_t i = 0; i < 5; ++i) {
+      book->ApplyEvent(FeedMapping::LevelFrame(seq++, symbol, 1000000 - i * 100 - offset,
+                                               100 + i, SwOrderBook::kSideBuy));
+      book->ApplyEvent(FeedMapping::LevelFrame(seq++, symbol, 1001000 + i * 100 + offset,
+                                               200 + i, SwOrderBook::kSideSell));
+    }
+  }
+}
+
+bool same_books(const SwOrderBook& a, const SwOrderBook& b) {
+  for (uint32_t symbol = 0; symbol < a.NumSymbols(); ++symbol) {
+    for (uint32_t i = 0; i < a.Depth(); ++i) {
+      if (a.BidPrices(symbol)[i] != b.BidPrices(symbol)[i] ||
+          a.BidQtys(symbol)[i] != b.BidQtys(symbol)[i] ||
+          a.AskPrices(symbol)[i] != b.AskPrices(symbol)[i] ||
+          a.AskQtys(symbol)[i] != b.AskQtys(symbol)[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Replaying a checkpoint rebuilds the same book, even over stale levels.
+bool test_round_trip() {
+  const std::string path = checkpoint_path();
+  SwOrderBook book;
+  fill_book(&book, 0);
+  bool discarded = true;
+  std::string error;
+  {
+    BookCheckpoint checkpoint;
+    if (!check(checkpoint.Open(path, book.GetConfig(), &discarded, &error) && !discarded,
+               "open new checkpoint")) return false;
+    BookCheckpoint::Snapshot snapshot;
+    if (!check(!checkpoint.Load(&snapshot), "new checkpoint is empty")) return false;
+    checkpoint.Save(book, 4242);
+  }
+
+  BookCheckpoint checkpoint;
+  BookCheckpoint::Snapshot snapshot;
+  bool ok = check(checkpoint.Open(path, book.GetConfig(), &discarded, &error) && !discarded &&
+                      checkpoint.Load(&snapshot),
+                  "reopened checkpoint loads");
+  ok = ok && check(snapshot.last_seq == 4242 && snapshot.levels.size() == 40,
+                   "seq and occupied levels only");
+
+  SwOrderBook restored;
+  fill_book(&restored, 50);
+  restored.ApplyEvent(FeedMapping::LevelFrame(1, 1, 990000, 7, SwOrderBook::kSideBuy));
+  std::vector<FpgaSharedStream::Frame> frames;
+  BookCheckpoint::ReplayFrames(snapshot, restored.NumSymbols(), &frames);
+  ok = ok && check(frames.size() == restored.NumSymbols() + 40 && frames[0].word0 == 1 &&
+                       frames[0].word4 == SwOrderBook::kEventResetBook,
+                   "a reset per symbol and an upsert per level");
+  for (const FpgaSharedStream::Frame& frame : frames) {
+    restored.ApplyEvent(frame);
+  }
+  ok = ok && check(same_books(book, restored), "replay rebuilds the book");
+  checkpoint.Close();
+  std::remove(path.c_str());
+  return ok;
+}
+
+// A save torn by a crash leaves the previous checkpoint to load, and the
+// next save does not overwrite it.
+bool test_torn_save() {
+  const std::string path = checkpoint_path();
+  SwOrderBook first;
+  fill_book(&first, 0);
+  SwOrderBook second;
+  fill_book(&second, 10);
+  bool discarded = false;
+  std::string error;
+  BookCheckpoint checkpoint;
+  if (!check(checkpoint.Open(path, first.GetConfig(), &discarded, &error), "open")) return false;
+  checkpoint.Save(first, 1);   // slot 1, generation 2
+  checkpoint.Save(second, 2);  // slot 0, generation 4
+
+  // Damage a level of slot 0 (file header 64 bytes, slot header 64 bytes).
+  const int fd = open(path.c_str(), O_RDWR);
+  const uint32_t junk = 0xDEADBEEF;
+  const bool written = pwrite(fd, &junk, sizeof(junk), 64 + 64 + 8) == sizeof(junk);
+  close(fd);
+
+  BookCheckpoint::Snapshot snapshot;
+  bool ok = check(written && checkpoint.Load(&snapshot) && snapshot.last_seq == 1 &&
+                      snapshot.generation == 2,
+                  "checksum failure falls back to the other slot");
+  checkpoint.Save(second, 3);
+  ok = ok && check(checkpoint.Load(&snapshot) && snapshot.last_seq == 3 &&
+                       snapshot.generation == 6,
+                   "next save replaces the damaged slot");
+  checkpoint.Close();
+  std::remove(path.c_str());
+  return ok;
+}
+
+bool test_shape_change_discards() {
+  const std::string path = checkpoint_path();
+  SwOrderBook book;
+  fill_book(&book, 0);
+  bool discarded = false;
+  std::string error;
+  BookCheckpoint checkpoint;
+  if (!check(checkpoint.Open(path, book.GetConfig(), &discarded, &error), "open")) return false;
+  checkpoint.Save(book, 9);
+
+  SwOrderBook::Config deeper = book.GetConfig();
+  deeper.depth = 16;
+  BookCheckpoint::Snapshot snapshot;
+  const bool ok = check(checkpoint.Open(path, deeper, &discarded, &error) && discarded &&
+                            !checkpoint.Load(&snapshot),
+                        "other book shape starts empty");
+  checkpoint.Close();
+  std::remove(path.c_str());
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_round_trip();
+  ok = ok && test_torn_save();
+  ok = ok && test_shape_change_discards();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] book_checkpoint_test\n";
+  return 0;
+}
@@ -0,0 +1,179 @@
+#include "bridge_journal.h"
+#include "workloads.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+std::string journal_path() {
+  return "/tmp/bridge_journal_test_" + std::to_string(getpid());
+}
+
+FpgaSharedStream::Frame frame_for(uint32_t seq, uint32_t kind) {
+  FpgaSharedStream::Frame frame{};
+  frame.word0 = seq;
+  frame.word1 = seq % 5;
+  frame.word2 = 1000000 + seq;
+  frame.word3 = 100;
+  frame.word4 = kind;
+  return frame;
+}
+
+off_t file_size(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+// TX and RX records come back in order, stamped, and the file is trimmed.
+bool test_round_trip() {
+  const std::string path = journal_path();
+  BridgeJournal journal;
+  std::string error;
+  if (!check(journal.Open(path, 1024, &error), "open")) return false;
+  for (uint32_t seq = 1; seq <= 100; ++seq) {
+    journal.Append(BridgeJournal::kTx, frame_for(seq, SwOrderBook::kEventUpsertLevel));
+    journal.Append(BridgeJournal::kRx, frame_for(seq, 0));
+  }
+  journal.Close();
+  bool ok = check(file_size(path) == static_cast<off_t>(sizeof(BridgeJournal::Header) +
+                                                        200 * sizeof(BridgeJournal::Record)),
+                  "close trims the preallocated tail");
+
+  BridgeJournal::Reader reader;
+  ok = ok && check(reader.Open(path, &error), "reader opens");
+  ok = ok && check(reader.Size() == 200 && reader.GetHeader().dropped == 0, "all records kept");
+  uint64_t last_ns = 0;
+  for (uint64_t i = 0; ok && i < reader.Size(); ++i) {
+    const BridgeJournal::Record& record = reader[i];
+    ok = check(record.direction == (i % 2 == 0 ? BridgeJournal::kTx : BridgeJournal::kRx) &&
+                   record.frame.word0 == i / 2 + 1 && record.timestamp_ns >= last_ns &&
+                   record.timestamp_ns >= reader.GetHeader().start_monotonic_ns,
+               "records in order with monotonic stamps");
+    last_ns = record.timestamp_ns;
+  }
+  reader.Close();
+  std::remove(path.c_str());
+  return ok;
+}
+
+// A full file drops and counts instead of blocking the caller.
+bool test_full_file_drops() {
+  const std::string path = journal_path();
+  BridgeJournal journal;
+  std::string error;
+  if (!check(journal.Open(path, 4, &error), "open small journal")) return false;
+  for (uint32_t seq = 1; seq <= 10; ++seq) {
+    journal.Append(BridgeJournal::kTx, frame_for(seq, SwOrderBook::kEventUpsertLevel));
+  }
+  journal.Close();
+  bool ok = check(journal.Dropped() == 6, "overflow counted as dropped");
+  BridgeJournal::Reader reader;
+  ok = ok && check(reader.Open(path, &error) && reader.Size() == 4 &&
+                       reader.GetHeader().dropped == 6 && reader[3].frame.word0 == 4,
+                   "first records kept, drop count in the header");
+  reader.Close();
+  std::remove(path.c_str());
+  return ok;
+}
+
+// A reader can follow a journal that is still being written.
+bool test_live_reader() {
+  const std::string path = journal_path();
+  BridgeJournal journal;
+  std::string error;
+  if (!check(journal.Open(path, 64, &error), "open live journal")) return false;
+  BridgeJournal::Reader reader;
+  bool ok = check(reader.Open(path, &error) && reader.Size() == 0, "empty while nothing appended");
+  for (uint32_t seq = 1; seq <= 10; ++seq) {
+    journal.Append(BridgeJournal::kTx, frame_for(seq, SwOrderBook::kEventUpsertLevel));
+  }
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (ok && reader.Size() < 10 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ok = ok && check(reader.Size() == 10 && journal.Written() == 10 && reader[9].frame.word0 == 10,
+                   "writer publishes records while open");
+  reader.Close();
+  journal.Close();
+  std::remove(path.c_str());
+  return ok;
+}
+
+// --workload-file takes a journal and replays only the frames sent.
+bool test_workload_replay() {
+  const std::string path = journal_path();
+  BridgeJournal journal;
+  std::string error;
+  if (!check(journal.Open(path, 64, &error), "open replay journal")) return false;
+  journal.Append(BridgeJournal::kTx, frame_for(7, SwOrderBook::kEventUpsertLevel));
+  journal.Append(BridgeJournal::kRx, frame_for(7, 0));
+  journal.Append(BridgeJournal::kTx, frame_for(8, SwOrderBook::kEventDeleteLevel));
+  journal.Append(BridgeJournal::kRx, frame_for(8, 0));
+  journal.Close();
+
+  std::vector<FpgaSharedStream::Frame> frames;
+  bool ok = check(Workloads::LoadFile(path, &frames) && frames.size() == 2 &&
+                      frames[0].word0 == 7 && frames[1].word4 == SwOrderBook::kEventDeleteLevel,
+                  "journal loads its TX frames");
+  Workloads::Config config = Workloads::DefaultConfig();
+  config.kind = Workloads::kFile;
+  config.path = path;
+  ok = ok && check(Workloads::Generate(config, 5, &frames) && frames.size() == 5 &&
+                       frames[4].word0 == 5 && frames[4].word2 == 1000007,
+                   "journal replays through Generate");
+  std::remove(path.c_str());
+
+  // A flat frame file is not mistaken for a journal.
+  BridgeJournal::Reader reader;
+  ok = ok && check(Workloads::SaveFile(path, frames) && !reader.Open(path, &error) &&
+                       Workloads::LoadFile(path, &frames) && frames.size() == 5,
+                   "flat frame files still load");
+  std::remove(path.c_str());
+
+  // A journal this build cannot read is an error, never replayed as raw
+  // frames (64 + 2 * 48 bytes would parse as five of them).
+  if (!check(journal.Open(path, 64, &error), "reopen replay journal")) return false;
+  journal.Append(BridgeJournal::kTx, frame_for(7, SwOrderBook::kEventUpsertLevel));
+  journal.Append(BridgeJournal::kRx, frame_for(7, 0));
+  journal.Close();
+  const int fd = open(path.c_str(), O_WRONLY);
+  const uint32_t future_version = 99;
+  const bool patched = pwrite(fd, &future_version, sizeof(future_version), 4) == 4;
+  close(fd);
+  error.clear();
+  ok = ok && check(patched && !Workloads::LoadFile(path, &frames, &error) &&
+                       error.find("bridge journal") != std::string::npos,
+                   "unreadable journal reports the journal error");
+  std::remove(path.c_str());
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_round_trip();
+  ok = ok && test_full_file_drops();
+  ok = ok && test_live_reader();
+  ok = ok && test_workload_replay();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] bridge_journal_test\n";
+  return 0;
+}
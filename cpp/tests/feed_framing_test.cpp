@@ -0,0 +1,89 @@
+#include "feed_framing.h"
+
+#include <iostream>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool test_pack() {
+  const uint32_t word = FeedFraming::Pack(1234, true);
+  if (!check(FeedFraming::Length(word) == 1234 && FeedFraming::IsReset(word),
+             "reset frame round-trips")) return false;
+  const uint32_t plain = FeedFraming::Pack(17, false);
+  return check(plain == 17 && !FeedFraming::IsReset(plain),
+               "plain frame is the bare length, as before");
+}
+
+bool test_reset_schedule() {
+  FeedFraming every_message(1);
+  for (int i = 0; i < 5; ++i) {
+    if (!check(every_message.NextIsReset(false), "reset_every 1 resets every message")) {
+      return false;
+    }
+  }
+
+  FeedFraming framing(4);
+  const bool expected[] = {true, false, false, false, true, false, false, false, true};
+  for (bool want : expected) {
+    if (!check(framing.NextIsReset(false) == want, "reset every 4 messages")) return false;
+  }
+  // A client joining forces a reset and restarts the count.
+  if (!check(framing.NextIsReset(true), "join forces a reset")) return false;
+  for (int i = 0; i < 3; ++i) {
+    if (!check(!framing.NextIsReset(false), "count restarts after a forced reset")) {
+      return false;
+    }
+  }
+  if (!check(framing.NextIsReset(false), "next scheduled reset")) return false;
+
+  FeedFraming on_join(0);
+  if (!check(on_join.NextIsReset(false), "first message always resets")) return false;
+  for (int i = 0; i < 1000; ++i) {
+    if (!check(!on_join.NextIsReset(false), "reset_every 0 never resets on its own")) {
+      return false;
+    }
+  }
+  return check(on_join.NextIsReset(true), "reset_every 0 resets on join");
+}
+
+bool test_reader_waits_for_reset() {
+  FeedFraming reader;
+  if (!check(!reader.Accept(FeedFraming::Pack(10, false)) &&
+                 !reader.Accept(FeedFraming::Pack(12, false)),
+             "mid-stream frames are skipped")) return false;
+  const uint32_t reset = FeedFraming::Pack(30, true);
+  if (!check(reader.Accept(reset), "reset frame syncs")) return false;
+  reader.Record(reset);
+  const uint32_t next = FeedFraming::Pack(6, false);
+  if (!check(reader.Accept(next), "synced reader takes plain frames")) return false;
+  reader.Record(next);
+  const FeedFraming::Stats& stats = reader.GetStats();
+  if (!check(stats.messages == 2 && stats.bytes == 36 && stats.resets == 1 &&
+                 stats.skipped == 2 && reader.BytesPerMessage() == 18.0,
+             "stream stats")) return false;
+
+  reader.Restart();
+  return check(!reader.Accept(next) && reader.GetStats().messages == 0 &&
+                   reader.GetStats().skipped == 1,
+               "reconnect waits for the next reset");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_pack();
+  ok = ok && test_reset_schedule();
+  ok = ok && test_reader_waits_for_reset();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] feed_framing_test\n";
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include "feed_mapping.h"
+#include "sw_order_book.h"
+
+#include <iostream>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool test_symbols_sides_prices() {
+  uint32_t id = 99;
+  if (!check(FeedMapping::MapSymbol("NVDA", &id) && id == 2, "known symbol")) return false;
+  if (!check(!FeedMapping::MapSymbol("IBM", &id), "unknown symbol")) return false;
+  if (!check(FeedMapping::ParseSide("buy") == SwOrderBook::kSideBuy &&
+                 FeedMapping::ParseSide("Sell") == SwOrderBook::kSideSell &&
+                 FeedMapping::ParseSide("x") == 0,
+             "side strings")) return false;
+  return check(FeedMapping::PriceToFixed1e4(18512, -2) == 1851200 &&
+                   FeedMapping::PriceToFixed1e4(-5, 0) == 0,
+               "decimal to 1e-4 fixed point");
+}
+
+// Each template maps onto exactly one event type.
+bool test_template_frames() {
+  const FpgaSharedStream::Frame update = FeedMapping::LevelFrame(1, 2, 1850000, 300, 1);
+  if (!check(update.word4 == SwOrderBook::kEventUpsertLevel && update.word3 == 300,
+             "level update is an upsert")) return false;
+  const FpgaSharedStream::Frame del = FeedMapping::DeleteFrame(2, 2, 1850000, 1);
+  if (!check(del.word0 == 2 && del.word1 == 2 && del.word2 == 1850000 && del.word5 == 1 &&
+                 del.word4 == SwOrderBook::kEventDeleteLevel,
+             "delete carries the level")) return false;
+  const FpgaSharedStream::Frame reset = FeedMapping::ResetFrame(3, 4);
+  if (!check(reset.word1 == 4 && reset.word4 == SwOrderBook::kEventResetBook,
+             "reset carries only the symbol")) return false;
+  const FpgaSharedStream::Frame partial = FeedMapping::TradeFrame(4, 2, 1850000, 120, 1);
+  if (!check(partial.word4 == SwOrderBook::kEventUpsertLevel && partial.word3 == 120,
+             "partial fill leaves the remaining quantity")) return false;
+  const FpgaSharedStream::Frame cleared = FeedMapping::TradeFrame(5, 2, 1850000, 0, 1);
+  return check(cleared.word4 == SwOrderBook::kEventDeleteLevel, "cleared level is deleted");
+}
+
+// A feed of updates, trades, deletes and a reset keeps the book in step
+// with what was published.
+bool test_book_follows_feed() {
+  SwOrderBook book;
+  const uint32_t sym = 1;
+  book.ApplyEvent(FeedMapping::LevelFrame(1, sym, 1000000, 100, SwOrderBook::kSideBuy));
+  book.ApplyEvent(FeedMapping::LevelFrame(2, sym, 999000, 200, SwOrderBook::kSideBuy));
+  book.ApplyEvent(FeedMapping::LevelFrame(3, sym, 1001000, 300, SwOrderBook::kSideSell));
+  if (!check(book.Top(sym).bid_px == 1000000 && book.Top(sym).bid_qty == 100,
+             "best bid after updates")) return false;
+
+  book.ApplyEvent(FeedMapping::TradeFrame(4, sym, 1000000, 40, SwOrderBook::kSideBuy));
+  if (!check(book.Top(sym).bid_qty == 40, "partial trade shrinks the touch")) return false;
+  book.ApplyEvent(FeedMapping::TradeFrame(5, sym, 1000000, 0, SwOrderBook::kSideBuy));
+  if (!check(book.Top(sym).bid_px == 999000 && book.Top(sym).bid_qty == 200,
+             "clearing trade promotes the next level")) return false;
+
+  book.ApplyEvent(FeedMapping::DeleteFrame(6, sym, 999000, SwOrderBook::kSideBuy));
+  if (!check(book.Top(sym).bid_qty == 0 && book.BidQtys(sym)[0] == 0,
+             "delete empties the side")) return false;
+
+  book.ApplyEvent(FeedMapping::ResetFrame(7, sym));
+  return check(book.Top(sym).ask_qty == 0 && book.AskQtys(sym)[0] == 0,
+               "reset clears the other side too");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_symbols_sides_prices();
+  ok = ok && test_template_frames();
+  ok = ok && test_book_follows_feed();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] feed_mapping_test\n";
+  return 0;
+}
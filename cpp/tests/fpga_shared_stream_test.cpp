@@ -1,6 +1,7 @@
 #include "fpga_shared_stream.h"
 
 #include <cerrno>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <fcntl.h>
@@ -9,6 +10,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <thread>
 #include <unistd.h>
 
 namespace {
@@ -34,6 +36,13 @@ const uint32_t kRegPerfSumLatencyCyclesLo = 0x048;
 const uint32_t kRegPerfSumLatencyCyclesHi = 0x04C;
 const uint32_t kRegPerfCmdStallCycles = 0x050;
 const uint32_t kRegPerfRspStallCycles = 0x054;
+const uint32_t kRegPerfHistBuckets = 0x058;
+const uint32_t kRegPerfHistBase = 0x060;
+const uint32_t kRegBookInfo = 0x0A0;
+const uint32_t kRegBookBase = 0x0A4;
+const uint32_t kRegBookCtrl = 0x0A8;
+const uint32_t kRegBookCount = 0x0AC;
+const uint32_t kRegBookSeq = 0x0B0;
 const uint32_t kTxBase = 0x100;
 
 bool check(bool cond, const char* msg) {
@@ -109,7 +118,13 @@ bool init_registers(const BackingFile& bf) {
          write32(bf, kRegPerfSumLatencyCyclesLo, 21u) &&
          write32(bf, kRegPerfSumLatencyCyclesHi, 1u) &&
          write32(bf, kRegPerfCmdStallCycles, 11u) &&
-         write32(bf, kRegPerfRspStallCycles, 13u);
+         write32(bf, kRegPerfRspStallCycles, 13u) &&
+         write32(bf, kRegPerfHistBuckets, 4u) &&
+         write32(bf, kRegPerfHistBase + 0, 0u) &&
+         write32(bf, kRegPerfHistBase + 4, 0u) &&
+         write32(bf, kRegPerfHistBase + 8, 2u) &&
+         write32(bf, kRegPerfHistBase + 12, 1u) &&
+         write32(bf, kRegPerfHistBase + 16, 0xDEADu);
 }
 
 bool test_send_and_full(const BackingFile& bf, FpgaSharedStream* stream) {
@@ -208,6 +223,123 @@ bool test_control_and_perf(const BackingFile& bf, FpgaSharedStream* stream) {
   if (!check(perf.cmd_stall_cycles == 11u, "perf cmd stall mismatch")) return false;
   if (!check(perf.rsp_stall_cycles == 13u, "perf rsp stall mismatch")) return false;
 
+  FpgaSharedStream::PerfHistogram hist{};
+  if (!check(stream->ReadPerfHistogram(&hist), "ReadPerfHistogram should succeed")) return false;
+  if (!check(hist.buckets == 4u, "perf histogram bucket count mismatch")) return false;
+  if (!check(hist.counts[2] == 2u && hist.counts[3] == 1u, "perf histogram counts mismatch")) {
+    return false;
+  }
+  if (!check(hist.counts[4] == 0u, "perf histogram must ignore registers past the bucket count")) {
+    return false;
+  }
+
+  return true;
+}
+
+bool test_slot_copy_modes(const BackingFile& bf, FpgaSharedStream* stream) {
+  const FpgaSharedStream::SlotCopyMode modes[] = {
+      FpgaSharedStream::kSlotCopyScalar,
+      FpgaSharedStream::kSlotCopyPaired64,
+      FpgaSharedStream::kSlotCopyVector,
+  };
+
+  for (FpgaSharedStream::SlotCopyMode mode : modes) {
+    stream->SetSlotCopyMode(mode);
+    if (mode == FpgaSharedStream::kSlotCopyVector && !FpgaSharedStream::HasVectorCopy()) {
+      if (!check(stream->ActiveSlotCopyMode() != mode, "vector copy should fall back")) return false;
+    } else {
+      if (!check(stream->ActiveSlotCopyMode() == mode, "copy mode should be active")) return false;
+    }
+
+    if (!check(write32(bf, kRegTxHead, 0) && write32(bf, kRegTxTail, 0) &&
+                   write32(bf, kRegRxHead, 0) && write32(bf, kRegRxTail, 0),
+               "reset ring pointers")) return false;
+
+    const uint32_t seed = 0x10u * (static_cast<uint32_t>(mode) + 1u);
+    FpgaSharedStream::Frame tx{seed + 0, seed + 1, seed + 2, seed + 3,
+                               seed + 4, seed + 5, seed + 6, 0xFFFFFFFFu};
+    if (!check(stream->Send(tx), "send with copy mode")) return false;
+
+    const uint32_t* tx_words = reinterpret_cast<const uint32_t*>(&tx);
+    for (uint32_t i = 0; i < FpgaSharedStream::kFrameWords; ++i) {
+      uint32_t word = 0;
+      if (!check(read32(bf, kTxBase + i * 4, &word), "read tx slot word")) return false;
+      if (!check(word == tx_words[i], "tx slot word order mismatch for copy mode")) return false;
+    }
+
+    const uint32_t rx_off = stream->RxBase();
+    for (uint32_t i = 0; i < FpgaSharedStream::kFrameWords; ++i) {
+      if (!check(write32(bf, rx_off + i * 4, 0xA0000000u + seed + i), "write rx slot word")) return false;
+    }
+    if (!check(write32(bf, kRegRxHead, 1), "set RX_HEAD=1")) return false;
+
+    FpgaSharedStream::Frame rx{};
+    if (!check(stream->Receive(&rx), "receive with copy mode")) return false;
+    const uint32_t* rx_words = reinterpret_cast<const uint32_t*>(&rx);
+    for (uint32_t i = 0; i < FpgaSharedStream::kFrameWords; ++i) {
+      if (!check(rx_words[i] == 0xA0000000u + seed + i, "rx word order mismatch for copy mode")) return false;
+    }
+  }
+
+  stream->SetSlotCopyMode(FpgaSharedStream::kSlotCopyScalar);
+  return true;
+}
+
+// Stands in for the FPGA book: waits for the host to overwrite the BOOK_CTRL
+// sentinel, then fills the level window for that symbol and bumps the count.
+void answer_book_capture(const BackingFile& bf, uint32_t base, uint32_t depth) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  uint32_t symbol = 0xFFFFFFFFu;
+  while (read32(bf, kRegBookCtrl, &symbol) && symbol == 0xFFFFFFFFu &&
+         std::chrono::steady_clock::now() < deadline) {
+  }
+  for (uint32_t i = 0; i < depth; ++i) {
+    const uint32_t qty = i < 3 ? 100u + i : 0u;
+    write32(bf, base + i * 16 + 0, qty == 0 ? 0u : 1000000u * (symbol + 1) - i * 100u);
+    write32(bf, base + i * 16 + 4, qty);
+    write32(bf, base + i * 16 + 8, qty == 0 ? 0u : 1000000u * (symbol + 1) + (i + 1) * 100u);
+    write32(bf, base + i * 16 + 12, qty == 0 ? 0u : qty + 50u);
+  }
+  write32(bf, kRegBookSeq, 77u);
+  write32(bf, kRegBookCount, 6u);
+}
+
+bool test_read_book(const BackingFile& bf, FpgaSharedStream* stream) {
+  FpgaSharedStream::BookSnapshot book{};
+  if (!check(stream->BookDepth() == 0 && !stream->ReadBook(0, &book),
+             "no readback window without BOOK_INFO")) return false;
+
+  const uint32_t base = stream->RxBase() + 4 * FpgaSharedStream::kFrameWords * 4;
+  if (!check(write32(bf, kRegBookInfo, (8u << 16) | 8u) && write32(bf, kRegBookBase, base) &&
+                 write32(bf, kRegBookCount, 5u) && write32(bf, kRegBookCtrl, 0xFFFFFFFFu),
+             "set up book window")) return false;
+  if (!check(stream->BookSymbols() == 8 && stream->BookDepth() == 8, "book window geometry")) {
+    return false;
+  }
+
+  std::thread peer(answer_book_capture, std::cref(bf), base, 8u);
+  const bool read = stream->ReadBook(3, &book);
+  peer.join();
+  if (!check(read, "ReadBook should succeed once the capture lands")) return false;
+  if (!check(book.symbol == 3 && book.depth == 8 && book.last_seq == 77u, "book header")) {
+    return false;
+  }
+  if (!check(book.levels[0].bid_px == 4000000u && book.levels[0].bid_qty == 100u &&
+                 book.levels[0].ask_px == 4000100u && book.levels[0].ask_qty == 150u &&
+                 book.levels[2].bid_px == 3999800u && book.levels[2].ask_qty == 152u,
+             "book levels in window order")) return false;
+  if (!check(book.levels[3].bid_qty == 0 && book.levels[8].bid_px == 0 &&
+                 book.levels[FpgaSharedStream::kBookMaxDepth - 1].ask_qty == 0,
+             "empty and out-of-depth levels are zero")) return false;
+
+  if (!check(!stream->ReadBook(8, &book), "symbol outside the book is rejected")) return false;
+  // Nobody answers: the count never moves.
+  if (!check(!stream->ReadBook(2, &book) &&
+                 stream->LastError() == "book readback capture timed out",
+             "capture that never lands times out")) return false;
+  if (!check(write32(bf, kRegBookBase, static_cast<uint32_t>(kSpan) - 16u) &&
+                 !stream->ReadBook(0, &book),
+             "window past the span is rejected")) return false;
   return true;
 }
 
@@ -244,6 +376,12 @@ int main() {
   if (ok) {
     ok = test_control_and_perf(bf, &stream);
   }
+  if (ok) {
+    ok = test_slot_copy_modes(bf, &stream);
+  }
+  if (ok) {
+    ok = test_read_book(bf, &stream);
+  }
 
   stream.Close();
   destroy_backing_file(bf);
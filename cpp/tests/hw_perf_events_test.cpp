@@ -0,0 +1,107 @@
+#include "hw_perf_events.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool test_names() {
+  for (int i = 0; i < HwPerfEvents::kNumCounters; ++i) {
+    if (!check(std::strcmp(HwPerfEvents::Name(static_cast<HwPerfEvents::Counter>(i)),
+                           "unknown") != 0,
+               "every counter should have a name")) return false;
+  }
+  return check(std::string(HwPerfEvents::Name(HwPerfEvents::kBranchMisses)) == "branch_misses",
+               "JSON key spelling");
+}
+
+bool test_closed_counts_nothing() {
+  HwPerfEvents counters;
+  counters.Start();
+  const HwPerfEvents::Counts counts = counters.Stop();
+  for (int i = 0; i < HwPerfEvents::kNumCounters; ++i) {
+    if (!check(!counts.valid[i] && counts.value[i] == 0, "closed counters are invalid")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Counter availability depends on the kernel, the PMU and
+// perf_event_paranoid; check whatever this host provides.
+bool test_open_counters() {
+  HwPerfEvents counters;
+  std::string error;
+  const bool any = counters.Open(&error);
+  bool all = true;
+  for (int i = 0; i < HwPerfEvents::kNumCounters; ++i) {
+    all = all && counters.IsOpen(static_cast<HwPerfEvents::Counter>(i));
+  }
+  if (!check(all == error.empty(), "error should list exactly the missing counters")) {
+    return false;
+  }
+  if (!any) {
+    std::cout << "hw_perf_events_test: no counters on this host (" << error << ")\n";
+    return true;
+  }
+
+  counters.Start();
+  volatile uint64_t sink = 0;
+  for (uint64_t i = 0; i < 1000000; ++i) {
+    sink += i * i;
+  }
+  for (int i = 0; i < 5; ++i) {
+    usleep(1000);
+  }
+  const HwPerfEvents::Counts counts = counters.Stop();
+  for (int i = 0; i < HwPerfEvents::kNumCounters; ++i) {
+    if (!check(counts.valid[i] == counters.IsOpen(static_cast<HwPerfEvents::Counter>(i)),
+               "open counters should report")) return false;
+  }
+  if (counts.valid[HwPerfEvents::kInstructions] &&
+      !check(counts.value[HwPerfEvents::kInstructions] >= 1000000, "loop instructions")) {
+    return false;
+  }
+  if (counts.valid[HwPerfEvents::kCycles] &&
+      !check(counts.value[HwPerfEvents::kCycles] > 0, "loop cycles")) return false;
+  if (counts.valid[HwPerfEvents::kContextSwitches] &&
+      !check(counts.value[HwPerfEvents::kContextSwitches] >= 5, "sleeps switch out")) {
+    return false;
+  }
+
+  // Stopped counters do not move; a new Start() resets them.
+  const HwPerfEvents::Counts again = counters.Stop();
+  for (int i = 0; i < HwPerfEvents::kNumCounters; ++i) {
+    if (!check(again.value[i] == counts.value[i], "stopped counters hold")) return false;
+  }
+  counters.Start();
+  const HwPerfEvents::Counts reset = counters.Stop();
+  if (counts.valid[HwPerfEvents::kContextSwitches] &&
+      !check(reset.value[HwPerfEvents::kContextSwitches] <
+                 counts.value[HwPerfEvents::kContextSwitches],
+             "start should reset")) return false;
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_names();
+  ok = ok && test_closed_counts_nothing();
+  ok = ok && test_open_counters();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] hw_perf_events_test\n";
+  return 0;
+}
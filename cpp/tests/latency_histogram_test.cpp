@@ -0,0 +1,84 @@
+#include "latency_histogram.h"
+
+#include <iostream>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool test_bucket_bounds() {
+  for (uint64_t v = 0; v < 2u * LatencyHistogram::kSubBuckets; ++v) {
+    if (!check(LatencyHistogram::BucketTop(LatencyHistogram::BucketOf(v)) == v,
+               "small values should be exact")) return false;
+  }
+  uint64_t state = 1;
+  for (int i = 0; i < 100000; ++i) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    const uint64_t v = ((state >> 24) >> (state % 40u)) | 1u;
+    const uint32_t bucket = LatencyHistogram::BucketOf(v);
+    const uint64_t top = LatencyHistogram::BucketTop(bucket);
+    if (!check(bucket < LatencyHistogram::kBuckets && top >= v, "bucket must hold the value")) {
+      return false;
+    }
+    if (!check(static_cast<double>(top - v) < static_cast<double>(v) / LatencyHistogram::kSubBuckets,
+               "relative error above 1/kSubBuckets")) return false;
+    if (bucket > 0 && !check(LatencyHistogram::BucketTop(bucket - 1) < v, "buckets overlap")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_percentiles() {
+  LatencyHistogram histogram;
+  if (!check(histogram.ValueAt(0.99) == 0 && histogram.Mean() == 0.0, "empty histogram")) {
+    return false;
+  }
+  for (uint64_t v = 1; v <= 10000; ++v) {
+    histogram.Record(v * 100);
+  }
+  if (!check(histogram.Count() == 10000 && histogram.Min() == 100 && histogram.Max() == 1000000,
+             "count/min/max should be exact")) return false;
+  if (!check(histogram.Mean() == 500050.0, "mean should be exact")) return false;
+  const double p50 = static_cast<double>(histogram.ValueAt(0.50));
+  const double p99 = static_cast<double>(histogram.ValueAt(0.99));
+  if (!check(p50 >= 500000.0 && p50 < 500000.0 * 1.008, "p50 within a bucket")) return false;
+  if (!check(p99 >= 990000.0 && p99 < 990000.0 * 1.008, "p99 within a bucket")) return false;
+  return check(histogram.ValueAt(1.0) == 1000000 && histogram.ValueAt(0.0) == 100,
+               "extremes clamp to min/max");
+}
+
+bool test_merge_and_saturation() {
+  LatencyHistogram a;
+  LatencyHistogram b;
+  a.Record(10);
+  a.Record(20);
+  b.Record(5);
+  b.Record(uint64_t(1) << 50);
+  a.Merge(b);
+  if (!check(a.Count() == 4 && a.Min() == 5 && a.Max() == (uint64_t(1) << 50),
+             "merge should combine samples")) return false;
+  if (!check(a.Saturated() == 1, "oversized value should be counted as saturated")) return false;
+  if (!check(a.ValueAt(0.5) == 10, "merged median")) return false;
+  a.Reset();
+  return check(a.Count() == 0 && a.Saturated() == 0 && a.ValueAt(0.5) == 0, "reset");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_bucket_bounds();
+  ok = ok && test_percentiles();
+  ok = ok && test_merge_and_saturation();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] latency_histogram_test\n";
+  return 0;
+}
@@ -0,0 +1,261 @@
+#include "md_bus.h"
+
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+std::string bus_path() {
+  return "/tmp/md_bus_test_" + std::to_string(getpid());
+}
+
+// Every word derives from the sequence number, so a torn copy shows up.
+FpgaSharedStream::Frame frame_for(uint64_t seq) {
+  FpgaSharedStream::Frame frame{};
+  const uint32_t base = static_cast<uint32_t>(seq * 8);
+  frame.word0 = base;
+  frame.word1 = base + 1;
+  frame.word2 = base + 2;
+  frame.word3 = base + 3;
+  frame.word4 = base + 4;
+  frame.word5 = base + 5;
+  frame.word6 = base + 6;
+  frame.word7 = base + 7;
+  return frame;
+}
+
+bool frame_matches(const MdBus::Message& message) {
+  const FpgaSharedStream::Frame& f = message.frame;
+  const uint32_t base = f.word0;
+  return base == static_cast<uint32_t>(message.position * 8) && f.word1 == base + 1 &&
+         f.word2 == base + 2 && f.word3 == base + 3 && f.word4 == base + 4 &&
+         f.word5 == base + 5 && f.word6 == base + 6 && f.word7 == base + 7;
+}
+
+bool test_fan_out() {
+  const std::string path = bus_path();
+  MdBus::Writer writer;
+  std::string error;
+  if (!check(writer.Create(path, 100, &error), "create bus")) return false;
+  if (!check(writer.Capacity() == 128, "capacity rounds up to a power of two")) return false;
+
+  MdBus::Reader early;
+  MdBus::Reader late;
+  if (!check(early.Attach(path, false, &error), "attach first reader")) return false;
+  for (uint64_t i = 0; i < 10; ++i) {
+    writer.Publish(i % 2 == 0 ? MdBus::kEvent : MdBus::kResponse, frame_for(i));
+  }
+  if (!check(late.Attach(path, false, &error), "attach second reader")) return false;
+  MdBus::Reader replay;
+  if (!check(replay.Attach(path, true, &error), "attach replaying reader")) return false;
+  if (!check(writer.Readers().size() == 3, "three readers registered")) return false;
+
+  writer.Publish(MdBus::kEvent, frame_for(10));
+  MdBus::Message message;
+  for (uint64_t i = 0; i <= 10; ++i) {
+    if (!check(early.Poll(&message) && message.position == i && frame_matches(message),
+               "first reader sees everything in order")) return false;
+    if (!check(message.kind == (i % 2 == 0 ? 1u : 2u), "kind round-trips")) return false;
+    if (!check(replay.Poll(&message) && message.position == i,
+               "replaying reader starts at the oldest message")) return false;
+  }
+  if (!check(late.Poll(&message) && message.position == 10 && !late.Poll(&message),
+             "live reader starts at the next message")) return false;
+  if (!check(!early.Poll(&message) && early.Lag() == 0 && early.Lost() == 0,
+             "caught-up reader has nothing to read")) return false;
+
+  late.Detach();
+  if (!check(writer.Readers().size() == 2, "detach frees the table entry")) return false;
+  unlink(path.c_str());
+  return true;
+}
+
+bool test_slow_reader_is_lapped() {
+  const std::string path = bus_path();
+  MdBus::Writer writer;
+  std::string error;
+  writer.Create(path, 16, &error);
+  MdBus::Reader reader;
+  if (!check(reader.Attach(path, false, &error), "attach")) return false;
+  for (uint64_t i = 0; i < 16 * 3 + 5; ++i) {
+    writer.Publish(MdBus::kEvent, frame_for(i));
+  }
+  if (!check(reader.Lag() == 53, "lag counts unread messages")) return false;
+  MdBus::Message message;
+  if (!check(reader.Poll(&message) && message.position == 37 && frame_matches(message),
+             "lapped reader resumes at the oldest held message")) return false;
+  if (!check(reader.Lost() == 37, "skipped messages are counted")) return false;
+  const std::vector<MdBus::ReaderInfo> readers = writer.Readers();
+  if (!check(readers.size() == 1 && readers[0].lost == 37 && readers[0].cursor == 38,
+             "producer sees the reader's loss and cursor")) return false;
+  uint64_t next = 38;
+  while (reader.Poll(&message)) {
+    if (!check(message.position == next++, "rest arrives in order")) return false;
+  }
+  unlink(path.c_str());
+  return check(next == 53, "reader drains to the head");
+}
+
+bool test_rejects_bad_files() {
+  const std::string path = bus_path();
+  MdBus::Reader reader;
+  std::string error;
+  if (!check(!reader.Attach(path, false, &error) && !error.empty(), "missing file")) {
+    return false;
+  }
+  FILE* file = std::fopen(path.c_str(), "w");
+  std::fputs("not a bus", file);
+  std::fclose(file);
+  error.clear();
+  const bool attached = reader.Attach(path, false, &error);
+  unlink(path.c_str());
+  return check(!attached && !error.empty(), "foreign file is rejected");
+}
+
+bool test_reader_table_full() {
+  const std::string path = bus_path();
+  MdBus::Writer writer;
+  std::string error;
+  writer.Create(path, 16, &error);
+  MdBus::Reader readers[MdBus::kMaxReaders + 1];
+  for (uint32_t i = 0; i < MdBus::kMaxReaders; ++i) {
+    if (!check(readers[i].Attach(path, false, &error), "attach up to the limit")) return false;
+  }
+  const bool extra = readers[MdBus::kMaxReaders].Attach(path, false, &error);
+  unlink(path.c_str());
+  return check(!extra && error.find("full") != std::string::npos, "table full is reported");
+}
+
+// A concurrent producer and readers: every message a reader accepts must be
+// whole and in order, and received plus lost must cover the stream.
+bool test_concurrent_readers() {
+  const std::string path = bus_path();
+  MdBus::Writer writer;
+  std::string error;
+  writer.Create(path, 64, &error);
+  const uint64_t total = 200000;
+  std::atomic<int> ready(0);
+  std::atomic<bool> failed(false);
+  std::atomic<uint64_t> received[2];
+  std::atomic<uint64_t> lost[2];
+  std::thread threads[2];
+  for (int r = 0; r < 2; ++r) {
+    received[r] = 0;
+    lost[r] = 0;
+    threads[r] = std::thread([&, r]() {
+      MdBus::Reader reader;
+      std::string attach_error;
+      if (!reader.Attach(path, false, &attach_error)) {
+        failed = true;
+        ready.fetch_add(1);
+        return;
+      }
+      ready.fetch_add(1);
+      MdBus::Message message;
+      uint64_t expected = 0;
+      uint64_t count = 0;
+      while (expected < total) {
+        if (!reader.Poll(&message)) {
+          continue;
+        }
+        if (message.position < expected || !frame_matches(message)) {
+          failed = true;
+          break;
+        }
+        expected = message.position + 1;
+        ++count;
+      }
+      received[r] = count;
+      lost[r] = reader.Lost();
+    });
+  }
+  while (ready.load() < 2) {
+  }
+  for (uint64_t i = 0; i < total; ++i) {
+    writer.Publish(MdBus::kEvent, frame_for(i));
+  }
+  threads[0].join();
+  threads[1].join();
+  unlink(path.c_str());
+  if (!check(!failed.load(), "no torn or reordered messages")) return false;
+  for (int r = 0; r < 2; ++r) {
+    if (!check(received[r] + lost[r] == total, "received plus lost covers the stream")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Readers are separate processes in practice.
+bool test_cross_process() {
+  const std::string path = bus_path();
+  MdBus::Writer writer;
+  std::string error;
+  writer.Create(path, 1024, &error);
+  int pipe_fds[2];
+  if (!check(pipe(pipe_fds) == 0, "pipe")) return false;
+  const pid_t child = fork();
+  if (child == 0) {
+    MdBus::Reader reader;
+    std::string attach_error;
+    const bool attached = reader.Attach(path, true, &attach_error);
+    const char byte = 1;
+    if (write(pipe_fds[1], &byte, 1) != 1 || !attached) {
+      _exit(2);
+    }
+    MdBus::Message message;
+    uint64_t next = 0;
+    while (next < 500) {
+      if (reader.Poll(&message)) {
+        if (message.position != next++ || !frame_matches(message)) {
+          _exit(3);
+        }
+      }
+    }
+    _exit(reader.Lost() == 0 && reader.WriterPid() == static_cast<uint32_t>(getppid()) ? 0 : 4);
+  }
+  char byte = 0;
+  if (!check(read(pipe_fds[0], &byte, 1) == 1, "child attached")) return false;
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+  for (uint64_t i = 0; i < 500; ++i) {
+    writer.Publish(MdBus::kResponse, frame_for(i));
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+  const bool reaped = writer.Readers().empty();
+  unlink(path.c_str());
+  if (!check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "child reads the stream")) {
+    return false;
+  }
+  return check(reaped, "exited reader leaves the table");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_fan_out();
+  ok = ok && test_slow_reader_is_lapped();
+  ok = ok && test_rejects_bad_files();
+  ok = ok && test_reader_table_full();
+  ok = ok && test_concurrent_readers();
+  ok = ok && test_cross_process();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] md_bus_test\n";
+  return 0;
+}
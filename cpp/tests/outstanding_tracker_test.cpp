@@ -0,0 +1,110 @@
+#include "outstanding_tracker.h"
+
+#include <iostream>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool test_in_order_matching() {
+  OutstandingTracker tracker;
+  tracker.Reset(4);
+
+  for (uint32_t seq = 1; seq <= 4; ++seq) {
+    tracker.OnSend(seq, 1000u * seq);
+  }
+  if (!check(tracker.Pending() == 4, "four requests should be pending")) return false;
+
+  for (uint32_t seq = 1; seq <= 4; ++seq) {
+    if (!check(tracker.OnResponse(seq, 1000u * seq + 100u * seq) == OutstandingTracker::kMatched,
+               "in-order response should match")) return false;
+  }
+  tracker.Finish();
+
+  const OutstandingTracker::Stats& stats = tracker.GetStats();
+  if (!check(stats.matched == 4, "matched count mismatch")) return false;
+  if (!check(stats.lost == 0 && stats.duplicates == 0 && stats.unknown == 0 && stats.reordered == 0,
+             "clean run should have no anomalies")) return false;
+
+  const OutstandingTracker::LatencySummary rtt = tracker.Summarize();
+  if (!check(rtt.count == 4, "latency count mismatch")) return false;
+  if (!check(rtt.min_ns == 100.0 && rtt.max_ns == 400.0, "latency min/max mismatch")) return false;
+  if (!check(rtt.avg_ns == 250.0, "latency avg mismatch")) return false;
+  return true;
+}
+
+bool test_anomalies() {
+  OutstandingTracker tracker;
+  tracker.Reset(8);
+
+  tracker.OnSend(10, 0);
+  tracker.OnSend(11, 0);
+  tracker.OnSend(12, 0);
+
+  if (!check(tracker.OnResponse(12, 50) == OutstandingTracker::kMatched, "seq 12 should match")) return false;
+  if (!check(tracker.OnResponse(10, 60) == OutstandingTracker::kMatched, "late seq 10 should match")) return false;
+  if (!check(tracker.OnResponse(10, 70) == OutstandingTracker::kDuplicate, "repeat seq 10 is duplicate")) return false;
+  if (!check(tracker.OnResponse(99, 80) == OutstandingTracker::kUnknown, "seq 99 is unknown")) return false;
+  tracker.Finish();
+
+  const OutstandingTracker::Stats& stats = tracker.GetStats();
+  if (!check(stats.matched == 2, "two responses should match")) return false;
+  if (!check(stats.reordered == 1, "seq 10 after 12 is reordered")) return false;
+  if (!check(stats.duplicates == 1, "one duplicate expected")) return false;
+  if (!check(stats.unknown == 1, "one unknown expected")) return false;
+  if (!check(stats.lost == 1, "seq 11 should be lost")) return false;
+  return true;
+}
+
+bool test_sequence_wraparound() {
+  OutstandingTracker tracker;
+  tracker.Reset(2);
+
+  tracker.OnSend(0xFFFFFFFFu, 0);
+  tracker.OnSend(0u, 0);
+  if (!check(tracker.OnResponse(0xFFFFFFFFu, 10) == OutstandingTracker::kMatched, "pre-wrap match")) return false;
+  if (!check(tracker.OnResponse(0u, 20) == OutstandingTracker::kMatched, "post-wrap match")) return false;
+  if (!check(tracker.GetStats().reordered == 0, "wraparound is not reordering")) return false;
+  return true;
+}
+
+bool test_intended_send_time() {
+  OutstandingTracker tracker;
+  tracker.Reset(4);
+
+  // Scheduled every 50 ns but sent late: the corrected RTT keeps the wait.
+  tracker.OnSend(1, 0, 0);
+  tracker.OnSend(2, 200, 50);
+  tracker.OnSend(3, 200, 100);
+  tracker.OnResponse(1, 50);
+  tracker.OnResponse(2, 250);
+  tracker.OnResponse(3, 260);
+  tracker.Finish();
+
+  const OutstandingTracker::LatencySummary service = tracker.Summarize();
+  const OutstandingTracker::LatencySummary corrected = tracker.SummarizeIntended();
+  if (!check(service.max_ns == 60.0, "service RTT counts from the actual send")) return false;
+  if (!check(corrected.min_ns == 50.0 && corrected.max_ns == 200.0,
+             "corrected RTT counts from the intended send")) return false;
+  return check(corrected.count == 3 && corrected.p50_ns == 160.0, "corrected median");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_in_order_matching();
+  ok = ok && test_anomalies();
+  ok = ok && test_sequence_wraparound();
+  ok = ok && test_intended_send_time();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] outstanding_tracker_test\n";
+  return 0;
+}
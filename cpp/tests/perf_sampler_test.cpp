@@ -0,0 +1,116 @@
+#include "perf_sampler.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool near(double a, double b) {
+  return std::fabs(a - b) < 1e-6;
+}
+
+PerfSampler::Snapshot make_snapshot(uint64_t host_ns, uint32_t count, uint64_t sum_cycles) {
+  PerfSampler::Snapshot s{};
+  s.host_ns = host_ns;
+  s.counters.clock_hz = 1000000u;
+  s.counters.count = count;
+  s.counters.sum_latency_cycles = sum_cycles;
+  s.histogram.buckets = FpgaSharedStream::kPerfHistMaxBuckets;
+  return s;
+}
+
+bool test_rates_and_average() {
+  PerfSampler sampler;
+  PerfSampler::Window w{};
+
+  PerfSampler::Snapshot s0 = make_snapshot(0, 100, 1000);
+  s0.counters.cmd_stall_cycles = 10;
+  if (!check(!sampler.Add(s0, &w), "first snapshot must only set the baseline")) return false;
+
+  PerfSampler::Snapshot s1 = make_snapshot(500000000ull, 600, 6000);
+  s1.counters.cmd_stall_cycles = 5010;
+  if (!check(sampler.Add(s1, &w), "second snapshot should produce a window")) return false;
+  if (!check(w.duration_ns == 500000000ull, "window duration mismatch")) return false;
+  if (!check(w.responses == 500, "response delta mismatch")) return false;
+  if (!check(near(w.responses_per_s, 1000.0), "response rate mismatch")) return false;
+  if (!check(near(w.avg_latency_cycles, 10.0), "average latency mismatch")) return false;
+  if (!check(w.cmd_stall_cycles == 5000, "cmd stall delta mismatch")) return false;
+  if (!check(near(w.cmd_stall_ratio, 0.01), "cmd stall ratio mismatch")) return false;
+  if (!check(!w.saturated, "window should not be saturated")) return false;
+  return true;
+}
+
+// Histogram buckets wrap in hardware; PERF_COUNT saturates instead, so here
+// it climbs close to the pin without reaching it.
+bool test_bucket_wraparound() {
+  PerfSampler sampler;
+  PerfSampler::Window w{};
+
+  PerfSampler::Snapshot s0 = make_snapshot(0, 0xFFFFFFD0u, 0);
+  s0.histogram.counts[3] = 0xFFFFFFFEu;
+  sampler.Add(s0, &w);
+
+  PerfSampler::Snapshot s1 = make_snapshot(1000, 0xFFFFFFF0u, 32 * 8);
+  s1.histogram.counts[3] = 0x0000001Eu;
+  if (!check(sampler.Add(s1, &w), "window expected")) return false;
+  if (!check(w.responses == 32 && !w.saturated, "count below the pin is not saturated")) {
+    return false;
+  }
+  if (!check(w.hist[3] == 32, "bucket delta must survive 32-bit wrap")) return false;
+  if (!check(near(w.avg_latency_cycles, 8.0), "average across bucket wrap mismatch")) return false;
+  return true;
+}
+
+bool test_histogram_percentiles() {
+  uint64_t counts[FpgaSharedStream::kPerfHistMaxBuckets] = {};
+  counts[2] = 90;  // [4, 8)
+  counts[5] = 9;   // [32, 64)
+  counts[15] = 1;  // >= 32768
+
+  if (!check(near(PerfSampler::Percentile(counts, 16, 0.50), 4.0 + 4.0 * 50.0 / 90.0),
+             "p50 should interpolate inside bucket 2")) return false;
+  if (!check(near(PerfSampler::Percentile(counts, 16, 0.99), 64.0),
+             "p99 should reach the top of bucket 5")) return false;
+  if (!check(near(PerfSampler::Percentile(counts, 16, 0.999), 32768.0),
+             "p999 should report the open-ended bucket's lower bound")) return false;
+
+  uint64_t empty[FpgaSharedStream::kPerfHistMaxBuckets] = {};
+  if (!check(PerfSampler::Percentile(empty, 16, 0.99) == 0.0, "empty histogram percentile")) {
+    return false;
+  }
+  if (!check(PerfSampler::Percentile(counts, 0, 0.99) == 0.0,
+             "missing histogram should report zero")) return false;
+  return true;
+}
+
+bool test_saturation_flag() {
+  PerfSampler sampler;
+  PerfSampler::Window w{};
+  sampler.Add(make_snapshot(0, 0xFFFFFFFFu, 0), &w);
+  if (!check(sampler.Add(make_snapshot(1000, 0xFFFFFFFFu, 0), &w), "window expected")) return false;
+  if (!check(w.saturated, "pinned PERF_COUNT should flag saturation")) return false;
+  if (!check(w.responses == 0, "saturated counter yields no delta")) return false;
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_rates_and_average();
+  ok = ok && test_bucket_wraparound();
+  ok = ok && test_histogram_percentiles();
+  ok = ok && test_saturation_flag();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] perf_sampler_test\n";
+  return 0;
+}
@@ -0,0 +1,169 @@
+#include "response_verifier.h"
+#include "workloads.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+// Round-robin over five symbols: seq n is symbol (n - 1) % 5, bids on odd seqs.
+std::vector<FpgaSharedStream::Frame> make_stream(uint32_t count) {
+  std::vector<FpgaSharedStream::Frame> events;
+  Workloads::Generate(Workloads::DefaultConfig(), count, &events);
+  return events;
+}
+
+// Sends `events` through the verifier with `in_flight` outstanding at a time,
+// answering from an independent SwOrderBook; `corrupt_seq` gets a bad bid qty.
+void run_pipelined(ResponseVerifier* verifier, const std::vector<FpgaSharedStream::Frame>& events,
+                   std::size_t in_flight, uint32_t corrupt_seq) {
+  SwOrderBook peer;
+  std::vector<FpgaSharedStream::Frame> queue;
+  std::size_t head = 0;
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    verifier->OnEvent(events[i]);
+    FpgaSharedStream::Frame response = peer.Process(events[i]);
+    if (response.word0 == corrupt_seq) {
+      response.word3 += 1;
+    }
+    queue.push_back(response);
+    if (queue.size() - head > in_flight) {
+      verifier->OnResponse(queue[head++]);
+    }
+  }
+  while (head < queue.size()) {
+    verifier->OnResponse(queue[head++]);
+  }
+}
+
+bool test_clean_stream_matches() {
+  ResponseVerifier verifier;
+  const std::vector<FpgaSharedStream::Frame> events = make_stream(5000);
+  run_pipelined(&verifier, events, 32, 0);
+  const ResponseVerifier::Stats& stats = verifier.GetStats();
+  if (!check(stats.compared == events.size() && stats.mismatches == 0, "clean stream must match")) {
+    return false;
+  }
+  return check(!verifier.HasDivergence() && stats.unknown == 0 && stats.unanswered == 0,
+               "clean stream should leave no divergence");
+}
+
+bool test_first_divergence_is_reported() {
+  ResponseVerifier verifier;
+  const std::vector<FpgaSharedStream::Frame> events = make_stream(1000);
+  run_pipelined(&verifier, events, 8, 401);
+  if (!check(verifier.GetStats().mismatches == 1, "one corrupted response expected")) return false;
+
+  const ResponseVerifier::Divergence& d = verifier.FirstDivergence();
+  if (!check(d.event.word0 == 401 && d.event.word1 == 400u % 5u, "divergence event mismatch")) {
+    return false;
+  }
+  if (!check(d.word_mask == (1u << 3) && d.actual.word3 == d.expected.word3 + 1,
+             "only bid_qty should differ")) return false;
+  if (!check(d.depth == 8 && d.bid_qty[0] != 0, "model book should be captured")) return false;
+
+  std::ostringstream report;
+  ResponseVerifier::Print(report, d);
+  return check(report.str().find("bid_qty: expected") != std::string::npos,
+               "report should name the differing field");
+}
+
+bool test_symbol_sampling() {
+  ResponseVerifier::Config config = ResponseVerifier::DefaultConfig();
+  config.sample_every = 2;
+  ResponseVerifier verifier(config);
+  const std::vector<FpgaSharedStream::Frame> events = make_stream(1000);
+  // seq 402 is symbol 1 (not sampled), seq 403 symbol 2 (sampled).
+  run_pipelined(&verifier, events, 4, 402);
+  if (!check(verifier.GetStats().mismatches == 0, "unsampled symbol must not be compared")) {
+    return false;
+  }
+  if (!check(verifier.GetStats().skipped == 400 && verifier.GetStats().compared == 600,
+             "symbols 1 and 3 should be skipped")) return false;
+
+  ResponseVerifier again(config);
+  run_pipelined(&again, events, 4, 403);
+  return check(again.GetStats().mismatches == 1, "sampled symbol must be compared");
+}
+
+bool test_unknown_and_unanswered() {
+  ResponseVerifier::Config config = ResponseVerifier::DefaultConfig();
+  config.max_outstanding = 16;  // 64-entry ring
+  ResponseVerifier verifier(config);
+  const std::vector<FpgaSharedStream::Frame> events = make_stream(200);
+
+  FpgaSharedStream::Frame stray{};
+  stray.word0 = 77;
+  if (!check(verifier.OnResponse(stray) == ResponseVerifier::kUnknown, "stray response")) {
+    return false;
+  }
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    verifier.OnEvent(events[i]);
+  }
+  // Only the last 64 events still have a slot.
+  if (!check(verifier.GetStats().unanswered == 136, "reused slots should count as unanswered")) {
+    return false;
+  }
+  FpgaSharedStream::Frame late{};
+  late.word0 = 1;
+  if (!check(verifier.OnResponse(late) == ResponseVerifier::kUnknown, "evicted seq is unknown")) {
+    return false;
+  }
+  const FpgaSharedStream::Frame reset = ResponseVerifier::ResetFrame(3);
+  return check(reset.word1 == 3 && reset.word4 == SwOrderBook::kEventResetBook,
+               "reset frame layout");
+}
+
+// A book read back from the FPGA is compared level by level with the model.
+bool test_book_readback_diffs() {
+  ResponseVerifier verifier;
+  const std::vector<FpgaSharedStream::Frame> events = make_stream(1000);
+  run_pipelined(&verifier, events, 8, 0);
+  const SwOrderBook& model = verifier.Model();
+
+  FpgaSharedStream::BookSnapshot book{};
+  book.symbol = 2;
+  book.depth = model.Depth();
+  book.last_seq = 1000;
+  for (uint32_t i = 0; i < book.depth; ++i) {
+    book.levels[i] = FpgaSharedStream::BookLevel{model.BidPrices(2)[i], model.BidQtys(2)[i],
+                                                 model.AskPrices(2)[i], model.AskQtys(2)[i]};
+  }
+  if (!check(ResponseVerifier::BookDiffs(model, book) == 0, "identical book has no diffs")) {
+    return false;
+  }
+  book.levels[1].ask_qty += 1;
+  book.depth += 1;  // a deeper FPGA book holds a level the model cannot
+  book.levels[book.depth - 1].bid_qty = 5;
+  if (!check(ResponseVerifier::BookDiffs(model, book) == 2, "changed and extra levels differ")) {
+    return false;
+  }
+  std::ostringstream report;
+  ResponseVerifier::PrintBook(report, book);
+  return check(report.str().find("read back after seq 1000") != std::string::npos,
+               "book report names the seq");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_clean_stream_matches();
+  ok = ok && test_first_divergence_is_reported();
+  ok = ok && test_symbol_sampling();
+  ok = ok && test_unknown_and_unanswered();
+  ok = ok && test_book_readback_diffs();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] response_verifier_test\n";
+  return 0;
+}
@@ -0,0 +1,127 @@
+#include "rt_setup.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool test_default_is_noop() {
+  const RtSetup::Config config = RtSetup::DefaultConfig();
+  if (!check(!RtSetup::Enabled(config), "default profile should be disabled")) return false;
+  const RtSetup::Report report = RtSetup::Apply(config);
+  return check(!report.pinned && !report.fifo && !report.locked && report.errors.empty() &&
+                   report.prefaulted_bytes == 0,
+               "default profile should change nothing");
+}
+
+bool test_pinning() {
+  std::string error;
+  if (!check(!RtSetup::PinThread(pthread_self(), -1, &error) && !error.empty(),
+             "negative cpu should be rejected")) return false;
+  if (!check(!RtSetup::PinThread(pthread_self(), CPU_SETSIZE, &error) && !error.empty(),
+             "out-of-range cpu should be rejected")) return false;
+
+  cpu_set_t before;
+  if (!check(pthread_getaffinity_np(pthread_self(), sizeof(before), &before) == 0,
+             "read affinity")) return false;
+  int cpu = 0;
+  while (cpu < CPU_SETSIZE && !CPU_ISSET(cpu, &before)) {
+    ++cpu;
+  }
+  RtSetup::Config config = RtSetup::DefaultConfig();
+  config.cpu = cpu;
+  const RtSetup::Report report = RtSetup::Apply(config);
+  if (!check(report.pinned && report.errors.empty(), "pin to an allowed cpu")) return false;
+  cpu_set_t after;
+  pthread_getaffinity_np(pthread_self(), sizeof(after), &after);
+  const bool only = CPU_COUNT(&after) == 1 && CPU_ISSET(cpu, &after);
+  pthread_setaffinity_np(pthread_self(), sizeof(before), &before);
+  return check(only, "thread should run on the one cpu");
+}
+
+bool test_failures_are_reported() {
+  // Priority 100 is outside SCHED_FIFO's range for everyone, root included.
+  RtSetup::Config config = RtSetup::DefaultConfig();
+  config.fifo_priority = 100;
+  const RtSetup::Report report = RtSetup::Apply(config);
+  return check(!report.fifo && report.errors.find("SCHED_FIFO") != std::string::npos,
+               "failed step should be reported, not fatal");
+}
+
+bool test_prepare_buffer() {
+  RtSetup::Config config = RtSetup::DefaultConfig();
+  config.prefault = true;
+  config.huge_pages = true;
+  std::vector<uint8_t> buffer(3 * RtSetup::kHugePageBytes, 7);
+  RtSetup::Report report{};
+  RtSetup::PrepareBuffer(config, buffer.data(), buffer.size(), &report);
+  if (!check(report.prefaulted_bytes == buffer.size(), "buffer should be prefaulted")) {
+    return false;
+  }
+  // THP may be disabled on the host; then the advice fails and says so.
+  if (!check(report.huge_page_bytes >= RtSetup::kHugePageBytes || !report.errors.empty(),
+             "huge-page advice should cover the aligned interior or report why not")) {
+    return false;
+  }
+  if (!check(report.huge_page_bytes % RtSetup::kHugePageBytes == 0 &&
+                 report.huge_page_bytes <= buffer.size(),
+             "advice stays inside the buffer on huge-page boundaries")) return false;
+  for (std::size_t i = 0; i < buffer.size(); i += 4096) {
+    if (buffer[i] != 7) {
+      return check(false, "prefault must not change contents");
+    }
+  }
+  RtSetup::PrefaultStack(RtSetup::kPrefaultStackBytes);
+  return true;
+}
+
+bool test_hiccup_meter() {
+  HiccupMeter meter;
+  std::string error;
+  HiccupMeter::Config config = HiccupMeter::DefaultConfig();
+  config.interval_ns = 0;
+  if (!check(!meter.Start(config, &error) && !error.empty(), "zero interval should fail")) {
+    return false;
+  }
+  config.interval_ns = 500000;
+  if (!check(meter.Start(config, &error) && error.empty(), "meter should start")) return false;
+  if (!check(!meter.Start(config, &error), "second start should fail")) return false;
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  meter.Stop();
+  const HiccupMeter::Stats stats = meter.Summarize();
+  if (!check(stats.samples >= 10, "meter should have woken repeatedly")) return false;
+  if (!check(stats.p50_ns <= stats.p99_ns && stats.p99_ns <= stats.p999_ns &&
+                 stats.p999_ns <= stats.max_ns,
+             "percentiles should be ordered")) return false;
+  if (!check(stats.total_ns >= stats.max_ns, "total should include the worst stall")) {
+    return false;
+  }
+  meter.Stop();
+  return check(meter.Start(config, &error), "meter should restart after stop");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_default_is_noop();
+  ok = ok && test_pinning();
+  ok = ok && test_failures_are_reported();
+  ok = ok && test_prepare_buffer();
+  ok = ok && test_hiccup_meter();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] rt_setup_test\n";
+  return 0;
+}
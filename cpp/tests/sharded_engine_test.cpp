@@ -0,0 +1,147 @@
+#include "sharded_engine.h"
+#include "workloads.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool test_ring_full_and_empty() {
+  SpscRing<uint32_t> ring(3);
+  if (!check(ring.Capacity() == 4, "capacity should round up to a power of two")) return false;
+  uint32_t value = 0;
+  if (!check(!ring.TryPop(&value), "new ring should be empty")) return false;
+  for (uint32_t round = 0; round < 5; ++round) {
+    for (uint32_t i = 0; i < 4; ++i) {
+      if (!check(ring.TryPush(round * 10 + i), "push below capacity should succeed")) return false;
+    }
+    if (!check(!ring.TryPush(99), "push into a full ring should fail")) return false;
+    for (uint32_t i = 0; i < 4; ++i) {
+      if (!check(ring.TryPop(&value) && value == round * 10 + i, "pop order mismatch")) return false;
+    }
+    if (!check(ring.Empty(), "drained ring should be empty")) return false;
+  }
+  return true;
+}
+
+bool test_ring_across_threads() {
+  const uint32_t kItems = 200000;
+  SpscRing<uint32_t> ring(16);
+  std::thread producer([&ring]() {
+    for (uint32_t i = 0; i < kItems; ++i) {
+      while (!ring.TryPush(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  uint32_t expected = 0;
+  uint32_t value = 0;
+  bool in_order = true;
+  while (expected < kItems) {
+    if (!ring.TryPop(&value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    in_order = in_order && value == expected;
+    ++expected;
+  }
+  producer.join();
+  return check(in_order, "items must arrive once and in order");
+}
+
+struct CollectSink {
+  std::vector<FpgaSharedStream::Frame>* out;
+  void operator()(const FpgaSharedStream::Frame& frame) { out->push_back(frame); }
+};
+
+bool same_frame(const FpgaSharedStream::Frame& a, const FpgaSharedStream::Frame& b) {
+  return a.word0 == b.word0 && a.word1 == b.word1 && a.word2 == b.word2 && a.word3 == b.word3 &&
+         a.word4 == b.word4 && a.word5 == b.word5 && a.word6 == b.word6 && a.word7 == b.word7;
+}
+
+bool matches_single_book(uint32_t threads, uint32_t ring_capacity, Workloads::Kind kind) {
+  const uint32_t kSymbols = 13;
+  Workloads::Config workload = Workloads::DefaultConfig();
+  workload.kind = kind;
+  workload.num_symbols = kSymbols + 1;  // one id past the book
+  std::vector<FpgaSharedStream::Frame> events;
+  Workloads::Generate(workload, 20000, &events);
+
+  SwOrderBook::Config book_config = SwOrderBook::DefaultConfig();
+  book_config.num_symbols = kSymbols;
+  SwOrderBook reference(book_config);
+
+  ShardedEngine::Config config = ShardedEngine::DefaultConfig();
+  config.threads = threads;
+  config.ring_capacity = ring_capacity;
+  config.book = book_config;
+  ShardedEngine engine;
+  if (!check(engine.Start(config), "engine should start")) return false;
+
+  std::vector<FpgaSharedStream::Frame> responses;
+  CollectSink sink{&responses};
+  // Two runs on the same engine: state must carry over between them.
+  engine.Run(events.data(), events.size() / 2, sink);
+  engine.Run(events.data() + events.size() / 2, events.size() - events.size() / 2, sink);
+  if (!check(responses.size() == events.size(), "every event needs a response")) return false;
+
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    if (!same_frame(responses[i], reference.Process(events[i]))) {
+      std::cerr << "[FAIL] " << threads << " shards diverged from one book on "
+                << Workloads::Name(kind) << " at event " << i << "\n";
+      return false;
+    }
+  }
+
+  uint64_t total = 0;
+  for (uint32_t s = 0; s < engine.Threads(); ++s) {
+    total += engine.GetShardStats(s).events;
+  }
+  return check(total == events.size(), "shard event counts should add up");
+}
+
+// Every generated workload: resets, deletes and crossing updates included.
+bool test_matches_single_book(uint32_t threads, uint32_t ring_capacity) {
+  for (int k = 0; k < Workloads::kNumKinds; ++k) {
+    const Workloads::Kind kind = static_cast<Workloads::Kind>(k);
+    if (kind != Workloads::kFile && !matches_single_book(threads, ring_capacity, kind)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_rejects_bad_config() {
+  ShardedEngine engine;
+  ShardedEngine::Config config = ShardedEngine::DefaultConfig();
+  config.threads = 0;
+  if (!check(!engine.Start(config), "zero threads must be rejected")) return false;
+  config.threads = ShardedEngine::kMaxThreads + 1;
+  return check(!engine.Start(config), "too many threads must be rejected");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_ring_full_and_empty();
+  ok = ok && test_ring_across_threads();
+  ok = ok && test_matches_single_book(1, 1024);
+  ok = ok && test_matches_single_book(2, 4);
+  ok = ok && test_matches_single_book(3, 64);
+  ok = ok && test_matches_single_book(5, 2);
+  ok = ok && test_rejects_bad_config();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] sharded_engine_test\n";
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include "sw_batch.h"
+#include "sw_strategies.h"
+#include "workloads.h"
+
+#include <iostream>
+#include <vector>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+uint32_t next_random(uint64_t* state) {
+  *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+  return static_cast<uint32_t>(*state >> 33);
+}
+
+bool same_frame(const FpgaSharedStream::Frame& a, const FpgaSharedStream::Frame& b) {
+  return a.word0 == b.word0 && a.word1 == b.word1 && a.word2 == b.word2 && a.word3 == b.word3 &&
+         a.word4 == b.word4 && a.word5 == b.word5 && a.word6 == b.word6 && a.word7 == b.word7;
+}
+
+template <typename Strategy>
+bool matches_per_event_book(const Strategy& strategy, Workloads::Kind kind) {
+  const uint32_t kSymbols = 13;
+  SwOrderBook::Config config = SwOrderBook::DefaultConfig();
+  config.num_symbols = kSymbols;
+  SwOrderBook reference(config);
+  SwBatchBook batched(config);
+  Workloads::Config workload = Workloads::DefaultConfig();
+  workload.kind = kind;
+  workload.num_symbols = kSymbols + 1;  // one id past the book
+  std::vector<FpgaSharedStream::Frame> events;
+  Workloads::Generate(workload, 20000, &events);
+  std::vector<FpgaSharedStream::Frame> expected(events.size());
+  std::vector<FpgaSharedStream::Frame> responses(kSymbols);
+
+  uint64_t state = 7;
+  std::size_t pos = 0;
+  uint64_t total = 0;
+  while (pos < events.size()) {
+    std::size_t batch = 1 + next_random(&state) % 40u;
+    if (batch > events.size() - pos) {
+      batch = events.size() - pos;
+    }
+    std::vector<uint32_t> last(kSymbols, 0);
+    for (std::size_t i = pos; i < pos + batch; ++i) {
+      expected[i] = reference.Process(events[i], strategy);
+      if (events[i].word1 < kSymbols) {
+        last[events[i].word1] = static_cast<uint32_t>(i + 1);
+      }
+    }
+    const std::size_t written =
+        batched.ProcessBatch(&events[pos], batch, responses.data(), strategy);
+    std::size_t changed = 0;
+    for (uint32_t s = 0; s < kSymbols; ++s) {
+      changed += last[s] != 0 ? 1u : 0u;
+    }
+    if (!check(written == changed, "one response per changed symbol")) return false;
+    for (std::size_t k = 0; k < written; ++k) {
+      const uint32_t seq = responses[k].word0;
+      const FpgaSharedStream::Frame& event = events[seq - 1];
+      if (!check(seq > pos && seq <= pos + batch && last[event.word1] == seq,
+                 "response should carry the symbol's last seq")) return false;
+      if (!same_frame(responses[k], expected[seq - 1])) {
+        std::cerr << "[FAIL] " << Strategy::Name() << " on " << Workloads::Name(kind)
+                  << ": batched response differs at seq " << seq << "\n";
+        return false;
+      }
+    }
+    total += written;
+    pos += batch;
+  }
+  const SwBatchBook::Stats& stats = batched.GetStats();
+  if (!check(stats.events == events.size() && stats.responses == total, "batch stats")) {
+    return false;
+  }
+  return check(batched.Book().OutOfRangeEvents() == reference.OutOfRangeEvents(),
+               "out-of-range events should be counted, not answered");
+}
+
+// Every generated workload: resets, deletes and crossing updates included.
+template <typename Strategy>
+bool matches_per_event_book(const Strategy& strategy) {
+  for (int k = 0; k < Workloads::kNumKinds; ++k) {
+    const Workloads::Kind kind = static_cast<Workloads::Kind>(k);
+    if (kind != Workloads::kFile && !matches_per_event_book(strategy, kind)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_matches_per_event_book() {
+  return matches_per_event_book(SwOrderBook::ImbalanceStrategy::Default());
+}
+
+// Other policies take the scalar path and may read the full depth.
+bool test_strategy_policies() {
+  return matches_per_event_book(MicropriceStrategy::Default()) &&
+         matches_per_event_book(DepthWeightedStrategy::Default()) &&
+         matches_per_event_book(SpreadRegimeStrategy::Default());
+}
+
+void set_top(SwBatchBook::TopOfBookBatch* batch, uint32_t i, uint32_t bid_px, uint32_t bid_qty,
+             uint32_t ask_px, uint32_t ask_qty) {
+  batch->bid_px[i] = bid_px;
+  batch->bid_qty[i] = bid_qty;
+  batch->ask_px[i] = ask_px;
+  batch->ask_qty[i] = ask_qty;
+}
+
+bool test_decide_batch_matches_scalar() {
+  SwBatchBook::TopOfBookBatch batch{};
+  const uint32_t kCount = 4099;  // exercises the scalar tail
+  batch.count = kCount;
+  batch.symbol.assign(kCount + 3, 0);
+  batch.seq.assign(kCount + 3, 0);
+  batch.bid_px.assign(kCount + 3, 0);
+  batch.bid_qty.assign(kCount + 3, 0);
+  batch.ask_px.assign(kCount + 3, 0);
+  batch.ask_qty.assign(kCount + 3, 0);
+  batch.spread.assign(kCount + 3, 0);
+  batch.imbalance.assign(kCount + 3, 0);
+  batch.action.assign(kCount + 3, 0);
+
+  uint64_t state = 99;
+  for (uint32_t i = 0; i < kCount; ++i) {
+    const uint32_t r = next_random(&state);
+    const uint32_t mid = (r & 1u) ? 0x7FFFFF00u : 1000000u;  // around the sign bit too
+    batch.bid_px[i] = mid - (r >> 4) % 30000u;
+    batch.ask_px[i] = mid + (r >> 9) % 30000u - 2000u;  // sometimes crossed
+    batch.bid_qty[i] = (r >> 3) % 7u == 0 ? 0u : next_random(&state) % 2000u;
+    batch.ask_qty[i] = (r >> 5) % 7u == 0 ? 0u : next_random(&state) % 2000u;
+  }
+  // Exact threshold and spread limits.
+  set_top(&batch, 0, 1000000, 600, 1025000, 100);
+  set_top(&batch, 1, 1000000, 600, 1025001, 100);
+  set_top(&batch, 2, 1000000, 100, 1000100, 600);
+  set_top(&batch, 3, 1000000, 900, 1000000, 100);
+
+  SwBatchBook::DecideBatch(&batch, SwOrderBook::kDefaultImbalanceThreshold,
+                           SwOrderBook::kDefaultMaxSpread1e4);
+  const SwOrderBook::Config config = SwOrderBook::DefaultConfig();
+  for (uint32_t i = 0; i < kCount; ++i) {
+    SwOrderBook::TopOfBook top{};
+    top.bid_px = batch.bid_px[i];
+    top.bid_qty = batch.bid_qty[i];
+    top.ask_px = batch.ask_px[i];
+    top.ask_qty = batch.ask_qty[i];
+    const FpgaSharedStream::Frame scalar = SwOrderBook::MakeResponse(0, top, config);
+    if (batch.action[i] != scalar.word1 || batch.spread[i] != scalar.word6 ||
+        batch.imbalance[i] != scalar.word7) {
+      std::cerr << "[FAIL] " << SwBatchBook::KernelName() << " decision differs at " << i << "\n";
+      return false;
+    }
+  }
+  return check(batch.action[0] == SwOrderBook::kActionBuy &&
+                   batch.action[1] == SwOrderBook::kActionNoop &&
+                   batch.action[2] == SwOrderBook::kActionSell &&
+                   batch.action[3] == SwOrderBook::kActionNoop,
+               "edge cases");
+}
+
+}  // namespace
+
+int main() {
+  std::cout << "batch kernel: " << SwBatchBook::KernelName() << "\n";
+  bool ok = test_matches_per_event_book();
+  ok = ok && test_strategy_policies();
+  ok = ok && test_decide_batch_matches_scalar();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] sw_batch_test\n";
+  return 0;
+}
@@ -0,0 +1,191 @@
+#include "sw_features.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+SwOrderBook::TopOfBook make_top(uint32_t bid_px, uint32_t bid_qty, uint32_t ask_px,
+                                uint32_t ask_qty) {
+  SwOrderBook::TopOfBook top{};
+  top.bid_px = bid_px;
+  top.bid_qty = bid_qty;
+  top.ask_px = ask_px;
+  top.ask_qty = ask_qty;
+  return top;
+}
+
+FpgaSharedStream::Frame level(uint32_t seq, uint32_t symbol, uint32_t side, uint32_t price,
+                              uint32_t qty, uint32_t type) {
+  FpgaSharedStream::Frame frame{};
+  frame.word0 = seq;
+  frame.word1 = symbol;
+  frame.word2 = price;
+  frame.word3 = qty;
+  frame.word4 = type;
+  frame.word5 = side;
+  return frame;
+}
+
+bool test_record_layout() {
+  SwFeatures features;
+  const uintptr_t first = reinterpret_cast<uintptr_t>(&features.Get(0));
+  const uintptr_t second = reinterpret_cast<uintptr_t>(&features.Get(1));
+  if (!check(first % 64 == 0 && second - first == 64, "records should be cache-line sized")) {
+    return false;
+  }
+  SwFeatures::Config config = SwFeatures::DefaultConfig();
+  config.mid_shift = 32;
+  return check(!features.Init(config), "shift of 32 must be rejected");
+}
+
+bool test_mid_and_volatility() {
+  SwFeatures features;
+  // Seeded by the first two-sided book, then flat: no volatility.
+  features.Update(0, make_top(1000000, 100, 1000200, 100));
+  for (int i = 0; i < 50; ++i) {
+    features.Update(0, make_top(1000000, 100 + i, 1000200, 100));
+  }
+  const SwFeatures::Record& flat = features.Get(0);
+  if (!check(SwFeatures::EwmaMid1e4(flat) == 1000100.0 && flat.variance_mid2 == 0 &&
+                 flat.mid_changes == 0,
+             "flat mid should have no volatility")) return false;
+
+  // Mid jumps by 100 every update: volatility tends to 100, the EWMA lags
+  // behind a rising mid.
+  for (int i = 1; i <= 400; ++i) {
+    const uint32_t step = (i & 1) ? 100u : 0u;
+    features.Update(0, make_top(1000000 + step * 2, 100, 1000200 + step * 2, 100));
+  }
+  const SwFeatures::Record& moving = features.Get(0);
+  const double vol = SwFeatures::Volatility1e4(moving);
+  if (!check(std::fabs(vol - 200.0) < 2.0, "alternating mid volatility")) return false;
+  if (!check(SwFeatures::VolatilityAtMost(moving, 201) && !SwFeatures::VolatilityAtMost(moving, 190),
+             "integer volatility limit")) return false;
+  const double mid = SwFeatures::EwmaMid1e4(moving);
+  if (!check(mid > 1000100.0 && mid < 1000300.0, "EWMA mid should sit between the two mids")) {
+    return false;
+  }
+  return check(moving.mid_changes == 400 && moving.updates == 451, "update counters");
+}
+
+bool test_order_flow_sign_and_decay() {
+  SwFeatures features;
+  features.Update(1, make_top(1000000, 500, 1000100, 500));
+  const int64_t seeded = features.Get(1).order_flow;  // the bid that appeared
+
+  // Bid size grows at the same price: +200.
+  features.Update(1, make_top(1000000, 700, 1000100, 500));
+  if (!check(features.Get(1).order_flow_total == seeded + 200, "bid growth is buy flow")) {
+    return false;
+  }
+  // Ask improves: the new ask size counts against.
+  features.Update(1, make_top(1000000, 700, 1000050, 300));
+  if (!check(features.Get(1).order_flow_total == seeded + 200 - 300, "ask improvement is sell flow")) {
+    return false;
+  }
+  // Ask taken out (moves up): the old ask size counts for.
+  features.Update(1, make_top(1000000, 700, 1000100, 400));
+  if (!check(features.Get(1).order_flow_total == seeded + 200 - 300 + 300,
+             "ask removal is buy flow")) return false;
+  if (!check(features.Get(1).ask_throughs == 1 && features.Get(1).bid_throughs == 0,
+             "ask move up is a trade-through")) return false;
+
+  // With no further flow the decayed sum shrinks towards zero.
+  const int64_t before = features.Get(1).order_flow;
+  for (int i = 0; i < 200; ++i) {
+    features.Update(1, make_top(1000000, 700, 1000100, 400));
+  }
+  const int64_t after = features.Get(1).order_flow;
+  return check(before > 0 && after >= 0 && after < 16, "order flow should decay");
+}
+
+bool test_throughs_on_book_events() {
+  SwOrderBook book;
+  SwFeatures features;
+  const SwOrderBook::ImbalanceStrategy plain = SwOrderBook::ImbalanceStrategy::Default();
+  uint32_t seq = 1;
+  const FpgaSharedStream::Frame setup[] = {
+      level(seq++, 3, SwOrderBook::kSideBuy, 1000000, 100, SwOrderBook::kEventUpsertLevel),
+      level(seq++, 3, SwOrderBook::kSideBuy, 999900, 100, SwOrderBook::kEventUpsertLevel),
+      level(seq++, 3, SwOrderBook::kSideSell, 1000100, 100, SwOrderBook::kEventUpsertLevel),
+      level(seq++, 3, SwOrderBook::kSideSell, 1000200, 100, SwOrderBook::kEventUpsertLevel),
+      // Best bid and best ask taken out, then the bid side emptied.
+      level(seq++, 3, SwOrderBook::kSideBuy, 1000000, 0, SwOrderBook::kEventDeleteLevel),
+      level(seq++, 3, SwOrderBook::kSideSell, 1000100, 0, SwOrderBook::kEventDeleteLevel),
+      level(seq++, 3, SwOrderBook::kSideBuy, 999900, 0, SwOrderBook::kEventDeleteLevel),
+  };
+  for (std::size_t i = 0; i < sizeof(setup) / sizeof(setup[0]); ++i) {
+    book.Process(setup[i], plain);
+    features.Update(3, book.Top(3));
+  }
+  const SwFeatures::Record& r = features.Get(3);
+  return check(r.bid_throughs == 2 && r.ask_throughs == 1, "deleting a best level is a through");
+}
+
+bool test_order_flow_strategy() {
+  SwOrderBook book;
+  SwFeatures features;
+  OrderFlowStrategy strategy = OrderFlowStrategy::Default(&features);
+  strategy.order_flow_threshold = 500;
+  uint32_t seq = 1;
+  book.Process(level(seq++, 0, SwOrderBook::kSideSell, 1000100, 500,
+                     SwOrderBook::kEventUpsertLevel), strategy);
+  FpgaSharedStream::Frame response = book.Process(
+      level(seq++, 0, SwOrderBook::kSideBuy, 1000000, 400, SwOrderBook::kEventUpsertLevel),
+      strategy);
+  if (!check(response.word1 == SwOrderBook::kActionNoop, "below threshold stays flat")) {
+    return false;
+  }
+  // Bids keep building at the best until the decayed flow crosses the
+  // threshold.
+  uint32_t qty = 400;
+  while (qty < 2000 && response.word1 == SwOrderBook::kActionNoop) {
+    qty += 200;
+    response = book.Process(
+        level(seq++, 0, SwOrderBook::kSideBuy, 1000000, qty, SwOrderBook::kEventUpsertLevel),
+        strategy);
+  }
+  if (!check(response.word1 == SwOrderBook::kActionBuy, "buy flow should buy")) return false;
+  if (!check(features.Get(0).updates == seq - 1, "strategy should update features every event")) {
+    return false;
+  }
+
+  // Same flow in a volatile market is filtered out.
+  SwOrderBook jumpy;
+  SwFeatures jumpy_features;
+  OrderFlowStrategy calm_only = OrderFlowStrategy::Default(&jumpy_features);
+  calm_only.order_flow_threshold = 1;
+  calm_only.max_volatility_1e4 = 1;
+  seq = 1;
+  jumpy.Process(level(seq++, 0, SwOrderBook::kSideSell, 1000100, 500,
+                      SwOrderBook::kEventUpsertLevel), calm_only);
+  jumpy.Process(level(seq++, 0, SwOrderBook::kSideBuy, 1000000, 500,
+                      SwOrderBook::kEventUpsertLevel), calm_only);
+  response = jumpy.Process(level(seq++, 0, SwOrderBook::kSideBuy, 1000050, 900,
+                                 SwOrderBook::kEventUpsertLevel), calm_only);
+  return check(response.word1 == SwOrderBook::kActionNoop, "volatile market should stay flat");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_record_layout();
+  ok = ok && test_mid_and_volatility();
+  ok = ok && test_order_flow_sign_and_decay();
+  ok = ok && test_throughs_on_book_events();
+  ok = ok && test_order_flow_strategy();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] sw_features_test\n";
+  return 0;
+}
@@ -0,0 +1,292 @@
+#include "sw_l3_book.h"
+
+#include <iostream>
+#include <map>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+FpgaSharedStream::Frame make_event(uint32_t seq, uint32_t symbol, uint32_t price, uint32_t qty,
+                                   uint32_t event_type, uint32_t side, uint32_t order_id) {
+  FpgaSharedStream::Frame frame{};
+  frame.word0 = seq;
+  frame.word1 = symbol;
+  frame.word2 = price;
+  frame.word3 = qty;
+  frame.word4 = event_type;
+  frame.word5 = side;
+  frame.word6 = order_id;
+  return frame;
+}
+
+SwL3Book::Config small_config() {
+  SwL3Book::Config config = SwL3Book::DefaultConfig();
+  config.max_orders = 64;
+  config.max_levels_per_side = 4;
+  return config;
+}
+
+// Ids of the orders queued at `rank`, head first.
+std::vector<uint32_t> queue_ids(const SwL3Book& book, uint32_t symbol, uint32_t side,
+                                uint32_t rank) {
+  std::vector<uint32_t> ids;
+  const SwL3Book::Level* level = book.LevelAt(symbol, side, rank);
+  for (uint32_t idx = level == nullptr ? SwL3Book::kNone : level->head; idx != SwL3Book::kNone;
+       idx = book.OrderAt(idx).next) {
+    ids.push_back(book.OrderAt(idx).id);
+  }
+  return ids;
+}
+
+bool test_fifo_and_aggregation() {
+  SwL3Book book(small_config());
+  const uint32_t kBuy = SwOrderBook::kSideBuy;
+  const uint32_t kSell = SwOrderBook::kSideSell;
+  book.Process(make_event(1, 0, 1850000, 1000, SwOrderBook::kEventAddOrder, kBuy, 11));
+  book.Process(make_event(2, 0, 1850000, 700, SwOrderBook::kEventAddOrder, kBuy, 12));
+  book.Process(make_event(3, 0, 1850000, 800, SwOrderBook::kEventAddOrder, kBuy, 13));
+  book.Process(make_event(4, 0, 1849000, 5000, SwOrderBook::kEventAddOrder, kBuy, 14));
+  FpgaSharedStream::Frame r =
+      book.Process(make_event(5, 0, 1852000, 1200, SwOrderBook::kEventAddOrder, kSell, 21));
+
+  if (!check(r.word2 == 1850000u && r.word3 == 2500u, "best bid should aggregate three orders")) {
+    return false;
+  }
+  if (!check(r.word4 == 1852000u && r.word5 == 1200u && r.word6 == 2000u, "ask/spread mismatch")) {
+    return false;
+  }
+  if (!check(r.word1 == SwOrderBook::kActionBuy && r.word7 == 1300u,
+             "decision should match the level book")) return false;
+  if (!check(queue_ids(book, 0, kBuy, 0) == std::vector<uint32_t>{11, 12, 13},
+             "orders should queue in arrival order")) return false;
+
+  // Cancel the middle order and partially fill the head.
+  r = book.Process(make_event(6, 0, 0, 0, SwOrderBook::kEventCancelOrder, 0, 12));
+  if (!check(r.word3 == 1800u, "cancel should reduce the level")) return false;
+  r = book.Process(make_event(7, 0, 0, 400, SwOrderBook::kEventExecuteOrder, 0, 11));
+  if (!check(r.word3 == 1400u && book.FindOrder(11)->qty == 600u, "partial fill mismatch")) {
+    return false;
+  }
+  if (!check(queue_ids(book, 0, kBuy, 0) == std::vector<uint32_t>{11, 13},
+             "partial fill must keep priority")) return false;
+
+  // Emptying the best level exposes the next one.
+  book.Process(make_event(8, 0, 0, 600, SwOrderBook::kEventExecuteOrder, 0, 11));
+  r = book.Process(make_event(9, 0, 0, 0, SwOrderBook::kEventCancelOrder, 0, 13));
+  if (!check(r.word2 == 1849000u && r.word3 == 5000u, "next bid level should become best")) {
+    return false;
+  }
+  if (!check(book.LevelCount(0, kBuy) == 1 && book.LiveOrders() == 2, "level/order counts")) {
+    return false;
+  }
+  return true;
+}
+
+bool test_modify_priority() {
+  SwL3Book book(small_config());
+  const uint32_t kSell = SwOrderBook::kSideSell;
+  book.Process(make_event(1, 3, 1700000, 100, SwOrderBook::kEventAddOrder, kSell, 1));
+  book.Process(make_event(2, 3, 1700000, 200, SwOrderBook::kEventAddOrder, kSell, 2));
+  book.Process(make_event(3, 3, 1700000, 300, SwOrderBook::kEventAddOrder, kSell, 3));
+
+  // Modify only names the order; word1 is ignored when the id is known.
+  book.Process(make_event(4, 7, 1700000, 50, SwOrderBook::kEventModifyOrder, 0, 1));
+  if (!check(queue_ids(book, 3, kSell, 0) == std::vector<uint32_t>{1, 2, 3},
+             "size decrease keeps priority")) return false;
+  book.Process(make_event(5, 0, 1700000, 250, SwOrderBook::kEventModifyOrder, 0, 2));
+  if (!check(queue_ids(book, 3, kSell, 0) == std::vector<uint32_t>{1, 3, 2},
+             "size increase goes to the back")) return false;
+
+  const FpgaSharedStream::Frame r =
+      book.Process(make_event(6, 0, 1699000, 300, SwOrderBook::kEventModifyOrder, 0, 3));
+  if (!check(r.word4 == 1699000u && r.word5 == 300u, "reprice should open a better level")) {
+    return false;
+  }
+  if (!check(book.LevelAt(3, kSell, 1)->total_qty == 300u, "old level keeps the rest")) {
+    return false;
+  }
+  if (!check(book.Top(7).ask_qty == 0, "other symbol must stay empty")) return false;
+  if (!check(book.GetStats().modifies == 3 && book.GetStats().rejected == 0, "modify stats")) {
+    return false;
+  }
+  return true;
+}
+
+bool test_rejects_and_reset() {
+  SwL3Book::Config config = small_config();
+  config.max_orders = 6;
+  config.max_levels_per_side = 2;
+  SwL3Book book(config);
+  const uint32_t kBuy = SwOrderBook::kSideBuy;
+
+  book.Process(make_event(1, 1, 100, 1, SwOrderBook::kEventAddOrder, kBuy, 1));
+  book.Process(make_event(2, 1, 100, 1, SwOrderBook::kEventAddOrder, kBuy, 1));   // duplicate
+  book.Process(make_event(3, 1, 200, 1, SwOrderBook::kEventAddOrder, kBuy, 2));
+  book.Process(make_event(4, 1, 300, 1, SwOrderBook::kEventAddOrder, kBuy, 3));   // side full
+  book.Process(make_event(5, 1, 0, 0, SwOrderBook::kEventCancelOrder, 0, 99));    // unknown
+  book.Process(make_event(6, 1, 100, 1, SwOrderBook::kEventAddOrder, 9, 4));      // bad side
+  book.Process(make_event(7, 1, 100, 1, SwOrderBook::kEventUpsertLevel, kBuy, 0));
+  if (!check(book.GetStats().rejected == 5 && book.LiveOrders() == 2, "reject accounting")) {
+    return false;
+  }
+
+  for (uint32_t id = 10; id < 14; ++id) {
+    book.Process(make_event(id, 2, 100, 1, SwOrderBook::kEventAddOrder, kBuy, id));
+  }
+  book.Process(make_event(20, 2, 100, 1, SwOrderBook::kEventAddOrder, kBuy, 20));  // pool full
+  if (!check(book.GetStats().rejected == 6 && book.LiveOrders() == 6, "pool exhaustion")) {
+    return false;
+  }
+
+  const FpgaSharedStream::Frame r =
+      book.Process(make_event(21, 2, 0, 0, SwOrderBook::kEventResetBook, 0, 0));
+  if (!check(r.word2 == 0 && r.word3 == 0 && book.LevelCount(2, kBuy) == 0, "reset clears symbol")) {
+    return false;
+  }
+  if (!check(book.LiveOrders() == 2 && book.FindOrder(10) == nullptr, "reset frees orders")) {
+    return false;
+  }
+  if (!check(book.Top(1).bid_px == 200u, "reset must not touch other symbols")) return false;
+
+  book.Process(make_event(22, 2, 100, 1, SwOrderBook::kEventAddOrder, kBuy, 20));
+  if (!check(book.FindOrder(20) != nullptr, "freed entries should be reused")) return false;
+
+  const FpgaSharedStream::Frame oor =
+      book.Process(make_event(23, 8, 100, 1, SwOrderBook::kEventAddOrder, kBuy, 30));
+  if (!check(oor.word0 == 23 && oor.word2 == 0 && book.GetStats().out_of_range == 1,
+             "out-of-range symbol gives empty response")) return false;
+
+  SwL3Book::Config bad = config;
+  bad.max_orders = 0;
+  if (!check(!book.Init(bad), "zero-order pool must be rejected")) return false;
+  return true;
+}
+
+// xorshift64*, fixed seed so failures reproduce.
+struct Rng {
+  uint64_t state;
+  uint32_t Next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<uint32_t>((state * 2685821657736338717ull) >> 32);
+  }
+};
+
+struct RefOrder {
+  uint32_t symbol;
+  uint32_t side;
+  uint32_t price;
+  uint32_t qty;
+};
+
+// Naive recomputation of one side's best level from every live order.
+void ref_best(const std::map<uint32_t, RefOrder>& orders, uint32_t symbol, uint32_t side,
+              uint32_t* px, uint32_t* qty) {
+  *px = 0;
+  *qty = 0;
+  for (std::map<uint32_t, RefOrder>::const_iterator it = orders.begin(); it != orders.end(); ++it) {
+    const RefOrder& o = it->second;
+    if (o.symbol != symbol || o.side != side) {
+      continue;
+    }
+    const bool better = *qty == 0 || (side == SwOrderBook::kSideBuy ? o.price > *px : o.price < *px);
+    if (better) {
+      *px = o.price;
+      *qty = o.qty;
+    } else if (o.price == *px) {
+      *qty += o.qty;
+    }
+  }
+}
+
+// Random churn on a small pool (dense hash, frequent id reuse) checked
+// against a map-based reference after every event.
+bool test_random_against_reference() {
+  SwL3Book::Config config = small_config();
+  config.num_symbols = 2;
+  config.max_orders = 48;
+  config.max_levels_per_side = 64;
+  SwL3Book book(config);
+  std::map<uint32_t, RefOrder> ref;
+  Rng rng{0x2545F4914F6CDD1Dull};
+
+  for (uint32_t seq = 1; seq <= 200000; ++seq) {
+    const uint32_t r = rng.Next();
+    const uint32_t id = rng.Next() % 96u;
+    FpgaSharedStream::Frame event = make_event(seq, rng.Next() % 2u, 1000u + rng.Next() % 12u,
+                                               1u + rng.Next() % 50u, 0, 1u + (r & 1u), id);
+    std::map<uint32_t, RefOrder>::iterator it = ref.find(id);
+    switch ((r >> 1) % 4u) {
+      case 0:
+        event.word4 = SwOrderBook::kEventAddOrder;
+        if (it == ref.end() && ref.size() < config.max_orders) {
+          const RefOrder o = {event.word1, event.word5, event.word2, event.word3};
+          ref[id] = o;
+        }
+        break;
+      case 1:
+        event.word4 = SwOrderBook::kEventCancelOrder;
+        if (it != ref.end()) ref.erase(it);
+        break;
+      case 2:
+        event.word4 = SwOrderBook::kEventExecuteOrder;
+        if (it != ref.end()) {
+          if (event.word3 >= it->second.qty) ref.erase(it);
+          else it->second.qty -= event.word3;
+        }
+        break;
+      default:
+        event.word4 = SwOrderBook::kEventModifyOrder;
+        if (it != ref.end()) {
+          it->second.price = event.word2;
+          it->second.qty = event.word3;
+        }
+        break;
+    }
+    book.Process(event);
+
+    if (book.LiveOrders() != ref.size()) {
+      std::cerr << "[FAIL] live order count diverged at seq " << seq << "\n";
+      return false;
+    }
+    for (uint32_t symbol = 0; symbol < config.num_symbols; ++symbol) {
+      SwOrderBook::TopOfBook expected{};
+      ref_best(ref, symbol, SwOrderBook::kSideBuy, &expected.bid_px, &expected.bid_qty);
+      ref_best(ref, symbol, SwOrderBook::kSideSell, &expected.ask_px, &expected.ask_qty);
+      const SwOrderBook::TopOfBook& top = book.Top(symbol);
+      if (top.bid_px != expected.bid_px || top.bid_qty != expected.bid_qty ||
+          top.ask_px != expected.ask_px || top.ask_qty != expected.ask_qty) {
+        std::cerr << "[FAIL] top of book diverged at seq " << seq << " symbol " << symbol << "\n";
+        return false;
+      }
+    }
+  }
+  for (std::map<uint32_t, RefOrder>::const_iterator it = ref.begin(); it != ref.end(); ++it) {
+    if (book.FindOrder(it->first) == nullptr) {
+      return check(false, "live order missing from the id hash");
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_fifo_and_aggregation();
+  ok = ok && test_modify_priority();
+  ok = ok && test_rejects_and_reset();
+  ok = ok && test_random_against_reference();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] sw_l3_book_test\n";
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include "sw_order_book.h"
+
+#include <iostream>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+FpgaSharedStream::Frame make_event(uint32_t seq, uint32_t symbol, uint32_t price, uint32_t qty,
+                                   uint32_t event_type, uint32_t side) {
+  FpgaSharedStream::Frame frame{};
+  frame.word0 = seq;
+  frame.word1 = symbol;
+  frame.word2 = price;
+  frame.word3 = qty;
+  frame.word4 = event_type;
+  frame.word5 = side;
+  return frame;
+}
+
+// Same stimulus and expectations as vhdl/tb_order_book_core.vhd.
+bool test_matches_order_book_core_tb() {
+  SwOrderBook book;
+  FpgaSharedStream::Frame r{};
+
+  r = book.Process(make_event(1, 0, 1850000, 2500, SwOrderBook::kEventUpsertLevel,
+                              SwOrderBook::kSideBuy));
+  if (!check(r.word0 == 1, "seq mismatch after buy")) return false;
+  if (!check(r.word2 == 0x001C3A90u && r.word3 == 0x9C4u, "best bid mismatch after buy")) return false;
+  if (!check(r.word4 == 0 && r.word6 == 0, "one-sided book should have no ask/spread")) return false;
+
+  r = book.Process(make_event(2, 0, 1852000, 1200, SwOrderBook::kEventUpsertLevel,
+                              SwOrderBook::kSideSell));
+  if (!check(r.word4 == 0x001C4260u && r.word5 == 0x4B0u, "best ask mismatch after sell")) return false;
+  if (!check(r.word6 == 0x7D0u, "spread mismatch after sell")) return false;
+  if (!check(r.word7 == 0x514u, "imbalance mismatch after sell")) return false;
+  if (!check(r.word1 == SwOrderBook::kActionBuy, "imbalance 1300 should buy")) return false;
+
+  r = book.Process(make_event(3, 0, 1851000, 1800, SwOrderBook::kEventUpsertLevel,
+                              SwOrderBook::kSideBuy));
+  if (!check(r.word2 == 0x001C3E78u && r.word3 == 0x708u, "stronger bid should become best")) {
+    return false;
+  }
+  if (!check(r.word6 == 0x3E8u && r.word7 == 0x258u, "spread/imbalance after stronger bid")) {
+    return false;
+  }
+
+  r = book.Process(make_event(4, 0, 1850500, 999, SwOrderBook::kEventUpsertLevel,
+                              SwOrderBook::kSideSell));
+  if (!check(r.word4 == 0x001C4260u && r.word5 == 0x4B0u, "crossed ask should be rejected")) {
+    return false;
+  }
+
+  r = book.Process(make_event(5, 0, 1853000, 999, SwOrderBook::kEventUpsertLevel,
+                              SwOrderBook::kSideBuy));
+  if (!check(r.word2 == 0x001C3E78u, "crossed bid should be rejected")) return false;
+
+  r = book.Process(make_event(6, 0, 1852000, 0, SwOrderBook::kEventDeleteLevel,
+                              SwOrderBook::kSideSell));
+  if (!check(r.word4 == 0 && r.word5 == 0 && r.word6 == 0, "delete should clear the ask")) {
+    return false;
+  }
+  if (!check(r.word1 == SwOrderBook::kActionNoop, "one-sided book should not trade")) return false;
+
+  // The second bid level is still there behind the best.
+  if (!check(book.BidPrices(0)[1] == 1850000u && book.BidQtys(0)[1] == 2500u,
+             "second bid level mismatch")) return false;
+  return true;
+}
+
+bool test_depth_limit_and_reset() {
+  SwOrderBook::Config config = SwOrderBook::DefaultConfig();
+  config.depth = 3;
+  SwOrderBook book(config);
+
+  for (uint32_t i = 0; i < 5; ++i) {
+    book.Process(make_event(i + 1, 2, 1000000u + i * 100u, 10u + i, SwOrderBook::kEventUpsertLevel,
+                            SwOrderBook::kSideBuy));
+  }
+  const uint32_t* px = book.BidPrices(2);
+  if (!check(px[0] == 1000400u && px[1] == 1000300u && px[2] == 1000200u,
+             "depth-3 book should keep the three best bids")) return false;
+
+  // A worse bid than every level is dropped once the side is full.
+  book.Process(make_event(6, 2, 900000u, 1u, SwOrderBook::kEventUpsertLevel, SwOrderBook::kSideBuy));
+  if (!check(px[2] == 1000200u, "worse bid must not enter a full side")) return false;
+
+  const FpgaSharedStream::Frame r =
+      book.Process(make_event(7, 2, 0, 0, SwOrderBook::kEventResetBook, 0));
+  if (!check(r.word2 == 0 && r.word3 == 0 && px[0] == 0, "reset should clear the symbol")) return false;
+  return true;
+}
+
+bool test_many_symbols_and_out_of_range() {
+  SwOrderBook::Config config = SwOrderBook::DefaultConfig();
+  config.num_symbols = 4096;
+  SwOrderBook book(config);
+  if (!check(reinterpret_cast<uintptr_t>(&book.Top(0)) % 64 == 0, "top of book must be line aligned")) {
+    return false;
+  }
+
+  book.Process(make_event(1, 4095, 500000, 7, SwOrderBook::kEventUpsertLevel, SwOrderBook::kSideSell));
+  if (!check(book.Top(4095).ask_px == 500000u && book.Top(4095).ask_qty == 7u,
+             "highest symbol should be tracked")) return false;
+  if (!check(book.Top(4094).ask_qty == 0, "neighbouring symbol must stay empty")) return false;
+
+  const FpgaSharedStream::Frame r =
+      book.Process(make_event(2, 4096, 500000, 7, SwOrderBook::kEventUpsertLevel, SwOrderBook::kSideSell));
+  if (!check(r.word0 == 2 && r.word4 == 0 && r.word5 == 0, "out-of-range symbol gives empty response")) {
+    return false;
+  }
+  if (!check(book.OutOfRangeEvents() == 1, "out-of-range event should be counted")) return false;
+
+  SwOrderBook::Config bad = config;
+  bad.depth = 0;
+  if (!check(!book.Init(bad), "zero depth must be rejected")) return false;
+  if (!check(book.NumSymbols() == 4096, "failed Init must keep the old book")) return false;
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_matches_order_book_core_tb();
+  ok = ok && test_depth_limit_and_reset();
+  ok = ok && test_many_symbols_and_out_of_range();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] sw_order_book_test\n";
+  return 0;
+}
@@ -0,0 +1,152 @@
+#include "sw_strategies.h"
+
+#include <iostream>
+#include <vector>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+FpgaSharedStream::Frame upsert(uint32_t seq, uint32_t symbol, uint32_t side, uint32_t price,
+                               uint32_t qty) {
+  FpgaSharedStream::Frame frame{};
+  frame.word0 = seq;
+  frame.word1 = symbol;
+  frame.word2 = price;
+  frame.word3 = qty;
+  frame.word4 = SwOrderBook::kEventUpsertLevel;
+  frame.word5 = side;
+  return frame;
+}
+
+SwOrderBook::TopOfBook make_top(uint32_t bid_px, uint32_t bid_qty, uint32_t ask_px,
+                                uint32_t ask_qty) {
+  SwOrderBook::TopOfBook top{};
+  top.bid_px = bid_px;
+  top.bid_qty = bid_qty;
+  top.ask_px = ask_px;
+  top.ask_qty = ask_qty;
+  return top;
+}
+
+bool test_default_strategy_matches_process() {
+  SwOrderBook plain;
+  SwOrderBook templated;
+  const SwOrderBook::ImbalanceStrategy strategy = SwOrderBook::ImbalanceStrategy::Default();
+  for (uint32_t i = 0; i < 20000; ++i) {
+    FpgaSharedStream::Frame event = upsert(i + 1, i % 9u, (i & 1u) ? SwOrderBook::kSideSell
+                                                                   : SwOrderBook::kSideBuy,
+                                           0, 100u + (i * 37u) % 4901u);
+    const uint32_t ticks = ((i * 17u) % 80u + 1u) * 100u;
+    event.word2 = event.word5 == SwOrderBook::kSideBuy ? 1850000u - ticks : 1850000u + ticks;
+    if (i % 13u == 0) {
+      event.word4 = SwOrderBook::kEventDeleteLevel;
+    }
+    const FpgaSharedStream::Frame a = plain.Process(event);
+    const FpgaSharedStream::Frame b = templated.Process(event, strategy);
+    if (a.word0 != b.word0 || a.word1 != b.word1 || a.word2 != b.word2 || a.word3 != b.word3 ||
+        a.word4 != b.word4 || a.word5 != b.word5 || a.word6 != b.word6 || a.word7 != b.word7) {
+      std::cerr << "[FAIL] imbalance policy diverged from Process() at event " << i << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_microprice() {
+  SwOrderBook book;
+  const MicropriceStrategy strategy = MicropriceStrategy::Default();  // 200 = 2 bp
+  // spread 1000, imbalance 800 over 1000: microprice 400 above mid.
+  const SwOrderBook::TopOfBook top = make_top(1000000, 900, 1001000, 100);
+  if (!check(strategy.Decide(book, 0, top, 1000, 800) == SwOrderBook::kActionBuy,
+             "bid-heavy book should buy")) return false;
+  const SwOrderBook::TopOfBook mirror = make_top(1000000, 100, 1001000, 900);
+  if (!check(strategy.Decide(book, 0, mirror, 1000, -800) == SwOrderBook::kActionSell,
+             "ask-heavy book should sell")) return false;
+  // spread 1000, imbalance 300 over 1100: 136 above mid, under the edge.
+  const SwOrderBook::TopOfBook small = make_top(1000000, 700, 1001000, 400);
+  if (!check(strategy.Decide(book, 0, small, 1000, 300) == SwOrderBook::kActionNoop,
+             "edge below min_edge should not trade")) return false;
+  // Exactly at the edge: 1000 * 400 == 2 * 1000 * 200.
+  const SwOrderBook::TopOfBook edge = make_top(1000000, 700, 1001000, 300);
+  return check(strategy.Decide(book, 0, edge, 1000, 400) == SwOrderBook::kActionBuy,
+               "edge equal to min_edge should trade");
+}
+
+bool test_depth_weighted_uses_deeper_levels() {
+  SwOrderBook book;
+  uint32_t seq = 1;
+  // Balanced top, bid-heavy below it.
+  book.Process(upsert(seq++, 2, SwOrderBook::kSideBuy, 1000000, 500));
+  book.Process(upsert(seq++, 2, SwOrderBook::kSideSell, 1000100, 500));
+  book.Process(upsert(seq++, 2, SwOrderBook::kSideBuy, 999900, 2000));
+  book.Process(upsert(seq++, 2, SwOrderBook::kSideSell, 1000200, 100));
+
+  DepthWeightedStrategy strategy = DepthWeightedStrategy::Default();
+  FpgaSharedStream::Frame response =
+      book.Process(upsert(seq++, 2, SwOrderBook::kSideBuy, 999800, 40), strategy);
+  // (500-500) + (2000-100)/2 + 40/4 = 960
+  if (!check(response.word1 == SwOrderBook::kActionBuy && response.word7 == 0,
+             "deeper bids should tip a balanced top")) return false;
+  if (!check(book.Process(upsert(seq++, 2, SwOrderBook::kSideBuy, 999800, 40)).word1 ==
+                 SwOrderBook::kActionNoop,
+             "top-of-book imbalance alone should not trade")) return false;
+
+  strategy.levels = 1;
+  response = book.Process(upsert(seq++, 2, SwOrderBook::kSideBuy, 999800, 40), strategy);
+  if (!check(response.word1 == SwOrderBook::kActionNoop, "one level is the top only")) {
+    return false;
+  }
+  strategy.levels = 100;  // clamped to the book depth
+  response = book.Process(upsert(seq++, 2, SwOrderBook::kSideBuy, 999800, 40), strategy);
+  return check(response.word1 == SwOrderBook::kActionBuy, "levels past the depth are clamped");
+}
+
+bool test_spread_regime() {
+  SwOrderBook book;
+  const SpreadRegimeStrategy strategy = SpreadRegimeStrategy::Default();
+  const SwOrderBook::TopOfBook top = make_top(1000000, 800, 1005000, 400);
+  if (!check(strategy.Decide(book, 0, top, 5000, 400) == SwOrderBook::kActionBuy,
+             "tight spread uses the low threshold")) return false;
+  if (!check(strategy.Decide(book, 0, top, 5001, 400) == SwOrderBook::kActionNoop,
+             "wide spread uses the high threshold")) return false;
+  if (!check(strategy.Decide(book, 0, top, 8000, -1000) == SwOrderBook::kActionSell,
+             "wide spread sells at the high threshold")) return false;
+  return check(strategy.Decide(book, 0, top, 30000, 4000) == SwOrderBook::kActionNoop,
+               "spread above the limit must not trade");
+}
+
+bool test_one_sided_book_never_trades() {
+  SwOrderBook book;
+  const FpgaSharedStream::Frame event = upsert(1, 0, SwOrderBook::kSideBuy, 1000000, 5000);
+  bool ok = book.Process(event, MicropriceStrategy::Default()).word1 == SwOrderBook::kActionNoop;
+  ok = ok && book.Process(event, DepthWeightedStrategy::Default()).word1 ==
+                 SwOrderBook::kActionNoop;
+  ok = ok && book.Process(event, SpreadRegimeStrategy::Default()).word1 ==
+                 SwOrderBook::kActionNoop;
+  FpgaSharedStream::Frame outside = event;
+  outside.word1 = book.NumSymbols();
+  ok = ok && book.Process(outside, MicropriceStrategy::Default()).word1 == SwOrderBook::kActionNoop;
+  return check(ok && book.OutOfRangeEvents() == 1, "one-sided or unknown book must not trade");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_default_strategy_matches_process();
+  ok = ok && test_microprice();
+  ok = ok && test_depth_weighted_uses_deeper_levels();
+  ok = ok && test_spread_regime();
+  ok = ok && test_one_sided_book_never_trades();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] sw_strategies_test\n";
+  return 0;
+}
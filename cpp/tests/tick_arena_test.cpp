@@ -0,0 +1,110 @@
+#include "tick_arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool test_alignment_and_reuse() {
+  TickArena arena;
+  std::vector<void*> blocks;
+  for (std::size_t bytes = 1; bytes <= 4096; bytes = bytes * 3 + 1) {
+    void* p = arena.Allocate(bytes);
+    if (!check(reinterpret_cast<uintptr_t>(p) % 16 == 0, "blocks are 16-byte aligned")) {
+      return false;
+    }
+    std::memset(p, 0xAB, bytes);
+    blocks.push_back(p);
+  }
+  if (!check(arena.GetStats().heap_allocations == 1, "small blocks share one chunk")) {
+    return false;
+  }
+  void* first = blocks[2];
+  arena.Deallocate(first);
+  if (!check(arena.Allocate(10) == first, "freed block is handed out again")) return false;
+  arena.Deallocate(nullptr);
+  return check(arena.GetStats().deallocations == 1, "null deallocation is ignored");
+}
+
+bool test_reallocate_keeps_contents() {
+  TickArena arena;
+  void* p = nullptr;
+  std::size_t capacity = arena.Reallocate(p, 0, 10);
+  if (!check(p != nullptr && capacity >= 10, "reallocate from null allocates")) return false;
+  for (std::size_t i = 0; i < 10; ++i) {
+    static_cast<uint8_t*>(p)[i] = static_cast<uint8_t>(i);
+  }
+  void* before = p;
+  if (!check(arena.Reallocate(p, 10, capacity) == capacity && p == before,
+             "growth within the block stays in place")) return false;
+  capacity = arena.Reallocate(p, 10, 100);
+  if (!check(capacity >= 100 && p != before, "growth past the block moves")) return false;
+  for (std::size_t i = 0; i < 10; ++i) {
+    if (static_cast<uint8_t*>(p)[i] != i) {
+      return check(false, "moved block keeps its contents");
+    }
+  }
+  // Past the largest class: a heap block of its own, contents still kept.
+  capacity = arena.Reallocate(p, 100, TickArena::kMaxBlockBytes + 1);
+  if (!check(capacity == TickArena::kMaxBlockBytes + 1 && static_cast<uint8_t*>(p)[9] == 9,
+             "large growth keeps contents")) return false;
+  const uint64_t heap = arena.GetStats().heap_allocations;
+  arena.Deallocate(p);
+  return check(arena.GetStats().in_use_bytes == 0 && heap == 2,
+               "large block is freed and counted");
+}
+
+// The decoder pattern: every message resizes a sequence and sets a few
+// strings, then the old storage is released. After the first message the
+// arena must not touch the heap.
+bool test_steady_state_is_heap_free() {
+  TickArena arena;
+  arena.Reserve(64, 4);
+  const uint64_t reserved = arena.GetStats().heap_allocations;
+  void* sequence = nullptr;
+  std::size_t capacity = 0;
+  uint64_t warm = 0;
+  for (uint32_t message = 0; message < 10000; ++message) {
+    const std::size_t entries = 1 + message % 8;
+    if (entries * 40 > capacity) {
+      capacity = arena.Reallocate(sequence, capacity, entries * 40);
+    }
+    void* symbol = arena.Allocate(5);
+    void* side = arena.Allocate(4);
+    arena.Deallocate(side);
+    arena.Deallocate(symbol);
+    if (message == 7) {
+      warm = arena.GetStats().heap_allocations;
+    }
+  }
+  arena.Deallocate(sequence);
+  const TickArena::Stats& stats = arena.GetStats();
+  if (!check(reserved == 1 && warm == reserved, "reserved chunk covers the working set")) {
+    return false;
+  }
+  if (!check(stats.heap_allocations == warm, "no heap calls after warmup")) return false;
+  return check(stats.allocations == 20000 && stats.in_use_bytes == 0, "requests are counted");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_alignment_and_reuse();
+  ok = ok && test_reallocate_keeps_contents();
+  ok = ok && test_steady_state_is_heap_free();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] tick_arena_test\n";
+  return 0;
+}
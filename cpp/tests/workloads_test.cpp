@@ -0,0 +1,210 @@
+#include "workloads.h"
+
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+bool check(bool cond, const char* msg) {
+  if (!cond) {
+    std::cerr << "[FAIL] " << msg << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool same_frames(const std::vector<FpgaSharedStream::Frame>& a,
+                 const std::vector<FpgaSharedStream::Frame>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (a[i].word0 != b[i].word0 || a[i].word1 != b[i].word1 || a[i].word2 != b[i].word2 ||
+        a[i].word3 != b[i].word3 || a[i].word4 != b[i].word4 || a[i].word5 != b[i].word5 ||
+        a[i].word6 != b[i].word6 || a[i].word7 != b[i].word7) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<FpgaSharedStream::Frame> generate(Workloads::Kind kind, uint32_t symbols,
+                                              uint64_t total, uint64_t seed) {
+  Workloads::Config config = Workloads::DefaultConfig();
+  config.kind = kind;
+  config.num_symbols = symbols;
+  config.seed = seed;
+  std::vector<FpgaSharedStream::Frame> events;
+  Workloads::Generate(config, total, &events);
+  return events;
+}
+
+uint32_t levels(const uint32_t* qtys, uint32_t depth) {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < depth; ++i) {
+    count += qtys[i] != 0 ? 1u : 0u;
+  }
+  return count;
+}
+
+bool test_names_and_determinism() {
+  for (int k = 0; k < Workloads::kNumKinds; ++k) {
+    Workloads::Kind parsed = Workloads::kNumKinds;
+    const Workloads::Kind kind = static_cast<Workloads::Kind>(k);
+    if (!check(Workloads::Parse(Workloads::Name(kind), &parsed) && parsed == kind,
+               "names should round-trip")) return false;
+    if (kind == Workloads::kFile) {
+      continue;
+    }
+    const std::vector<FpgaSharedStream::Frame> a = generate(kind, 8, 5000, 3);
+    if (!check(a.size() == 5000 && a.front().word0 == 1 && a.back().word0 == 5000,
+               "events are numbered from 1")) return false;
+    if (!check(same_frames(a, generate(kind, 8, 5000, 3)), "same seed, same stream")) {
+      return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      if (!check(a[i].word1 < 8, "symbols stay in range")) return false;
+    }
+    if (kind != Workloads::kRoundRobin &&
+        !check(!same_frames(a, generate(kind, 8, 5000, 4)), "seed should change the stream")) {
+      return false;
+    }
+  }
+  Workloads::Kind parsed = Workloads::kRoundRobin;
+  return check(!Workloads::Parse("bogus", &parsed), "unknown names are rejected");
+}
+
+bool test_round_robin_pattern() {
+  const std::vector<FpgaSharedStream::Frame> events =
+      generate(Workloads::kRoundRobin, 5, 10, Workloads::kDefaultSeed);
+  // idx 3: symbol 3, sell, ticks (51 % 80) + 1 = 52, qty 100 + 111.
+  const FpgaSharedStream::Frame& e = events[3];
+  return check(e.word0 == 4 && e.word1 == 3 && e.word5 == SwOrderBook::kSideSell &&
+                   e.word2 == 1700000u + 5200u && e.word3 == 211 &&
+                   e.word4 == SwOrderBook::kEventUpsertLevel,
+               "round-robin keeps the original fpga_benchmark pattern");
+}
+
+bool test_zipf_skew() {
+  const std::vector<FpgaSharedStream::Frame> events = generate(Workloads::kZipf, 64, 100000, 1);
+  std::vector<uint64_t> counts(64, 0);
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    ++counts[events[i].word1];
+  }
+  // s = 1.2 over 64 symbols: the hottest takes ~28%, the coldest ~0.2%.
+  return check(counts[0] > 25000 && counts[0] > 2 * counts[1] && counts[63] < 1000,
+               "zipf should concentrate on the first symbols");
+}
+
+bool test_book_effects() {
+  SwOrderBook::Config config = SwOrderBook::DefaultConfig();
+  config.num_symbols = 4;
+
+  // Deletes name levels that are in the book.
+  SwOrderBook deletes(config);
+  const std::vector<FpgaSharedStream::Frame> heavy =
+      generate(Workloads::kDeleteHeavy, 4, 20000, 1);
+  uint64_t delete_events = 0;
+  uint64_t hits = 0;
+  for (std::size_t i = 0; i < heavy.size(); ++i) {
+    const FpgaSharedStream::Frame& e = heavy[i];
+    if (e.word4 == SwOrderBook::kEventDeleteLevel) {
+      ++delete_events;
+      const uint32_t* px = e.word5 == SwOrderBook::kSideBuy ? deletes.BidPrices(e.word1)
+                                                            : deletes.AskPrices(e.word1);
+      for (uint32_t l = 0; l < config.depth; ++l) {
+        hits += px[l] == e.word2 ? 1u : 0u;
+      }
+    }
+    deletes.Process(e);
+  }
+  if (!check(delete_events > heavy.size() * 2 / 5 && hits == delete_events,
+             "delete-heavy deletes should hit live levels")) return false;
+
+  // Depth churn keeps every level filled.
+  SwOrderBook churn(config);
+  const std::vector<FpgaSharedStream::Frame> churn_events =
+      generate(Workloads::kDepthChurn, 4, 5000, 1);
+  for (std::size_t i = 0; i < churn_events.size(); ++i) {
+    churn.Process(churn_events[i]);
+  }
+  for (uint32_t s = 0; s < 4; ++s) {
+    if (!check(levels(churn.BidQtys(s), config.depth) >= config.depth - 1 &&
+                   levels(churn.AskQtys(s), config.depth) >= config.depth - 1,
+               "depth-churn should keep the book full")) return false;
+  }
+
+  // Crossing prices are dropped by the book instead of crossing it.
+  SwOrderBook cross(config);
+  const std::vector<FpgaSharedStream::Frame> crossing = generate(Workloads::kCrossing, 4, 5000, 1);
+  uint64_t through = 0;
+  for (std::size_t i = 0; i < crossing.size(); ++i) {
+    const FpgaSharedStream::Frame& e = crossing[i];
+    const SwOrderBook::TopOfBook before = cross.Top(e.word1);
+    through += e.word5 == SwOrderBook::kSideBuy ? (before.ask_qty != 0 && e.word2 >= before.ask_px)
+                                                : (before.bid_qty != 0 && e.word2 <= before.bid_px);
+    cross.Process(e);
+    const SwOrderBook::TopOfBook& top = cross.Top(e.word1);
+    if (!check(top.bid_qty == 0 || top.ask_qty == 0 || top.bid_px < top.ask_px,
+               "book must never cross")) return false;
+  }
+  if (!check(through > crossing.size() / 4, "crossing should send many through prices")) {
+    return false;
+  }
+
+  // Resets come in bursts at the start of each period.
+  const std::vector<FpgaSharedStream::Frame> storm =
+      generate(Workloads::kResetStorm, 4, 3 * Workloads::kStormPeriod, 1);
+  for (std::size_t i = 0; i < storm.size(); ++i) {
+    const bool in_burst = i % Workloads::kStormPeriod < Workloads::kStormLength;
+    if (!check((storm[i].word4 == SwOrderBook::kEventResetBook) == in_burst,
+               "reset-storm bursts")) return false;
+  }
+  return true;
+}
+
+bool test_file_replay() {
+  char path[] = "/tmp/workloads_testXXXXXX";
+  const int fd = mkstemp(path);
+  if (!check(fd >= 0, "temp file")) return false;
+  close(fd);
+
+  const std::vector<FpgaSharedStream::Frame> recorded = generate(Workloads::kUniform, 8, 100, 9);
+  bool ok = check(Workloads::SaveFile(path, recorded), "save");
+  Workloads::Config config = Workloads::DefaultConfig();
+  config.kind = Workloads::kFile;
+  config.path = path;
+  std::vector<FpgaSharedStream::Frame> replayed;
+  ok = ok && check(Workloads::Generate(config, 250, &replayed) && replayed.size() == 250,
+                   "replay to a longer length");
+  ok = ok && check(replayed[0].word0 == 1 && replayed[249].word0 == 250, "replay is renumbered");
+  ok = ok && check(replayed[150].word1 == recorded[50].word1 &&
+                       replayed[150].word2 == recorded[50].word2 &&
+                       replayed[150].word4 == recorded[50].word4,
+                   "replay repeats the recording");
+
+  {
+    std::FILE* file = std::fopen(path, "ab");
+    std::fputc(0, file);
+    std::fclose(file);
+  }
+  ok = ok && check(!Workloads::Generate(config, 10, &replayed), "torn frame is rejected");
+  std::remove(path);
+  return ok && check(!Workloads::Generate(config, 10, &replayed), "missing file is rejected");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = test_names_and_determinism();
+  ok = ok && test_round_robin_pattern();
+  ok = ok && test_zipf_skew();
+  ok = ok && test_book_effects();
+  ok = ok && test_file_replay();
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "[PASS] workloads_test\n";
+  return 0;
+}
@@ -20,6 +20,17 @@ endif()
 set(CMAKE_C_COMPILER "${HFT_C_COMPILER}" CACHE STRING "C compiler" FORCE)
 set(CMAKE_CXX_COMPILER "${HFT_CXX_COMPILER}" CACHE STRING "CXX compiler" FORCE)
 
+# The DE10-Nano's Cortex-A9 has NEON, but armhf compilers default to a
+# VFP-only -mfpu, which compiles the NEON book kernels and slot copy out.
+# -DHFT_ARM_NEON=OFF builds for a core without NEON.
+if(NOT DEFINED HFT_ARM_NEON)
+    set(HFT_ARM_NEON ON)
+endif()
+if(HFT_ARM_NEON)
+    set(CMAKE_C_FLAGS_INIT "-mfpu=neon")
+    set(CMAKE_CXX_FLAGS_INIT "-mfpu=neon")
+endif()
+
 # Avoid configure-time test executables that cannot run on the build host.
 set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
 
@@ -6,7 +6,11 @@ entity arm_fpga_shared_stream_bridge is
   generic (
     G_ADDR_WIDTH : natural := 13; -- byte address width
     G_DEPTH      : natural := 64;
-    G_SLOT_WORDS : natural := 8   -- 8 words = 256-bit frame
+    G_SLOT_WORDS : natural := 8;  -- 8 words = 256-bit frame
+    G_PERF_HIST_BUCKETS : natural := 16; -- at most 16 (0x060..0x09C)
+    -- Book readback window after the RX ring; depth 0 leaves it out
+    G_NUM_SYMBOLS : natural := 0;
+    G_BOOK_DEPTH  : natural := 0
   );
   port (
     clk_i     : in  std_logic;
@@ -39,7 +43,17 @@ entity arm_fpga_shared_stream_bridge is
     perf_max_lat_cycles_i   : in  std_logic_vector(31 downto 0);
     perf_sum_lat_cycles_i   : in  std_logic_vector(63 downto 0);
     perf_cmd_stall_cycles_i : in  std_logic_vector(31 downto 0);
-    perf_rsp_stall_cycles_i : in  std_logic_vector(31 downto 0)
+    perf_rsp_stall_cycles_i : in  std_logic_vector(31 downto 0);
+    -- Latency histogram, bucket i in bits [32*i+31 : 32*i]
+    perf_hist_i             : in  std_logic_vector(G_PERF_HIST_BUCKETS * 32 - 1 downto 0) := (others => '0');
+
+    -- Book readback from the order book, see order_book_core
+    book_rd_req_o        : out std_logic;
+    book_rd_req_symbol_o : out std_logic_vector(31 downto 0);
+    book_rd_data_i       : in  std_logic_vector(G_BOOK_DEPTH * 128 - 1 downto 0) := (others => '0');
+    book_rd_seq_i        : in  std_logic_vector(31 downto 0) := (others => '0');
+    book_rd_symbol_i     : in  std_logic_vector(31 downto 0) := (others => '0');
+    book_rd_count_i      : in  std_logic_vector(31 downto 0) := (others => '0')
   );
 end entity;
 
@@ -69,9 +83,19 @@ architecture rtl of arm_fpga_shared_stream_bridge is
   constant C_REG_PERF_SUM_LAT_CYCLES_HI_W : natural := 16#04C# / 4;
   constant C_REG_PERF_CMD_STALL_CYCLES_W : natural := 16#050# / 4;
   constant C_REG_PERF_RSP_STALL_CYCLES_W : natural := 16#054# / 4;
+  constant C_REG_PERF_HIST_BUCKETS_W     : natural := 16#058# / 4;
+  constant C_REG_PERF_HIST_BASE_W        : natural := 16#060# / 4;
+  constant C_REG_BOOK_INFO_W  : natural := 16#0A0# / 4; -- symbols << 16 | depth, 0 if absent
+  constant C_REG_BOOK_BASE_W  : natural := 16#0A4# / 4; -- byte offset of the level window
+  constant C_REG_BOOK_CTRL_W  : natural := 16#0A8# / 4; -- write symbol to capture
+  constant C_REG_BOOK_COUNT_W : natural := 16#0AC# / 4; -- captures so far
+  constant C_REG_BOOK_SEQ_W   : natural := 16#0B0# / 4; -- global last event seq at the capture
 
   constant C_TX_BASE_W : natural := 16#100# / 4;
   constant C_RX_BASE_W : natural := C_TX_BASE_W + (G_DEPTH * G_SLOT_WORDS);
+  -- Four words per level: bid_px, bid_qty, ask_px, ask_qty
+  constant C_BOOK_BASE_W  : natural := C_RX_BASE_W + (G_DEPTH * G_SLOT_WORDS);
+  constant C_BOOK_WORDS   : natural := G_BOOK_DEPTH * 4;
 
   subtype t_slot is std_logic_vector(G_SLOT_WORDS * 32 - 1 downto 0);
   type t_ram is array (0 to G_DEPTH - 1) of t_slot;
@@ -94,6 +118,8 @@ architecture rtl of arm_fpga_shared_stream_bridge is
   signal cmd_valid_s : std_logic;
   signal rsp_ready_s : std_logic;
   signal perf_reset_q : std_logic := '0';
+  signal book_rd_req_q        : std_logic := '0';
+  signal book_rd_req_symbol_q : std_logic_vector(31 downto 0) := (others => '0');
 
   function f_inc_wrap(v : unsigned) return unsigned is
     variable r : unsigned(v'range);
@@ -127,6 +153,16 @@ architecture rtl of arm_fpga_shared_stream_bridge is
   end function;
 
 begin
+  assert G_PERF_HIST_BUCKETS <= 16
+    report "G_PERF_HIST_BUCKETS must fit in 0x060..0x09C"
+    severity failure;
+  assert G_NUM_SYMBOLS < 65536 and G_BOOK_DEPTH < 65536
+    report "G_NUM_SYMBOLS and G_BOOK_DEPTH must fit in 16 bits of BOOK_INFO"
+    severity failure;
+  assert (C_BOOK_BASE_W + C_BOOK_WORDS) * 4 <= 2 ** G_ADDR_WIDTH
+    report "book readback window must fit in G_ADDR_WIDTH"
+    severity failure;
+
   tx_empty_s <= '1' when tx_head_q = tx_tail_q else '0';
   tx_full_s  <= '1' when f_inc_wrap(tx_head_q) = tx_tail_q else '0';
   rx_empty_s <= '1' when rx_head_q = rx_tail_q else '0';
@@ -139,6 +175,8 @@ begin
   cmd_data_o  <= tx_ram_q(to_integer(tx_tail_q));
   rsp_ready_o <= rsp_ready_s;
   perf_reset_o <= perf_reset_q;
+  book_rd_req_o <= book_rd_req_q;
+  book_rd_req_symbol_o <= book_rd_req_symbol_q;
 
   mm_rdata_o <= mm_rdata_q;
   mm_ready_o <= mm_ready_q;
@@ -162,6 +200,7 @@ begin
         mm_ready_q <= '0';
         mm_rdata_q <= (others => '0');
         perf_reset_q <= '0';
+        book_rd_req_q <= '0';
 
         -- Consume ARM->FPGA queue into stream.
         if cmd_valid_s = '1' and cmd_ready_i = '1' then
@@ -189,6 +228,10 @@ begin
           elsif waddr = C_REG_PERF_CTRL_W then
             -- bit0: one-cycle reset pulse for performance counters
             perf_reset_q <= mm_wdata_i(0);
+          elsif waddr = C_REG_BOOK_CTRL_W then
+            -- one-cycle capture request; BOOK_COUNT advances once it lands
+            book_rd_req_q <= '1';
+            book_rd_req_symbol_q <= mm_wdata_i;
           elsif waddr = C_REG_TX_HEAD_W then
             tx_head_q <= to_unsigned(
               to_integer(unsigned(mm_wdata_i(15 downto 0))) mod G_DEPTH,
@@ -262,6 +305,29 @@ begin
             mm_rdata_q <= perf_cmd_stall_cycles_i;
           elsif waddr = C_REG_PERF_RSP_STALL_CYCLES_W then
             mm_rdata_q <= perf_rsp_stall_cycles_i;
+          elsif waddr = C_REG_PERF_HIST_BUCKETS_W then
+            mm_rdata_q <= std_logic_vector(to_unsigned(G_PERF_HIST_BUCKETS, 32));
+          elsif waddr >= C_REG_PERF_HIST_BASE_W and waddr < (C_REG_PERF_HIST_BASE_W + G_PERF_HIST_BUCKETS) then
+            rel := waddr - C_REG_PERF_HIST_BASE_W;
+            mm_rdata_q <= perf_hist_i(rel * 32 + 31 downto rel * 32);
+          elsif waddr = C_REG_BOOK_INFO_W then
+            if G_BOOK_DEPTH /= 0 then
+              mm_rdata_q <= std_logic_vector(to_unsigned(G_NUM_SYMBOLS, 16)) &
+                            std_logic_vector(to_unsigned(G_BOOK_DEPTH, 16));
+            end if;
+          elsif waddr = C_REG_BOOK_BASE_W then
+            if G_BOOK_DEPTH /= 0 then
+              mm_rdata_q <= std_logic_vector(to_unsigned(C_BOOK_BASE_W * 4, 32));
+            end if;
+          elsif waddr = C_REG_BOOK_CTRL_W then
+            mm_rdata_q <= book_rd_symbol_i;
+          elsif waddr = C_REG_BOOK_COUNT_W then
+            mm_rdata_q <= book_rd_count_i;
+          elsif waddr = C_REG_BOOK_SEQ_W then
+            mm_rdata_q <= book_rd_seq_i;
+          elsif waddr >= C_BOOK_BASE_W and waddr < (C_BOOK_BASE_W + C_BOOK_WORDS) then
+            rel := waddr - C_BOOK_BASE_W;
+            mm_rdata_q <= book_rd_data_i(rel * 32 + 31 downto rel * 32);
           elsif waddr >= C_TX_BASE_W and waddr < (C_TX_BASE_W + (G_DEPTH * G_SLOT_WORDS)) then
             rel := waddr - C_TX_BASE_W;
             slot_idx := rel / G_SLOT_WORDS;
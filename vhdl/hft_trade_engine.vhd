@@ -30,6 +30,11 @@ architecture rtl of hft_trade_engine is
   subtype t_u64 is unsigned(63 downto 0);
   type t_timestamp_fifo is array (0 to G_DEPTH - 1) of t_u64;
 
+  -- Log2 latency histogram: bucket 0 counts latencies below 2 cycles,
+  -- bucket i counts [2^i, 2^(i+1)) and the last bucket is open-ended.
+  constant C_PERF_HIST_BUCKETS : natural := 16;
+  type t_perf_hist is array (0 to C_PERF_HIST_BUCKETS - 1) of unsigned(31 downto 0);
+
   signal cmd_valid_s : std_logic;
   signal cmd_data_s  : std_logic_vector(G_SLOT_WORDS * 32 - 1 downto 0);
   signal cmd_ready_s : std_logic;
@@ -53,6 +58,15 @@ architecture rtl of hft_trade_engine is
   signal perf_sum_lat_q  : t_u64 := (others => '0');
   signal perf_cmd_stall_q : unsigned(31 downto 0) := (others => '0');
   signal perf_rsp_stall_q : unsigned(31 downto 0) := (others => '0');
+  signal perf_hist_q      : t_perf_hist := (others => (others => '0'));
+  signal perf_hist_s      : std_logic_vector(C_PERF_HIST_BUCKETS * 32 - 1 downto 0);
+
+  signal book_rd_req_s        : std_logic;
+  signal book_rd_req_symbol_s : std_logic_vector(31 downto 0);
+  signal book_rd_data_s       : std_logic_vector(G_BOOK_DEPTH * 128 - 1 downto 0);
+  signal book_rd_seq_s        : std_logic_vector(31 downto 0);
+  signal book_rd_symbol_s     : std_logic_vector(31 downto 0);
+  signal book_rd_count_s      : std_logic_vector(31 downto 0);
 
   function f_inc_wrap(v : unsigned) return unsigned is
     variable r : unsigned(v'range);
@@ -73,12 +87,33 @@ architecture rtl of hft_trade_engine is
     end if;
     return v + 1;
   end function;
+
+  function f_log2_bucket(v : unsigned(31 downto 0)) return natural is
+    variable bucket_v : natural := 0;
+  begin
+    for i in 1 to 31 loop
+      if v(i) = '1' then
+        bucket_v := i;
+      end if;
+    end loop;
+    if bucket_v > C_PERF_HIST_BUCKETS - 1 then
+      bucket_v := C_PERF_HIST_BUCKETS - 1;
+    end if;
+    return bucket_v;
+  end function;
 begin
+  g_perf_hist : for i in 0 to C_PERF_HIST_BUCKETS - 1 generate
+    perf_hist_s(i * 32 + 31 downto i * 32) <= std_logic_vector(perf_hist_q(i));
+  end generate;
+
   u_bridge : entity work.arm_fpga_shared_stream_bridge
     generic map (
       G_ADDR_WIDTH => G_ADDR_WIDTH,
       G_DEPTH      => G_DEPTH,
-      G_SLOT_WORDS => G_SLOT_WORDS
+      G_SLOT_WORDS => G_SLOT_WORDS,
+      G_PERF_HIST_BUCKETS => C_PERF_HIST_BUCKETS,
+      G_NUM_SYMBOLS => G_NUM_SYMBOLS,
+      G_BOOK_DEPTH  => G_BOOK_DEPTH
     )
     port map (
       clk_i       => clk_i,
@@ -103,7 +138,14 @@ begin
       perf_max_lat_cycles_i   => std_logic_vector(perf_max_lat_q),
       perf_sum_lat_cycles_i   => std_logic_vector(perf_sum_lat_q),
       perf_cmd_stall_cycles_i => std_logic_vector(perf_cmd_stall_q),
-      perf_rsp_stall_cycles_i => std_logic_vector(perf_rsp_stall_q)
+      perf_rsp_stall_cycles_i => std_logic_vector(perf_rsp_stall_q),
+      perf_hist_i             => perf_hist_s,
+      book_rd_req_o           => book_rd_req_s,
+      book_rd_req_symbol_o    => book_rd_req_symbol_s,
+      book_rd_data_i          => book_rd_data_s,
+      book_rd_seq_i           => book_rd_seq_s,
+      book_rd_symbol_i        => book_rd_symbol_s,
+      book_rd_count_i         => book_rd_count_s
     );
 
   u_decision : entity work.trade_decision_core
@@ -122,7 +164,13 @@ begin
       cmd_ready_o => cmd_ready_s,
       rsp_valid_o => rsp_valid_s,
       rsp_data_o  => rsp_data_s,
-      rsp_ready_i => rsp_ready_s
+      rsp_ready_i => rsp_ready_s,
+      book_rd_req_i        => book_rd_req_s,
+      book_rd_req_symbol_i => book_rd_req_symbol_s,
+      book_rd_data_o       => book_rd_data_s,
+      book_rd_seq_o        => book_rd_seq_s,
+      book_rd_symbol_o     => book_rd_symbol_s,
+      book_rd_count_o      => book_rd_count_s
     );
 
   p_perf : process(clk_i)
@@ -151,6 +199,7 @@ begin
         perf_sum_lat_q <= (others => '0');
         perf_cmd_stall_q <= (others => '0');
         perf_rsp_stall_q <= (others => '0');
+        perf_hist_q <= (others => (others => '0'));
       else
         cycle_q <= cycle_q + 1;
 
@@ -194,6 +243,10 @@ begin
             perf_max_lat_q <= latency32_v;
           end if;
           perf_sum_lat_q <= perf_sum_lat_q + resize(latency32_v, perf_sum_lat_q'length);
+          -- Histogram buckets wrap instead of saturating so the host can take
+          -- modular deltas between samples.
+          perf_hist_q(f_log2_bucket(latency32_v)) <=
+            perf_hist_q(f_log2_bucket(latency32_v)) + 1;
           next_rsp_tracked_v := '1';
         end if;
 
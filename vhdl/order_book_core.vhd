@@ -25,7 +25,20 @@ entity order_book_core is
     best_ask_qty_o       : out std_logic_vector(31 downto 0);
     spread_1e4_o         : out std_logic_vector(31 downto 0);
     imbalance_o          : out std_logic_vector(31 downto 0);
-    snapshot_ready_i     : in  std_logic
+    snapshot_ready_i     : in  std_logic;
+
+    -- Book readback: a one-cycle request latches every level of one symbol.
+    -- Level i occupies book_rd_data_o(128*i+127 downto 128*i) as the words
+    -- bid_px, bid_qty, ask_px, ask_qty (lowest first). book_rd_seq_o is the
+    -- seq of the last event accepted before the capture, for any symbol (not
+    -- the last one that touched this symbol), and book_rd_count_o counts
+    -- captures so a poller can tell when a new one has landed.
+    book_rd_req_i        : in  std_logic := '0';
+    book_rd_req_symbol_i : in  std_logic_vector(31 downto 0) := (others => '0');
+    book_rd_data_o       : out std_logic_vector(G_BOOK_DEPTH * 128 - 1 downto 0);
+    book_rd_seq_o        : out std_logic_vector(31 downto 0);
+    book_rd_symbol_o     : out std_logic_vector(31 downto 0);
+    book_rd_count_o      : out std_logic_vector(31 downto 0)
   );
 end entity;
 
@@ -56,6 +69,11 @@ architecture rtl of order_book_core is
   signal spread_1e4_q         : std_logic_vector(31 downto 0) := (others => '0');
   signal imbalance_q          : std_logic_vector(31 downto 0) := (others => '0');
 
+  signal book_rd_data_q   : std_logic_vector(G_BOOK_DEPTH * 128 - 1 downto 0) := (others => '0');
+  signal book_rd_seq_q    : std_logic_vector(31 downto 0) := (others => '0');
+  signal book_rd_symbol_q : std_logic_vector(31 downto 0) := (others => '0');
+  signal book_rd_count_q  : unsigned(31 downto 0) := (others => '0');
+
   signal evt_ready_s : std_logic;
 
   function f_word(frame : std_logic_vector; idx : natural) return std_logic_vector is
@@ -168,6 +186,11 @@ begin
   spread_1e4_o         <= spread_1e4_q;
   imbalance_o          <= imbalance_q;
 
+  book_rd_data_o   <= book_rd_data_q;
+  book_rd_seq_o    <= book_rd_seq_q;
+  book_rd_symbol_o <= book_rd_symbol_q;
+  book_rd_count_o  <= std_logic_vector(book_rd_count_q);
+
   p_main : process(clk_i)
     variable v_bid_price   : t_side_matrix;
     variable v_bid_qty     : t_side_matrix;
@@ -294,4 +317,36 @@ begin
       end if;
     end if;
   end process;
+
+  -- Captures the registered book, i.e. the state after snapshot_seq_q and
+  -- before any event accepted in the same cycle. A symbol out of range
+  -- reads as an empty book.
+  p_book_readback : process(clk_i)
+    variable data_v : std_logic_vector(G_BOOK_DEPTH * 128 - 1 downto 0);
+    variable idx_v  : natural;
+  begin
+    if rising_edge(clk_i) then
+      if rst_ni = '0' then
+        book_rd_data_q <= (others => '0');
+        book_rd_seq_q <= (others => '0');
+        book_rd_symbol_q <= (others => '0');
+        book_rd_count_q <= (others => '0');
+      elsif book_rd_req_i = '1' then
+        data_v := (others => '0');
+        if unsigned(book_rd_req_symbol_i) < G_NUM_SYMBOLS then
+          idx_v := to_integer(unsigned(book_rd_req_symbol_i));
+          for i in 0 to G_BOOK_DEPTH - 1 loop
+            data_v(128 * i + 31 downto 128 * i) := std_logic_vector(bid_price_q(idx_v)(i));
+            data_v(128 * i + 63 downto 128 * i + 32) := std_logic_vector(bid_qty_q(idx_v)(i));
+            data_v(128 * i + 95 downto 128 * i + 64) := std_logic_vector(ask_price_q(idx_v)(i));
+            data_v(128 * i + 127 downto 128 * i + 96) := std_logic_vector(ask_qty_q(idx_v)(i));
+          end loop;
+        end if;
+        book_rd_data_q <= data_v;
+        book_rd_seq_q <= snapshot_seq_q;
+        book_rd_symbol_q <= book_rd_req_symbol_i;
+        book_rd_count_q <= book_rd_count_q + 1;
+      end if;
+    end if;
+  end process;
 end architecture rtl;
@@ -124,6 +124,10 @@ begin
     mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, 16#004#, rd_val);
     assert rd_val = x"00000001" report "VERSION mismatch" severity failure;
 
+    -- Without an order book attached the readback window is absent.
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, 16#0A0#, rd_val); -- BOOK_INFO
+    assert rd_val = x"00000000" report "BOOK_INFO should be 0 without a book" severity failure;
+
     -- Prepare one TX frame in slot 0
     mm_write(mm_addr, mm_wr, mm_wdata, mm_ready, C_TX_BASE + 16#000#, x"0000002A");
     mm_write(mm_addr, mm_wr, mm_wdata, mm_ready, C_TX_BASE + 16#004#, x"00000000");
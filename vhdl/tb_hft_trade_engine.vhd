@@ -17,9 +17,15 @@ architecture sim of tb_hft_trade_engine is
   constant C_REG_TX_TAIL : natural := 16#014#;
   constant C_REG_RX_HEAD : natural := 16#018#;
   constant C_REG_RX_TAIL : natural := 16#01C#;
+  constant C_REG_BOOK_INFO  : natural := 16#0A0#;
+  constant C_REG_BOOK_BASE  : natural := 16#0A4#;
+  constant C_REG_BOOK_CTRL  : natural := 16#0A8#;
+  constant C_REG_BOOK_COUNT : natural := 16#0AC#;
+  constant C_REG_BOOK_SEQ   : natural := 16#0B0#;
 
   constant C_TX_BASE : natural := 16#100#;
   constant C_RX_BASE : natural := C_TX_BASE + (C_DEPTH * C_SLOT_WORDS * 4);
+  constant C_BOOK_BASE : natural := C_RX_BASE + (C_DEPTH * C_SLOT_WORDS * 4);
 
   constant C_ACTION_NOOP : std_logic_vector(31 downto 0) := x"00000000";
   constant C_ACTION_BUY  : std_logic_vector(31 downto 0) := x"00000001";
@@ -260,6 +266,34 @@ begin
     assert rd_val(2) = '0' report "STATUS.rx_has_data should clear after drain" severity failure;
     assert rd_val(3) = '0' report "STATUS.rx_full should clear after drain" severity failure;
 
+    -- Book readback window: symbol 0 after the three events.
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_REG_BOOK_INFO, rd_val);
+    assert rd_val = x"00080008" report "BOOK_INFO should report 8 symbols of depth 8" severity failure;
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_REG_BOOK_BASE, rd_val);
+    assert rd_val = f_u32(C_BOOK_BASE) report "BOOK_BASE should follow the RX ring" severity failure;
+    mm_write(mm_addr, mm_wr, mm_wdata, mm_ready, C_REG_BOOK_CTRL, x"00000000");
+    for i in 0 to 3 loop
+      wait until rising_edge(clk);
+    end loop;
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_REG_BOOK_COUNT, rd_val);
+    assert rd_val = x"00000001" report "BOOK_COUNT should advance after a capture" severity failure;
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_REG_BOOK_SEQ, rd_val);
+    assert rd_val = x"00000003" report "BOOK_SEQ should be the last event seq" severity failure;
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_REG_BOOK_CTRL, rd_val);
+    assert rd_val = x"00000000" report "BOOK_CTRL should read back the captured symbol" severity failure;
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_BOOK_BASE + 0, rd_val);
+    assert rd_val = x"001C3A90" report "book L0 bid px mismatch" severity failure;
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_BOOK_BASE + 4, rd_val);
+    assert rd_val = x"000009C4" report "book L0 bid qty mismatch" severity failure;
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_BOOK_BASE + 8, rd_val);
+    assert rd_val = x"001C4260" report "book L0 ask px mismatch" severity failure;
+    mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_BOOK_BASE + 12, rd_val);
+    assert rd_val = x"00000C80" report "book L0 ask qty mismatch" severity failure;
+    for lane in 4 to 7 loop
+      mm_read(mm_addr, mm_rd, mm_rdata, mm_ready, C_BOOK_BASE + lane * 4, rd_val);
+      assert rd_val = x"00000000" report "book L1 should be empty" severity failure;
+    end loop;
+
     report "tb_hft_trade_engine PASSED" severity note;
     wait;
   end process;
@@ -17,6 +17,8 @@ architecture tb of tb_hft_trade_engine_avalon_mm is
   constant C_REG_PERF_MIN   : natural := 16#040#;
   constant C_REG_PERF_MAX   : natural := 16#044#;
   constant C_REG_PERF_SUM_LO : natural := 16#048#;
+  constant C_REG_PERF_HIST_BUCKETS : natural := 16#058#;
+  constant C_REG_PERF_HIST_BASE    : natural := 16#060#;
   constant C_TX_BASE        : natural := 16#100#;
 
   signal clk_i             : std_logic := '0';
@@ -97,6 +99,8 @@ begin
     end procedure;
 
     variable rdata_v : std_logic_vector(31 downto 0);
+    variable count_v : unsigned(31 downto 0);
+    variable hist_sum_v : unsigned(31 downto 0);
   begin
     -- ==========================
     -- 1) During reset, bridge must not hang
@@ -158,6 +162,7 @@ begin
     assert unsigned(rdata_v) >= 1
       report "PERF_COUNT did not advance"
       severity failure;
+    count_v := unsigned(rdata_v);
 
     avalon_read(C_REG_PERF_LAST, rdata_v);
     assert unsigned(rdata_v) > 0
@@ -179,6 +184,20 @@ begin
       report "PERF_SUM_LAT_CYCLES_LO did not advance"
       severity failure;
 
+    avalon_read(C_REG_PERF_HIST_BUCKETS, rdata_v);
+    assert rdata_v = x"00000010"
+      report "PERF_HIST_BUCKETS mismatch"
+      severity failure;
+
+    hist_sum_v := (others => '0');
+    for i in 0 to 15 loop
+      avalon_read(C_REG_PERF_HIST_BASE + 4 * i, rdata_v);
+      hist_sum_v := hist_sum_v + unsigned(rdata_v);
+    end loop;
+    assert hist_sum_v = count_v
+      report "PERF_HIST buckets do not add up to PERF_COUNT"
+      severity failure;
+
     -- ==========================
     -- 5) Reset performance counters
     -- ==========================
@@ -188,6 +207,12 @@ begin
     assert rdata_v = x"00000000"
       report "PERF_COUNT did not reset"
       severity failure;
+    for i in 0 to 15 loop
+      avalon_read(C_REG_PERF_HIST_BASE + 4 * i, rdata_v);
+      assert rdata_v = x"00000000"
+        report "PERF_HIST bucket did not reset"
+        severity failure;
+    end loop;
 
     -- ==========================
     -- 6) Finish
@@ -33,6 +33,13 @@ architecture tb of tb_order_book_core is
   signal spread_1e4         : std_logic_vector(31 downto 0);
   signal imbalance          : std_logic_vector(31 downto 0);
 
+  signal book_rd_req        : std_logic := '0';
+  signal book_rd_req_symbol : std_logic_vector(31 downto 0) := (others => '0');
+  signal book_rd_data       : std_logic_vector(C_BOOK_DEPTH * 128 - 1 downto 0);
+  signal book_rd_seq        : std_logic_vector(31 downto 0);
+  signal book_rd_symbol     : std_logic_vector(31 downto 0);
+  signal book_rd_count      : std_logic_vector(31 downto 0);
+
   procedure push_event(
     signal valid_s : out std_logic;
     signal data_s  : out std_logic_vector(C_SLOT_WORDS * 32 - 1 downto 0);
@@ -85,7 +92,13 @@ begin
       best_ask_qty_o       => best_ask_qty,
       spread_1e4_o         => spread_1e4,
       imbalance_o          => imbalance,
-      snapshot_ready_i     => '1'
+      snapshot_ready_i     => '1',
+      book_rd_req_i        => book_rd_req,
+      book_rd_req_symbol_i => book_rd_req_symbol,
+      book_rd_data_o       => book_rd_data,
+      book_rd_seq_o        => book_rd_seq,
+      book_rd_symbol_o     => book_rd_symbol,
+      book_rd_count_o      => book_rd_count
     );
 
   stim : process
@@ -139,6 +152,33 @@ begin
     assert best_ask_qty = x"00000000" report "best ask qty should clear after delete" severity failure;
     assert spread_1e4 = x"00000000" report "spread should clear after delete" severity failure;
 
+    -- Book readback: every level of symbol 0 as left by the events above.
+    book_rd_req_symbol <= x"00000000";
+    book_rd_req <= '1';
+    wait until rising_edge(clk);
+    book_rd_req <= '0';
+    wait until rising_edge(clk);
+    assert book_rd_count = x"00000001" report "readback count mismatch" severity failure;
+    assert book_rd_seq = x"00000006" report "readback seq mismatch, got " & to_hstring(book_rd_seq) severity failure;
+    assert book_rd_symbol = x"00000000" report "readback symbol mismatch" severity failure;
+    assert book_rd_data(31 downto 0) = x"001C3E78" report "readback L0 bid px mismatch" severity failure;
+    assert book_rd_data(63 downto 32) = x"00000708" report "readback L0 bid qty mismatch" severity failure;
+    assert book_rd_data(127 downto 64) = x"0000000000000000" report "readback L0 ask should be empty" severity failure;
+    assert book_rd_data(159 downto 128) = x"001C3A90" report "readback L1 bid px mismatch" severity failure;
+    assert book_rd_data(191 downto 160) = x"000009C4" report "readback L1 bid qty mismatch" severity failure;
+    assert unsigned(book_rd_data(C_BOOK_DEPTH * 128 - 1 downto 256)) = 0
+      report "readback levels past L1 should be empty" severity failure;
+
+    -- A symbol out of range reads as an empty book.
+    book_rd_req_symbol <= x"00000009";
+    book_rd_req <= '1';
+    wait until rising_edge(clk);
+    book_rd_req <= '0';
+    wait until rising_edge(clk);
+    assert book_rd_count = x"00000002" report "readback count should advance" severity failure;
+    assert book_rd_symbol = x"00000009" report "readback symbol mismatch for bad symbol" severity failure;
+    assert unsigned(book_rd_data) = 0 report "bad symbol should read as an empty book" severity failure;
+
     report "tb_order_book_core PASSED" severity note;
     wait;
   end process;
@@ -19,7 +19,15 @@ entity trade_decision_core is
 
     rsp_valid_o : out std_logic;
     rsp_data_o  : out std_logic_vector(G_SLOT_WORDS * 32 - 1 downto 0);
-    rsp_ready_i : in std_logic
+    rsp_ready_i : in std_logic;
+
+    -- Book readback, see order_book_core.
+    book_rd_req_i        : in  std_logic := '0';
+    book_rd_req_symbol_i : in  std_logic_vector(31 downto 0) := (others => '0');
+    book_rd_data_o       : out std_logic_vector(G_BOOK_DEPTH * 128 - 1 downto 0);
+    book_rd_seq_o        : out std_logic_vector(31 downto 0);
+    book_rd_symbol_o     : out std_logic_vector(31 downto 0);
+    book_rd_count_o      : out std_logic_vector(31 downto 0)
   );
 end entity;
 
@@ -56,7 +64,13 @@ begin
       best_ask_qty_o       => best_ask_qty_s,
       spread_1e4_o         => spread_1e4_s,
       imbalance_o          => imbalance_s,
-      snapshot_ready_i     => snapshot_ready_s
+      snapshot_ready_i     => snapshot_ready_s,
+      book_rd_req_i        => book_rd_req_i,
+      book_rd_req_symbol_i => book_rd_req_symbol_i,
+      book_rd_data_o       => book_rd_data_o,
+      book_rd_seq_o        => book_rd_seq_o,
+      book_rd_symbol_o     => book_rd_symbol_o,
+      book_rd_count_o      => book_rd_count_o
     );
 
   u_strategy : entity work.generated_strategy_core